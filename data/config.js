@@ -29,6 +29,10 @@ window.AppConfig = {
   // ESP32: "/stream", IP Webcam Android: "/video", "/videofeed" и т.д.
   STREAM_PATH: '/stream',
   
+  // Сокращённые JPEG (только ESP32): таблицы JPEG приходят один раз,
+  // дальше только scan-данные. Кадры собирает MjpegReader (mjpeg-reader.js)
+  STREAM_ABBREV: false,
+  
   // === MJPEG Proxy (обход CORS) ===
   // Для источников без CORS (IP Webcam, внешние камеры)
   // Работает только через dev-server!
@@ -53,6 +57,15 @@ window.AppConfig = {
   
   // API телеметрии (для OSD)
   STATUS_API: '/api/status',
+
+  // WebSocket управления (тот же JSON, что и CONTROL_API)
+  CONTROL_WS: '/ws/control',
+
+  // Expo/ремап осей джойстика в прошивке
+  MIXER_API: '/api/mixer',
+
+  // Аренда управления (один пульт ведёт, остальные ждут)
+  LEASE_API: '/api/lease',
   
   // === Управление ===
   
@@ -68,6 +81,11 @@ window.AppConfig = {
     outputMaxX: 255,          // Руль: макс. PWM
     outputMinY: 0,            // Газ: мин. PWM
     outputMaxY: 255,          // Газ: макс. PWM
+    transport: 'ws',          // 'ws' — одно WebSocket-соединение, 'http' — POST на тик
+    wsAck: false,             // ACK на каждое WS-сообщение (RTT для отладки)
+    shaping: 'device',        // 'device' — expo/ремап в прошивке, 'client' — в браузере
+    leasePriority: 10,        // Приоритет аренды управления (0 = не брать)
+    leaseTtlMs: 3000,         // TTL аренды (мс), продлевается командами
   },
   
   // === Джойстики ===
@@ -197,6 +215,7 @@ window.AppConfig = {
   OSD: {
     enabled: true,            // OSD включён по умолчанию
     pollIntervalSec: 5,       // Интервал опроса (секунды, 1-10)
+    streamTelemetryHz: 0,     // Телеметрия part'ами MJPEG-стрима (Гц, 0 = polling /api/status)
   },
   
   // === Утилиты ===
@@ -230,6 +249,13 @@ window.AppConfig = {
   getApiUrl(endpoint) {
     return `${this.getApiBase()}${endpoint}`;
   },
+
+  /**
+   * Получить URL WebSocket endpoint (ws:// на том же хосте, что и API)
+   */
+  getWsUrl(endpoint) {
+    return this.getApiBase().replace(/^http/, 'ws') + endpoint;
+  },
   
   // === Сохранение настроек (localStorage) ===
   
@@ -243,6 +269,7 @@ window.AppConfig = {
       VIDEO_HOST: this.VIDEO_HOST,
       STREAM_PORT: this.STREAM_PORT,
       STREAM_PATH: this.STREAM_PATH,
+      STREAM_ABBREV: this.STREAM_ABBREV,
       USE_PROXY: this.USE_PROXY,
       EXTERNAL_STREAM_URL: this.EXTERNAL_STREAM_URL,
       CONTROL: { ...this.CONTROL },
@@ -261,7 +288,7 @@ window.AppConfig = {
     if (saved) {
       try {
         const parsed = JSON.parse(saved);
-        const networkKeys = ['ESP32_HOST', 'VIDEO_HOST', 'STREAM_PORT', 'STREAM_PATH', 'USE_PROXY', 'EXTERNAL_STREAM_URL'];
+        const networkKeys = ['ESP32_HOST', 'VIDEO_HOST', 'STREAM_PORT', 'STREAM_PATH', 'STREAM_ABBREV', 'USE_PROXY', 'EXTERNAL_STREAM_URL'];
         networkKeys.forEach(k => { if (parsed[k] !== undefined) this[k] = parsed[k]; });
         if (parsed.CONTROL && typeof parsed.CONTROL === 'object') {
           Object.assign(this.CONTROL, parsed.CONTROL);
@@ -9,13 +9,23 @@
  *   - Throttle/debounce логику
  *   - Sync tick (периодическая синхронизация с сервером)
  *   - Clamp/map преобразования
- *   - AbortController для switchMap паттерна
+ *   - AbortController для switchMap паттерна (HTTP)
+ *   - WebSocket-транспорт (/ws/control) с latest-wins отправкой
+ *   - Замер латентности обоих транспортов (measureLatency)
+ *   - Expo/ремап осей: в прошивке (/api/mixer, shaping: 'device')
+ *     или на клиенте (shaping: 'client')
+ *   - Аренда управления (/api/lease, leasePriority > 0): токен в
+ *     каждой команде; чужая аренда — команды отклоняются (409),
+ *     повторная попытка после её истечения
  * 
  * Использование:
  *   const control = new ControlService('/api/control');
  *   control.onStateChange = (state) => updateUI(state);
  *   control.setXY(100, -50);
  *   control.stop();
+ *
+ *   // Сравнение латентности WS и POST (шлёт только stop)
+ *   control.measureLatency(200).then(console.table);
  * 
  * ============================================================
  */
@@ -34,6 +44,16 @@ class ControlService {
     outputMaxX: 255,          // Руль: макс. PWM выхода
     outputMinY: 0,            // Газ: мин. PWM выхода
     outputMaxY: 255,          // Газ: макс. PWM выхода
+    transport: 'http',        // 'http' — POST на тик, 'ws' — одно WebSocket-соединение
+    wsUrl: null,              // URL /ws/control (для transport: 'ws')
+    wsAck: false,             // Просить ACK у устройства (RTT в state.rttMs)
+    wsReconnectMs: 1000,      // Пауза перед переподключением WS
+    shaping: 'client',        // 'client' — expo/ремап здесь, 'device' — таблицы прошивки
+    mixerUrl: '/api/mixer',   // API настроек осей (для shaping: 'device')
+    leaseUrl: '/api/lease',   // API аренды управления
+    leasePriority: 0,         // Приоритет аренды 1-255 (0 = без аренды)
+    leaseTtlMs: 3000,         // TTL аренды (продлевается каждой командой)
+    leaseOwner: 'web',        // Имя держателя (видно в /api/lease)
   };
 
   constructor(apiUrl = ControlService.DEFAULTS.apiUrl, options = {}) {
@@ -61,12 +81,29 @@ class ControlService {
       // Статус
       pending: false,         // Есть ли запрос в полёте
       error: null,
+      rttMs: null,            // Последний RTT команды (мс)
+      leaseOwner: null,       // Держатель чужой аренды (команды отклоняются)
     };
 
     // === SwitchMap ===
     this._abortController = null;
     this._requestId = 0;
 
+    // === WebSocket ===
+    this._ws = null;
+    this._wsSeq = 0;
+    this._wsReconnectTimer = null;
+    this._wsWaiters = new Map();   // seq → resolve (measureLatency)
+
+    // === Аренда ===
+    this._leaseToken = 0;          // 0 — аренды нет
+    this._leaseCheckedAt = 0;      // Последний ответ /api/lease (Date.now)
+    this._leaseRetryAt = 0;        // Чужая аренда: не просить раньше
+    this._leasePending = false;
+
+    // === Латентность (последние N замеров, мс) ===
+    this._latency = { ws: [], http: [] };
+
     // === Tick loop ===
     this._tickTimer = null;
 
@@ -87,7 +124,9 @@ class ControlService {
     if (this._tickTimer) return;
     
     this._tickTimer = setInterval(() => this._tick(), this.config.tickIntervalMs);
-    console.log('🎮 ControlService started');
+    if (this.config.transport === 'ws') this._wsConnect();
+    if (this.config.shaping === 'device') this.syncMixer();
+    console.log('🎮 ControlService started (' + this.config.transport + ')');
   }
 
   /**
@@ -107,6 +146,8 @@ class ControlService {
     
     // Отправляем stop на сервер
     this._sendImmediate(0, 0);
+    this._wsClose();
+    this._leaseRelease();
     
     console.log('🎮 ControlService stopped');
   }
@@ -249,13 +290,12 @@ class ControlService {
   // Private: Network
   // ============================================================
 
-  _send(x, y) {
-    // SwitchMap: отменяем предыдущий
-    this._abort();
-    this._abortController = new AbortController();
-    
-    const thisRequestId = ++this._requestId;
-    
+  _send(x, y, force = false) {
+    // WebSocket latest-wins: пока предыдущее сообщение в буфере сокета —
+    // не ставим новое в очередь. lastSent не обновляется, и следующий
+    // tick отправит самое свежее значение.
+    if (this._wsReady() && this._ws.bufferedAmount > 0 && !force) return;
+
     // Применяем expo кривую (раздельно для каждой оси)
     const expoX = this._applyExpo(x, this.config.expoX);
     const expoY = this._applyExpo(y, this.config.expoY);
@@ -264,6 +304,11 @@ class ControlService {
     const outX = this._remapOutput(expoX, this.config.outputMinX, this.config.outputMaxX);
     const outY = this._remapOutput(expoY, this.config.outputMinY, this.config.outputMaxY);
     
+    // Device shaping: кривые применит прошивка, шлём сырые значения
+    const device = this.config.shaping === 'device';
+    const sendX = device ? x : outX;
+    const sendY = device ? y : outY;
+    
     // Обновляем state (сырые + expo значения)
     this._updateState({
       expoX: expoX,
@@ -273,22 +318,47 @@ class ControlService {
       lastSentX: x,
       lastSentY: y,
       lastSentTime: Date.now(),
-      pending: true,
+      pending: !this._wsReady(),
       error: null,
     });
 
+    // t — метка отправки (мкс по модулю 2^32): по ней джиттер-буфер
+    // прошивки восстанавливает порядок и интервалы команд
+    const msg = { type: 'xy', x: sendX, y: sendY, t: this._nowUs() };
+    this._leaseTick();
+    if (this._leaseToken) msg.lease = this._leaseToken;
+
+    if (this._wsReady()) {
+      this._wsSend(msg, this.config.wsAck);
+      return;
+    }
+
+    // SwitchMap: отменяем предыдущий
+    this._abort();
+    this._abortController = new AbortController();
+    
+    const thisRequestId = ++this._requestId;
+    const t0 = performance.now();
+
     fetch(this.config.apiUrl, {
       method: 'POST',
       headers: { 'Content-Type': 'application/json' },
-      body: JSON.stringify({ type: 'xy', x: outX, y: outY }),
+      body: JSON.stringify(msg),
       signal: this._abortController.signal,
     })
       .then(r => r.json())
       .then(data => {
         // Проверка актуальности
         if (thisRequestId !== this._requestId) return;
+        if (data.error === 'lease') {
+          this._leaseLost(data);
+          this._updateState({ pending: false });
+          return;
+        }
         
-        this._updateState({ pending: false });
+        const rtt = performance.now() - t0;
+        this._recordLatency('http', rtt);
+        this._updateState({ pending: false, rttMs: rtt });
         
         if (data.motors) {
           this._updateState({ motors: data.motors });
@@ -312,7 +382,236 @@ class ControlService {
    * Немедленная отправка (игнорирует throttle)
    */
   _sendImmediate(x, y) {
-    this._send(x, y);
+    this._send(x, y, true);
+  }
+
+  // ============================================================
+  // Private: WebSocket
+  // ============================================================
+
+  _wsReady() {
+    return this._ws !== null && this._ws.readyState === WebSocket.OPEN;
+  }
+
+  _wsConnect() {
+    if (!this.config.wsUrl || this._ws) return;
+
+    const ws = new WebSocket(this.config.wsUrl);
+    this._ws = ws;
+
+    ws.onopen = () => console.log('🔌 Control WS connected');
+    ws.onmessage = (event) => this._wsOnMessage(event.data);
+    ws.onclose = () => {
+      if (this._ws !== ws) return;
+      this._ws = null;
+      // Пока WS нет — команды идут POST'ом, переподключаемся в фоне
+      if (this._tickTimer) {
+        this._wsReconnectTimer = setTimeout(() => {
+          this._wsReconnectTimer = null;
+          this._wsConnect();
+        }, this.config.wsReconnectMs);
+      }
+    };
+    ws.onerror = () => ws.close();
+  }
+
+  _wsClose() {
+    if (this._wsReconnectTimer) {
+      clearTimeout(this._wsReconnectTimer);
+      this._wsReconnectTimer = null;
+    }
+    if (this._ws) {
+      const ws = this._ws;
+      this._ws = null;
+      ws.close();   // Буфер (в т.ч. последний stop) уходит до close-фрейма
+    }
+  }
+
+  /**
+   * Отправить JSON-сообщение по WS
+   * @param {object} msg - Тот же формат, что и тело POST /api/control
+   * @param {boolean} ack - Запросить ACK (добавляет seq и t)
+   * @returns {number|null} seq сообщения (если ack)
+   */
+  _wsSend(msg, ack) {
+    let seq = null;
+    if (ack) {
+      seq = ++this._wsSeq;
+      msg.seq = seq;
+      msg.t = this._nowUs();
+    }
+    this._ws.send(JSON.stringify(msg));
+    return seq;
+  }
+
+  /** Время клиента в мкс по модулю 2^32 (метки t) */
+  _nowUs() {
+    return Math.floor(performance.now() * 1000) % 4294967296;
+  }
+
+  _wsOnMessage(data) {
+    let msg;
+    try {
+      msg = JSON.parse(data);
+    } catch (e) {
+      return;
+    }
+    if (msg.ack === undefined) return;
+    if (msg.rejected === 'lease') this._leaseLost({});
+
+    // RTT по эхо t (мкс по модулю 2^32)
+    const nowUs = this._nowUs();
+    const rtt = (((nowUs - msg.t) % 4294967296 + 4294967296) % 4294967296) / 1000;
+    this._recordLatency('ws', rtt);
+    this._updateState({ rttMs: rtt });
+
+    const waiter = this._wsWaiters.get(msg.ack);
+    if (waiter) {
+      this._wsWaiters.delete(msg.ack);
+      waiter(rtt);
+    }
+
+    if (msg.motors) {
+      this._updateState({ motors: msg.motors });
+      if (this.onMotorsUpdate) {
+        this.onMotorsUpdate(msg.motors);
+      }
+    }
+  }
+
+  // ============================================================
+  // Private: Аренда управления
+  // ============================================================
+
+  /**
+   * Взять/продлить аренду, если она включена и пора: без токена —
+   * сразу (кроме паузы после отказа), с токеном — раз в TTL/2
+   * (продление заодно сообщает о вытеснении).
+   */
+  _leaseTick() {
+    if (!this.config.leasePriority || this._leasePending) return;
+    const now = Date.now();
+    if (!this._leaseToken && now < this._leaseRetryAt) return;
+    if (this._leaseToken && now - this._leaseCheckedAt < this.config.leaseTtlMs / 2) return;
+
+    this._leasePending = true;
+    this._leaseRequest({
+      action: 'acquire',
+      priority: this.config.leasePriority,
+      ttl_ms: this.config.leaseTtlMs,
+      owner: this.config.leaseOwner,
+      token: this._leaseToken,
+    })
+      .then((data) => {
+        this._leaseCheckedAt = Date.now();
+        if (data.token) {
+          if (!this._leaseToken) console.log('🔑 Lease ' + data.result);
+          this._leaseToken = data.token;
+          this._updateState({ leaseOwner: null });
+        } else {
+          this._leaseLost(data);
+        }
+      })
+      .catch((err) => console.warn('🔑 Lease request failed:', err.message))
+      .finally(() => { this._leasePending = false; });
+  }
+
+  /**
+   * Аренда чужая (отказ или вытеснение): забыть токен и не просить
+   * до её истечения.
+   * @param {object} info - Состояние аренды из ответа прошивки
+   */
+  _leaseLost(info) {
+    if (this._leaseToken) console.warn('🔑 Lease lost to ' + (info.owner || '?'));
+    this._leaseToken = 0;
+    this._leaseRetryAt = Date.now() + (info.remaining_ms || this.config.leaseTtlMs);
+    this._updateState({ leaseOwner: info.owner || '?' });
+  }
+
+  _leaseRelease() {
+    if (!this._leaseToken) return;
+    this._leaseRequest({ action: 'release', token: this._leaseToken }).catch(() => {});
+    this._leaseToken = 0;
+  }
+
+  _leaseRequest(body) {
+    return fetch(this.config.leaseUrl, {
+      method: 'POST',
+      headers: { 'Content-Type': 'application/json' },
+      body: JSON.stringify(body),
+    }).then(r => r.json());
+  }
+
+  // ============================================================
+  // Латентность
+  // ============================================================
+
+  _recordLatency(transport, ms) {
+    const samples = this._latency[transport];
+    samples.push(ms);
+    if (samples.length > 500) samples.shift();
+  }
+
+  /**
+   * Распределение RTT по транспортам (из накопленных замеров)
+   * @returns {{ws: object, http: object}} count/min/p50/p95/p99/max в мс
+   */
+  getLatencyStats() {
+    const summarize = (samples) => {
+      if (samples.length === 0) return { count: 0 };
+      const sorted = [...samples].sort((a, b) => a - b);
+      const pct = (p) => sorted[Math.min(sorted.length - 1, Math.floor(sorted.length * p))];
+      const round = (v) => Math.round(v * 100) / 100;
+      return {
+        count: sorted.length,
+        min: round(sorted[0]),
+        p50: round(pct(0.5)),
+        p95: round(pct(0.95)),
+        p99: round(pct(0.99)),
+        max: round(sorted[sorted.length - 1]),
+      };
+    };
+    return { ws: summarize(this._latency.ws), http: summarize(this._latency.http) };
+  }
+
+  /**
+   * Сравнить латентность WS и POST: count команд stop по каждому
+   * транспорту, последовательно (ровер не двигается).
+   * Вызывать при отпущенных джойстиках.
+   * @param {number} count - Кол-во замеров на транспорт
+   * @returns {Promise<{ws: object, http: object}>}
+   */
+  async measureLatency(count = 100) {
+    this._latency = { ws: [], http: [] };
+    const timeout = (ms) => new Promise(resolve => setTimeout(() => resolve(null), ms));
+
+    // --- WebSocket ---
+    if (!this._ws && this.config.wsUrl) this._wsConnect();
+    for (let i = 0; i < 50 && !this._wsReady(); i++) await timeout(100);
+    for (let i = 0; i < count && this._wsReady(); i++) {
+      const seq = this._wsSend({ type: 'stop' }, true);
+      const done = new Promise(resolve => this._wsWaiters.set(seq, resolve));
+      await Promise.race([done, timeout(1000)]);
+      this._wsWaiters.delete(seq);
+    }
+
+    // --- HTTP POST (текущий путь) ---
+    for (let i = 0; i < count; i++) {
+      const t0 = performance.now();
+      try {
+        const r = await fetch(this.config.apiUrl, {
+          method: 'POST',
+          headers: { 'Content-Type': 'application/json' },
+          body: JSON.stringify({ type: 'stop' }),
+        });
+        await r.json();
+        this._recordLatency('http', performance.now() - t0);
+      } catch (e) {
+        // Потерянный запрос — в статистику не идёт
+      }
+    }
+
+    return this.getLatencyStats();
   }
 
   _abort() {
@@ -424,6 +723,7 @@ class ControlService {
       this.config.expoY = expo;
     }
     console.log(`📈 Expo ${axis.toUpperCase()} set to ${(expo * 100).toFixed(0)}%`);
+    if (this.config.shaping === 'device') this.syncMixer(axis);
   }
 
   /**
@@ -452,6 +752,36 @@ class ControlService {
       this.config.outputMaxY = max;
     }
     console.log(`🔧 Output ${axis.toUpperCase()}: ${min}..${max}`);
+    if (this.config.shaping === 'device') this.syncMixer(axis);
+  }
+
+  /**
+   * Передать настройки осей в прошивку (POST /api/mixer).
+   * Прошивка пересчитывает таблицы expo/ремапа по тем же формулам.
+   * @param {'x'|'y'|'both'} axis - Ось
+   * @returns {Promise<boolean>}
+   */
+  syncMixer(axis = 'both') {
+    const axes = axis === 'both' ? ['x', 'y'] : [axis];
+    const requests = axes.map((a) => {
+      const sfx = a.toUpperCase();
+      return fetch(this.config.mixerUrl, {
+        method: 'POST',
+        headers: { 'Content-Type': 'application/json' },
+        body: JSON.stringify({
+          axis: a,
+          expo: Math.round(this.config['expo' + sfx] * 100),
+          min: this.config['outputMin' + sfx],
+          max: this.config['outputMax' + sfx],
+        }),
+      }).then(r => r.ok);
+    });
+    return Promise.all(requests)
+      .then(results => results.every(Boolean))
+      .catch((err) => {
+        console.warn('🎚️ Mixer sync failed:', err.message);
+        return false;
+      });
   }
 
   /**
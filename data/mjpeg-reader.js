@@ -0,0 +1,200 @@
+/**
+ * ============================================================
+ * 📼 MjpegReader — чтение multipart MJPEG через fetch()
+ * ============================================================
+ *
+ * Разбирает multipart/x-mixed-replace поток вручную, что даёт
+ * доступ к part'ам, которые <img> показать не умеет:
+ *
+ *   - application/x-jpeg-tables — заголовок JPEG (DQT/SOF/DHT/SOS),
+ *     присылается при подключении и при смене качества/разрешения
+ *   - image/x-jpeg-scan        — только scan-данные кадра;
+ *     кадр = tables + scan + EOI (FFD9)
+ *   - image/jpeg               — обычный полный кадр
+ *   - application/json         — телеметрия (/stream?telemetry=N),
+ *     тот же формат, что и /api/status
+ *
+ * Использование:
+ *   const reader = new MjpegReader(streamUrl + '?abbrev=1');
+ *   reader.onFrame = (blob) => { img.src = URL.createObjectURL(blob); };
+ *   reader.onTelemetry = (data) => updateOSD(data);
+ *   reader.onError = (err) => reconnect();
+ *   reader.start();
+ *   reader.stop();
+ *
+ * ============================================================
+ */
+
+class MjpegReader {
+  static EOI = new Uint8Array([0xff, 0xd9]);
+
+  constructor(url) {
+    this.url = url;
+
+    // Заголовок JPEG для сборки сокращённых кадров
+    this.tables = null;
+
+    // Буфер непрочитанных байт потока
+    this._buf = new Uint8Array(64 * 1024);
+    this._len = 0;
+    this._boundary = null;
+    this._abortController = null;
+
+    // Статистика
+    this.stats = { frames: 0, bytes: 0, tables: 0, telemetry: 0 };
+
+    // === Callbacks ===
+    this.onFrame = null;    // (blob) => void
+    this.onTelemetry = null; // (object) => void
+    this.onError = null;    // (error) => void
+  }
+
+  // ============================================================
+  // Public API
+  // ============================================================
+
+  start() {
+    this.stop();
+    this._abortController = new AbortController();
+    this._len = 0;
+    this.tables = null;
+
+    fetch(this.url, { signal: this._abortController.signal })
+      .then(response => {
+        if (!response.ok || !response.body) {
+          throw new Error(`HTTP ${response.status}`);
+        }
+        const type = response.headers.get('Content-Type') || '';
+        const m = type.match(/boundary=([^;]+)/);
+        this._boundary = this._encode('--' + (m ? m[1].trim() : ''));
+        return this._pump(response.body.getReader());
+      })
+      .catch(err => {
+        if (err.name === 'AbortError') return;
+        if (this.onError) this.onError(err);
+      });
+  }
+
+  stop() {
+    if (this._abortController) {
+      this._abortController.abort();
+      this._abortController = null;
+    }
+  }
+
+  // ============================================================
+  // Private: Чтение потока
+  // ============================================================
+
+  async _pump(reader) {
+    while (true) {
+      const { done, value } = await reader.read();
+      if (done) throw new Error('Stream closed');
+      this.stats.bytes += value.length;
+      this._append(value);
+      while (this._parsePart()) { /* разбираем все целые part'ы */ }
+    }
+  }
+
+  _append(chunk) {
+    if (this._len + chunk.length > this._buf.length) {
+      const grown = new Uint8Array(Math.max(this._buf.length * 2, this._len + chunk.length));
+      grown.set(this._buf.subarray(0, this._len));
+      this._buf = grown;
+    }
+    this._buf.set(chunk, this._len);
+    this._len += chunk.length;
+  }
+
+  /**
+   * Разобрать один part из начала буфера
+   * @returns {boolean} true если part разобран (можно пробовать следующий)
+   */
+  _parsePart() {
+    const buf = this._buf.subarray(0, this._len);
+
+    const start = this._indexOf(buf, this._boundary, 0);
+    if (start < 0) return false;
+    const headersEnd = this._indexOf(buf, this._encode('\r\n\r\n'), start);
+    if (headersEnd < 0) return false;
+
+    const headers = new TextDecoder().decode(buf.subarray(start, headersEnd));
+    const lenMatch = headers.match(/Content-Length:\s*(\d+)/i);
+    const typeMatch = headers.match(/Content-Type:\s*([^\r\n]+)/i);
+    if (!lenMatch) {
+      this._consume(headersEnd + 4);
+      return true;
+    }
+
+    const bodyStart = headersEnd + 4;
+    const bodyLen = parseInt(lenMatch[1]);
+    if (this._len < bodyStart + bodyLen) return false;
+
+    const body = buf.slice(bodyStart, bodyStart + bodyLen);
+    this._consume(bodyStart + bodyLen);
+    this._onPart(typeMatch ? typeMatch[1].trim() : '', body);
+    return true;
+  }
+
+  _onPart(type, body) {
+    let blob = null;
+
+    if (type === 'application/x-jpeg-tables') {
+      this.tables = body;
+      this.stats.tables++;
+      return;
+    } else if (type === 'image/x-jpeg-scan') {
+      if (!this.tables) return;  // Кадр до таблиц — собрать нельзя
+      blob = new Blob([this.tables, body, MjpegReader.EOI], { type: 'image/jpeg' });
+    } else if (type === 'image/jpeg') {
+      blob = new Blob([body], { type: 'image/jpeg' });
+    } else if (type === 'application/json') {
+      this._onTelemetry(body);
+      return;
+    } else {
+      return;
+    }
+
+    this.stats.frames++;
+    if (this.onFrame) this.onFrame(blob);
+  }
+
+  _onTelemetry(body) {
+    let data;
+    try {
+      data = JSON.parse(new TextDecoder().decode(body));
+    } catch (e) {
+      return;  // Битый part — ждём следующий
+    }
+    this.stats.telemetry++;
+    if (this.onTelemetry) this.onTelemetry(data);
+  }
+
+  _consume(n) {
+    this._buf.copyWithin(0, n, this._len);
+    this._len -= n;
+  }
+
+  // ============================================================
+  // Private: Utilities
+  // ============================================================
+
+  _encode(str) {
+    return new TextEncoder().encode(str);
+  }
+
+  _indexOf(haystack, needle, from) {
+    const first = needle[0];
+    const last = haystack.length - needle.length;
+    for (let i = from; i <= last; i++) {
+      if (haystack[i] !== first) continue;
+      let j = 1;
+      while (j < needle.length && haystack[i + j] === needle[j]) j++;
+      if (j === needle.length) return i;
+    }
+    return -1;
+  }
+}
+
+// Экспорт для использования в script.js
+window.MjpegReader = MjpegReader;
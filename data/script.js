@@ -25,6 +25,8 @@
   let webcamStream = null;
   let ledState = false;
   let reconnectTimer = null;
+  let mjpegReader = null;     // MjpegReader для сокращённого стрима (STREAM_ABBREV)
+  let frameUrl = null;        // Blob URL последнего кадра MjpegReader
 
   // === Инициализация ===
   function init() {
@@ -52,19 +54,64 @@
     if (isStreaming) return;
     
     showOverlay('Подключение к стриму...');
-    // CORS: установить ДО src для cross-origin доступа (нужно для OpenCV.js)
-    videoFeed.crossOrigin = 'anonymous';
-    // Добавляем timestamp чтобы избежать кэширования при переподключении
-    videoFeed.src = streamUrl + '?t=' + Date.now();
+    connectStream();
     isStreaming = true;
     updateStreamUI();
   }
 
+  /**
+   * Подключить <img> к стриму: напрямую или через MjpegReader
+   * (сокращённые JPEG собираются на клиенте)
+   */
+  function connectStream() {
+    // CORS: установить ДО src для cross-origin доступа (нужно для OpenCV.js)
+    videoFeed.crossOrigin = 'anonymous';
+
+    if (!useStreamReader()) {
+      // Добавляем timestamp чтобы избежать кэширования при переподключении
+      videoFeed.src = streamUrl + '?t=' + Date.now();
+      return;
+    }
+
+    if (mjpegReader) mjpegReader.stop();
+    const params = [];
+    if (window.AppConfig.STREAM_ABBREV) params.push('abbrev=1');
+    if (osdStreamTelemetryHz() > 0) params.push('telemetry=' + osdStreamTelemetryHz());
+    params.push('t=' + Date.now());
+    mjpegReader = new window.MjpegReader(streamUrl + '?' + params.join('&'));
+    mjpegReader.onFrame = (blob) => {
+      const prevUrl = frameUrl;
+      frameUrl = URL.createObjectURL(blob);
+      videoFeed.src = frameUrl;
+      if (prevUrl) URL.revokeObjectURL(prevUrl);
+    };
+    mjpegReader.onTelemetry = (data) => osdOnStreamTelemetry(data);
+    mjpegReader.onError = () => onStreamError();
+    mjpegReader.start();
+  }
+
+  function useStreamReader() {
+    const wantsReader = window.AppConfig.STREAM_ABBREV || osdStreamTelemetryHz() > 0;
+    return wantsReader && !window.AppConfig.USE_PROXY && window.MjpegReader;
+  }
+
+  function disconnectStream() {
+    if (mjpegReader) {
+      mjpegReader.stop();
+      mjpegReader = null;
+    }
+    videoFeed.src = '';
+    if (frameUrl) {
+      URL.revokeObjectURL(frameUrl);
+      frameUrl = null;
+    }
+  }
+
   function stopStream() {
     if (!isStreaming) return;
     
     // Останавливаем загрузку
-    videoFeed.src = '';
+    disconnectStream();
     isStreaming = false;
     clearReconnectTimer();
     showOverlay('Стрим остановлен');
@@ -96,10 +143,7 @@
   function scheduleReconnect() {
     clearReconnectTimer();
     reconnectTimer = setTimeout(() => {
-      if (isStreaming) {
-        videoFeed.crossOrigin = 'anonymous';
-        videoFeed.src = streamUrl + '?t=' + Date.now();
-      }
+      if (isStreaming) connectStream();
     }, window.AppConfig.UI.reconnectDelay);
   }
 
@@ -380,7 +424,12 @@
     // === Создаём ControlService ===
     controlService = new ControlService(
       window.AppConfig.getApiUrl(window.AppConfig.CONTROL_API),
-      window.AppConfig.CONTROL
+      {
+        ...window.AppConfig.CONTROL,
+        wsUrl: window.AppConfig.getWsUrl(window.AppConfig.CONTROL_WS),
+        mixerUrl: window.AppConfig.getApiUrl(window.AppConfig.MIXER_API),
+        leaseUrl: window.AppConfig.getApiUrl(window.AppConfig.LEASE_API),
+      }
     );
 
     // Подписки
@@ -1567,7 +1616,9 @@
   // ============================================================
   //
   // Виджеты отображаются в 4-х углах видео (DJI FPV-style).
-  // Данные запрашиваются polling'ом из /api/status.
+  // Данные запрашиваются polling'ом из /api/status, либо приходят
+  // JSON-part'ами в самом MJPEG-стриме (OSD.streamTelemetryHz > 0) —
+  // тогда polling пропускается, пока телеметрия из стрима свежая.
   // Тогглер и интервал настраиваются в панели настроек.
   //
   // ============================================================
@@ -1575,6 +1626,23 @@
   let osdEnabled = true;
   let osdPollTimer = null;
   let osdIntervalMs = 5000;
+  let osdStreamTelemetryAt = 0;   // Время последней телеметрии из стрима (ms)
+
+  /**
+   * Частота телеметрии в стриме (0 — выключена)
+   */
+  function osdStreamTelemetryHz() {
+    return window.AppConfig.OSD ? (window.AppConfig.OSD.streamTelemetryHz || 0) : 0;
+  }
+
+  /**
+   * Телеметрия из MJPEG-стрима (MjpegReader.onTelemetry)
+   * @param {object} data - Тот же формат, что и /api/status
+   */
+  function osdOnStreamTelemetry(data) {
+    osdStreamTelemetryAt = Date.now();
+    if (osdEnabled) updateOSD(data);
+  }
 
   /**
    * Инициализация OSD: тогглер, слайдер интервала, старт polling'а
@@ -1666,6 +1734,9 @@
   function osdFetchStatus() {
     if (!osdEnabled) return;
 
+    // Стрим уже доставляет телеметрию — отдельный запрос не нужен
+    if (Date.now() - osdStreamTelemetryAt < 3000) return;
+
     const url = window.AppConfig.getApiUrl(
       window.AppConfig.STATUS_API || '/api/status'
     );
@@ -12,21 +12,40 @@
  *   - Формат: JPEG, VGA (640x480), quality=12
  *   - Двойной фреймбуфер (fb_count=2) для плавного стрима
  *   - Поддержка vflip/hmirror через OV2640 сенсор (без CPU)
+ *   - Засыпание без зрителей: standby сенсора (COM2) + пауза
+ *     LEDC-таймера XCLK. Без XCLK сенсор не выдаёт PCLK/VSYNC,
+ *     и DMA драйвера стоит. Пробуждение — обратный порядок плюс
+ *     пропуск кадров, снятых до засыпания (по fb->timestamp)
  *
  * Зависимости:
  *   - esp_camera.h — драйвер камеры ESP-IDF
- *   - config.h     — пины камеры AI-Thinker
+ *   - config.h     — пины камеры AI-Thinker, CAM_IDLE_SUSPEND_MS
+ *   - driver/ledc.h — пауза/возобновление таймера XCLK
  *
  * ============================================================
  */
 
 #include "camera.h"
 #include "config.h"
+#include "log.h"
+#include <driver/ledc.h>
+#include <esp_timer.h>
+
+#define CAM_FB_COUNT        2       // Кол-во фреймбуферов драйвера
+#define CAM_XCLK_TIMER      LEDC_TIMER_0
+#define CAM_XCLK_MODE       LEDC_LOW_SPEED_MODE  // Режим LEDC, в котором esp32-camera заводит XCLK
+
+// Регистр OV2640 для set_reg(): бит 8 — банк сенсора (0xFF = 1)
+#define OV2640_REG_COM2     0x109
+#define OV2640_COM2_STANDBY 0x10    // Soft sleep, регистры сохраняются
 
 // --- Глобальные переменные ---
 
 SemaphoreHandle_t cameraSemaphore = NULL;  // Мьютекс для синхронизации доступа к камере
 
+static unsigned long    camLastUse = 0;     // millis() последнего захвата
+static CameraPowerStats camPower = {};      // Под cameraSemaphore
+
 /**
  * @brief Инициализация камеры OV2640
  *
@@ -46,7 +65,7 @@ bool cameraInit() {
     // Конфигурация камеры
     camera_config_t config;
     config.ledc_channel = LEDC_CHANNEL_0;
-    config.ledc_timer   = LEDC_TIMER_0;
+    config.ledc_timer   = CAM_XCLK_TIMER;
     
     config.pin_d0       = CAM_PIN_Y2;
     config.pin_d1       = CAM_PIN_Y3;
@@ -70,7 +89,7 @@ bool cameraInit() {
     config.pixel_format = PIXFORMAT_JPEG; // Аппаратное JPEG-сжатие на OV2640
     config.frame_size   = FRAMESIZE_VGA;  // 640x480 — баланс качества и скорости
     config.jpeg_quality = 12;             // Качество JPEG (0-63, меньше = лучше)
-    config.fb_count     = 2;              // Двойной буфер для непрерывного стрима
+    config.fb_count     = CAM_FB_COUNT;   // Двойной буфер для непрерывного стрима
 
     esp_err_t err = esp_camera_init(&config);
     if (err != ESP_OK) {
@@ -87,15 +106,82 @@ bool cameraInit() {
         Serial.printf("   📷 Flip: vflip=%d, hmirror=%d\n", CAM_VFLIP, CAM_HMIRROR);
     }
 
+    camLastUse = millis();
     Serial.println("✅ Камера инициализирована");
     return true;
 }
 
+// ============================================================
+// 💤 Энергосбережение (вызывать под cameraSemaphore)
+// ============================================================
+
+/**
+ * Усыпить камеру: standby сенсора, затем остановка XCLK
+ * (SCCB-запись требует работающего XCLK — порядок важен).
+ */
+static void cameraSuspendLocked() {
+    sensor_t* sensor = esp_camera_sensor_get();
+    if (sensor) sensor->set_reg(sensor, OV2640_REG_COM2, OV2640_COM2_STANDBY, OV2640_COM2_STANDBY);
+    ledc_timer_pause(CAM_XCLK_MODE, CAM_XCLK_TIMER);
+
+    camPower.suspended = true;
+    camPower.suspends++;
+    LOG_I("💤 Камера: standby (нет зрителей)");
+}
+
+/**
+ * Разбудить камеру и получить первый свежий кадр.
+ * Кадры, лежащие в очереди драйвера с момента засыпания, отбрасываются.
+ * @return Свежий кадр или NULL
+ */
+static camera_fb_t* cameraResumeLocked() {
+    int64_t t0 = esp_timer_get_time();
+
+    ledc_timer_resume(CAM_XCLK_MODE, CAM_XCLK_TIMER);
+    sensor_t* sensor = esp_camera_sensor_get();
+    if (sensor) sensor->set_reg(sensor, OV2640_REG_COM2, OV2640_COM2_STANDBY, 0);
+    camPower.suspended = false;
+
+    // Буферы, заполненные до засыпания, устарели — пропускаем их
+    camera_fb_t* fb = NULL;
+    for (int i = 0; i <= CAM_FB_COUNT; i++) {
+        fb = esp_camera_fb_get();
+        if (!fb) break;
+        int64_t fbUs = (int64_t)fb->timestamp.tv_sec * 1000000 + fb->timestamp.tv_usec;
+        if (fbUs >= t0) break;
+        esp_camera_fb_return(fb);
+        fb = NULL;
+    }
+
+    uint32_t us = (uint32_t)(esp_timer_get_time() - t0);
+    camPower.resumes++;
+    camPower.resumeUsLast = us;
+    if (us > camPower.resumeUsMax) camPower.resumeUsMax = us;
+    LOG_I("📷 Камера: пробуждение за %lu мкс", (unsigned long)us);
+    return fb;
+}
+
+void cameraPowerTick() {
+    if (CAM_IDLE_SUSPEND_MS == 0 || cameraSemaphore == NULL) return;
+    if (camPower.suspended || millis() - camLastUse < CAM_IDLE_SUSPEND_MS) return;
+
+    // Не ждём: если камера занята — значит, она не простаивает
+    if (xSemaphoreTake(cameraSemaphore, 0) != pdTRUE) return;
+    if (!camPower.suspended && millis() - camLastUse >= CAM_IDLE_SUSPEND_MS) {
+        cameraSuspendLocked();
+    }
+    xSemaphoreGive(cameraSemaphore);
+}
+
+CameraPowerStats cameraGetPowerStats() {
+    return camPower;
+}
+
 /**
  * @brief Потокобезопасный захват JPEG-кадра с камеры
  *
  * Ждёт мьютекс до timeoutMs, захватывает кадр через esp_camera_fb_get(),
- * затем освобождает мьютекс. Вызывающий код ОБЯЗАН вернуть буфер через
+ * затем освобождает мьютекс. Спящая камера предварительно будится. Вызывающий код ОБЯЗАН вернуть буфер через
  * esp_camera_fb_return(fb) после использования.
  *
  * @param timeoutMs Макс. время ожидания мьютекса (мс), по умолчанию 500
@@ -108,7 +194,8 @@ camera_fb_t* cameraCapture(uint32_t timeoutMs) {
     
     // Пытаемся захватить мьютекс в пределах таймаута
     if (xSemaphoreTake(cameraSemaphore, pdMS_TO_TICKS(timeoutMs)) == pdTRUE) {
-        fb = esp_camera_fb_get();
+        fb = camPower.suspended ? cameraResumeLocked() : esp_camera_fb_get();
+        camLastUse = millis();
         xSemaphoreGive(cameraSemaphore);
     }
     
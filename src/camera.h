@@ -8,6 +8,11 @@
  *
  * Формат: JPEG, VGA 640x480, двойной фреймбуфер.
  *
+ * Энергосбережение: после CAM_IDLE_SUSPEND_MS без захватов сенсор
+ * уходит в standby, XCLK останавливается (DMA простаивает).
+ * Следующий cameraCapture() будит камеру «тёплым» путём — без
+ * повторного esp_camera_init, регистры сенсора сохраняются.
+ *
  * ============================================================
  */
 
@@ -38,4 +43,22 @@ bool cameraInit();
  */
 camera_fb_t* cameraCapture(uint32_t timeoutMs = 500);
 
+// --- Статистика энергосбережения камеры ---
+struct CameraPowerStats {
+    bool     suspended;       // Камера сейчас спит
+    uint32_t suspends;        // Всего засыпаний
+    uint32_t resumes;         // Всего пробуждений
+    uint32_t resumeUsLast;    // Время до первого свежего кадра после пробуждения (мкс)
+    uint32_t resumeUsMax;     // Максимум resumeUsLast
+};
+
+/**
+ * @brief Усыпить камеру, если она простаивает дольше CAM_IDLE_SUSPEND_MS
+ * Вызывать периодически из цикла без зрителей (стрим-задача).
+ */
+void cameraPowerTick();
+
+/** @brief Получить статистику энергосбережения */
+CameraPowerStats cameraGetPowerStats();
+
 #endif // CAMERA_H
@@ -7,9 +7,20 @@
  *   - WiFi credentials
  *   - Пины камеры OV2640 (AI-Thinker ESP32-CAM)
  *   - Пины и каналы PWM для моторов
+ *   - Профиль плавности (рампы) моторов
+ *   - Замкнутый контур скорости колёс (PID, энкодеры, модель)
  *   - Порты HTTP-серверов
+ *   - RTP/UDP стрим (порт, multicast-группа)
+ *   - Воркер миниатюр (ядро, качество)
+ *   - UDP-канал управления (порт, приоритет)
+ *   - Аварийный стоп (порт, приоритет)
  *   - Параметры управления (watchdog, deadzone)
- *   - Параметры демо-режима
+ *   - Джиттер-буфер команд X/Y (задержка, стадии деградации)
+ *   - Аренда управления (обязательность, TTL)
+ *   - Асинхронный лог (уровень, кольцо, UDP)
+ *   - Журнал команд управления (размер, воспроизведение)
+ *   - Миссии (байткод-сценарии движения)
+ *   - Параметры демо-программы
  *
  * ============================================================
  */
@@ -28,6 +39,9 @@
 // Переворот изображения (0=выкл, 1=вкл)
 #define CAM_VFLIP       1   // Вертикальный переворот (по вертикали)
 #define CAM_HMIRROR     1   // Горизонтальное зеркало (по горизонтали)
+
+// Энергосбережение: standby сенсора + остановка XCLK без зрителей
+#define CAM_IDLE_SUSPEND_MS  10000  // Простой до засыпания камеры (мс), 0 = не засыпать
 #define CAM_PIN_XCLK    0
 #define CAM_PIN_SIOD    26
 #define CAM_PIN_SIOC    27
@@ -46,6 +60,18 @@
 // --- IR LED (подсветка) ---
 #define PIN_IR_LED      4
 
+// --- Бэкенд вывода моторов (drive_backend.h), выбор при сборке ---
+#define DRIVE_BACKEND_LEDC_SIM  0        // LED-имитация на LEDC (текущая плата)
+#define DRIVE_BACKEND_MCPWM     1        // H-мост: MCPWM + пин направления на сторону
+#define DRIVE_BACKEND           DRIVE_BACKEND_LEDC_SIM
+
+// --- H-мост (DRIVE_BACKEND_MCPWM) — на месте LED-пинов ---
+#define MCPWM_PIN_LEFT_PWM      12
+#define MCPWM_PIN_LEFT_DIR      14
+#define MCPWM_PIN_RIGHT_PWM     13
+#define MCPWM_PIN_RIGHT_DIR     15
+#define MCPWM_FREQ              20000    // Гц — выше слышимого диапазона
+
 // --- PWM моторы (LED-имитация) ---
 //     FL = Front Left,  FR = Front Right
 //     RL = Rear Left,   RR = Rear Right
@@ -64,15 +90,140 @@
 #define PWM_CH_RL       3
 #define PWM_CH_RR       4
 
+// --- Плавность моторов (ramp.h) ---
+#define RAMP_PROFILE_DEFAULT RAMP_NORMAL  // Профиль при старте: RAMP_OFF / SOFT / NORMAL / SPORT
+#define RAMP_FADE_CHUNK_MS   40           // Макс. участок на аппаратном fade LEDC (0 — только программно)
+
+// --- Замкнутый контур скорости колёс (wheel_pid.h, encoder.h) ---
+// Цель мотора 0-255 становится уставкой 0..SPEEDCTL_MAX_CPS, скважность считает PID
+#define SPEEDCTL_SOURCE        0      // 0 — разомкнутый PWM, 1 — энкодеры PCNT, 2 — модель мотора
+#define SPEEDCTL_DIVIDER       4      // PID раз в N тиков управления (200 Гц / 4 = 50 Гц)
+#define SPEEDCTL_MAX_CPS       2000   // Уставка при цели 255 (имп/с)
+#define SPEEDCTL_KP_Q16        8000   // ≈0.12 скважности на 1 имп/с ошибки
+#define SPEEDCTL_KI_Q16        1500   // ≈0.023 скважности на 1 имп/с ошибки за шаг
+#define SPEEDCTL_KD_Q16        0      // По измерению, за шаг
+#define SPEEDCTL_FILTER_SHIFT  1      // IIR измерения: meas += (raw − meas) / 2
+#define SPEEDCTL_SETTLE_PCT    5      // Полоса установления для settle_ms (% от уставки)
+
+// Энкодеры (PCNT, передний фронт), -1 — не подключён
+#define ENCODER_PIN_FL       -1
+#define ENCODER_PIN_FR       -1
+#define ENCODER_PIN_RL       -1
+#define ENCODER_PIN_RR       -1
+#define ENCODER_PCNT_FILTER  100    // Фильтр дребезга (такты APB 80 МГц, ≤ 1023)
+#define ENCODER_PCNT_LIMIT   32767  // Предел 16-битного счётчика (сброс в 0)
+
+// Модель мотора первого порядка (источник "sim")
+#define SIM_MOTOR_GAIN_CPS   2200   // Установившаяся скорость при скважности 255 (имп/с)
+#define SIM_MOTOR_TAU_MS     120    // Постоянная времени
+#define SIM_MOTOR_DEADBAND   25     // Скважность трогания
+
 // --- HTTP серверы ---
 #define HTTP_PORT_MAIN   80
 #define HTTP_PORT_STREAM 81
 
+// --- RTP/UDP стрим (RFC 2435) ---
+#define RTP_DEFAULT_PORT     5004              // UDP-порт получателя по умолчанию
+#define RTP_MULTICAST_GROUP  "239.255.0.81"    // Multicast-группа для зрителей в LAN
+#define RTP_MULTICAST_TTL    1                 // TTL multicast (1 = только локальная сеть)
+#define RTP_MTU              1400              // Макс. размер RTP-пакета (байт)
+
+// --- Телеметрия в MJPEG-стриме (/stream?telemetry=N) ---
+#define STREAM_TELEMETRY_MAX_HZ  10   // Макс. частота JSON-part'ов телеметрии (Гц)
+
+// --- Миниатюры / уменьшенный стрим (1/2, 1/4, 1/8) ---
+#define THUMB_TASK_CORE      1     // Ядро воркера перекодирования (стрим — на Core 0)
+#define THUMB_TASK_PRIORITY  1     // Приоритет воркера (ниже httpd)
+#define THUMB_JPEG_QUALITY   80    // Качество сжатия миниатюр (fmt2jpg: 0-100, больше = лучше)
+
 // --- Управление (Control) ---
 #define CONTROL_TIMEOUT_MS   2000  // Watchdog таймаут (мс) — стоп если нет команд (2 сек)
 #define CONTROL_DEADZONE     20    // Мёртвая зона джойстика (игнорируем малые отклонения)
+#define CONTROL_RATE_HZ      200   // Частота задачи управления (Гц): 200 / 500
+#define CONTROL_TASK_PRIORITY 10   // Приоритет задачи управления (выше httpd/стрима)
+#define CONTROL_TASK_CORE    1     // Ядро задачи управления (стрим — на Core 0)
+#define CONTROL_PROBE_TIMEOUT_MS 100 // Замер латентности: макс. ожидание применения и записи LEDC
+
+// --- Джиттер-буфер команд X/Y (jitter_buffer.h) ---
+// Стадии от последней команды: продолжение → удержание → спад → стоп.
+// DELAY + HOLD + DECAY < CONTROL_TIMEOUT_MS — watchdog остаётся последним рубежом
+#define JITTER_ENABLE        1     // 0 — X/Y применяются сразу, как пришли
+#define JITTER_DELAY_MS      60    // Задержка проигрывания (покрывает разброс доставки)
+#define JITTER_GRACE_MS      150   // Последняя команда как свежая
+#define JITTER_HOLD_MS       1200  // Удержание (больше heartbeat клиента 1 с)
+#define JITTER_DECAY_MS      500   // Линейный спад к нулю, затем стоп
+
+// --- Аренда управления (lease.h) ---
+#define LEASE_REQUIRED        0      // 1 — без действующей аренды команды не принимаются
+#define LEASE_TTL_DEFAULT_MS  3000   // TTL, если клиент не указал
+#define LEASE_TTL_MIN_MS      500    // Минимальный TTL
+#define LEASE_TTL_MAX_MS      60000  // Максимальный TTL
+
+// --- Бинарный UDP-канал управления (udp_control.h) ---
+#define UDP_CONTROL_PORT           4210  // UDP-порт пакетов управления
+#define UDP_CONTROL_TASK_PRIORITY  5     // Приоритет задачи приёма (как у httpd)
+#define UDP_CONTROL_TASK_CORE      1     // Ядро задачи приёма (стрим — на Core 0)
+
+// --- Аварийный стоп (estop.h) ---
+#define ESTOP_PORT           4211  // UDP-порт пакетов e-stop
+#define ESTOP_TASK_PRIORITY  20    // Выше задачи управления (10) и tcpip (18)
+#define ESTOP_TASK_CORE      1     // Ядро задачи приёма (как у задачи управления)
+
+// --- Защита по смене сцены (scene_guard.h) ---
+// Пока ровер едет вперёд, нижняя часть кадра сравнивается с предыдущей;
+// резкий скачок изменившихся блоков над фоном — потолок/отсечка хода вперёд
+#define SCENE_GUARD_ENABLE     1      // 0 — выключена при старте (включается через /api/scene)
+#define SCENE_ROI_PCT          50     // Анализируемая полоса снизу кадра (% высоты)
+#define SCENE_BLOCK_DELTA      24     // Порог изменения яркости блока сетки 8×4 (0-255)
+#define SCENE_TRIGGER_PCT      40     // Мин. доля изменившихся блоков (%)
+#define SCENE_SPIKE_RATIO_Q4   40     // Во сколько раз выше фона (Q4: 40 = ×2.5)
+#define SCENE_MAX_GAP_MS       400    // Разрыв между кадрами, после которого сравнение заново
+#define SCENE_CAP_DUTY         0      // Потолок «вперёд» при срабатывании (0 — отсечка)
+#define SCENE_HOLD_MS          1500   // Удержание потолка (продлевается новыми срабатываниями)
+
+// --- Кадры для анализа на устройстве (vision.h) ---
+// Декодирование 1/8 одно на всех: защита по смене сцены, следование
+#define VISION_SELF_CAPTURE_MS 100    // Нет кадров от стрима дольше — снимаем сами
+#define VISION_TASK_PRIORITY   6      // Выше httpd/UDP (5), ниже задачи управления (10)
+#define VISION_TASK_CORE       1      // Ядро анализа (стрим — на Core 0)
+
+// --- Следование за движением (follow.h) ---
+// Центр крупнейшей движущейся области кадра 1/8 → руль X/Y на устройстве
+#define FOLLOW_PIXEL_DELTA     28     // Порог изменения яркости пикселя (0-255)
+#define FOLLOW_MIN_AREA        12     // Мин. площадь цели (пикселей кадра 80×60)
+#define FOLLOW_MAX_AREA_PCT    35     // Движется больше — поворот ровера, не цель (%)
+#define FOLLOW_MAX_GAP_MS      400    // Разрыв между кадрами, после которого сравнение заново
+#define FOLLOW_KP_Q8           384    // Руль X = смещение цели × 1.5 (Q8)
+#define FOLLOW_MAX_TURN        160    // Макс. |X| руля
+#define FOLLOW_SPEED           0      // Газ при цели в центре (0 — разворот на месте)
+#define FOLLOW_LOST_MS         600    // Цели нет дольше — стоп (режим остаётся включён)
+
+// --- Асинхронный лог (log.h) ---
+#define LOG_LEVEL          LOG_LEVEL_INFO  // NONE / ERROR / WARN / INFO / DEBUG (выше — вырезается)
+#define LOG_RING_SLOTS     32              // Строк в кольце (переполнение → dropped)
+#define LOG_LINE_MAX       128             // Макс. длина строки (байт, с префиксом времени)
+#define LOG_UDP_PORT       0               // UDP-broadcast строк на порт (0 = только Serial)
+#define LOG_TASK_PRIORITY  1               // Приоритет задачи вывода (ниже всех рабочих)
+#define LOG_TASK_CORE      0               // Ядро задачи вывода
+
+// --- Журнал команд управления (recorder.h) ---
+#define RECORDER_ENTRIES_PSRAM     16384  // Записей в PSRAM (20 байт каждая → 320 КБ)
+#define RECORDER_ENTRIES_DRAM      256    // Записей без PSRAM (5 КБ внутренней памяти)
+#define RECORDER_AUTOSTART         1      // Писать журнал с момента старта
+#define RECORDER_REPLAY_MAX_GAP_MS 5000   // Паузы длиннее сжимаются при воспроизведении
+#define RECORDER_REPLAY_PRIORITY   5      // Приоритет задачи воспроизведения (как у UDP-канала)
+#define RECORDER_REPLAY_CORE       1      // Ядро задачи воспроизведения
+
+// --- Миссии: байткод-сценарии движения (mission.h) ---
+#define MISSION_PROGRAM_MAX    1024  // Макс. размер загружаемой программы (байт)
+#define MISSION_LOOP_DEPTH     4     // Вложенность LOOP/NEXT
+#define MISSION_OPS_PER_TICK   32    // Инструкций за тик управления (дальше — следующий тик)
+#define MISSION_AUTOSTART_DEMO 0     // Запускать демо-программу при старте
+
+// --- Проигрыватель форм скважности (wave.h) ---
+#define WAVE_MAX_SAMPLES       12000 // Макс. отсчётов формы (60 с при 200 Гц)
 
-// --- Демо режим ---
+// --- Демо-программа (встроенная миссия MISSION_PROG_DEMO) ---
 #define DEMO_STEP_MS         2000  // Длительность одного шага демо (мс)
 #define DEMO_SPEED_DEFAULT   200   // Скорость в демо режиме
 #define DEMO_SPEED_RAMP_LOW  50    // Низкая скорость для ramp
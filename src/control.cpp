@@ -10,18 +10,111 @@
  *   моторы автоматически останавливаются. Это предотвращает
  *   неуправляемое движение при потере связи.
  *
+ * Задача управления (Control):
+ *   Единственный владелец записи в моторы и проверки watchdog.
+ *   Будится esp_timer'ом с частотой CONTROL_RATE_HZ (200/500 Гц),
+ *   закреплена за CONTROL_TASK_CORE с приоритетом выше httpd.
+ *   Источники команд (HTTP, WebSocket, UDP) только публикуют
+ *   команду в свой lock-free SPSC почтовый ящик (LatestMailbox) и
+ *   сразу возвращаются. Тик забирает из всех ящиков самую новую
+ *   команду (по метке времени) — пачка команд схлопывается в
+ *   последнюю, задержка не больше одного периода.
+ *   Стоп не схлопывается с движением: у каждого источника для него
+ *   отдельный ящик, и если за тик пришёл стоп от кого угодно, тик
+ *   применяет стоп, а движение этого тика (даже более новое)
+ *   отбрасывает.
+ *
+ * Аренда (lease.h):
+ *   Источник проверяет токен команды до публикации — команды
+ *   чужих клиентов не вытесняют команду держателя из ящика и не
+ *   сбрасывают watchdog.
+ *
+ * Джиттер-буфер (jitter_buffer.h):
+ *   Команды X/Y не применяются сразу, а кладутся в буфер по метке
+ *   отправителя; тик проигрывает их с задержкой JITTER_DELAY_MS,
+ *   интерполируя между соседними. Когда команды кончились —
+ *   продолжение последней (grace), удержание, спад к нулю и стоп.
+ *   Остальные команды (stop, direction, drive), команды с меткой
+ *   замера и воспроизведение журнала (CTRL_SRC_REPLAY — исходные
+ *   интервалы уже в журнале) идут мимо буфера и сбрасывают его.
+ *   Последняя стадия заканчивается раньше CONTROL_TIMEOUT_MS —
+ *   watchdog страхует.
+ *
+ * Аварийный стоп (estop.h):
+ *   Каналы гасит сама задача приёма e-stop (driveEstop). Пока
+ *   защёлка взведена, тик забирает команды из ящиков и
+ *   отбрасывает их, прерывает миссию, следование и форму,
+ *   сбрасывает джиттер-буфер и обнуляет цели моторов.
+ *
+ * Рампа:
+ *   Команды задают цели моторов, на LEDC их выводит driveTick()
+ *   в конце каждого тика — с ограничением нарастания и рывка.
+ *
+ * Замер латентности (controlProbeNext/Wait):
+ *   Команда с меткой замера возвращает источнику время публикации,
+ *   применения и первой записи LEDC канала, чья цель изменилась
+ *   (на этом же тике или позже — реверс через ноль, fade).
+ *
+ * Миссии (mission.h):
+ *   ВМ байткод-сценариев шагает на каждом тике после разбора
+ *   команд, до рампы. Любая дошедшая до задачи команда прерывает
+ *   миссию (ручной перехват).
+ *
+ * Следование (follow.h):
+ *   Руль от задачи Vision забирается из LatestMailbox на каждом
+ *   тике и применяется applyXY мимо джиттер-буфера (метка —
+ *   снимок кадра, а не отправитель). Ручная команда, миссия и
+ *   аварийный стоп выключают режим.
+ *
+ * Формы скважности (wave.h):
+ *   Проигрыватель ставит отсчёт до миссии и рампы, журнал пишет
+ *   сразу после driveTick(). Запуск формы прерывает миссию и
+ *   следование; ручная команда, миссия и аварийный стоп — форму.
+ *
+ * Снимок состояния (system_state.h):
+ *   В конце тика цели моторов и ControlState публикуются одной
+ *   записью seqlock — /api/status и телеметрия читают их целостно.
+ *
+ * Журнал:
+ *   Каждая применённая команда вместе с получившимися целями
+ *   моторов уходит в recorder.h (скачивание и воспроизведение).
+ *   X/Y через джиттер-буфер пишутся не при приёме, а когда буфер
+ *   применяет отсчёт: тот X/Y, что дошёл до микшера (с интерполяцией),
+ *   и время применения; стадия «стоп» — как CMD_STOP. Тогда out[]
+ *   записи — действительно результат её X/Y, и воспроизведение
+ *   (мимо буфера) повторяет журнал.
+ *
+ * Тайминг:
+ *   На каждом тике мерится отклонение периода от номинального,
+ *   результат копится в гистограмме (controlGetTiming, /api/control).
+ *
  * Режимы управления:
  *   1. По направлению (controlSetMovement) — forward, backward, left, right
  *   2. По осям X/Y (controlSetXY) — от джойстика, с skid-steer микшированием
+ *   3. Прямые скорости моторов (controlSetDrive) — отладка /api/drive,
+ *      без watchdog
  *
- * Skid-steer микширование (танковое управление):
+ * Skid-steer микширование (танковое управление, mixer.h):
+ *   X/Y → таблицы expo + ремапа (256 байт на ось, настраиваются
+ *   через /api/mixer)
  *   leftSpeed  = Y + X    (Y = газ, X = поворот)
  *   rightSpeed = Y - X
- *   При превышении 255 — нормализация с сохранением пропорций.
+ *   При превышении 255 — нормализация с сохранением пропорций
+ *   (целочисленно, Q16).
  *
  * Зависимости:
- *   - drive.h  — driveSetSpeed(), driveStop() для управления моторами
- *   - config.h — CONTROL_TIMEOUT_MS, CONTROL_DEADZONE
+ *   - drive.h  — driveSetAll(), driveStop() для управления моторами
+ *   - config.h — CONTROL_TIMEOUT_MS, CONTROL_DEADZONE, CONTROL_RATE_HZ
+ *   - mailbox.h — LatestMailbox (тройной буфер)
+ *   - jitter_buffer.h — проигрывание X/Y по метке отправителя
+ *   - mixer.h  — expo/ремап таблицы и skid-steer микширование
+ *   - recorder.h — журнал применённых команд
+ *   - lease.h  — аренда управления (проверка токена до почтового ящика)
+ *   - mission.h — ВМ сценариев движения (шаг в тике, ручной перехват)
+ *   - follow.h — руль следования за движением (Vision → тик)
+ *   - wave.h   — проигрыватель форм скважности (отсчёт в тике)
+ *   - system_state.h — публикация снимка состояния в конце тика
+ *   - esp_timer.h — периодический таймер задачи
  *
  * ============================================================
  */
@@ -29,8 +122,20 @@
 #include "control.h"
 #include "drive.h"
 #include "config.h"
+#include "log.h"
+#include "mailbox.h"
+#include "mixer.h"
+#include "recorder.h"
+#include "lease.h"
+#include "mission.h"
+#include "follow.h"
+#include "wave.h"
+#include "system_state.h"
+#include <esp_timer.h>
+
+#define CONTROL_PERIOD_US (1000000 / CONTROL_RATE_HZ)
 
-// --- Внутреннее состояние управления ---
+// --- Внутреннее состояние управления (пишет только задача) ---
 static ControlState state = {
     .direction = CTRL_STOP,
     .speed = 0,
@@ -38,6 +143,73 @@ static ControlState state = {
     .active = false
 };
 
+// --- Команда от источников (HTTP/WS/UDP/Replay) → задаче ---
+struct ControlCommand {
+    ControlCommandKind kind;
+    ControlSource      source;
+    ControlDirection   direction;
+    uint8_t            speed;
+    int16_t            x;
+    int16_t            y;
+    DriveState         drive;
+    uint32_t           stampUs;   // Время публикации (выбор самой новой среди источников)
+    uint32_t           senderUs;  // Метка отправителя (джиттер-буфер, 0 — нет)
+    unsigned long      ms;        // millis() публикации (watchdog)
+    uint32_t           probeId;   // Метка замера латентности (0 — нет)
+};
+
+// Почтовые ящики источников: продюсер — задача источника, консьюмер — задача управления.
+// Стоп — в отдельном ящике: более новое движение того же источника его не вытесняет
+static LatestMailbox<ControlCommand> mailboxes[CTRL_SRC_COUNT];
+static LatestMailbox<ControlCommand> stopBoxes[CTRL_SRC_COUNT];
+
+// --- Замер латентности ---
+// probeArmed[] пишет и читает только задача-продюсер источника,
+// результаты — почтовый ящик задача управления → источник
+static uint32_t probeArmed[CTRL_SRC_COUNT] = {};
+static LatestMailbox<ControlProbe> probeResults[CTRL_SRC_COUNT];
+
+// Незавершённый замер (только задача управления)
+static ControlProbe  probeCur = {};
+static ControlSource probeSrc = CTRL_SRC_HTTP;
+static uint8_t       probeMask = 0;        // Каналы, чья цель изменилась
+static uint32_t      probeTicksLeft = 0;   // > 0 — ждём записи LEDC
+
+#define CONTROL_PROBE_TICKS (CONTROL_PROBE_TIMEOUT_MS * CONTROL_RATE_HZ / 1000)
+
+// --- Джиттер-буфер X/Y (только задача управления) ---
+static_assert(JITTER_DELAY_MS + JITTER_HOLD_MS + JITTER_DECAY_MS < CONTROL_TIMEOUT_MS,
+              "джиттер-буфер должен останавливать раньше watchdog");
+static_assert(JITTER_GRACE_MS <= JITTER_HOLD_MS, "grace входит в hold");
+
+static const JitterParams jitterParams = {
+    JITTER_DELAY_MS * 1000,
+    JITTER_GRACE_MS * 1000,
+    JITTER_HOLD_MS * 1000,
+    JITTER_DECAY_MS * 1000
+};
+static JitterBuffer jitter = {};
+static int16_t jitterOutX = 0, jitterOutY = 0;   // Последние применённые из буфера
+static bool    jitterOut = false;                // jitterOutX/Y действительны
+static ControlSource jitterSource = CTRL_SRC_HTTP;  // Источник команд в буфере (для журнала)
+static bool    followDriving = false;            // Моторы ведёт руль следования
+
+// --- Задача и таймер ---
+static TaskHandle_t       controlTask = NULL;
+static esp_timer_handle_t controlTimer = NULL;
+
+// Верхние границы корзин гистограммы джиттера (мкс), последняя — всё остальное
+static const uint32_t jitterBinUs[CONTROL_JITTER_BINS - 1] = {10, 25, 50, 100, 250, 500, 1000};
+static ControlTimingStats timing = {};
+
+static void controlTaskLoop(void* pvParameters);
+static void applyStop();
+
+// Колбэк esp_timer (задача esp_timer) — только будит задачу управления
+static void controlTimerCallback(void* arg) {
+    xTaskNotifyGive(controlTask);
+}
+
 // ============================================================
 // Инициализация
 // ============================================================
@@ -53,35 +225,92 @@ void controlInit() {
     state.speed = 0;
     state.lastCommandMs = 0;
     state.active = false;
+    timing.rateHz = CONTROL_RATE_HZ;
+    mixerInit();
+
+    // Задача управления — ждёт уведомления от таймера
+    BaseType_t res = xTaskCreatePinnedToCore(
+        controlTaskLoop,
+        "Control",
+        4096,
+        NULL,
+        CONTROL_TASK_PRIORITY,
+        &controlTask,
+        CONTROL_TASK_CORE
+    );
+    if (res != pdPASS) {
+        Serial.println("❌ Control: ошибка запуска задачи");
+        return;
+    }
+
+    // Периодический таймер будит задачу с частотой CONTROL_RATE_HZ
+    esp_timer_create_args_t timerArgs = {};
+    timerArgs.callback = controlTimerCallback;
+    timerArgs.dispatch_method = ESP_TIMER_TASK;
+    timerArgs.name = "control";
+    esp_timer_create(&timerArgs, &controlTimer);
+    esp_timer_start_periodic(controlTimer, CONTROL_PERIOD_US);
     
     Serial.println("✅ Control модуль инициализирован");
     Serial.printf("   ⏱️ Watchdog таймаут: %d мс\n", CONTROL_TIMEOUT_MS);
+    Serial.printf("   🔁 Задача управления: %d Гц, Core %d\n", CONTROL_RATE_HZ, CONTROL_TASK_CORE);
 }
 
 // ============================================================
-// Watchdog Update — вызывать в loop()
+// Публикация команд (любая задача)
 // ============================================================
 
 /**
- * @brief Проверка watchdog-таймаута
- *
- * Если управление активно и прошло более CONTROL_TIMEOUT_MS мс
- * с последней команды — принудительная остановка моторов.
- * Вызывать в loop() каждый цикл.
+ * Опубликовать команду в почтовый ящик источника (не блокируется).
+ * Невзятая команда того же источника вытесняется (latest-wins).
+ * Команда с чужим токеном аренды отклоняется до ящика; стоп
+ * принимается от любого клиента и аренду не продлевает (lease.h).
  */
-void controlUpdate() {
-    // Если управление не активно — ничего не делаем
-    if (!state.active) return;
-    
-    // Проверяем таймаут
-    unsigned long now = millis();
-    unsigned long elapsed = now - state.lastCommandMs;
-    
-    if (elapsed >= CONTROL_TIMEOUT_MS) {
-        // Таймаут! Останавливаем моторы
-        Serial.printf("⏱️ Watchdog: таймаут %lu мс, остановка моторов\n", elapsed);
-        controlStop();
-    }
+static bool postCommand(ControlCommand& cmd, ControlSource source, uint32_t lease) {
+    if (source >= CTRL_SRC_COUNT) return false;
+    cmd.probeId = probeArmed[source];
+    probeArmed[source] = 0;
+    if (cmd.kind != CMD_STOP && !leaseCheck(lease)) return false;
+
+    cmd.source = source;
+    cmd.stampUs = (uint32_t)esp_timer_get_time();
+    if (cmd.senderUs == 0) cmd.senderUs = cmd.stampUs;
+    cmd.ms = millis();
+    if (cmd.kind == CMD_STOP) stopBoxes[source].post(cmd);
+    else                      mailboxes[source].post(cmd);
+    return true;
+}
+
+bool controlSetMovement(ControlDirection direction, uint8_t speed, ControlSource source,
+                        uint32_t lease) {
+    ControlCommand cmd = {};
+    cmd.kind = CMD_MOVEMENT;
+    cmd.direction = direction;
+    cmd.speed = speed;
+    return postCommand(cmd, source, lease);
+}
+
+bool controlSetXY(int16_t x, int16_t y, ControlSource source, uint32_t lease,
+                  uint32_t senderUs) {
+    ControlCommand cmd = {};
+    cmd.kind = CMD_XY;
+    cmd.x = x;
+    cmd.y = y;
+    cmd.senderUs = senderUs;
+    return postCommand(cmd, source, lease);
+}
+
+bool controlSetDrive(const DriveState& speeds, ControlSource source, uint32_t lease) {
+    ControlCommand cmd = {};
+    cmd.kind = CMD_DRIVE;
+    cmd.drive = speeds;
+    return postCommand(cmd, source, lease);
+}
+
+bool controlStop(ControlSource source, uint32_t lease) {
+    ControlCommand cmd = {};
+    cmd.kind = CMD_STOP;
+    return postCommand(cmd, source, lease);
 }
 
 // ============================================================
@@ -89,16 +318,15 @@ void controlUpdate() {
 // ============================================================
 
 /**
- * @brief Установить направление и скорость движения
- * Сбрасывает watchdog-таймер. Транслирует команду в drive-модуль.
+ * Применить направление и скорость движения (задача управления).
+ * Транслирует команду в drive-модуль.
  * @param direction Направление из enum ControlDirection
  * @param speed     Скорость 0-255
  */
-void controlSetMovement(ControlDirection direction, uint8_t speed) {
+static void applyMovement(ControlDirection direction, uint8_t speed) {
     // Обновляем состояние
     state.direction = direction;
     state.speed = speed;
-    state.lastCommandMs = millis();  // Сброс watchdog
     state.active = (direction != CTRL_STOP);
     
     // Применяем к моторам через drive модуль
@@ -154,9 +382,10 @@ void controlSetMovement(ControlDirection direction, uint8_t speed) {
 // ============================================================
 
 /**
- * @brief Установить движение по осям X/Y (для джойстика)
+ * Применить движение по осям X/Y (задача управления)
  *
- * Применяет skid-steer (танковое) микширование:
+ * Оси проходят через таблицы expo/ремапа (mixer.h), затем
+ * skid-steer (танковое) микширование:
  *   leftSpeed  = Y + X
  *   rightSpeed = Y - X
  *
@@ -166,10 +395,7 @@ void controlSetMovement(ControlDirection direction, uint8_t speed) {
  * @param x Ось X: -255 (лево) .. +255 (право)
  * @param y Ось Y: -255 (назад) .. +255 (вперёд)
  */
-void controlSetXY(int16_t x, int16_t y) {
-    // Обновляем watchdog
-    state.lastCommandMs = millis();
-    
+static void applyXY(int16_t x, int16_t y) {
     // Ограничиваем входные значения
     x = constrain(x, -255, 255);
     y = constrain(y, -255, 255);
@@ -177,53 +403,41 @@ void controlSetXY(int16_t x, int16_t y) {
     // Мёртвая зона (deadzone) — игнорируем малые отклонения
     if (abs(x) < CONTROL_DEADZONE && abs(y) < CONTROL_DEADZONE) {
         // Джойстик в центре — остановка
-        controlStop();
+        applyStop();
         return;
     }
     
     // Активируем управление
     state.active = true;
     
+    // --- Expo + ремап по осям (таблицы mixer.h) ---
+    x = mixerShape(MIXER_AXIS_X, x);
+    y = mixerShape(MIXER_AXIS_Y, y);
+
     // --- Микширование для skid-steer ---
     // leftSpeed  = Y + X  (положительный X поворачивает вправо → левая сторона быстрее)
     // rightSpeed = Y - X
-    int16_t leftSpeed  = y + x;
-    int16_t rightSpeed = y - x;
+    // Нормализация за 255 — с сохранением знака и пропорций (Q16)
+    int16_t leftSpeed, rightSpeed;
+    mixerMix(x, y, &leftSpeed, &rightSpeed);
     
-    // Нормализация: если значения выходят за 255, масштабируем
-    // Важно: сохраняем знак при нормализации!
-    int16_t maxVal = max(abs(leftSpeed), abs(rightSpeed));
-    if (maxVal > 255) {
-        // Используем float для точного деления, затем округляем
-        float scale = 255.0f / maxVal;
-        leftSpeed  = (int16_t)(leftSpeed * scale);
-        rightSpeed = (int16_t)(rightSpeed * scale);
-    }
-    
-    // --- Применяем к моторам ---
+    // --- Применяем к моторам (одним driveSetAll) ---
     // Положительные значения — вперёд (FL, FR)
     // Отрицательные значения — назад (RL, RR)
+    DriveState next = {};
     
     // Левая сторона (FL для вперёд, RL для назад)
-    if (leftSpeed >= 0) {
-        driveSetSpeed(MOTOR_FL, (uint8_t)leftSpeed);
-        driveSetSpeed(MOTOR_RL, 0);
-    } else {
-        driveSetSpeed(MOTOR_FL, 0);
-        driveSetSpeed(MOTOR_RL, (uint8_t)(-leftSpeed));  // Инвертируем знак
-    }
+    if (leftSpeed >= 0) next.speed[MOTOR_FL] = (uint8_t)leftSpeed;
+    else                next.speed[MOTOR_RL] = (uint8_t)(-leftSpeed);  // Инвертируем знак
     
     // Правая сторона (FR для вперёд, RR для назад)
-    if (rightSpeed >= 0) {
-        driveSetSpeed(MOTOR_FR, (uint8_t)rightSpeed);
-        driveSetSpeed(MOTOR_RR, 0);
-    } else {
-        driveSetSpeed(MOTOR_FR, 0);
-        driveSetSpeed(MOTOR_RR, (uint8_t)(-rightSpeed));  // Инвертируем знак
-    }
+    if (rightSpeed >= 0) next.speed[MOTOR_FR] = (uint8_t)rightSpeed;
+    else                 next.speed[MOTOR_RR] = (uint8_t)(-rightSpeed);  // Инвертируем знак
     
-    // Отладка (раскомментировать для проверки)
-    Serial.printf("XY: x=%d y=%d | L=%d R=%d | FL=%d FR=%d RL=%d RR=%d\n",
+    driveSetAll(next);
+    
+    // Отладка (LOG_LEVEL_DEBUG, иначе вырезается)
+    LOG_D("XY: x=%d y=%d | L=%d R=%d | FL=%d FR=%d RL=%d RR=%d",
         x, y, leftSpeed, rightSpeed,
         driveGetSpeed(MOTOR_FL), driveGetSpeed(MOTOR_FR),
         driveGetSpeed(MOTOR_RL), driveGetSpeed(MOTOR_RR));
@@ -242,10 +456,10 @@ void controlSetXY(int16_t x, int16_t y) {
 // ============================================================
 
 /**
- * @brief Немедленная остановка всех моторов
+ * Остановка всех моторов (задача управления)
  * Деактивирует управление (active=false), вызывает driveStop().
  */
-void controlStop() {
+static void applyStop() {
     state.direction = CTRL_STOP;
     state.speed = 0;
     state.active = false;
@@ -254,6 +468,350 @@ void controlStop() {
     driveStop();
 }
 
+// ============================================================
+// Задача управления
+// ============================================================
+
+/**
+ * Учесть период между тиками в гистограмме джиттера.
+ * @param periodUs Фактический период (мкс)
+ */
+static void recordTiming(uint32_t periodUs) {
+    uint32_t jitter = (periodUs > CONTROL_PERIOD_US) ? periodUs - CONTROL_PERIOD_US
+                                                     : CONTROL_PERIOD_US - periodUs;
+    int bin = 0;
+    while (bin < CONTROL_JITTER_BINS - 1 && jitter > jitterBinUs[bin]) bin++;
+
+    timing.hist[bin]++;
+    timing.ticks++;
+    if (jitter > timing.jitterMaxUs) timing.jitterMaxUs = jitter;
+    if (periodUs >= 2 * CONTROL_PERIOD_US) timing.overruns++;
+}
+
+/**
+ * Забрать команду тика из всех почтовых ящиков.
+ * Есть стоп от любого источника — он (самый новый из стопов), всё
+ * движение тика отбрасывается. Иначе — самое новое движение, более
+ * старое других источников отбрасывается.
+ * @return false если ни один источник ничего не публиковал
+ */
+static bool takeLatestCommand(ControlCommand* out) {
+    bool stop = false;
+    for (int i = 0; i < CTRL_SRC_COUNT; i++) {
+        ControlCommand cmd;
+        if (!stopBoxes[i].take(&cmd)) continue;
+        if (!stop || (int32_t)(cmd.stampUs - out->stampUs) > 0) {
+            *out = cmd;
+            stop = true;
+        }
+    }
+
+    bool fresh = stop;
+    for (int i = 0; i < CTRL_SRC_COUNT; i++) {
+        ControlCommand cmd;
+        if (!mailboxes[i].take(&cmd) || stop) continue;
+        if (!fresh || (int32_t)(cmd.stampUs - out->stampUs) > 0) {
+            *out = cmd;
+            fresh = true;
+        }
+    }
+    return fresh;
+}
+
+/**
+ * Записать применённую команду и цели моторов в журнал.
+ */
+static void recordCommand(const ControlCommand& cmd) {
+    RecorderEntry e = {};
+    e.stampUs   = cmd.stampUs;
+    e.source    = cmd.source;
+    e.kind      = cmd.kind;
+    e.direction = cmd.direction;
+    e.speed     = cmd.speed;
+    e.x         = cmd.x;
+    e.y         = cmd.y;
+    memcpy(e.drive, cmd.drive.speed, sizeof(e.drive));
+    memcpy(e.out, driveGetState().speed, sizeof(e.out));
+    recorderAppend(e);
+}
+
+/**
+ * Начать замер: команда применена, ждём записи изменившихся каналов.
+ * @param before Цели моторов до применения команды
+ */
+static void probeBegin(const ControlCommand& cmd, const DriveState& before) {
+    if (probeTicksLeft > 0) probeResults[probeSrc].post(probeCur);  // Вытеснен — без pwmUs
+
+    probeCur.id      = cmd.probeId;
+    probeCur.postUs  = cmd.stampUs;
+    probeCur.applyUs = (uint32_t)esp_timer_get_time();
+    probeCur.pwmUs   = 0;
+    probeSrc = cmd.source;
+
+    const DriveState& after = driveGetState();
+    probeMask = 0;
+    for (int i = 0; i < MOTOR_COUNT; i++) {
+        if (after.speed[i] != before.speed[i]) probeMask |= 1 << i;
+    }
+    if (probeMask == 0) {
+        probeResults[probeSrc].post(probeCur);   // Цели не изменились — писать нечего
+        probeTicksLeft = 0;
+    } else {
+        probeTicksLeft = CONTROL_PROBE_TICKS;
+    }
+}
+
+/**
+ * Учесть запись LEDC этого тика в незавершённом замере.
+ * @param written Маска записанных каналов (driveTick)
+ */
+static void probeTick(uint8_t written) {
+    if (probeTicksLeft == 0) return;
+    if (written & probeMask) {
+        probeCur.pwmUs = (uint32_t)esp_timer_get_time();
+        probeTicksLeft = 0;
+    } else if (--probeTicksLeft > 0) {
+        return;
+    }
+    probeResults[probeSrc].post(probeCur);
+}
+
+/**
+ * Разобрать команду X/Y: в джиттер-буфер или (замер, воспроизведение,
+ * буфер выключен) сразу.
+ * @return true — применена сейчас, false — ушла в буфер
+ */
+static bool takeXY(const ControlCommand& cmd) {
+    if (JITTER_ENABLE && cmd.probeId == 0 && cmd.source != CTRL_SRC_REPLAY) {
+        jitterPush(&jitter, cmd.senderUs, cmd.stampUs, cmd.x, cmd.y);
+        jitterSource = cmd.source;
+        return false;
+    }
+    jitterReset(&jitter);
+    jitterOut = false;
+    applyXY(cmd.x, cmd.y);
+    return true;
+}
+
+/**
+ * Записать в журнал то, что применил джиттер-буфер.
+ */
+static void recordJitter(ControlCommandKind kind, int16_t x, int16_t y, uint32_t nowUs) {
+    ControlCommand cmd = {};
+    cmd.kind = kind;
+    cmd.source = jitterSource;
+    cmd.stampUs = nowUs;
+    cmd.x = x;
+    cmd.y = y;
+    recordCommand(cmd);
+}
+
+/**
+ * Шаг джиттер-буфера: выход текущей стадии → моторы (только изменения).
+ */
+static void jitterTick(uint32_t nowUs) {
+    int16_t x, y;
+    JitterStage stage = jitterSample(&jitter, jitterParams, nowUs, &x, &y);
+    if (stage == JITTER_IDLE) return;
+    if (missionGetStatus().state == MISSION_RUNNING || waveRunning()) {   // Миссия/форма — уступаем
+        jitterReset(&jitter);
+        jitterOut = false;
+        return;
+    }
+    if (stage == JITTER_STOP) {
+        LOG_W("📶 Джиттер-буфер: нет команд %d мс, остановка", JITTER_HOLD_MS + JITTER_DECAY_MS);
+        jitterOut = false;
+        applyStop();
+        recordJitter(CMD_STOP, 0, 0, nowUs);
+        return;
+    }
+    if (jitterOut && x == jitterOutX && y == jitterOutY) return;
+    jitterOutX = x;
+    jitterOutY = y;
+    jitterOut = true;
+    applyXY(x, y);
+    recordJitter(CMD_XY, x, y, nowUs);
+}
+
+/**
+ * Шаг следования: последний руль от Vision → моторы.
+ * Выключенный режим останавливает моторы, если вёл их он.
+ */
+static void followTick(uint32_t nowUs) {
+    FollowSteer s;
+    bool got = followTake(&s);
+    if (followActive() && (missionGetStatus().state == MISSION_RUNNING || waveRunning())) {
+        followOverride();                                // Миссия/форма — уступаем
+        followDriving = false;
+        return;
+    }
+    if (!followActive()) {
+        if (followDriving) applyStop();
+        followDriving = false;
+        return;
+    }
+    if (!got) return;
+
+    jitterReset(&jitter);
+    jitterOut = false;
+    state.lastCommandMs = millis();
+    applyXY(s.x, s.y);
+    followDriving = true;
+    followApplied(s, nowUs);
+}
+
+/**
+ * Тик под защёлкой аварийного стопа: опустошить ящики,
+ * прервать миссию и следование, забыть буфер X/Y, держать
+ * цели в нуле (тик, вытесненный стопом, мог записать свои).
+ */
+static void estopHoldTick() {
+    ControlCommand cmd;
+    FollowSteer steer;
+    takeLatestCommand(&cmd);
+    followTake(&steer);
+    missionOverride();
+    followOverride();
+    waveOverride();
+    followDriving = false;
+    jitterReset(&jitter);
+    jitterOut = false;
+    driveStop();
+    state.direction = CTRL_STOP;
+    state.speed = 0;
+    state.active = false;
+}
+
+/**
+ * FreeRTOS-задача: тик таймера → новая команда → джиттер-буфер → следование →
+ * форма → миссия → watchdog → рампа → журнал формы → снимок состояния.
+ */
+static void controlTaskLoop(void* pvParameters) {
+    int64_t lastWakeUs = 0;
+
+    while (true) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        int64_t nowUs = esp_timer_get_time();
+        uint32_t periodUs = CONTROL_PERIOD_US;
+        if (lastWakeUs != 0) {
+            periodUs = (uint32_t)(nowUs - lastWakeUs);
+            recordTiming(periodUs);
+        }
+        lastWakeUs = nowUs;
+
+        // --- Аварийный стоп: команды отбрасываются до снятия защёлки ---
+        ControlCommand cmd;
+        if (driveEstopLatched()) {
+            estopHoldTick();
+            probeTick(driveTick(CONTROL_PERIOD_US));
+            systemStatePublishControl(state, driveGetState());
+            continue;
+        }
+
+        // --- Самая новая команда из почтовых ящиков ---
+        if (takeLatestCommand(&cmd)) {
+            missionOverride();
+            followOverride();
+            waveOverride();
+            followDriving = false;
+            DriveState before = driveGetState();
+            state.lastCommandMs = cmd.ms;
+            if (cmd.kind != CMD_XY) {
+                jitterReset(&jitter);
+                jitterOut = false;
+            }
+            bool applied = true;
+            switch (cmd.kind) {
+                case CMD_STOP:     applyStop(); break;
+                case CMD_MOVEMENT: applyMovement(cmd.direction, cmd.speed); break;
+                case CMD_XY:       applied = takeXY(cmd); break;
+                case CMD_DRIVE:    driveSetAll(cmd.drive); break;
+            }
+            if (applied) recordCommand(cmd);            // Из буфера — пишет jitterTick
+            if (cmd.probeId != 0) probeBegin(cmd, before);
+        }
+
+        // --- Джиттер-буфер X/Y: интерполяция или стадия деградации ---
+        jitterTick((uint32_t)nowUs);
+
+        // --- Следование: руль от Vision (задержка — период кадра, не сеть) ---
+        followTick((uint32_t)nowUs);
+
+        // --- Форма скважности: отсчёт на этом тике (до миссии и рампы) ---
+        if (waveTick((uint32_t)nowUs)) {
+            missionOverride();
+            followOverride();
+            followDriving = false;
+            jitterReset(&jitter);
+            jitterOut = false;
+            state.direction = CTRL_STOP;
+            state.speed = 0;
+            state.active = false;
+        }
+
+        // --- Миссия: шаг сценария (тайминг — этот тик, не сеть) ---
+        missionTick((uint32_t)nowUs);
+        if (waveRunning() && missionGetStatus().state == MISSION_RUNNING) {
+            waveOverride(false);                         // Миссию запустили позже — уступаем
+        }
+
+        // --- Watchdog ---
+        // Если управление активно и прошло более CONTROL_TIMEOUT_MS мс
+        // с последней команды — принудительная остановка моторов.
+        if (state.active) {
+            unsigned long elapsed = millis() - state.lastCommandMs;
+            if (elapsed >= CONTROL_TIMEOUT_MS) {
+                LOG_W("⏱️ Watchdog: таймаут %lu мс, остановка моторов", elapsed);
+                applyStop();
+            }
+        }
+
+        // --- Рампа: цели моторов → LEDC (не больше двух периодов за шаг) ---
+        uint8_t written = driveTick(min(periodUs, (uint32_t)(2 * CONTROL_PERIOD_US)));
+        probeTick(written);
+        waveAfterTick(written);
+
+        // --- Снимок для читателей без блокировок (только при изменении) ---
+        systemStatePublishControl(state, driveGetState());
+    }
+}
+
+ControlTimingStats controlGetTiming() {
+    return timing;
+}
+
+ControlJitterStatus controlGetJitter() {
+    ControlJitterStatus st;
+    st.stage = jitter.stage;
+    st.depth = jitter.count;
+    st.stats = jitter.stats;
+    return st;
+}
+
+ControlMailboxStats controlGetMailboxStats(ControlSource source) {
+    ControlMailboxStats st = {};
+    if (source < CTRL_SRC_COUNT) {
+        st.posted = mailboxes[source].postedCount() + stopBoxes[source].postedCount();
+        st.taken  = mailboxes[source].takenCount() + stopBoxes[source].takenCount();
+    }
+    return st;
+}
+
+void controlProbeNext(ControlSource source, uint32_t id) {
+    if (source < CTRL_SRC_COUNT) probeArmed[source] = id;
+}
+
+bool controlProbeWait(ControlSource source, uint32_t id, ControlProbe* out, uint32_t timeoutMs) {
+    if (source >= CTRL_SRC_COUNT) return false;
+    unsigned long startMs = millis();
+    while (true) {
+        if (probeResults[source].take(out) && out->id == id) return true;
+        if (millis() - startMs >= timeoutMs) return false;
+        vTaskDelay(1);
+    }
+}
+
 // ============================================================
 // Геттеры состояния
 // ============================================================
@@ -2,6 +2,8 @@
 #define CONTROL_H
 
 #include <Arduino.h>
+#include "drive.h"
+#include "jitter_buffer.h"
 
 // ============================================================
 // 🎮 Модуль управления движением с Watchdog таймаутом
@@ -11,6 +13,20 @@
 // Если команда не поступает в течение CONTROL_TIMEOUT_MS,
 // моторы автоматически останавливаются (watchdog).
 //
+// Моторы пишет только задача управления (CONTROL_RATE_HZ, esp_timer).
+// Функции controlSet*() / controlStop() не блокируются: они кладут
+// команду в lock-free почтовый ящик источника (mailbox.h), задача
+// управления забирает из всех ящиков самую новую на ближайшем тике.
+// У каждого источника ровно одна задача-продюсер (SPSC).
+//
+// Команды X/Y проходят джиттер-буфер (jitter_buffer.h): проигрываются
+// по метке отправителя с задержкой JITTER_DELAY_MS, а при разрыве
+// связи выход деградирует ступенями (удержание → спад → стоп)
+// вместо жёсткого стопа по CONTROL_TIMEOUT_MS.
+//
+// Если клиенты берут аренду (lease.h), команды с чужим токеном
+// отклоняются ещё до почтового ящика — controlSet*() вернёт false.
+//
 // Используется для:
 //   - Виртуальных джойстиков (стиков)
 //   - Управления с мобильного приложения
@@ -18,7 +34,7 @@
 //
 // НЕ используется для:
 //   - Отладочных increment/decrement команд (/api/drive)
-//   - Демо-режима
+//   - Сценариев движения (mission.h — шагают в той же задаче)
 //
 // ============================================================
 
@@ -42,30 +58,80 @@ struct ControlState {
     bool active;                 // Активно ли управление
 };
 
+// --- Источник команды (у каждого свой почтовый ящик) ---
+// Один источник — одна задача-продюсер!
+enum ControlSource : uint8_t {
+    CTRL_SRC_HTTP = 0,   // Задача httpd: POST /api/control, /api/drive, /ws/control
+    CTRL_SRC_UDP,        // Задача UdpControl
+    CTRL_SRC_REPLAY,     // Задача Replay (воспроизведение журнала, recorder.h)
+    CTRL_SRC_COUNT
+};
+
+// --- Вид команды (почтовый ящик, журнал recorder.h) ---
+enum ControlCommandKind : uint8_t {
+    CMD_STOP = 0,
+    CMD_MOVEMENT,     // direction + speed
+    CMD_XY,           // x + y
+    CMD_DRIVE         // Прямые скорости моторов (отладка)
+};
+
+// --- Статистика почтового ящика источника ---
+struct ControlMailboxStats {
+    uint32_t posted;     // Опубликовано команд
+    uint32_t taken;      // Забрано задачей управления (posted − taken — схлопнуто)
+};
+
+// --- Замер латентности команды (probe) ---
+// Метки — esp_timer_get_time() по модулю 2^32 (мкс)
+struct ControlProbe {
+    uint32_t id;         // Метка замера от источника (≠ 0)
+    uint32_t postUs;     // Команда опубликована в почтовый ящик
+    uint32_t applyUs;    // Применена задачей управления
+    uint32_t pwmUs;      // Завершена первая запись LEDC изменившегося канала
+                         // (0 — цели не изменились или запись не случилась)
+};
+
+// --- Состояние джиттер-буфера X/Y ---
+struct ControlJitterStatus {
+    JitterStage stage;   // Стадия на последнем тике
+    uint8_t     depth;   // Ожидающих проигрывания команд
+    JitterStats stats;
+};
+
+// --- Тайминг задачи управления ---
+#define CONTROL_JITTER_BINS 8    // Корзины: ≤10, ≤25, ≤50, ≤100, ≤250, ≤500, ≤1000, >1000 мкс
+
+struct ControlTimingStats {
+    uint32_t rateHz;                     // Номинальная частота
+    uint32_t ticks;                      // Всего тиков
+    uint32_t overruns;                   // Тиков с периодом ≥ 2× номинального
+    uint32_t jitterMaxUs;                // Макс. |период − номинал| (мкс)
+    uint32_t hist[CONTROL_JITTER_BINS];  // Гистограмма |период − номинал|
+};
+
 // ============================================================
 // API функции
 // ============================================================
 
 /**
  * @brief Инициализация модуля управления
+ * Запускает задачу управления и её таймер.
  * Вызывать в setup() после driveInit()
  */
 void controlInit();
 
-/**
- * @brief Обновление watchdog таймера
- * Вызывать в loop() — проверяет таймаут и останавливает моторы
- */
-void controlUpdate();
-
 /**
  * @brief Установить направление и скорость движения
  * Сбрасывает watchdog таймер
  * 
  * @param direction Направление из enum ControlDirection
  * @param speed Скорость 0-255
+ * @param source Источник (задача-продюсер)
+ * @param lease Токен аренды клиента (0 — без аренды)
+ * @return false — отклонено арендой
  */
-void controlSetMovement(ControlDirection direction, uint8_t speed);
+bool controlSetMovement(ControlDirection direction, uint8_t speed,
+                        ControlSource source = CTRL_SRC_HTTP, uint32_t lease = 0);
 
 /**
  * @brief Установить движение по осям X/Y (для джойстика)
@@ -75,18 +141,37 @@ void controlSetMovement(ControlDirection direction, uint8_t speed);
  * 
  * @param x Ось X (-255 лево, +255 право)
  * @param y Ось Y (-255 назад, +255 вперёд)
+ * @param source Источник (задача-продюсер)
+ * @param lease Токен аренды клиента (0 — без аренды)
+ * @param senderUs Метка отправителя, мкс (джиттер-буфер; 0 — время публикации)
+ * @return false — отклонено арендой
  */
-void controlSetXY(int16_t x, int16_t y);
+bool controlSetXY(int16_t x, int16_t y, ControlSource source = CTRL_SRC_HTTP, uint32_t lease = 0,
+                  uint32_t senderUs = 0);
+
+/**
+ * @brief Установить скорости моторов напрямую (отладка, /api/drive)
+ * Не активирует watchdog — моторы крутятся до следующей команды.
+ * @param speeds Скорости всех моторов (0-255)
+ * @return false — отклонено арендой
+ */
+bool controlSetDrive(const DriveState& speeds, ControlSource source = CTRL_SRC_HTTP,
+                     uint32_t lease = 0);
 
 /**
  * @brief Принудительная остановка
- * Останавливает моторы и деактивирует управление
+ * Останавливает моторы и деактивирует управление. Принимается
+ * от любого клиента: токен не проверяется и аренду держателя
+ * не продлевает (lease.h).
+ * @return false — неверный источник
  */
-void controlStop();
+bool controlStop(ControlSource source = CTRL_SRC_HTTP, uint32_t lease = 0);
 
 /**
  * @brief Получить текущее состояние управления
  * @return Ссылка на структуру ControlState
+ * Ссылка на статик задачи управления — из других задач читать
+ * systemStateRead() (system_state.h), иначе поля могут «порваться».
  */
 const ControlState& controlGetState();
 
@@ -96,4 +181,35 @@ const ControlState& controlGetState();
  */
 bool controlIsActive();
 
+/**
+ * @brief Статистика тайминга задачи управления (гистограмма джиттера)
+ */
+ControlTimingStats controlGetTiming();
+
+/**
+ * @brief Состояние джиттер-буфера X/Y (стадия, глубина, счётчики)
+ */
+ControlJitterStatus controlGetJitter();
+
+/**
+ * @brief Статистика почтового ящика источника
+ */
+ControlMailboxStats controlGetMailboxStats(ControlSource source);
+
+/**
+ * @brief Пометить следующую команду источника меткой замера
+ * Вызывать из задачи-продюсера источника перед controlSet*().
+ * @param id Метка (≠ 0), вернётся в ControlProbe::id
+ */
+void controlProbeNext(ControlSource source, uint32_t id);
+
+/**
+ * @brief Дождаться результата замера (задача-продюсер источника)
+ * Результат готов после первой записи LEDC изменившегося канала
+ * или через CONTROL_PROBE_TIMEOUT_MS тиков ожидания записи.
+ * @return false — команда не применена за timeoutMs (например,
+ *         вытеснена более новой)
+ */
+bool controlProbeWait(ControlSource source, uint32_t id, ControlProbe* out, uint32_t timeoutMs);
+
 #endif // CONTROL_H
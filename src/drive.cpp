@@ -3,15 +3,37 @@
  * 🚗 drive.cpp — Модуль управления моторами (PWM / LED-имитация)
  * ============================================================
  *
- * Низкоуровневое управление 4 моторами через LEDC (PWM).
- * На текущей плате моторы ещё не подключены — используются LED
- * для визуальной отладки (яркость LED = скорость мотора).
+ * Управление 4 моторами. Вывод на железо — бэкенд, выбранный
+ * при сборке (DRIVE_BACKEND, drive_backend.h): на текущей плате
+ * моторы ещё не подключены — LED на LEDC для визуальной отладки
+ * (яркость LED = скорость мотора), на ровере — H-мост на MCPWM.
  *
  * Архитектура:
  *   - 4 мотора: FL (Front Left), FR, RL, RR
- *   - Каждый мотор привязан к LEDC каналу (1-4, канал 0 занят камерой)
- *   - PWM: 5 кГц, 8-бит разрешение (0-255)
- *   - Состояние хранится в static DriveState
+ *   - LED-имитация: каналы LEDC 1-4 (канал 0 занят камерой),
+ *     PWM 5 кГц, 8-бит разрешение (0-255)
+ *   - Состояние (целевые скорости) хранится в static DriveState
+ *   - Выходной каскад — DriveOutput<DriveBackend> (drive_output.h):
+ *     вызовы бэкенда статические, без виртуальной диспетчеризации
+ *
+ * Плавность (ramp.h):
+ *   driveSetSpeed() задаёт только цель. Выход на LEDC ведёт
+ *   driveTick() из задачи управления (CONTROL_RATE_HZ) через
+ *   ограничитель скорости нарастания/рывка по профилю
+ *   (driveSetRampProfile). Линейные участки рампы отдаются
+ *   аппаратному fade'у LEDC (если он есть у бэкенда) — CPU
+ *   не пишет скважность на каждом шаге. Встречные каналы одной стороны (FL↔RL,
+ *   FR↔RR) не включаются, пока другой не погас до нуля —
+ *   реверс идёт через остановку.
+ *
+ * Атомарное обновление (driveSetAll):
+ *   Все команды движения собирают полный DriveState и фиксируют
+ *   его одним вызовом: сравнение с текущими целями и копирование
+ *   изменившихся каналов — в одной короткой критической секции.
+ *   driveTick() снимает цели под той же секцией, поэтому никогда
+ *   не видит промежуточных комбинаций (например, «передние уже
+ *   включены, задние ещё нет»). Неизменившиеся каналы не
+ *   переписываются ни в целях, ни в регистрах PWM.
  *
  * Команды движения:
  *   - driveForward/Backward — передняя/задняя пара
@@ -19,58 +41,326 @@
  *   - driveRotateLeft/Right — танковый разворот (диагональные пары)
  *   - driveStop — остановка всех моторов
  *
+ * Контур скорости (encoder.h, wheel_pid.h):
+ *   Если выбран источник энкодера, цели 0-255 — уставки
+ *   0..SPEEDCTL_MAX_CPS. Рампа профиля ведёт саму уставку
+ *   (каждый тик, программно), раз в SPEEDCTL_DIVIDER тиков PID
+ *   колеса по приросту импульсов пересчитывает скважность, и она
+ *   идёт в бэкенд мимо рампы выхода — запаздывание рампы внутри
+ *   контура раскачивало бы колесо за уставку. Реверс через ноль
+ *   сохраняется. Скважность, реально поданная на мотор, уходит
+ *   обратно в PID (anti-windup). Модель мотора шагает каждым
+ *   тиком по фактическому выходу.
+ *
+ * Аварийный стоп (driveEstop):
+ *   Вызывается прямо из задачи приёма e-stop (estop.h): stopAll()
+ *   бэкенда (ledc_stop / сравнение MCPWM в 0) и нулевые цели,
+ *   без ожидания тика. Пока защёлка взведена, driveTick() держит
+ *   рампу в нуле и не пишет в бэкенд; если стоп пришёл посреди
+ *   тика (задача управления вытеснена между проверкой и записью),
+ *   тик гасит каналы повторно. Такой тик мог и записать цели
+ *   команды уже после обнуления — их обнуляют каждый тик под
+ *   защёлкой (задача управления) и driveEstopClear() перед снятием.
+ *
+ * Потолок «вперёд» (driveSetForwardCap):
+ *   Защита по смене сцены (scene_guard.h) ограничивает каналы
+ *   FL/FR: цели до контура скорости (с контуром — уставку, её
+ *   рампа после отсечки стартует с нуля) и скважность после
+ *   него, прямо перед выходом; отсечка (потолок 0) гасит их без
+ *   рампы. Назад (RL/RR) — без ограничений: отъехать от
+ *   препятствия можно.
+ *
  * Демо-режим:
- *   - 16 шагов, перебирает все комбинации моторов
- *   - Вызывается из loop() через driveDemoUpdate()
+ *   - встроенная программа миссий (mission.h, MISSION_PROG_DEMO)
  *
  * Зависимости:
- *   - config.h — пины, частота PWM, параметры демо
+ *   - config.h — пины, частота PWM, профиль рампы
+ *   - ramp.h   — ограничитель скорости нарастания и рывка
+ *   - encoder.h, wheel_pid.h — контур скорости колёс
+ *   - drive_output.h, drive_backend.h — выходной каскад и бэкенд
  *
  * ============================================================
  */
 
 #include "drive.h"
 #include "config.h"
+#include "log.h"
+#include "encoder.h"
+#include "wheel_pid.h"
+#include "drive_output.h"
+#include "drive_backend.h"
+#include <atomic>
 
-// --- Маппинг пинов и LEDC-каналов ---
-// Индексы совпадают с enum Motor: [RL=0, FR=1, FL=2, RR=3]
-static const uint8_t pwmPins[MOTOR_COUNT] = {
-    PWM_PIN_FL, PWM_PIN_FR, PWM_PIN_RL, PWM_PIN_RR
-};
-static const uint8_t pwmChannels[MOTOR_COUNT] = {
-    PWM_CH_FL, PWM_CH_FR, PWM_CH_RL, PWM_CH_RR
-};
+static_assert(MOTOR_COUNT == DRIVE_CHANNELS, "DriveOutput: каналы = enum Motor");
+static_assert((MOTOR_FL ^ 2) == MOTOR_RL && (MOTOR_FR ^ 2) == MOTOR_RR,
+              "DriveOutput: встречный канал стороны — ch ^ 2");
 
-// --- Текущее состояние скоростей моторов ---
+// --- Целевые скорости моторов (driveSetAll, под driveMux) ---
 static DriveState state = {{0, 0, 0, 0}};
+static portMUX_TYPE driveMux = portMUX_INITIALIZER_UNLOCKED;
+
+// --- Выход рампы (пишет только driveTick) ---
+static DriveOutput<DriveBackend> out;
+static DriveState output = {{0, 0, 0, 0}};
+static RampProfileId rampProfile = RAMP_PROFILE_DEFAULT;
+static DriveStats stats = {};
+
+// --- Контур скорости (состояние — только в задаче управления) ---
+#define SPEEDCTL_RATE_HZ   (CONTROL_RATE_HZ / SPEEDCTL_DIVIDER)
+#define LOOP_NO_REQUEST    0xFF
+
+static const WheelPidGains loopGains = {
+    (int32_t)((255LL << 16) / SPEEDCTL_MAX_CPS),  // ff: 255 скважности на SPEEDCTL_MAX_CPS
+    SPEEDCTL_KP_Q16,
+    SPEEDCTL_KI_Q16,
+    SPEEDCTL_KD_Q16,
+    SPEEDCTL_FILTER_SHIFT
+};
+static const EncoderSource* loopSource = NULL;
+static WheelPid loopPid[MOTOR_COUNT];
+static RampChannel loopRamp[MOTOR_COUNT];        // Рампа уставки (единицы цели 0-255)
+static uint32_t loopCounts[MOTOR_COUNT];
+static uint32_t loopSample = 0;                  // Номер шага PID
+static uint32_t loopStepSample[MOTOR_COUNT];     // Шаг последней смены уставки
+static uint32_t loopOutSample[MOTOR_COUNT];      // Последний шаг вне полосы
+static uint8_t  loopDivider = 0;
+static DriveLoopStatus loopStatus = {};
+static portMUX_TYPE loopMux = portMUX_INITIALIZER_UNLOCKED;
+static std::atomic<uint8_t> loopRequest(LOOP_NO_REQUEST);
+
+// --- Защёлка аварийного стопа (любая задача) ---
+static std::atomic<bool> estopLatched(false);
+
+// --- Потолок каналов «вперёд» (scene_guard.h, любая задача) ---
+static std::atomic<uint8_t> forwardCap(PWM_MAX_DUTY);
 
-// --- Демо режим: шаг и таймер ---
-static uint8_t demoStep = 0;
-static unsigned long demoLastMs = 0;
+// --- Каналы прямого вывода, мимо рампы и контура (wave.h) ---
+static std::atomic<uint8_t> rawMask(0);
 
 /**
- * Применить текущую скорость мотора на LEDC (PWM).
- * Внутренняя функция — вызывается после изменения state.speed[motor].
- * @param motor Индекс мотора (0-3)
+ * @brief Инициализация PWM каналов для всех моторов
+ * Настраивает бэкенд (LEDC: частота PWM_FREQ, разрешение
+ * PWM_RESOLUTION бит). Все моторы устанавливаются в 0 (остановлены).
  */
-static void applyPwm(Motor motor) {
-    if (motor >= MOTOR_COUNT) return;
-    ledcWrite(pwmChannels[motor], state.speed[motor]);
+void driveInit() {
+    out.begin();
+    memset(&state, 0, sizeof(state));
+    memset(&output, 0, sizeof(output));
+    driveSetSpeedLoop(SPEEDCTL_SOURCE);
 }
 
 /**
- * @brief Инициализация PWM каналов для всех моторов
- * Настраивает LEDC: частота PWM_FREQ, разрешение PWM_RESOLUTION бит.
- * Все моторы устанавливаются в 0 (остановлены).
+ * Переключить источник контура (из driveTick). Регуляторы
+ * сбрасываются, счёт импульсов начинается с текущего значения.
  */
-void driveInit() {
+static void speedLoopSelect(EncoderSourceId id) {
+    const EncoderSource* src = encoderGetSource(id);
+    if (src && !src->begin()) {
+        LOG_W("🧭 Энкодер %s недоступен — разомкнутый PWM", encoderSourceName(id));
+        src = NULL;
+        id = ENCODER_SRC_NONE;
+    }
+    loopSource = src;
+    loopDivider = 0;
+    for (uint8_t i = 0; i < MOTOR_COUNT; i++) {
+        wheelPidReset(&loopPid[i]);
+        rampReset(&loopRamp[i], output.speed[i]);      // Уставка — от текущего хода
+        loopStepSample[i] = loopOutSample[i] = loopSample;
+    }
+    if (src) src->read(loopCounts);
+
+    portENTER_CRITICAL(&loopMux);
+    loopStatus = DriveLoopStatus{};
+    loopStatus.source = id;
+    portEXIT_CRITICAL(&loopMux);
+    LOG_I("🧭 Контур скорости: %s", encoderSourceName(id));
+}
+
+/**
+ * Шаг PID всех колёс: прирост импульсов → имп/с → скважность.
+ * Регулятор ведёт уставку после рампы; время установления —
+ * от смены запрошенной уставки до последнего выхода измерения
+ * из полосы ±SPEEDCTL_SETTLE_PCT.
+ */
+static void speedLoopSample(const DriveState& targets) {
+    uint32_t counts[MOTOR_COUNT];
+    loopSource->read(counts);
+    loopSample++;
+
+    DriveLoopStatus next = loopStatus;
+    for (uint8_t i = 0; i < MOTOR_COUNT; i++) {
+        int32_t cps = (int32_t)(counts[i] - loopCounts[i]) * SPEEDCTL_RATE_HZ;
+        loopCounts[i] = counts[i];
+
+        int32_t sp = (int32_t)targets.speed[i] * SPEEDCTL_MAX_CPS / 255;
+        if (sp != next.setpointCps[i]) loopStepSample[i] = loopOutSample[i] = loopSample;
+
+        // Обратно — скважность, что реально шла на мотор (срез, реверс, прямой вывод)
+        int32_t ramped = (int32_t)rampDuty(&loopRamp[i]) * SPEEDCTL_MAX_CPS / 255;
+        next.duty[i] = wheelPidStep(&loopPid[i], loopGains, ramped, cps, PWM_MAX_DUTY,
+                                    output.speed[i]);
+        int32_t meas = loopPid[i].measCps;
+        int32_t err = sp > meas ? sp - meas : meas - sp;
+        if (err > sp * SPEEDCTL_SETTLE_PCT / 100) loopOutSample[i] = loopSample;
+
+        next.setpointCps[i] = sp;
+        next.measuredCps[i] = meas;
+        next.settleMs[i] = (loopOutSample[i] - loopStepSample[i]) * 1000 / SPEEDCTL_RATE_HZ;
+    }
+
+    portENTER_CRITICAL(&loopMux);
+    loopStatus = next;
+    portEXIT_CRITICAL(&loopMux);
+}
+
+/**
+ * Контур скорости внутри driveTick: рампа уставок, заменяет цели
+ * выходом PID.
+ * @param cutMask Каналы под отсечкой — рампа их уставки в ноль
+ * @return Каналы, что ведёт PID (мимо рампы выхода); 0 — контур
+ *         выключен, цели проходят в рампу как есть
+ */
+static uint8_t speedLoopTick(DriveState& targets, const RampProfile& profile,
+                             uint32_t dtUs, uint8_t cutMask) {
+    uint8_t req = loopRequest.exchange(LOOP_NO_REQUEST);
+    if (req != LOOP_NO_REQUEST) speedLoopSelect((EncoderSourceId)req);
+    if (!loopSource) return 0;
+
+    for (uint8_t i = 0; i < MOTOR_COUNT; i++) {
+        if (cutMask & (1 << i)) rampReset(&loopRamp[i], 0);
+        uint8_t segDuty;
+        uint32_t segMs;
+        rampStep(&loopRamp[i], profile, targets.speed[i], dtUs, 0, &segDuty, &segMs);
+    }
+
+    // Объект (модель) живёт с периодом тика, регулятор — реже
+    if (loopSource->advance) loopSource->advance(output, dtUs);
+    if (++loopDivider >= SPEEDCTL_DIVIDER) {
+        loopDivider = 0;
+        speedLoopSample(targets);
+    }
+    for (uint8_t i = 0; i < MOTOR_COUNT; i++) targets.speed[i] = loopStatus.duty[i];
+    return (1 << MOTOR_COUNT) - 1;
+}
+
+/** Потолок «вперёд» на каналах FL/FR */
+static void capFront(DriveState& targets, uint8_t cap) {
+    if (targets.speed[MOTOR_FL] > cap) targets.speed[MOTOR_FL] = cap;
+    if (targets.speed[MOTOR_FR] > cap) targets.speed[MOTOR_FR] = cap;
+}
+
+/**
+ * @brief Шаг рампы всех моторов: цель → ограничитель → бэкенд
+ * Вызывать с фиксированной частотой из задачи управления.
+ * @param dtUs Время с прошлого вызова (мкс)
+ * @return Маска моторов, в чьи каналы записано (запись или старт fade)
+ */
+uint8_t driveTick(uint32_t dtUs) {
+    const RampProfile& profile = rampGetProfile(rampProfile);
+    uint32_t maxFadeUs = (uint32_t)RAMP_FADE_CHUNK_MS * 1000;
+
+    // Аварийный стоп: рампа и выход в нуле, в бэкенд не пишем
+    if (estopLatched.load()) {
+        out.reset();
+        for (uint8_t i = 0; i < MOTOR_COUNT; i++) rampReset(&loopRamp[i], 0);
+        memset(&output, 0, sizeof(output));
+        return 0;
+    }
+
+    // Согласованный снимок целей всех моторов
+    portENTER_CRITICAL(&driveMux);
+    DriveState targets = state;
+    portEXIT_CRITICAL(&driveMux);
+
+    // Потолок «вперёд»: до контура — на уставку, после — на скважность
+    uint8_t written = 0;
+    uint8_t cap = forwardCap.load();
+    uint8_t cutMask = cap == 0 ? (1 << MOTOR_FL) | (1 << MOTOR_FR) : 0;
+    if (cutMask) written |= out.cut(cutMask);
+
+    // Каналы прямого вывода — цель как есть, мимо контура скорости
+    DriveState requested = targets;
+    capFront(targets, cap);
+    uint8_t looped = speedLoopTick(targets, profile, dtUs, cutMask);
+    uint8_t raw = rawMask.load();
     for (uint8_t i = 0; i < MOTOR_COUNT; i++) {
-        ledcSetup(pwmChannels[i], PWM_FREQ, PWM_RESOLUTION);
-        ledcAttachPin(pwmPins[i], pwmChannels[i]);
-        ledcWrite(pwmChannels[i], 0);
-        state.speed[i] = 0;
+        if (raw & (1 << i)) targets.speed[i] = requested.speed[i];
     }
-    demoLastMs = millis();
+    capFront(targets, cap);
+
+    written |= out.tick(targets.speed, profile, dtUs, maxFadeUs, raw | looped);
+    memcpy(output.speed, out.duty, sizeof(output.speed));
+    stats.writes = out.writes;
+    stats.fades = out.fades;
+
+    // Стоп пришёл, пока тик писал — его запись могла перекрыть stopAll()
+    if (estopLatched.load()) out.stopAll();
+    return written;
+}
+
+void driveSetRampProfile(RampProfileId profile) {
+    if (profile < RAMP_PROFILE_COUNT) rampProfile = profile;
+}
+
+RampProfileId driveGetRampProfile() {
+    return rampProfile;
+}
+
+const DriveState& driveGetOutput() {
+    return output;
+}
+
+DriveStats driveGetStats() {
+    return stats;
+}
+
+void driveEstop() {
+    estopLatched.store(true);
+    DriveOutput<DriveBackend>::stopAll();
+
+    portENTER_CRITICAL(&driveMux);
+    memset(&state, 0, sizeof(state));
+    portEXIT_CRITICAL(&driveMux);
+}
+
+void driveEstopClear() {
+    // Тик, вытесненный стопом посреди применения команды, мог вернуть
+    // ненулевые цели — защёлка снимается только с нулями
+    portENTER_CRITICAL(&driveMux);
+    memset(&state, 0, sizeof(state));
+    portEXIT_CRITICAL(&driveMux);
+    estopLatched.store(false);
+}
+
+bool driveEstopLatched() {
+    return estopLatched.load();
+}
+
+void driveSetForwardCap(uint8_t cap) {
+    forwardCap.store(cap > PWM_MAX_DUTY ? PWM_MAX_DUTY : cap);
+}
+
+uint8_t driveGetForwardCap() {
+    return forwardCap.load();
+}
+
+void driveSetRawMask(uint8_t mask) {
+    rawMask.store(mask & ((1 << MOTOR_COUNT) - 1));
+}
+
+uint8_t driveGetRawMask() {
+    return rawMask.load();
+}
+
+void driveSetSpeedLoop(uint8_t source) {
+    if (source < ENCODER_SRC_COUNT) loopRequest.store(source);
+}
+
+DriveLoopStatus driveGetLoopStatus() {
+    portENTER_CRITICAL(&loopMux);
+    DriveLoopStatus st = loopStatus;
+    portEXIT_CRITICAL(&loopMux);
+    return st;
 }
 
 // --- Получение текущего состояния всех моторов ---
@@ -84,14 +374,42 @@ uint8_t driveGetSpeed(Motor motor) {
 }
 
 /**
- * @brief Установить скорость одного мотора
+ * @brief Атомарно задать целевые скорости всех моторов
+ * Изменившиеся каналы копируются в одной критической секции,
+ * выход догонит цели через рампу в driveTick().
+ * @param next Новые скорости (ограничиваются PWM_MAX_DUTY)
+ * @return Маска изменившихся моторов (бит = индекс enum Motor)
+ */
+uint8_t driveSetAll(const DriveState& next) {
+    uint8_t changed = 0;
+
+    portENTER_CRITICAL(&driveMux);
+    for (uint8_t i = 0; i < MOTOR_COUNT; i++) {
+        uint8_t speed = (next.speed[i] > PWM_MAX_DUTY) ? PWM_MAX_DUTY : next.speed[i];
+        if (speed != state.speed[i]) {
+            state.speed[i] = speed;
+            changed |= 1 << i;
+        }
+    }
+    stats.commits++;
+    if (!changed) stats.unchanged++;
+    portEXIT_CRITICAL(&driveMux);
+
+    return changed;
+}
+
+/**
+ * @brief Установить целевую скорость одного мотора
  * @param motor Индекс мотора (enum Motor)
  * @param speed Скорость 0-255 (ограничивается PWM_MAX_DUTY)
  */
 void driveSetSpeed(Motor motor, uint8_t speed) {
     if (motor >= MOTOR_COUNT) return;
-    state.speed[motor] = (speed > PWM_MAX_DUTY) ? PWM_MAX_DUTY : speed;
-    applyPwm(motor);
+    if (speed > PWM_MAX_DUTY) speed = PWM_MAX_DUTY;
+
+    portENTER_CRITICAL(&driveMux);
+    state.speed[motor] = speed;
+    portEXIT_CRITICAL(&driveMux);
 }
 
 // --- Инкремент ---
@@ -108,172 +426,49 @@ void driveDecrement(Motor motor, uint8_t step) {
     driveSetSpeed(motor, (newSpeed < 0) ? 0 : newSpeed);
 }
 
+/**
+ * Собрать состояние «пара/диагональ на скорости speed» (a == b —
+ * один мотор), остальные — 0, и зафиксировать одним driveSetAll().
+ */
+static void driveSetPair(Motor a, Motor b, uint8_t speed) {
+    DriveState next = {};
+    next.speed[a] = speed;
+    next.speed[b] = speed;
+    driveSetAll(next);
+}
+
 // --- Стоп ---
 void driveStop() {
-    for (uint8_t i = 0; i < MOTOR_COUNT; i++) {
-        driveSetSpeed((Motor)i, 0);
-    }
+    DriveState next = {};
+    driveSetAll(next);
 }
 
 // --- Вперёд: FL + FR ---
 void driveForward(uint8_t speed) {
-    driveSetSpeed(MOTOR_FL, speed);
-    driveSetSpeed(MOTOR_FR, speed);
-    driveSetSpeed(MOTOR_RL, 0);
-    driveSetSpeed(MOTOR_RR, 0);
+    driveSetPair(MOTOR_FL, MOTOR_FR, speed);
 }
 
 // --- Назад: RL + RR ---
 void driveBackward(uint8_t speed) {
-    driveSetSpeed(MOTOR_FL, 0);
-    driveSetSpeed(MOTOR_FR, 0);
-    driveSetSpeed(MOTOR_RL, speed);
-    driveSetSpeed(MOTOR_RR, speed);
+    driveSetPair(MOTOR_RL, MOTOR_RR, speed);
 }
 
 // --- Поворот влево: правая сторона вперёд ---
 void driveTurnLeft(uint8_t speed) {
-    driveSetSpeed(MOTOR_FL, 0);
-    driveSetSpeed(MOTOR_FR, speed);
-    driveSetSpeed(MOTOR_RL, 0);
-    driveSetSpeed(MOTOR_RR, 0);
+    driveSetPair(MOTOR_FR, MOTOR_FR, speed);
 }
 
 // --- Поворот вправо: левая сторона вперёд ---
 void driveTurnRight(uint8_t speed) {
-    driveSetSpeed(MOTOR_FL, speed);
-    driveSetSpeed(MOTOR_FR, 0);
-    driveSetSpeed(MOTOR_RL, 0);
-    driveSetSpeed(MOTOR_RR, 0);
+    driveSetPair(MOTOR_FL, MOTOR_FL, speed);
 }
 
 // --- Разворот влево: правая вперёд, левая назад ---
 void driveRotateLeft(uint8_t speed) {
-    driveSetSpeed(MOTOR_FL, 0);
-    driveSetSpeed(MOTOR_FR, speed);
-    driveSetSpeed(MOTOR_RL, speed);
-    driveSetSpeed(MOTOR_RR, 0);
+    driveSetPair(MOTOR_FR, MOTOR_RL, speed);
 }
 
 // --- Разворот вправо: левая вперёд, правая назад ---
 void driveRotateRight(uint8_t speed) {
-    driveSetSpeed(MOTOR_FL, speed);
-    driveSetSpeed(MOTOR_FR, 0);
-    driveSetSpeed(MOTOR_RL, 0);
-    driveSetSpeed(MOTOR_RR, speed);
-}
-
-/**
- * @brief Демо режим: перебирает 16 тестовых паттернов моторов
- * Вызывать в loop(). Переключает шаги каждые DEMO_STEP_MS мс.
- * Паттерны: одиночные → парные → диагонали → все → танковый разворот → ramp → стоп
- */
-void driveDemoUpdate() {
-    unsigned long now = millis();
-    if (now - demoLastMs < DEMO_STEP_MS) return;
-    demoLastMs = now;
-
-    demoStep = (demoStep + 1) % 16;
-    driveStop();  // Сначала всё выключаем
-    
-    switch (demoStep) {
-        // === Одиночные моторы ===
-        case 0:
-            Serial.println("🔴 [1/16] FL only");
-            driveSetSpeed(MOTOR_FL, DEMO_SPEED_DEFAULT);
-            break;
-        case 1:
-            Serial.println("🟠 [2/16] FR only");
-            driveSetSpeed(MOTOR_FR, DEMO_SPEED_DEFAULT);
-            break;
-        case 2:
-            Serial.println("🟡 [3/16] RL only");
-            driveSetSpeed(MOTOR_RL, DEMO_SPEED_DEFAULT);
-            break;
-        case 3:
-            Serial.println("🟢 [4/16] RR only");
-            driveSetSpeed(MOTOR_RR, DEMO_SPEED_DEFAULT);
-            break;
-
-        // === Парные: левая/правая сторона ===
-        case 4:
-            Serial.println("⬅️ [5/16] LEFT side (FL + RL)");
-            driveSetSpeed(MOTOR_FL, DEMO_SPEED_DEFAULT);
-            driveSetSpeed(MOTOR_RL, DEMO_SPEED_DEFAULT);
-            break;
-        case 5:
-            Serial.println("➡️ [6/16] RIGHT side (FR + RR)");
-            driveSetSpeed(MOTOR_FR, DEMO_SPEED_DEFAULT);
-            driveSetSpeed(MOTOR_RR, DEMO_SPEED_DEFAULT);
-            break;
-
-        // === Парные: перед/зад ===
-        case 6:
-            Serial.println("⬆️ [7/16] FRONT (FL + FR)");
-            driveSetSpeed(MOTOR_FL, DEMO_SPEED_DEFAULT);
-            driveSetSpeed(MOTOR_FR, DEMO_SPEED_DEFAULT);
-            break;
-        case 7:
-            Serial.println("⬇️ [8/16] REAR (RL + RR)");
-            driveSetSpeed(MOTOR_RL, DEMO_SPEED_DEFAULT);
-            driveSetSpeed(MOTOR_RR, DEMO_SPEED_DEFAULT);
-            break;
-
-        // === Диагонали ===
-        case 8:
-            Serial.println("↗️ [9/16] DIAG 1 (FL + RR)");
-            driveSetSpeed(MOTOR_FL, DEMO_SPEED_DEFAULT);
-            driveSetSpeed(MOTOR_RR, DEMO_SPEED_DEFAULT);
-            break;
-        case 9:
-            Serial.println("↖️ [10/16] DIAG 2 (FR + RL)");
-            driveSetSpeed(MOTOR_FR, DEMO_SPEED_DEFAULT);
-            driveSetSpeed(MOTOR_RL, DEMO_SPEED_DEFAULT);
-            break;
-
-        // === Все 4 вместе ===
-        case 10:
-            Serial.println("🔵 [11/16] ALL motors");
-            driveSetSpeed(MOTOR_FL, DEMO_SPEED_DEFAULT);
-            driveSetSpeed(MOTOR_FR, DEMO_SPEED_DEFAULT);
-            driveSetSpeed(MOTOR_RL, DEMO_SPEED_DEFAULT);
-            driveSetSpeed(MOTOR_RR, DEMO_SPEED_DEFAULT);
-            break;
-
-        // === Танковый разворот (гусеницы) ===
-        case 11:
-            Serial.println("🔄 [12/16] TANK LEFT (right fwd, left back)");
-            driveSetSpeed(MOTOR_FR, DEMO_SPEED_DEFAULT);  // правая вперёд
-            driveSetSpeed(MOTOR_RR, DEMO_SPEED_DEFAULT);
-            // FL, RL = 0 (в реале назад, но у нас LED)
-            break;
-        case 12:
-            Serial.println("🔃 [13/16] TANK RIGHT (left fwd, right back)");
-            driveSetSpeed(MOTOR_FL, DEMO_SPEED_DEFAULT);  // левая вперёд
-            driveSetSpeed(MOTOR_RL, DEMO_SPEED_DEFAULT);
-            // FR, RR = 0 (в реале назад)
-            break;
-
-        // === Плавное нарастание ===
-        case 13:
-            Serial.println("📈 [14/16] RAMP UP all (low)");
-            driveSetSpeed(MOTOR_FL, DEMO_SPEED_RAMP_LOW);
-            driveSetSpeed(MOTOR_FR, DEMO_SPEED_RAMP_LOW);
-            driveSetSpeed(MOTOR_RL, DEMO_SPEED_RAMP_LOW);
-            driveSetSpeed(MOTOR_RR, DEMO_SPEED_RAMP_LOW);
-            break;
-        case 14:
-            Serial.println("📈 [15/16] RAMP UP all (mid)");
-            driveSetSpeed(MOTOR_FL, DEMO_SPEED_RAMP_MID);
-            driveSetSpeed(MOTOR_FR, DEMO_SPEED_RAMP_MID);
-            driveSetSpeed(MOTOR_RL, DEMO_SPEED_RAMP_MID);
-            driveSetSpeed(MOTOR_RR, DEMO_SPEED_RAMP_MID);
-            break;
-
-        // === Стоп ===
-        case 15:
-            Serial.println("🛑 [16/16] STOP");
-            driveStop();
-            break;
-    }
+    driveSetPair(MOTOR_FL, MOTOR_RR, speed);
 }
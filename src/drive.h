@@ -4,7 +4,8 @@
  * ============================================================
  *
  * Низкоуровневое PWM-управление 4 моторами ровера.
- * На текущей плате используется LED-имитация (яркость = скорость).
+ * На текущей плате используется LED-имитация (яркость = скорость),
+ * бэкенд вывода выбирается при сборке (DRIVE_BACKEND, drive_backend.h).
  *
  * Моторы:
  *   FL (Front Left)  — передний левый
@@ -15,6 +16,12 @@
  * Индексы в enum Motor НЕ последовательные (из-за разводки платы):
  *   RL=0, FR=1, FL=2, RR=3
  *
+ * driveSetSpeed() и команды движения задают ЦЕЛЬ; на LEDC её
+ * выводит driveTick() через рампу (ramp.h) — см. driveGetOutput().
+ * С включённым контуром скорости (driveSetSpeedLoop) цель —
+ * уставка скорости колеса: рампа ведёт уставку, скважность
+ * подбирает PID по энкодеру.
+ *
  * ============================================================
  */
 
@@ -22,6 +29,7 @@
 #define DRIVE_H
 
 #include <Arduino.h>
+#include "ramp.h"
 
 // --- Индексы моторов (порядок определяется разводкой платы) ---
 enum Motor : uint8_t {
@@ -37,6 +45,23 @@ struct DriveState {
     uint8_t speed[MOTOR_COUNT];  // PWM скорость каждого мотора (0-255)
 };
 
+// --- Статистика обновлений целей и вывода на LEDC ---
+struct DriveStats {
+    uint32_t commits;            // Вызовов driveSetAll()
+    uint32_t unchanged;          // Из них без изменений (ничего не записано)
+    uint32_t writes;             // Программных записей скважности
+    uint32_t fades;              // Запущенных аппаратных fade'ов
+};
+
+// --- Состояние контура скорости (encoder.h, wheel_pid.h) ---
+struct DriveLoopStatus {
+    uint8_t  source;                    // EncoderSourceId, 0 — контур выключен
+    int32_t  setpointCps[MOTOR_COUNT];  // Уставка (имп/с)
+    int32_t  measuredCps[MOTOR_COUNT];  // Отфильтрованное измерение (имп/с)
+    uint8_t  duty[MOTOR_COUNT];         // Выход PID (идёт мимо рампы выхода)
+    uint32_t settleMs[MOTOR_COUNT];     // Время установления после смены уставки
+};
+
 // ============================================================
 // API функции
 // ============================================================
@@ -44,12 +69,88 @@ struct DriveState {
 /** @brief Инициализация PWM каналов. Вызывать в setup(). */
 void driveInit();
 
-/** @brief Получить ссылку на текущее состояние всех моторов */
+/** @brief Получить ссылку на целевые скорости всех моторов */
 const DriveState& driveGetState();
 
+/** @brief Фактическая скважность на LEDC (выход рампы) */
+const DriveState& driveGetOutput();
+
+/**
+ * @brief Шаг рампы: ведёт выход LEDC к целевым скоростям
+ * Вызывать только из задачи управления с фиксированной частотой.
+ * @param dtUs Время с прошлого вызова (мкс)
+ * @return Маска моторов (бит = индекс), в чьи каналы LEDC записано на этом шаге
+ */
+uint8_t driveTick(uint32_t dtUs);
+
+/** @brief Выбрать профиль рампы (RAMP_OFF — без ограничений) */
+void driveSetRampProfile(RampProfileId profile);
+
+/** @brief Текущий профиль рампы */
+RampProfileId driveGetRampProfile();
+
+/** @brief Счётчики фиксаций целей и записей/fade'ов LEDC */
+DriveStats driveGetStats();
+
+/**
+ * @brief Включить контур скорости с источником энкодера (EncoderSourceId)
+ * Потокобезопасно: применяется на следующем driveTick(). Если
+ * источник недоступен (нет пинов) — остаётся разомкнутый PWM.
+ */
+void driveSetSpeedLoop(uint8_t source);
+
+/** @brief Снимок состояния контура скорости */
+DriveLoopStatus driveGetLoopStatus();
+
+/**
+ * @brief Аварийный стоп из любой задачи (estop.h)
+ * Сразу гасит каналы моторов (stopAll() бэкенда, мимо рампы и
+ * задачи управления), обнуляет цели и защёлкивает останов:
+ * driveTick() ничего не выводит до driveEstopClear().
+ */
+void driveEstop();
+
+/** @brief Снять защёлку аварийного стопа (цели обнуляются до снятия) */
+void driveEstopClear();
+
+/** @brief Защёлка аварийного стопа взведена */
+bool driveEstopLatched();
+
+/**
+ * @brief Потолок скважности каналов «вперёд» (FL, FR) из любой задачи
+ * Защита по смене сцены (scene_guard.h): PWM_MAX_DUTY — без
+ * ограничения, 0 — отсечка: на ближайшем driveTick() каналы
+ * гаснут сразу, мимо рампы. Цели не меняются — после снятия
+ * потолка выход догонит их через рампу.
+ */
+void driveSetForwardCap(uint8_t cap);
+
+/** @brief Текущий потолок каналов «вперёд» */
+uint8_t driveGetForwardCap();
+
+/**
+ * @brief Каналы прямого вывода (бит = индекс enum Motor)
+ * Цели этих каналов выводятся на ближайшем driveTick() как есть —
+ * мимо рампы и контура скорости (проигрыватель форм, wave.h).
+ * Потолок «вперёд», реверс через ноль и аварийный стоп действуют.
+ * 0 — обычный режим.
+ */
+void driveSetRawMask(uint8_t mask);
+
+/** @brief Текущая маска каналов прямого вывода */
+uint8_t driveGetRawMask();
+
 /** @brief Получить скорость конкретного мотора (0-255) */
 uint8_t driveGetSpeed(Motor motor);
 
+/**
+ * @brief Атомарно задать целевые скорости всех моторов
+ * Сравнивает с текущими и фиксирует только изменившиеся каналы
+ * в одной критической секции.
+ * @return Маска изменившихся моторов (бит = индекс enum Motor)
+ */
+uint8_t driveSetAll(const DriveState& next);
+
 /** @brief Установить скорость конкретного мотора (0-255) */
 void driveSetSpeed(Motor motor, uint8_t speed);
 
@@ -68,7 +169,4 @@ void driveTurnRight(uint8_t speed);  // Поворот вправо: тольк
 void driveRotateLeft(uint8_t speed); // Танковый разворот влево (FR + RL)
 void driveRotateRight(uint8_t speed);// Танковый разворот вправо (FL + RR)
 
-/** @brief Демо режим: вызывать в loop(), перебирает 16 паттернов */
-void driveDemoUpdate();
-
 #endif // DRIVE_H
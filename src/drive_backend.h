@@ -0,0 +1,219 @@
+/**
+ * ============================================================
+ * 🔌 drive_backend.h — Бэкенды вывода моторов (выбор при сборке)
+ * ============================================================
+ *
+ * Политики для DriveOutput<Backend> (drive_output.h), выбор —
+ * DRIVE_BACKEND в config.h:
+ *
+ *   LedcSimBackend      — LED-имитация: 4 канала LEDC, яркость =
+ *                         скорость, аппаратный fade (текущая плата)
+ *   McpwmHBridgeBackend — настоящий мост: MCPWM + пин направления
+ *                         на сторону, fade нет — рампа программная
+ *
+ * Горячий путь (write, fade) пишет регистры через HAL low-level
+ * (hal/ledc_ll.h, hal/mcpwm_ll.h — static inline): ни
+ * драйверных блокировок, ни вызовов через указатель — запись
+ * посреди fade не ждёт его окончания. Настройка (begin) — через
+ * обычные драйверы Arduino/IDF.
+ *
+ * Хостовый бэкенд — drive_backend_mock.h.
+ *
+ * ============================================================
+ */
+
+#ifndef DRIVE_BACKEND_H
+#define DRIVE_BACKEND_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "drive_output.h"
+
+#if DRIVE_BACKEND == DRIVE_BACKEND_LEDC_SIM
+
+#include <driver/ledc.h>
+#include <hal/ledc_ll.h>
+#include <soc/ledc_struct.h>
+
+// ============================================================
+// LED-имитация на LEDC
+// ============================================================
+
+struct LedcSimBackend {
+    static constexpr bool kHasFade = true;
+
+    // Индексы совпадают с enum Motor: [RL=0, FR=1, FL=2, RR=3]
+    // (исторически: пины и каналы FL/RL перекрещены разводкой)
+    static constexpr uint8_t kPins[DRIVE_CHANNELS] = {
+        PWM_PIN_FL, PWM_PIN_FR, PWM_PIN_RL, PWM_PIN_RR
+    };
+    static constexpr uint8_t kChannels[DRIVE_CHANNELS] = {
+        PWM_CH_FL, PWM_CH_FR, PWM_CH_RL, PWM_CH_RR
+    };
+
+    // Каналы Arduino 0-7 — группа LEDC_HIGH_SPEED_MODE, 8-15 — LOW_SPEED
+    static ledc_mode_t mode(uint8_t ch) { return (ledc_mode_t)(kChannels[ch] / 8); }
+    static ledc_channel_t channel(uint8_t ch) { return (ledc_channel_t)(kChannels[ch] % 8); }
+
+    static void begin() {
+        for (uint8_t i = 0; i < DRIVE_CHANNELS; i++) {
+            ledcSetup(kChannels[i], PWM_FREQ, PWM_RESOLUTION);
+            ledcAttachPin(kPins[i], kChannels[i]);
+            ledcWrite(kChannels[i], 0);
+        }
+    }
+
+    static constexpr uint32_t kFieldMax = 1023;       // duty_num / duty_cycle — 10 бит
+
+    // Как ledcWrite: максимум разрешения — полное включение
+    static uint32_t level(uint8_t duty) {
+        return duty >= PWM_MAX_DUTY ? (1u << PWM_RESOLUTION) : duty;
+    }
+
+    /**
+     * Запустить изменение скважности регистрами: от start по num
+     * шагов в направлении dir, шаг — каждые cycle периодов PWM.
+     * num = 1, scale = 0 — просто новая скважность.
+     *
+     * Драйвер fade IDF (ledc_set_fade_with_time) не используется:
+     * он держит семафор до ISR конца участка, и ledc_set_duty()
+     * посреди участка ждёт его с portMAX_DELAY — до
+     * RAMP_FADE_CHUNK_MS на задаче управления. Здесь любая запись
+     * перепрограммирует канал сразу, в том числе посреди fade.
+     */
+    static inline void program(uint8_t ch, uint32_t start, ledc_duty_direction_t dir,
+                               uint32_t num, uint32_t cycle, uint32_t scale) {
+        ledc_mode_t m = mode(ch);
+        ledc_channel_t c = channel(ch);
+        ledc_ll_set_fade_end_intr(&LEDC, m, c, false);
+        ledc_ll_set_duty_int_part(&LEDC, m, c, start);
+        ledc_ll_set_duty_direction(&LEDC, m, c, dir);
+        ledc_ll_set_duty_num(&LEDC, m, c, num);
+        ledc_ll_set_duty_cycle(&LEDC, m, c, cycle);
+        ledc_ll_set_duty_scale(&LEDC, m, c, scale);
+        ledc_ll_set_sig_out_en(&LEDC, m, c, true);
+        ledc_ll_set_duty_start(&LEDC, m, c, true);
+        if (m == LEDC_LOW_SPEED_MODE) ledc_ll_ls_channel_update(&LEDC, m, c);
+    }
+
+    /** То же, что ledc_set_duty() + ledc_update_duty(); идущий fade прерывается */
+    static inline void write(uint8_t ch, uint8_t duty) {
+        program(ch, level(duty), LEDC_DUTY_DIR_INCREASE, 1, 1, 0);
+    }
+
+    /**
+     * Аппаратный fade (не ждёт окончания): от текущей скважности
+     * канала до duty по единице за шаг. Участок короче шага
+     * (меньше периода PWM на единицу) — сразу запись.
+     */
+    static void fade(uint8_t ch, uint8_t duty, uint32_t ms) {
+        uint32_t from = 0;
+        ledc_ll_get_duty(&LEDC, mode(ch), channel(ch), &from);
+        uint32_t to = level(duty);
+        uint32_t delta = to > from ? to - from : from - to;
+        uint32_t cycles = (uint32_t)PWM_FREQ * ms / 1000;
+        if (delta == 0 || delta > kFieldMax || cycles < delta) {
+            write(ch, duty);
+            return;
+        }
+        uint32_t cycle = cycles / delta;
+        if (cycle > kFieldMax) cycle = kFieldMax;
+        program(ch, from, to > from ? LEDC_DUTY_DIR_INCREASE : LEDC_DUTY_DIR_DECREASE,
+                delta, cycle, 1);
+    }
+
+    /** Выход всех каналов в idle = 0, минуя fade */
+    static void stopAll() {
+        for (uint8_t i = 0; i < DRIVE_CHANNELS; i++) {
+            ledc_stop(mode(i), channel(i), 0);
+        }
+    }
+};
+
+typedef LedcSimBackend DriveBackend;
+
+#elif DRIVE_BACKEND == DRIVE_BACKEND_MCPWM
+
+#include <driver/mcpwm.h>
+#include <hal/mcpwm_ll.h>
+#include <hal/gpio_ll.h>
+#include <soc/mcpwm_struct.h>
+#include <soc/gpio_struct.h>
+
+// ============================================================
+// H-мост: MCPWM0, таймер/оператор 0 — левая сторона, 1 — правая
+// ============================================================
+//
+// Пары каналов enum Motor становятся направлением одной стороны:
+// FL/FR — вперёд, RL/RR — назад. DriveOutput не включает
+// встречный канал, пока другой не в нуле, поэтому на стороне
+// активен не больше одного — он и задаёт PWM и пин DIR.
+
+struct McpwmHBridgeBackend {
+    static constexpr bool kHasFade = false;
+
+    // Сторона канала: [RL=0]→0, [FR=1]→1, [FL=2]→0, [RR=3]→1
+    static uint8_t side(uint8_t ch) { return ch & 1; }
+    // Канал «назад»: RL=0 и RR=3
+    static bool reverse(uint8_t ch) { return ch == 0 || ch == 3; }
+
+    static constexpr uint8_t kPwmPins[2] = { MCPWM_PIN_LEFT_PWM, MCPWM_PIN_RIGHT_PWM };
+    static constexpr uint8_t kDirPins[2] = { MCPWM_PIN_LEFT_DIR, MCPWM_PIN_RIGHT_DIR };
+
+    static inline uint32_t peak = 0;                  // Период таймера в тиках
+    static inline uint8_t  fwd[2] = {};               // Скважность «вперёд» по сторонам
+    static inline uint8_t  rev[2] = {};               // Скважность «назад»
+
+    static void begin() {
+        mcpwm_gpio_init(MCPWM_UNIT_0, MCPWM0A, kPwmPins[0]);
+        mcpwm_gpio_init(MCPWM_UNIT_0, MCPWM1A, kPwmPins[1]);
+
+        mcpwm_config_t cfg = {};
+        cfg.frequency    = MCPWM_FREQ;
+        cfg.cmpr_a       = 0;
+        cfg.cmpr_b       = 0;
+        cfg.counter_mode = MCPWM_UP_COUNTER;
+        cfg.duty_mode    = MCPWM_DUTY_MODE_0;
+        mcpwm_init(MCPWM_UNIT_0, MCPWM_TIMER_0, &cfg);
+        mcpwm_init(MCPWM_UNIT_0, MCPWM_TIMER_1, &cfg);
+        peak = mcpwm_ll_timer_get_peak(&MCPWM0, 0, false);
+
+        for (uint8_t s = 0; s < 2; s++) {
+            pinMode(kDirPins[s], OUTPUT);
+            digitalWrite(kDirPins[s], LOW);
+            fwd[s] = rev[s] = 0;
+        }
+    }
+
+    /**
+     * Сравнение оператора (генератор A) и пин DIR — регистрами.
+     * Новое сравнение вступает на нуле таймера (теневой регистр),
+     * без рваного периода.
+     */
+    static inline void write(uint8_t ch, uint8_t duty) {
+        uint8_t s = side(ch);
+        if (reverse(ch)) rev[s] = duty;
+        else fwd[s] = duty;
+
+        bool back = fwd[s] == 0 && rev[s] > 0;
+        uint8_t d = back ? rev[s] : fwd[s];
+        gpio_ll_set_level(&GPIO, (gpio_num_t)kDirPins[s], back ? 1 : 0);
+        mcpwm_ll_operator_set_compare_value(&MCPWM0, s, 0, (uint32_t)d * peak / PWM_MAX_DUTY);
+    }
+
+    /** Сравнение в 0 — выход в низком уровне с ближайшего периода */
+    static void stopAll() {
+        for (uint8_t s = 0; s < 2; s++) {
+            mcpwm_ll_operator_set_compare_value(&MCPWM0, s, 0, 0);
+            fwd[s] = rev[s] = 0;
+        }
+    }
+};
+
+typedef McpwmHBridgeBackend DriveBackend;
+
+#else
+#error "DRIVE_BACKEND: неизвестный бэкенд (config.h)"
+#endif
+
+#endif // DRIVE_BACKEND_H
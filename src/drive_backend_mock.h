@@ -0,0 +1,69 @@
+/**
+ * ============================================================
+ * 🧪 drive_backend_mock.h — Бэкенд вывода моторов для хоста
+ * ============================================================
+ *
+ * Политика для DriveOutput<MockDriveBackend> (drive_output.h)
+ * без железа: записи и fade'ы складываются в статические поля,
+ * их проверяет test/test_drive_output (pio test -e native):
+ *
+ *   DriveOutput<MockDriveBackend> out;
+ *   out.begin();
+ *   out.tick(targets, rampGetProfile(RAMP_SOFT), 5000, 40000);
+ *   // MockDriveBackend::duty[ch], ::writes, ::fades, ::stops
+ *
+ * kHasFade задаётся параметром шаблона: MockDriveBackendT<false>
+ * повторяет бэкенд без fade (MCPWM).
+ *
+ * ============================================================
+ */
+
+#ifndef DRIVE_BACKEND_MOCK_H
+#define DRIVE_BACKEND_MOCK_H
+
+#include <stdint.h>
+#include "drive_output.h"
+
+template <bool HasFade>
+struct MockDriveBackendT {
+    static constexpr bool kHasFade = HasFade;
+
+    static inline uint8_t  duty[DRIVE_CHANNELS] = {};     // Последняя скважность канала
+    static inline uint32_t fadeMs[DRIVE_CHANNELS] = {};   // Длительность последнего fade (0 — запись)
+    static inline uint32_t writes = 0;
+    static inline uint32_t fades  = 0;
+    static inline uint32_t stops  = 0;
+    static inline uint32_t begins = 0;
+
+    /** Сбросить запись (между сценариями) */
+    static void clear() {
+        for (uint8_t i = 0; i < DRIVE_CHANNELS; i++) duty[i] = fadeMs[i] = 0;
+        writes = fades = stops = begins = 0;
+    }
+
+    static void begin() {
+        clear();
+        begins++;
+    }
+
+    static void write(uint8_t ch, uint8_t d) {
+        duty[ch] = d;
+        fadeMs[ch] = 0;
+        writes++;
+    }
+
+    static void fade(uint8_t ch, uint8_t d, uint32_t ms) {
+        duty[ch] = d;
+        fadeMs[ch] = ms;
+        fades++;
+    }
+
+    static void stopAll() {
+        for (uint8_t i = 0; i < DRIVE_CHANNELS; i++) duty[i] = 0;
+        stops++;
+    }
+};
+
+typedef MockDriveBackendT<true> MockDriveBackend;
+
+#endif // DRIVE_BACKEND_MOCK_H
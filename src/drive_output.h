@@ -0,0 +1,141 @@
+/**
+ * ============================================================
+ * ⚙️ drive_output.h — Выходной каскад моторов над бэкендом
+ * ============================================================
+ *
+ * Общая для всех плат часть driveTick(): рампа каждого канала,
+ * реверс через ноль и решение «fade / программная запись /
+ * ничего». Куда уходит скважность — решает бэкенд (параметр
+ * шаблона, drive_backend.h), выбранный при сборке: вызовы
+ * Backend::write() статические и встраиваются в тик — без
+ * виртуальных функций и указателей.
+ *
+ * Контракт бэкенда (все методы static):
+ *
+ *   kHasFade            — constexpr bool: есть аппаратный fade;
+ *                         false — рампа идёт только программно
+ *   begin()             — настроить периферию, выход 0
+ *   write(ch, duty)     — скважность 0-255 канала ch (горячий путь);
+ *                         идущий fade канала прерывается сразу, без
+ *                         ожидания его конца
+ *   fade(ch, duty, ms)  — линейный участок до duty за ms
+ *                         (нужен только при kHasFade)
+ *   stopAll()           — погасить все каналы из любой задачи,
+ *                         мимо рампы; выход вернёт первая write/fade
+ *
+ * Каналы — индексы enum Motor (drive.h): RL=0, FR=1, FL=2, RR=3.
+ * Встречный канал той же стороны — ch ^ 2 (RL↔FL, FR↔RR).
+ *
+ * Модуль не зависит от Arduino/IDF: с MockDriveBackend
+ * (drive_backend_mock.h) тот же каскад собирается на хосте.
+ *
+ * ============================================================
+ */
+
+#ifndef DRIVE_OUTPUT_H
+#define DRIVE_OUTPUT_H
+
+#include <stdint.h>
+#include "ramp.h"
+
+#define DRIVE_CHANNELS 4
+
+template <typename Backend>
+class DriveOutput {
+public:
+    /** @brief Настроить бэкенд, рампы и выход в ноль */
+    void begin() {
+        Backend::begin();
+        reset();
+    }
+
+    /** @brief Рампы и выход в ноль (в бэкенд не пишет) */
+    void reset() {
+        for (uint8_t i = 0; i < DRIVE_CHANNELS; i++) {
+            rampReset(&ramp[i], 0);
+            duty[i] = 0;
+        }
+    }
+
+    /**
+     * @brief Шаг рампы всех каналов: цели → ограничитель → бэкенд
+     * @param targets   Цели 0-255 по индексам enum Motor
+     * @param maxFadeUs Макс. участок на аппаратном fade (0 — только программно)
+     * @param rawMask   Каналы мимо рампы: цель пишется как есть (реверс через
+     *                  ноль по-прежнему действует)
+     * @return Маска каналов, в которые записано (write или старт fade)
+     */
+    uint8_t tick(const uint8_t* targets, const RampProfile& profile, uint32_t dtUs,
+                 uint32_t maxFadeUs, uint8_t rawMask = 0) {
+        if (!Backend::kHasFade) maxFadeUs = 0;
+
+        uint8_t written = 0;
+        for (uint8_t i = 0; i < DRIVE_CHANNELS; i++) {
+            uint8_t target = targets[i];
+            // Реверс через ноль: ждём, пока встречный канал погаснет
+            if (target > 0 && ramp[i ^ 2].pos > 0.0f) target = 0;
+
+            uint8_t segDuty = 0;
+            uint32_t segMs = 0;
+            RampAction action;
+            if (rawMask & (1 << i)) {
+                action = ramp[i].holdUs > 0 ? RAMP_FADE_ABORT : RAMP_SOFTWARE;
+                rampReset(&ramp[i], target);
+            } else {
+                action = rampStep(&ramp[i], profile, target, dtUs, maxFadeUs,
+                                  &segDuty, &segMs);
+            }
+            if (action == RAMP_FADE_START) {
+                if constexpr (Backend::kHasFade) {
+                    Backend::fade(i, segDuty, segMs);
+                    duty[i] = segDuty;
+                    fades++;
+                    written |= 1 << i;
+                }
+            } else if (action == RAMP_SOFTWARE || action == RAMP_FADE_ABORT) {
+                // После прерванного fade железо где-то посреди участка,
+                // а duty[] — его конец: пишем безусловно
+                uint8_t d = rampDuty(&ramp[i]);
+                if (d != duty[i] || action == RAMP_FADE_ABORT) {
+                    Backend::write(i, d);
+                    duty[i] = d;
+                    writes++;
+                    written |= 1 << i;
+                }
+            }
+        }
+        return written;
+    }
+
+    /**
+     * @brief Сбросить каналы маски в ноль без рампы (задача тика)
+     * @return Маска каналов, в которые записан ноль
+     */
+    uint8_t cut(uint8_t mask) {
+        uint8_t written = 0;
+        for (uint8_t i = 0; i < DRIVE_CHANNELS; i++) {
+            if (!(mask & (1 << i))) continue;
+            bool fading = ramp[i].holdUs > 0;
+            rampReset(&ramp[i], 0);
+            if (duty[i] != 0 || fading) {
+                Backend::write(i, 0);
+                duty[i] = 0;
+                writes++;
+                written |= 1 << i;
+            }
+        }
+        return written;
+    }
+
+    /** @brief Погасить все каналы (любая задача, мимо рампы) */
+    static void stopAll() { Backend::stopAll(); }
+
+    uint8_t  duty[DRIVE_CHANNELS] = {};   // Выход рампы — последнее записанное
+    uint32_t writes = 0;                  // Программных записей скважности
+    uint32_t fades  = 0;                  // Запущенных аппаратных fade'ов
+
+private:
+    RampChannel ramp[DRIVE_CHANNELS];
+};
+
+#endif // DRIVE_OUTPUT_H
@@ -0,0 +1,144 @@
+/**
+ * ============================================================
+ * 🧭 encoder.cpp — Источники импульсов энкодеров колёс
+ * ============================================================
+ *
+ * PCNT:
+ *   Блоки 0-3, считается передний фронт канала 0, фильтр
+ *   дребезга ENCODER_PCNT_FILTER тактов APB. 16-битный счётчик
+ *   сбрасывается в 0 на ENCODER_PCNT_LIMIT — разность за период
+ *   контура (десятки импульсов) восстанавливается по модулю.
+ *
+ * Модель:
+ *   Четыре MotorModel с параметрами SIM_MOTOR_*; шаг — из
+ *   driveTick() с фактической скважностью выхода рампы.
+ *
+ * Все функции чтения/шага вызывает только задача управления.
+ *
+ * Зависимости:
+ *   - driver/pcnt.h — счётчик импульсов (IDF 4.4)
+ *   - wheel_pid.h   — модель мотора
+ *   - config.h      — ENCODER_*, SIM_MOTOR_*
+ *
+ * ============================================================
+ */
+
+#include "encoder.h"
+#include "config.h"
+#include "wheel_pid.h"
+#include <driver/pcnt.h>
+
+// ============================================================
+// PCNT — аппаратные энкодеры
+// ============================================================
+
+// Индексы совпадают с enum Motor: [RL=0, FR=1, FL=2, RR=3]
+static const int8_t encoderPins[MOTOR_COUNT] = {
+    ENCODER_PIN_RL, ENCODER_PIN_FR, ENCODER_PIN_FL, ENCODER_PIN_RR
+};
+static int16_t  pcntLast[MOTOR_COUNT];
+static uint32_t pcntTotal[MOTOR_COUNT];
+
+static bool pcntBegin() {
+    for (int i = 0; i < MOTOR_COUNT; i++) {
+        if (encoderPins[i] < 0) return false;
+    }
+    for (int i = 0; i < MOTOR_COUNT; i++) {
+        pcnt_unit_t unit = (pcnt_unit_t)i;
+        pcnt_config_t cfg = {};
+        cfg.pulse_gpio_num = encoderPins[i];
+        cfg.ctrl_gpio_num  = PCNT_PIN_NOT_USED;
+        cfg.channel        = PCNT_CHANNEL_0;
+        cfg.unit           = unit;
+        cfg.pos_mode       = PCNT_COUNT_INC;
+        cfg.neg_mode       = PCNT_COUNT_DIS;
+        cfg.lctrl_mode     = PCNT_MODE_KEEP;
+        cfg.hctrl_mode     = PCNT_MODE_KEEP;
+        cfg.counter_h_lim  = ENCODER_PCNT_LIMIT;
+        cfg.counter_l_lim  = 0;
+        if (pcnt_unit_config(&cfg) != ESP_OK) return false;
+
+        pcnt_set_filter_value(unit, ENCODER_PCNT_FILTER);
+        pcnt_filter_enable(unit);
+        pcnt_counter_pause(unit);
+        pcnt_counter_clear(unit);
+        pcnt_counter_resume(unit);
+        pcntLast[i] = 0;
+        pcntTotal[i] = 0;
+    }
+    return true;
+}
+
+static void pcntRead(uint32_t counts[MOTOR_COUNT]) {
+    for (int i = 0; i < MOTOR_COUNT; i++) {
+        int16_t now = 0;
+        pcnt_get_counter_value((pcnt_unit_t)i, &now);
+        int32_t delta = now - pcntLast[i];
+        if (delta < 0) delta += ENCODER_PCNT_LIMIT;   // Счётчик сбросился на пределе
+        pcntLast[i] = now;
+        pcntTotal[i] += delta;
+        counts[i] = pcntTotal[i];
+    }
+}
+
+// ============================================================
+// Модель мотора
+// ============================================================
+
+static MotorModel simMotors[MOTOR_COUNT];
+static MotorModelParams simParams = {
+    SIM_MOTOR_GAIN_CPS,
+    SIM_MOTOR_TAU_MS * 1000,
+    SIM_MOTOR_DEADBAND,
+    100
+};
+
+static bool simBegin() {
+    memset(simMotors, 0, sizeof(simMotors));
+    return true;
+}
+
+static void simRead(uint32_t counts[MOTOR_COUNT]) {
+    for (int i = 0; i < MOTOR_COUNT; i++) counts[i] = motorModelCounts(&simMotors[i]);
+}
+
+static void simAdvance(const DriveState& duty, uint32_t dtUs) {
+    for (int i = 0; i < MOTOR_COUNT; i++) motorModelStep(&simMotors[i], simParams, duty.speed[i], dtUs);
+}
+
+void encoderSimSetLoad(uint8_t loadPct) {
+    simParams.loadPct = loadPct;
+}
+
+uint8_t encoderSimGetLoad() {
+    return simParams.loadPct;
+}
+
+// ============================================================
+// Реестр источников
+// ============================================================
+
+static const EncoderSource sources[ENCODER_SRC_COUNT] = {
+    {"off",  NULL,      NULL,     NULL},
+    {"pcnt", pcntBegin, pcntRead, NULL},
+    {"sim",  simBegin,  simRead,  simAdvance},
+};
+
+const EncoderSource* encoderGetSource(EncoderSourceId id) {
+    if (id == ENCODER_SRC_NONE || id >= ENCODER_SRC_COUNT) return NULL;
+    return &sources[id];
+}
+
+const char* encoderSourceName(EncoderSourceId id) {
+    return sources[id < ENCODER_SRC_COUNT ? id : ENCODER_SRC_NONE].name;
+}
+
+bool encoderSourceByName(const char* name, EncoderSourceId* id) {
+    for (int i = 0; i < ENCODER_SRC_COUNT; i++) {
+        if (strcmp(name, sources[i].name) == 0) {
+            *id = (EncoderSourceId)i;
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,60 @@
+/**
+ * ============================================================
+ * 🧭 encoder.h — Источники импульсов энкодеров колёс
+ * ============================================================
+ *
+ * Замкнутый контур скорости (drive.h) читает энкодеры через
+ * таблицу функций EncoderSource — регулятору всё равно, откуда
+ * импульсы:
+ *
+ *   - pcnt — аппаратный счётчик импульсов ESP32 (PCNT), по
+ *            одному блоку на колесо, пины ENCODER_PIN_*
+ *   - sim  — модель мотора первого порядка (wheel_pid.h) по
+ *            фактической скважности: отладка контура без
+ *            энкодеров, нагрузка задаётся encoderSimSetLoad()
+ *
+ * Импульсы — накопленные по модулю 2^32, скорость считает
+ * вызывающий по разности за свой период.
+ *
+ * ============================================================
+ */
+
+#ifndef ENCODER_H
+#define ENCODER_H
+
+#include <Arduino.h>
+#include "drive.h"
+
+// --- Источник (SPEEDCTL_SOURCE в config.h) ---
+enum EncoderSourceId : uint8_t {
+    ENCODER_SRC_NONE = 0,    // Разомкнутый PWM (без контура)
+    ENCODER_SRC_PCNT,        // Аппаратные энкодеры
+    ENCODER_SRC_SIM,         // Модель мотора
+    ENCODER_SRC_COUNT
+};
+
+// --- Таблица функций источника ---
+struct EncoderSource {
+    const char* name;                                         // Имя для API
+    bool (*begin)();                                          // Настроить, false — недоступен
+    void (*read)(uint32_t counts[MOTOR_COUNT]);               // Накопленные импульсы
+    void (*advance)(const DriveState& duty, uint32_t dtUs);   // Шаг объекта (только модель), иначе NULL
+};
+
+/** @brief Источник по идентификатору (NULL для ENCODER_SRC_NONE) */
+const EncoderSource* encoderGetSource(EncoderSourceId id);
+
+/** @brief Имя источника ("off" для ENCODER_SRC_NONE) */
+const char* encoderSourceName(EncoderSourceId id);
+
+/**
+ * @brief Найти источник по имени ("off", "pcnt", "sim")
+ * @return false если имя неизвестно
+ */
+bool encoderSourceByName(const char* name, EncoderSourceId* id);
+
+/** @brief Нагрузка модели, % от номинала (батарея/покрытие) */
+void encoderSimSetLoad(uint8_t loadPct);
+uint8_t encoderSimGetLoad();
+
+#endif // ENCODER_H
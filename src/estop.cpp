@@ -0,0 +1,167 @@
+/**
+ * ============================================================
+ * 🛑 estop.cpp — Приоритетный канал аварийного стопа
+ * ============================================================
+ *
+ * Задача EStop блокируется в recvfrom() на своём сокете. Путь
+ * от пакета до погашенных каналов: стек lwIP → recvfrom() →
+ * проверка magic/cmd → driveEstop() — без httpd, JSON, почтовых
+ * ящиков и тика задачи управления. Приоритет задачи выше
+ * задачи управления: стоп вытесняет её посреди тика (drive.cpp
+ * гасит каналы повторно в конце такого тика).
+ *
+ * Статистику пишут задача EStop и httpd (estopTrigger из
+ * /api/estop) — под estopMux.
+ *
+ * Зависимости:
+ *   - drive.h      — driveEstop(), защёлка
+ *   - lwip/sockets — UDP-сокет
+ *   - config.h     — ESTOP_PORT, ESTOP_TASK_*
+ *
+ * ============================================================
+ */
+
+#include "estop.h"
+#include "drive.h"
+#include "config.h"
+#include "log.h"
+#include <esp_timer.h>
+#include <lwip/sockets.h>
+
+static int estopFd = -1;
+static EstopStats stats = {};
+static portMUX_TYPE estopMux = portMUX_INITIALIZER_UNLOCKED;
+
+static inline uint32_t rd32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+static inline void wr32(uint8_t* p, uint32_t v) {
+    p[0] = v; p[1] = v >> 8; p[2] = v >> 16; p[3] = v >> 24;
+}
+
+/**
+ * Погасить моторы и учесть стоп.
+ * @return Время, когда каналы погашены (esp_timer, мкс)
+ */
+static uint32_t doStop(EstopSource source, uint32_t recvUs) {
+    driveEstop();
+    uint32_t stopUs = (uint32_t)esp_timer_get_time();
+    uint32_t took = stopUs - recvUs;
+
+    portENTER_CRITICAL(&estopMux);
+    bool first = !stats.latched;
+    stats.latched = true;
+    stats.lastSource = source;
+    stats.stops++;
+    stats.lastStopUs = took;
+    if (took > stats.maxStopUs) stats.maxStopUs = took;
+    portEXIT_CRITICAL(&estopMux);
+
+    if (first) LOG_W("🛑 Аварийный стоп (%s), %lu мкс", source == ESTOP_SRC_UDP ? "UDP" : "HTTP",
+                     (unsigned long)took);
+    return stopUs;
+}
+
+void estopTrigger(EstopSource source, uint32_t recvUs) {
+    doStop(source, recvUs ? recvUs : (uint32_t)esp_timer_get_time());
+}
+
+void estopClear() {
+    portENTER_CRITICAL(&estopMux);
+    bool was = stats.latched;
+    stats.latched = false;
+    if (was) stats.clears++;
+    portEXIT_CRITICAL(&estopMux);
+
+    driveEstopClear();
+    if (was) LOG_I("🛑 Аварийный стоп снят");
+}
+
+EstopStats estopGetStats() {
+    portENTER_CRITICAL(&estopMux);
+    EstopStats st = stats;
+    portEXIT_CRITICAL(&estopMux);
+    return st;
+}
+
+/**
+ * FreeRTOS-задача: приём, стоп прямо здесь, затем ответ.
+ */
+static void estopTask(void* pvParameters) {
+    uint8_t buf[ESTOP_REPLY_LEN];
+    struct sockaddr_in from;
+
+    while (true) {
+        socklen_t fromLen = sizeof(from);
+        int n = recvfrom(estopFd, buf, sizeof(buf), 0, (struct sockaddr*)&from, &fromLen);
+        if (n < 0) {
+            vTaskDelay(pdMS_TO_TICKS(10));
+            continue;
+        }
+        uint32_t recvUs = (uint32_t)esp_timer_get_time();
+
+        if (n != ESTOP_PACKET_LEN || buf[0] != ESTOP_MAGIC ||
+            buf[1] < ESTOP_CMD_STOP || buf[1] > ESTOP_CMD_STATUS) {
+            portENTER_CRITICAL(&estopMux);
+            stats.malformed++;
+            portEXIT_CRITICAL(&estopMux);
+            continue;
+        }
+
+        // Сначала стоп — всё остальное потом
+        uint8_t cmd = buf[1];
+        uint32_t stopUs = 0;
+        if (cmd == ESTOP_CMD_STOP) stopUs = doStop(ESTOP_SRC_UDP, recvUs);
+        else if (cmd == ESTOP_CMD_CLEAR) estopClear();
+
+        EstopStats st = estopGetStats();
+        uint32_t nonce = rd32(buf + 4);
+        memset(buf, 0, sizeof(buf));
+        buf[0] = ESTOP_MAGIC;
+        buf[1] = cmd | 0x80;
+        buf[2] = st.latched ? 1 : 0;
+        wr32(buf + 4, nonce);
+        wr32(buf + 8, recvUs);
+        wr32(buf + 12, stopUs);
+        wr32(buf + 16, st.stops);
+        sendto(estopFd, buf, ESTOP_REPLY_LEN, MSG_DONTWAIT, (struct sockaddr*)&from, fromLen);
+    }
+}
+
+bool estopInit() {
+    estopFd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (estopFd < 0) {
+        Serial.println("❌ E-stop: ошибка создания сокета");
+        return false;
+    }
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family      = AF_INET;
+    addr.sin_addr.s_addr = INADDR_ANY;
+    addr.sin_port        = htons(ESTOP_PORT);
+
+    if (bind(estopFd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        Serial.println("❌ E-stop: ошибка bind");
+        close(estopFd);
+        estopFd = -1;
+        return false;
+    }
+
+    BaseType_t res = xTaskCreatePinnedToCore(
+        estopTask,
+        "EStop",
+        3072,
+        NULL,
+        ESTOP_TASK_PRIORITY,
+        NULL,
+        ESTOP_TASK_CORE
+    );
+    if (res != pdPASS) {
+        Serial.println("❌ E-stop: ошибка запуска задачи");
+        return false;
+    }
+
+    Serial.printf("✅ E-stop на UDP-порту %d (приоритет %d)\n", ESTOP_PORT, ESTOP_TASK_PRIORITY);
+    return true;
+}
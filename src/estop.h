@@ -0,0 +1,96 @@
+/**
+ * ============================================================
+ * 🛑 estop.h — Приоритетный канал аварийного стопа
+ * ============================================================
+ *
+ * Обычный стоп — POST /api/control {"type":"stop"}: он ждёт в
+ * очереди httpd за раздачей статики и разбором JSON (а сокетов
+ * всего max_open_sockets = 5). Аварийный стоп идёт мимо:
+ *
+ *   - отдельный UDP-порт ESTOP_PORT, своя задача с приоритетом
+ *     выше задачи управления (ESTOP_TASK_PRIORITY)
+ *   - стоп выполняется прямо в задаче приёма: driveEstop() гасит
+ *     каналы LEDC сразу после recvfrom(), ответ — уже после
+ *   - останов защёлкивается: команды управления отбрасываются,
+ *     миссия прерывается, пока стоп не снят явно (ESTOP_CMD_CLEAR
+ *     или POST /api/estop {"action":"clear"})
+ *
+ * Формат запроса (8 байт, little-endian):
+ *
+ *   off  size  поле
+ *   0    1     magic   'S' (0x53)
+ *   1    1     cmd     EstopCommand
+ *   2    2     —       0
+ *   4    4     nonce   эхом в ответе (сопоставление, RTT)
+ *
+ * Ответ (ESTOP_REPLY_LEN байт) на тот же адрес:
+ *
+ *   0    1     magic   'S'
+ *   1    1     cmd | 0x80
+ *   2    1     latched 1 — стоп защёлкнут
+ *   3    1     —
+ *   4    4     nonce
+ *   8    4     recvUs  пакет принят (esp_timer, мкс)
+ *   12   4     stopUs  каналы погашены (0 — не стоп)
+ *   16   4     stops   всего аварийных стопов
+ *
+ * STOP идемпотентен — клиент может слать его несколько раз
+ * подряд на случай потери пакета.
+ *
+ * Хост-клиент и замер под нагрузкой: tools/estop.js
+ *
+ * ============================================================
+ */
+
+#ifndef ESTOP_H
+#define ESTOP_H
+
+#include <Arduino.h>
+
+#define ESTOP_MAGIC        0x53   // 'S'
+#define ESTOP_PACKET_LEN   8
+#define ESTOP_REPLY_LEN    20
+
+enum EstopCommand : uint8_t {
+    ESTOP_CMD_STOP   = 1,   // Аварийный стоп (защёлка)
+    ESTOP_CMD_CLEAR  = 2,   // Снять защёлку
+    ESTOP_CMD_STATUS = 3    // Только ответ
+};
+
+// --- Откуда пришёл стоп ---
+enum EstopSource : uint8_t {
+    ESTOP_SRC_NONE = 0,
+    ESTOP_SRC_UDP,
+    ESTOP_SRC_HTTP
+};
+
+// --- Статистика ---
+struct EstopStats {
+    bool        latched;
+    EstopSource lastSource;   // Источник последнего стопа
+    uint32_t    stops;        // Аварийных стопов
+    uint32_t    clears;       // Снятий защёлки
+    uint32_t    malformed;    // Битых пакетов
+    uint32_t    lastStopUs;   // Приём → LEDC погашены, последний стоп (мкс)
+    uint32_t    maxStopUs;    // То же, максимум
+};
+
+/**
+ * @brief Запустить задачу приёма на ESTOP_PORT
+ * Вызывать в setup() после подключения WiFi.
+ */
+bool estopInit();
+
+/**
+ * @brief Аварийный стоп из кода (HTTP, кнопки)
+ * @param recvUs Время приёма запроса (для статистики), 0 — сейчас
+ */
+void estopTrigger(EstopSource source, uint32_t recvUs = 0);
+
+/** @brief Снять защёлку аварийного стопа */
+void estopClear();
+
+/** @brief Статистика (копия) */
+EstopStats estopGetStats();
+
+#endif // ESTOP_H
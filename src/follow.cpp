@@ -0,0 +1,240 @@
+/**
+ * ============================================================
+ * 🎯 follow.cpp — Следование за движением
+ * ============================================================
+ *
+ * Задача Vision:
+ *   - followPoll(): включение сбрасывает предыдущий кадр и цель,
+ *     цель не видна дольше FOLLOW_LOST_MS — публикуется стоп
+ *   - followOnFrame(): яркости → motionCentroid() против
+ *     предыдущего кадра → руль → steerBox
+ *
+ * Задача управления забирает руль из steerBox (followTake) и
+ * применяет его тем же applyXY, что и джойстик, — микшер, рампа,
+ * потолок защиты по смене сцены действуют как обычно.
+ *
+ * Буферы кадра (яркости ×2, маска, стек) — в PSRAM, выделяются
+ * при первом кадре и при смене его размера.
+ *
+ * Зависимости:
+ *   - motion_centroid.h — маска и области
+ *   - mailbox.h         — руль Vision → задача управления
+ *   - lease.h           — аренда управления при включении
+ *   - vision.h          — пробуждение задачи при включении
+ *   - config.h          — FOLLOW_*
+ *
+ * ============================================================
+ */
+
+#include "follow.h"
+#include "motion_centroid.h"
+#include "mailbox.h"
+#include "lease.h"
+#include "vision.h"
+#include "config.h"
+#include "log.h"
+#include <atomic>
+#include <esp_heap_caps.h>
+#include <esp_timer.h>
+
+static const MotionParams params = {
+    FOLLOW_PIXEL_DELTA,
+    FOLLOW_MIN_AREA,
+    FOLLOW_MAX_AREA_PCT
+};
+
+static portMUX_TYPE  followMux = portMUX_INITIALIZER_UNLOCKED;
+static FollowStats   stats = {};                         // Под followMux
+static std::atomic<bool>    followEnabled(false);
+static std::atomic<uint8_t> followSpeed(FOLLOW_SPEED);
+static LatestMailbox<FollowSteer> steerBox;              // Vision → задача управления
+
+// --- Только задача Vision ---
+static uint8_t*  cur = NULL;                             // Яркости текущего кадра
+static uint8_t*  prev = NULL;                            // Яркости предыдущего кадра
+static uint8_t*  mask = NULL;
+static uint16_t* stack = NULL;
+static uint32_t  bufPixels = 0;
+static bool      hasPrev = false;
+static uint32_t  prevUs = 0;
+static bool      wasEnabled = false;
+static bool      tracking = false;
+static int64_t   lastSeenUs = 0;
+static int16_t   lastY = 0;
+
+static inline uint32_t ema(uint32_t avg, uint32_t sample) {
+    return avg == 0 ? sample : avg - avg / 8 + sample / 8;
+}
+
+/** Буферы под кадр w × h (PSRAM); false — нет памяти */
+static bool ensureBuffers(uint32_t pixels) {
+    if (pixels == bufPixels && cur) return true;
+    free(cur);
+    free(prev);
+    free(mask);
+    free(stack);
+    cur   = (uint8_t*)heap_caps_malloc(pixels, MALLOC_CAP_SPIRAM);
+    prev  = (uint8_t*)heap_caps_malloc(pixels, MALLOC_CAP_SPIRAM);
+    mask  = (uint8_t*)heap_caps_malloc(pixels, MALLOC_CAP_SPIRAM);
+    stack = (uint16_t*)heap_caps_malloc(pixels * sizeof(uint16_t), MALLOC_CAP_SPIRAM);
+    hasPrev = false;
+    if (cur && prev && mask && stack) {
+        bufPixels = pixels;
+        return true;
+    }
+    free(cur);
+    free(prev);
+    free(mask);
+    free(stack);
+    cur = prev = mask = NULL;
+    stack = NULL;
+    bufPixels = 0;
+    return false;
+}
+
+static void publish(int16_t x, int16_t y, uint32_t frameUs) {
+    steerBox.post({x, y, frameUs});
+    lastY = y;
+
+    uint32_t steerUs = (uint32_t)esp_timer_get_time() - frameUs;
+    portENTER_CRITICAL(&followMux);
+    stats.x = x;
+    stats.y = y;
+    stats.steerUsAvg = ema(stats.steerUsAvg, steerUs);
+    if (steerUs > stats.steerUsMax) stats.steerUsMax = steerUs;
+    portEXIT_CRITICAL(&followMux);
+}
+
+static void setTracking(bool on) {
+    tracking = on;
+    portENTER_CRITICAL(&followMux);
+    stats.tracking = on;
+    portEXIT_CRITICAL(&followMux);
+}
+
+bool followStart(uint8_t speed, uint32_t lease) {
+    if (!leaseCheck(lease)) return false;
+
+    followSpeed.store(speed);
+    followEnabled.store(true);
+    portENTER_CRITICAL(&followMux);
+    stats.enabled = true;
+    stats.speed = speed;
+    portEXIT_CRITICAL(&followMux);
+    LOG_I("🎯 Следование включено (газ %u)", speed);
+    visionWake();
+    return true;
+}
+
+void followStop() {
+    if (!followEnabled.exchange(false)) return;
+    portENTER_CRITICAL(&followMux);
+    stats.enabled = false;
+    portEXIT_CRITICAL(&followMux);
+    LOG_I("🎯 Следование выключено");
+    visionWake();
+}
+
+bool followActive() {
+    return followEnabled.load();
+}
+
+void followPoll(int64_t nowUs) {
+    bool enabled = followEnabled.load();
+    if (enabled != wasEnabled) {
+        wasEnabled = enabled;
+        hasPrev = false;
+        lastY = 0;
+        setTracking(false);
+    }
+    if (!enabled || !tracking) return;
+
+    if (nowUs - lastSeenUs > (int64_t)FOLLOW_LOST_MS * 1000) {
+        setTracking(false);
+        publish(0, 0, (uint32_t)nowUs);
+        portENTER_CRITICAL(&followMux);
+        stats.lost++;
+        portEXIT_CRITICAL(&followMux);
+        LOG_I("🎯 Следование: цель потеряна (%d мс), стоп", FOLLOW_LOST_MS);
+    }
+}
+
+bool followWants() {
+    return followEnabled.load();
+}
+
+void followOnFrame(const uint8_t* rgb, uint16_t w, uint16_t h, uint32_t frameUs) {
+    if (!followEnabled.load()) return;
+    int64_t t0 = esp_timer_get_time();
+
+    uint32_t pixels = (uint32_t)w * h;
+    if (pixels > 0xFFFF || !ensureBuffers(pixels)) return;
+
+    motionLumaRgb565(rgb, w, h, cur);
+    bool fresh = hasPrev && (uint32_t)(frameUs - prevUs) <= (uint32_t)FOLLOW_MAX_GAP_MS * 1000;
+    MotionResult r = {};
+    if (fresh) motionCentroid(cur, prev, w, h, params, mask, stack, &r);
+
+    uint8_t* t = prev;
+    prev = cur;
+    cur = t;
+    hasPrev = true;
+    prevUs = frameUs;
+    if (!fresh) return;                          // Первый кадр после разрыва — только запомнить
+
+    uint32_t analyzeUs = (uint32_t)(esp_timer_get_time() - t0);
+
+    if (r.found) {
+        int32_t x = (int32_t)r.cx * FOLLOW_KP_Q8 / 256;
+        x = constrain(x, -FOLLOW_MAX_TURN, FOLLOW_MAX_TURN);
+        int32_t y = (int32_t)followSpeed.load() * (256 - abs(r.cx)) / 256;
+        lastSeenUs = esp_timer_get_time();
+        if (!tracking) setTracking(true);
+        publish((int16_t)x, (int16_t)y, frameUs);
+    } else if (r.global && tracking) {
+        publish(0, lastY, frameUs);              // Кадр «плывёт» — перестать поворачивать
+    }
+
+    portENTER_CRITICAL(&followMux);
+    stats.frames++;
+    if (r.found) {
+        stats.found++;
+        stats.cx = r.cx;
+        stats.cy = r.cy;
+        stats.area = r.area;
+    }
+    if (r.global) stats.global++;
+    stats.analyzeUsAvg = ema(stats.analyzeUsAvg, analyzeUs);
+    if (analyzeUs > stats.analyzeUsMax) stats.analyzeUsMax = analyzeUs;
+    portEXIT_CRITICAL(&followMux);
+}
+
+bool followTake(FollowSteer* out) {
+    return steerBox.take(out);
+}
+
+void followApplied(const FollowSteer& s, uint32_t nowUs) {
+    uint32_t loopUs = nowUs - s.frameUs;
+    portENTER_CRITICAL(&followMux);
+    stats.applied++;
+    stats.loopUsLast = loopUs;
+    stats.loopUsAvg = ema(stats.loopUsAvg, loopUs);
+    if (loopUs > stats.loopUsMax) stats.loopUsMax = loopUs;
+    portEXIT_CRITICAL(&followMux);
+}
+
+void followOverride() {
+    if (!followEnabled.exchange(false)) return;
+    portENTER_CRITICAL(&followMux);
+    stats.enabled = false;
+    stats.overrides++;
+    portEXIT_CRITICAL(&followMux);
+    LOG_I("🎯 Следование прервано ручной командой");
+}
+
+FollowStats followGetStats() {
+    portENTER_CRITICAL(&followMux);
+    FollowStats st = stats;
+    portEXIT_CRITICAL(&followMux);
+    return st;
+}
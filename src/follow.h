@@ -0,0 +1,115 @@
+/**
+ * ============================================================
+ * 🎯 follow.h — Следование за движением (замкнуто на устройстве)
+ * ============================================================
+ *
+ * В браузере MotionDetector уже считает centerOfMass, но руль по
+ * нему шёл бы через сеть: кадр → клиент → команда → ровер, и
+ * задержка цикла — это Wi-Fi в обе стороны. Здесь цикл целиком
+ * на устройстве и ограничен периодом кадра камеры:
+ *
+ *   снимок → Vision (1/8, vision.h) → центр крупнейшей движущейся
+ *   области (motion_centroid.h) → руль X/Y → LatestMailbox →
+ *   тик управления → skid-steer микшер (mixer.h) → рампа → моторы
+ *
+ * Руль:
+ *   X = cx × FOLLOW_KP_Q8 / 256, не больше ±FOLLOW_MAX_TURN
+ *   Y = speed × (1 − |cx|) — вперёд тем медленнее, чем дальше
+ *       цель от центра (speed по умолчанию FOLLOW_SPEED)
+ *
+ * Кадры, где движется почти всё (поворот самого ровера), цель не
+ * дают — руль X обнуляется, пока картинка не успокоится. Нет цели
+ * дольше FOLLOW_LOST_MS — стоп; режим остаётся включённым и
+ * поедет, как только цель снова появится.
+ *
+ * При speed > 0 кадр «течёт» на ходу так же, как при повороте, —
+ * детектор разностей кадров видит цель в основном стоя. Поэтому
+ * FOLLOW_SPEED = 0: ровер разворачивается к цели на месте.
+ *
+ * Режим прерывают: любая ручная команда, дошедшая до задачи
+ * управления, запуск миссии, аварийный стоп, followStop().
+ * Watchdog CONTROL_TIMEOUT_MS продлевает каждая применённая
+ * команда руля — если Vision встанет, ровер остановится.
+ *
+ * Тайминг цикла (followGetStats, /api/follow, телеметрия):
+ *   analyzeUs — яркость + маска + области
+ *   steerUs   — снимок кадра → руль опубликован
+ *   loopUs    — снимок кадра → руль применён задачей управления
+ *
+ * ============================================================
+ */
+
+#ifndef FOLLOW_H
+#define FOLLOW_H
+
+#include <Arduino.h>
+
+// --- Команда руля (Vision → задача управления) ---
+struct FollowSteer {
+    int16_t  x, y;            // Оси как у controlSetXY (0/0 — стоп)
+    uint32_t frameUs;         // Время снимка кадра (esp_timer)
+};
+
+// --- Статистика ---
+struct FollowStats {
+    bool     enabled;
+    bool     tracking;        // Цель видна (не дольше FOLLOW_LOST_MS назад)
+    uint8_t  speed;           // Газ при цели в центре
+    int16_t  cx, cy;          // Центр цели, последний кадр с целью (−256..256)
+    uint16_t area;            // Площадь цели (пикселей кадра 1/8)
+    int16_t  x, y;            // Последний опубликованный руль
+    uint32_t frames;          // Проанализировано кадров
+    uint32_t found;           // Кадров с целью
+    uint32_t global;          // Кадров «движется всё»
+    uint32_t lost;            // Потерь цели (стоп)
+    uint32_t applied;         // Команд руля применено
+    uint32_t overrides;       // Прерываний ручной командой / миссией / e-stop
+    uint32_t analyzeUsAvg;    // Яркость + маска + области (мкс, EMA)
+    uint32_t analyzeUsMax;
+    uint32_t steerUsAvg;      // Снимок → руль опубликован (мкс, EMA)
+    uint32_t steerUsMax;
+    uint32_t loopUsLast;      // Снимок → руль применён (мкс)
+    uint32_t loopUsAvg;
+    uint32_t loopUsMax;
+};
+
+/**
+ * @brief Включить следование
+ * @param speed Газ при цели в центре (0 — только поворот на месте)
+ * @param lease Токен аренды управления (lease.h)
+ * @return false — отклонено арендой
+ */
+bool followStart(uint8_t speed, uint32_t lease = 0);
+
+/** @brief Выключить следование (моторы останавливает задача управления) */
+void followStop();
+
+/** @brief Режим включён */
+bool followActive();
+
+// --- Потребитель Vision (вызываются только из задачи Vision) ---
+
+/** @brief Включение/выключение, потеря цели по таймауту */
+void followPoll(int64_t nowUs);
+
+/** @brief Режим включён — нужны кадры */
+bool followWants();
+
+/** @brief Кадр 1/8 RGB565; frameUs — время снимка (esp_timer) */
+void followOnFrame(const uint8_t* rgb, uint16_t w, uint16_t h, uint32_t frameUs);
+
+// --- Задача управления ---
+
+/** @brief Забрать последний руль (только задача управления) */
+bool followTake(FollowSteer* out);
+
+/** @brief Руль применён в nowUs — учесть задержку цикла */
+void followApplied(const FollowSteer& s, uint32_t nowUs);
+
+/** @brief Ручная команда / миссия / e-stop — выключить режим */
+void followOverride();
+
+/** @brief Статистика (копия) */
+FollowStats followGetStats();
+
+#endif // FOLLOW_H
@@ -0,0 +1,137 @@
+/**
+ * ============================================================
+ * 📶 jitter_buffer.cpp — Джиттер-буфер команд джойстика (X/Y)
+ * ============================================================
+ *
+ * Все метки — мкс по модулю 2^32, сравнения только через
+ * знаковую разность ((int32_t)(a − b)), переполнение не страшно.
+ *
+ * ============================================================
+ */
+
+#include "jitter_buffer.h"
+
+// Скачок offset больше секунды — клиент перезапущен или сменился
+#define JITTER_RESYNC_US   1000000
+// Подтекание offset вверх: 1/16384 прошедшего времени (~61 ppm)
+#define JITTER_LEAK_SHIFT  14
+
+void jitterReset(JitterBuffer* b) {
+    JitterStats stats = b->stats;
+    *b = JitterBuffer{};
+    b->stats = stats;
+}
+
+/** Проиграть старейшую ожидающую команду: она становится last */
+static void playHead(JitterBuffer* b) {
+    b->last = b->q[0];
+    b->hasLast = true;
+    b->count--;
+    for (uint8_t i = 0; i < b->count; i++) b->q[i] = b->q[i + 1];
+}
+
+bool jitterPush(JitterBuffer* b, uint32_t senderUs, uint32_t localUs, int16_t x, int16_t y) {
+    uint32_t offset = localUs - senderUs;
+    if (b->synced) {
+        int32_t jump = (int32_t)(offset - b->offsetUs);
+        if (jump > JITTER_RESYNC_US || jump < -JITTER_RESYNC_US) {
+            jitterReset(b);
+            b->stats.resyncs++;
+        }
+    }
+
+    // Оценка offset: минимум с медленным подтеканием вверх
+    if (!b->synced) {
+        b->offsetUs = offset;
+        b->synced = true;
+    } else {
+        b->offsetUs += (localUs - b->offsetLocalUs) >> JITTER_LEAK_SHIFT;
+        if ((int32_t)(offset - b->offsetUs) < 0) b->offsetUs = offset;
+    }
+    b->offsetLocalUs = localUs;
+
+    // Старше уже проигранной — поздно
+    if (b->hasLast && (int32_t)(senderUs - b->last.senderUs) <= 0) {
+        b->stats.late++;
+        return false;
+    }
+
+    // Вставка по метке отправителя (повтор метки — замена)
+    uint8_t pos = b->count;
+    while (pos > 0 && (int32_t)(senderUs - b->q[pos - 1].senderUs) < 0) pos--;
+    if (pos > 0 && b->q[pos - 1].senderUs == senderUs) {
+        b->q[pos - 1].x = x;
+        b->q[pos - 1].y = y;
+        b->stats.pushed++;
+        return true;
+    }
+    if (pos < b->count) b->stats.reordered++;
+    if (b->count == JITTER_DEPTH) {
+        if (pos == 0) {              // Старше всех ожидающих при полном буфере
+            b->stats.late++;
+            return false;
+        }
+        playHead(b);
+        pos--;
+        b->stats.overflow++;
+    }
+    for (uint8_t i = b->count; i > pos; i--) b->q[i] = b->q[i - 1];
+    b->q[pos] = JitterSample{senderUs, x, y};
+    b->count++;
+    b->stats.pushed++;
+    return true;
+}
+
+JitterStage jitterSample(JitterBuffer* b, const JitterParams& p, uint32_t nowUs,
+                         int16_t* x, int16_t* y) {
+    if (!b->synced) return b->stage = JITTER_IDLE;
+
+    // Текущий момент проигрывания в часах отправителя
+    uint32_t playUs = nowUs - b->offsetUs - p.delayUs;
+    while (b->count > 0 && (int32_t)(b->q[0].senderUs - playUs) <= 0) playHead(b);
+    if (!b->hasLast) return b->stage = JITTER_IDLE;   // Первая команда ещё не наступила
+
+    const JitterSample& last = b->last;
+
+    // Есть следующая — интерполяция last → q[0]
+    if (b->count > 0) {
+        const JitterSample& next = b->q[0];
+        int32_t span = (int32_t)(next.senderUs - last.senderUs);
+        int32_t pos = (int32_t)(playUs - last.senderUs);
+        *x = (int16_t)(last.x + (int64_t)(next.x - last.x) * pos / span);
+        *y = (int16_t)(last.y + (int64_t)(next.y - last.y) * pos / span);
+        return b->stage = JITTER_PLAY;
+    }
+
+    // Разрыв: последняя команда держится (без наклона — клиент шлёт
+    // только изменения, и конец движения стика неотличим от потери)
+    uint32_t age = playUs - last.senderUs;
+    int32_t exX = last.x, exY = last.y;
+
+    JitterStage stage;
+    if (age < p.graceUs) {
+        stage = JITTER_EXTRAPOLATE;
+        b->stats.extrapolated++;
+    } else if (age < p.holdUs) {
+        stage = JITTER_HOLD;
+        b->stats.held++;
+    } else if (age < p.holdUs + p.decayUs) {
+        uint32_t left = p.holdUs + p.decayUs - age;
+        exX = (int64_t)exX * left / p.decayUs;
+        exY = (int64_t)exY * left / p.decayUs;
+        stage = JITTER_DECAY;
+        b->stats.decayed++;
+    } else {
+        jitterReset(b);
+        b->stats.stops++;
+        return b->stage = JITTER_STOP;
+    }
+    *x = (int16_t)exX;
+    *y = (int16_t)exY;
+    return b->stage = stage;
+}
+
+const char* jitterStageName(JitterStage stage) {
+    static const char* const names[] = {"idle", "play", "extrapolate", "hold", "decay", "stop"};
+    return stage <= JITTER_STOP ? names[stage] : "?";
+}
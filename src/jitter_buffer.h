@@ -0,0 +1,116 @@
+/**
+ * ============================================================
+ * 📶 jitter_buffer.h — Джиттер-буфер команд джойстика (X/Y)
+ * ============================================================
+ *
+ * Wi-Fi доставляет команды пачками и с разрывами: без буфера
+ * моторы получают ступеньки, а при потере связи ровер едет
+ * со старой командой до жёсткого стопа watchdog'а.
+ *
+ * Буфер проигрывает команды по времени ОТПРАВИТЕЛЯ (метка
+ * клиента, мкс по модулю 2^32) с постоянной задержкой delay:
+ *
+ *   play = now − offset − delay        (часы отправителя)
+ *   offset = min(приём − отправка)     — самый быстрый пакет;
+ *            медленно «подтекает» вверх (~61 ppm) вслед за
+ *            уходом кварцев клиента и устройства
+ *
+ * Пакеты, задержанные сетью меньше чем на delay, встают на
+ * своё место (в том числе переупорядоченные), между соседними
+ * командами выход интерполируется линейно. Команда старше уже
+ * проигранной отбрасывается (late).
+ *
+ * Когда команды кончились, выход деградирует по стадиям
+ * (возраст — play минус метка последней команды):
+ *
+ *   < grace         EXTRAPOLATE — последняя команда как свежая
+ *                   (обычная пауза между командами потока)
+ *   < hold          HOLD  — удержание, связь под подозрением
+ *   < hold + decay  DECAY — линейный спад к нулю
+ *   дальше          STOP  — один раз, затем IDLE до новой команды
+ *
+ * Модуль не зависит от Arduino/IDF — считается одинаково
+ * на устройстве и на хосте.
+ *
+ * ============================================================
+ */
+
+#ifndef JITTER_BUFFER_H
+#define JITTER_BUFFER_H
+
+#include <stdint.h>
+
+#define JITTER_DEPTH 8   // Ожидающих проигрывания команд (больше — старейшая проигрывается сразу)
+
+// --- Параметры (мкс) ---
+struct JitterParams {
+    uint32_t delayUs;    // Задержка проигрывания
+    uint32_t graceUs;    // Продолжение последней команды без деградации
+    uint32_t holdUs;     // Конец удержания (от последней команды)
+    uint32_t decayUs;    // Длительность спада к нулю после hold
+};
+
+// --- Стадия выхода ---
+enum JitterStage : uint8_t {
+    JITTER_IDLE = 0,     // Нечего проигрывать (выход не трогать)
+    JITTER_PLAY,         // Интерполяция между командами
+    JITTER_EXTRAPOLATE,  // Разрыв в пределах grace
+    JITTER_HOLD,         // Удержание
+    JITTER_DECAY,        // Спад к нулю
+    JITTER_STOP          // Команд нет — остановить (один раз)
+};
+
+// --- Счётчики ---
+struct JitterStats {
+    uint32_t pushed;      // Принято команд
+    uint32_t late;        // Отброшено: старше уже проигранной
+    uint32_t reordered;   // Вставлено не в конец (пришли не по порядку)
+    uint32_t overflow;    // Проиграно досрочно (буфер полон)
+    uint32_t resyncs;     // Пересинхронизаций часов отправителя
+    uint32_t extrapolated;// Тиков в стадии EXTRAPOLATE
+    uint32_t held;        // Тиков в HOLD
+    uint32_t decayed;     // Тиков в DECAY
+    uint32_t stops;       // Остановок по истечении спада
+};
+
+struct JitterSample {
+    uint32_t senderUs;   // Метка отправителя
+    int16_t  x;
+    int16_t  y;
+};
+
+// --- Состояние буфера ---
+struct JitterBuffer {
+    JitterSample q[JITTER_DEPTH];  // Ожидающие, по возрастанию senderUs
+    uint8_t      count;
+    JitterSample last;             // Последняя проигранная
+    bool         hasLast;
+    bool         synced;           // offset оценён
+    uint32_t     offsetUs;         // Приём − отправка (мин., по модулю 2^32)
+    uint32_t     offsetLocalUs;    // Время последнего обновления offset
+    JitterStage  stage;            // Стадия последнего jitterSample()
+    JitterStats  stats;
+};
+
+/** @brief Сбросить буфер (счётчики сохраняются) */
+void jitterReset(JitterBuffer* b);
+
+/**
+ * @brief Положить команду
+ * @param senderUs Метка отправителя (мкс)
+ * @param localUs  Время приёма на устройстве (мкс)
+ * @return false — отброшена как опоздавшая
+ */
+bool jitterPush(JitterBuffer* b, uint32_t senderUs, uint32_t localUs, int16_t x, int16_t y);
+
+/**
+ * @brief Выход на момент nowUs (вызывать каждый тик)
+ * @param x, y Значения для применения (кроме IDLE/STOP)
+ */
+JitterStage jitterSample(JitterBuffer* b, const JitterParams& p, uint32_t nowUs,
+                         int16_t* x, int16_t* y);
+
+/** @brief Имя стадии для API ("idle", "play", ...) */
+const char* jitterStageName(JitterStage stage);
+
+#endif // JITTER_BUFFER_H
@@ -0,0 +1,110 @@
+/**
+ * ============================================================
+ * 🧩 jpeg_util.cpp — Разбор структуры JPEG-кадров OV2640
+ * ============================================================
+ *
+ * Проходит по маркерам JPEG от SOI до SOS:
+ *   - DQT  (FFDB) — таблицы квантования (8 бит, до 2 штук)
+ *   - SOF0 (FFC0) — размеры и субдискретизация яркости
+ *   - DRI  (FFDD) — restart-интервалы (не поддерживаются)
+ *   - SOS  (FFDA) — за ним начинаются scan-данные
+ *
+ * Конец scan-данных — последний маркер EOI (FFD9). Буфер
+ * OV2640 может содержать выравнивающие нули после EOI,
+ * поэтому EOI ищется с конца.
+ *
+ * ============================================================
+ */
+
+#include "jpeg_util.h"
+
+// Чтение 16-битного big-endian значения
+static inline uint16_t readBe16(const uint8_t* p) {
+    return ((uint16_t)p[0] << 8) | p[1];
+}
+
+bool jpegParse(const uint8_t* buf, size_t len, JpegInfo* info) {
+    if (!buf || !info || len < 4) return false;
+    if (buf[0] != 0xFF || buf[1] != 0xD8) return false;  // Нет SOI
+
+    memset(info, 0, sizeof(*info));
+    bool haveSof = false;
+    size_t i = 2;
+
+    while (i + 4 <= len) {
+        if (buf[i] != 0xFF) return false;
+        uint8_t marker = buf[i + 1];
+
+        // Fill-байты 0xFF перед маркером
+        if (marker == 0xFF) { i++; continue; }
+
+        uint16_t segLen = readBe16(buf + i + 2);
+        if (segLen < 2 || i + 2 + segLen > len) return false;
+        const uint8_t* seg = buf + i + 4;
+        size_t dataLen = segLen - 2;
+
+        switch (marker) {
+            case 0xDB: {  // DQT — одна или несколько таблиц
+                size_t p = 0;
+                while (p < dataLen) {
+                    uint8_t pq = seg[p] >> 4;
+                    uint8_t tq = seg[p] & 0x0F;
+                    if (pq != 0 || tq > 1 || p + 65 > dataLen) return false;
+                    info->qtables[tq] = seg + p + 1;
+                    if (tq + 1 > info->qtableCount) info->qtableCount = tq + 1;
+                    p += 65;
+                }
+                break;
+            }
+
+            case 0xC0: {  // SOF0 — baseline
+                if (dataLen < 15 || seg[5] != 3) return false;
+                info->height = readBe16(seg + 1);
+                info->width  = readBe16(seg + 3);
+                uint8_t ySampling = seg[7];
+                if (ySampling == 0x21)      info->rtpType = 0;  // 4:2:2
+                else if (ySampling == 0x22) info->rtpType = 1;  // 4:2:0
+                else return false;
+                haveSof = true;
+                break;
+            }
+
+            case 0xC1: case 0xC2: case 0xC3:
+            case 0xDD:    // Progressive / lossless / restart-интервалы
+                return false;
+
+            case 0xDA: {  // SOS — дальше scan-данные
+                if (!haveSof || info->qtableCount == 0) return false;
+                for (uint8_t t = 0; t < info->qtableCount; t++) {
+                    if (!info->qtables[t]) return false;
+                }
+                info->headerLen = i + 2 + segLen;
+
+                size_t end = len;
+                while (end >= info->headerLen + 2) {
+                    if (buf[end - 2] == 0xFF && buf[end - 1] == 0xD9) break;
+                    end--;
+                }
+                if (end < info->headerLen + 2) return false;  // Нет EOI
+                info->scanLen = end - 2 - info->headerLen;
+                return true;
+            }
+
+            default:      // APPn, COM, DHT — пропускаем
+                break;
+        }
+
+        i += 2 + segLen;
+    }
+
+    return false;
+}
+
+uint32_t jpegHash(const uint8_t* data, size_t len) {
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        h ^= data[i];
+        h *= 16777619u;
+    }
+    return h;
+}
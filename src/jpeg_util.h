@@ -0,0 +1,52 @@
+/**
+ * ============================================================
+ * 🧩 jpeg_util.h — Разбор структуры JPEG-кадров OV2640
+ * ============================================================
+ *
+ * Лёгкий парсер маркеров JPEG (без декодирования пикселей).
+ * Находит таблицы квантования, размеры кадра и границу
+ * между заголовком и entropy-coded данными скана.
+ *
+ * Используется:
+ *   - RTP-стримом (RFC 2435) — нужны Q-таблицы и scan-данные
+ *   - Сокращённым MJPEG-стримом — заголовок отправляется один раз
+ *
+ * ============================================================
+ */
+
+#ifndef JPEG_UTIL_H
+#define JPEG_UTIL_H
+
+#include <Arduino.h>
+
+// --- Результат разбора JPEG-кадра ---
+struct JpegInfo {
+    uint16_t width;              // Ширина кадра (px)
+    uint16_t height;             // Высота кадра (px)
+    uint8_t  rtpType;            // Тип по RFC 2435: 0 = 4:2:2, 1 = 4:2:0
+    uint8_t  qtableCount;        // Кол-во 8-битных таблиц квантования (1-2)
+    const uint8_t* qtables[2];   // Указатели на таблицы (64 байта, zigzag) внутри буфера
+    size_t   headerLen;          // Смещение начала scan-данных (всё до него — заголовок)
+    size_t   scanLen;            // Длина scan-данных без завершающего EOI
+};
+
+/**
+ * @brief Разобрать заголовок baseline JPEG
+ *
+ * Поддерживаются кадры OV2640: SOF0, 3 компоненты, 8-битные
+ * таблицы квантования, без restart-маркеров (DRI).
+ *
+ * @param buf  Буфер JPEG (начинается с SOI)
+ * @param len  Размер буфера (байт)
+ * @param info Заполняемая структура
+ * @return true — кадр разобран, false — формат не поддерживается
+ */
+bool jpegParse(const uint8_t* buf, size_t len, JpegInfo* info);
+
+/**
+ * @brief FNV-1a хэш блока данных
+ * Используется для обнаружения смены заголовка JPEG (качество, размер).
+ */
+uint32_t jpegHash(const uint8_t* data, size_t len);
+
+#endif // JPEG_UTIL_H
@@ -0,0 +1,115 @@
+/**
+ * ============================================================
+ * 🔑 lease.cpp — Аренда управления (арбитраж пультов)
+ * ============================================================
+ *
+ * Одна аренда на ровер: токен (esp_random, ≠ 0), приоритет,
+ * TTL и момент истечения в millis(). Проверяют её задачи
+ * источников (httpd, UdpControl) до публикации команды —
+ * отклонённая команда не попадает в почтовый ящик и не
+ * вытесняет команду держателя того же источника.
+ *
+ * Истечение ленивое: аренда считается свободной, как только
+ * millis() прошёл срок, и сбрасывается при первом обращении.
+ *
+ * Зависимости:
+ *   - config.h — LEASE_REQUIRED, LEASE_TTL_*
+ *
+ * ============================================================
+ */
+
+#include "lease.h"
+#include "config.h"
+#include "log.h"
+#include <esp_system.h>
+
+static uint32_t     leaseToken = 0;           // 0 — аренды нет
+static uint8_t      leasePriority = 0;
+static uint32_t     leaseTtlMs = 0;
+static uint32_t     leaseExpiresMs = 0;
+static char         leaseOwner[LEASE_OWNER_MAX] = "";
+static LeaseInfo    counters = {};            // Только счётчики
+static portMUX_TYPE leaseMux = portMUX_INITIALIZER_UNLOCKED;
+
+/**
+ * Действует ли аренда; истёкшая сбрасывается (под leaseMux).
+ */
+static bool leaseHeldLocked(uint32_t nowMs) {
+    if (leaseToken == 0) return false;
+    if ((int32_t)(leaseExpiresMs - nowMs) > 0) return true;
+    leaseToken = 0;
+    counters.expired++;
+    return false;
+}
+
+LeaseResult leaseAcquire(uint8_t priority, uint32_t ttlMs, const char* owner, uint32_t* token) {
+    ttlMs = constrain(ttlMs, (uint32_t)LEASE_TTL_MIN_MS, (uint32_t)LEASE_TTL_MAX_MS);
+    uint32_t fresh = esp_random() | 1;   // Токен новой аренды (≠ 0)
+    LeaseResult result;
+
+    portENTER_CRITICAL(&leaseMux);
+    uint32_t now = millis();
+    bool held = leaseHeldLocked(now);
+
+    if (held && *token == leaseToken) {
+        result = LEASE_RENEWED;
+    } else if (held && priority <= leasePriority) {
+        result = LEASE_DENIED;
+    } else {
+        if (held) counters.preempted++;
+        counters.granted++;
+        leaseToken = fresh;
+        result = LEASE_GRANTED;
+    }
+
+    if (result != LEASE_DENIED) {
+        leasePriority = priority;
+        leaseTtlMs = ttlMs;
+        leaseExpiresMs = now + ttlMs;
+        strlcpy(leaseOwner, owner ? owner : "", sizeof(leaseOwner));
+        *token = leaseToken;
+    }
+    portEXIT_CRITICAL(&leaseMux);
+
+    if (result == LEASE_GRANTED) {
+        LOG_I("🔑 Аренда: %s, приоритет %u, TTL %lu мс",
+              owner ? owner : "?", priority, (unsigned long)ttlMs);
+    }
+    return result;
+}
+
+bool leaseRelease(uint32_t token) {
+    portENTER_CRITICAL(&leaseMux);
+    bool ok = token != 0 && token == leaseToken;
+    if (ok) leaseToken = 0;
+    portEXIT_CRITICAL(&leaseMux);
+    return ok;
+}
+
+bool leaseCheck(uint32_t token) {
+    portENTER_CRITICAL(&leaseMux);
+    uint32_t now = millis();
+    bool ok;
+    if (leaseHeldLocked(now)) {
+        ok = (token == leaseToken);
+        if (ok) leaseExpiresMs = now + leaseTtlMs;
+    } else {
+        ok = !LEASE_REQUIRED;
+    }
+    if (!ok) counters.rejected++;
+    portEXIT_CRITICAL(&leaseMux);
+    return ok;
+}
+
+LeaseInfo leaseGetInfo() {
+    portENTER_CRITICAL(&leaseMux);
+    uint32_t now = millis();
+    LeaseInfo info = counters;
+    info.held = leaseHeldLocked(now);
+    info.priority = info.held ? leasePriority : 0;
+    info.ttlMs = info.held ? leaseTtlMs : 0;
+    info.remainingMs = info.held ? leaseExpiresMs - now : 0;
+    strlcpy(info.owner, info.held ? leaseOwner : "", sizeof(info.owner));
+    portEXIT_CRITICAL(&leaseMux);
+    return info;
+}
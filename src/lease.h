@@ -0,0 +1,82 @@
+/**
+ * ============================================================
+ * 🔑 lease.h — Аренда управления (арбитраж пультов)
+ * ============================================================
+ *
+ * Управлять может любой клиент, и без арбитража побеждает
+ * последний писавший: забытая вкладка браузера дерётся с
+ * пилотом и заодно держит watchdog живым. Аренда решает это:
+ *
+ *   - клиент берёт аренду с приоритетом и временем жизни (TTL)
+ *     и получает токен; команды несут токен
+ *   - пока аренда действует, до микшера доходят только команды
+ *     с её токеном (остальные — отказ, watchdog не сбрасывают)
+ *   - каждая принятая команда держателя продлевает аренду на TTL
+ *   - более высокий приоритет вытесняет держателя, равный — нет
+ *   - стоп (controlStop, стоп миссии/следования/проигрывателя
+ *     форм) принимается от любого клиента: остановить ровер —
+ *     не значит драться с пилотом. Токен стопа не проверяется и
+ *     аренду держателя не продлевает
+ *   - без действующей аренды команды без токена принимаются,
+ *     если LEASE_REQUIRED == 0 (совместимость со старыми клиентами)
+ *
+ * leaseCheck() — горячий путь каждой команды: сравнение токена
+ * и срока в короткой критической секции, O(1).
+ *
+ * Воспроизведение журнала (CTRL_SRC_REPLAY) — обычный клиент:
+ * токен проверяется при запуске в /api/recorder, каждая команда
+ * прогона несёт его же.
+ *
+ * ============================================================
+ */
+
+#ifndef LEASE_H
+#define LEASE_H
+
+#include <Arduino.h>
+
+#define LEASE_OWNER_MAX 16   // Имя держателя (с '\0')
+
+// --- Результат запроса аренды ---
+enum LeaseResult : uint8_t {
+    LEASE_GRANTED = 0,   // Выдана (была свободна или вытеснена)
+    LEASE_RENEWED,       // Продлена (токен совпал)
+    LEASE_DENIED         // Занята держателем с приоритетом не ниже
+};
+
+// --- Состояние аренды и счётчики ---
+struct LeaseInfo {
+    bool     held;                     // Аренда действует
+    uint8_t  priority;                 // Приоритет держателя
+    uint32_t ttlMs;                    // TTL держателя
+    uint32_t remainingMs;              // Осталось до истечения
+    char     owner[LEASE_OWNER_MAX];   // Имя держателя
+    uint32_t granted;                  // Выдано аренд
+    uint32_t preempted;                // Из них с вытеснением держателя
+    uint32_t expired;                  // Истекло без продления
+    uint32_t rejected;                 // Отклонено команд чужих клиентов
+};
+
+/**
+ * @brief Взять (или продлить своей) аренду
+ * @param priority Приоритет 0-255 (больше — главнее)
+ * @param ttlMs    Время жизни без команд (ограничивается LEASE_TTL_MIN/MAX_MS)
+ * @param owner    Имя держателя (для /api/lease), может быть NULL
+ * @param token    Вход: текущий токен клиента (0 — нет); выход: токен аренды
+ */
+LeaseResult leaseAcquire(uint8_t priority, uint32_t ttlMs, const char* owner, uint32_t* token);
+
+/** @brief Вернуть аренду досрочно. @return false если токен не держателя */
+bool leaseRelease(uint32_t token);
+
+/**
+ * @brief Проверить токен команды (горячий путь, O(1))
+ * Принятая команда держателя продлевает аренду на её TTL.
+ * @return true — команду можно применять
+ */
+bool leaseCheck(uint32_t token);
+
+/** @brief Состояние аренды */
+LeaseInfo leaseGetInfo();
+
+#endif // LEASE_H
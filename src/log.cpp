@@ -0,0 +1,122 @@
+/**
+ * ============================================================
+ * 📝 log.cpp — Асинхронный лог с уровнями
+ * ============================================================
+ *
+ * Строки копятся в LogRing (log_ring.h — MPSC-очередь без
+ * блокировок): форматирование идёт в задаче-вызывающем прямо
+ * в слот кольца, ожидание вывода — только в задаче Log.
+ *
+ * Зависимости:
+ *   - log_ring.h    — кольцо строк
+ *   - config.h      — LOG_RING_SLOTS, LOG_LINE_MAX, LOG_UDP_PORT, LOG_TASK_*
+ *   - lwip/sockets  — UDP-broadcast строк (если LOG_UDP_PORT ≠ 0)
+ *
+ * ============================================================
+ */
+
+#include "log.h"
+#include "log_ring.h"
+#include <stdarg.h>
+#include <lwip/sockets.h>
+
+typedef LogRing<LOG_RING_SLOTS, LOG_LINE_MAX> LogRingT;
+
+static LogRingT     logRing;
+static TaskHandle_t logTask = NULL;
+
+void logWrite(char level, const char* fmt, ...) {
+    // --- Занять позицию ---
+    uint32_t pos = 0;
+    LogRingT::Slot* slot = logRing.claim(&pos);
+    if (!slot) return;                                  // Кольцо заполнено
+
+    // --- Форматировать прямо в слот ---
+    unsigned long ms = millis();
+    int n = snprintf(slot->text, LOG_LINE_MAX, "[%lu.%03lu] %c ", ms / 1000, ms % 1000, level);
+    va_list args;
+    va_start(args, fmt);
+    int m = vsnprintf(slot->text + n, LOG_LINE_MAX - n, fmt, args);
+    va_end(args);
+    if (m < 0) m = 0;
+    n = (n + m < LOG_LINE_MAX - 1) ? n + m : LOG_LINE_MAX - 2;  // Обрезка длинной строки
+    slot->text[n++] = '\n';
+    slot->len = n;
+
+    logRing.publish(slot, pos);
+    if (logTask) xTaskNotifyGive(logTask);
+}
+
+/**
+ * Вывести строку во все приёмники.
+ */
+static void logEmit(int udpFd, const struct sockaddr_in* dest, const char* text, size_t len) {
+    Serial.write((const uint8_t*)text, len);
+    if (udpFd >= 0) {
+        sendto(udpFd, text, len, MSG_DONTWAIT, (const struct sockaddr*)dest, sizeof(*dest));
+    }
+}
+
+/**
+ * FreeRTOS-задача: вычерпывает кольцо в Serial/UDP.
+ */
+static void logTaskLoop(void* pvParameters) {
+    int udpFd = -1;
+    struct sockaddr_in dest;
+    memset(&dest, 0, sizeof(dest));
+    if (LOG_UDP_PORT != 0) {
+        udpFd = socket(AF_INET, SOCK_DGRAM, 0);
+        int on = 1;
+        setsockopt(udpFd, SOL_SOCKET, SO_BROADCAST, &on, sizeof(on));
+        dest.sin_family      = AF_INET;
+        dest.sin_port        = htons(LOG_UDP_PORT);
+        dest.sin_addr.s_addr = INADDR_BROADCAST;
+    }
+
+    uint32_t reportedDropped = 0;
+
+    while (true) {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(100));
+
+        // --- Все заполненные слоты по порядку ---
+        while (const LogRingT::Slot* slot = logRing.front()) {
+            logEmit(udpFd, &dest, slot->text, slot->len);
+            logRing.pop();
+        }
+
+        // --- Сообщить о потерях ---
+        uint32_t dropped = logRing.dropped();
+        if (dropped != reportedDropped) {
+            char line[64];
+            int len = snprintf(line, sizeof(line), "⚠️ Лог: потеряно строк: %lu\n",
+                               (unsigned long)(dropped - reportedDropped));
+            logEmit(udpFd, &dest, line, len);
+            reportedDropped = dropped;
+        }
+    }
+}
+
+void logInit() {
+    BaseType_t res = xTaskCreatePinnedToCore(
+        logTaskLoop,
+        "Log",
+        3072,
+        NULL,
+        LOG_TASK_PRIORITY,
+        &logTask,
+        LOG_TASK_CORE
+    );
+    if (res != pdPASS) {
+        Serial.println("❌ Log: ошибка запуска задачи");
+        return;
+    }
+    Serial.printf("✅ Лог: уровень %d, кольцо %d строк%s\n", LOG_LEVEL, LOG_RING_SLOTS,
+                  LOG_UDP_PORT ? ", UDP broadcast" : "");
+}
+
+LogStats logGetStats() {
+    LogStats st;
+    st.lines   = logRing.lines();
+    st.dropped = logRing.dropped();
+    return st;
+}
@@ -0,0 +1,87 @@
+/**
+ * ============================================================
+ * 📝 log.h — Асинхронный лог с уровнями
+ * ============================================================
+ *
+ * Serial.printf на 115200 бод блокирует вызывающего на время
+ * передачи строки (~5 мс на 60 символов). Макросы LOG_x только
+ * форматируют строку в слот lock-free кольца и возвращаются;
+ * в Serial (и, если задан LOG_UDP_PORT, UDP-broadcast) строки
+ * выводит низкоприоритетная задача Log.
+ *
+ * Уровни (LOG_LEVEL в config.h):
+ *   LOG_E — ошибки, LOG_W — предупреждения,
+ *   LOG_I — события (подключения, режимы),
+ *   LOG_D — отладка горячих путей
+ * Вызовы уровней выше LOG_LEVEL превращаются в if (0) и
+ * вырезаются компилятором: аргументы не вычисляются, но формат
+ * по-прежнему проверяется.
+ *
+ * Переполнение кольца: строка отбрасывается (счётчик dropped),
+ * вызывающий никогда не ждёт. Задача Log сообщает о потерях
+ * отдельной строкой.
+ *
+ * Сообщения инициализации в setup() по-прежнему идут напрямую
+ * в Serial — до старта задач порядок важнее скорости.
+ *
+ * ============================================================
+ */
+
+#ifndef LOG_H
+#define LOG_H
+
+#include <Arduino.h>
+#include "config.h"
+
+#define LOG_LEVEL_NONE   0
+#define LOG_LEVEL_ERROR  1
+#define LOG_LEVEL_WARN   2
+#define LOG_LEVEL_INFO   3
+#define LOG_LEVEL_DEBUG  4
+
+// --- Статистика ---
+struct LogStats {
+    uint32_t lines;       // Принято строк
+    uint32_t dropped;     // Отброшено (кольцо заполнено)
+};
+
+/**
+ * @brief Запустить задачу вывода. Вызывать в setup() после Serial.begin().
+ * Строки, записанные до вызова, копятся в кольце.
+ */
+void logInit();
+
+/**
+ * @brief Записать строку в кольцо (printf-формат, '\n' добавляется сам)
+ * Не блокируется; используйте макросы LOG_x.
+ */
+void logWrite(char level, const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+
+/** @brief Получить статистику лога */
+LogStats logGetStats();
+
+#if LOG_LEVEL >= LOG_LEVEL_ERROR
+#define LOG_E(fmt, ...) logWrite('E', fmt, ##__VA_ARGS__)
+#else
+#define LOG_E(fmt, ...) do { if (0) logWrite('E', fmt, ##__VA_ARGS__); } while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_WARN
+#define LOG_W(fmt, ...) logWrite('W', fmt, ##__VA_ARGS__)
+#else
+#define LOG_W(fmt, ...) do { if (0) logWrite('W', fmt, ##__VA_ARGS__); } while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_INFO
+#define LOG_I(fmt, ...) logWrite('I', fmt, ##__VA_ARGS__)
+#else
+#define LOG_I(fmt, ...) do { if (0) logWrite('I', fmt, ##__VA_ARGS__); } while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_DEBUG
+#define LOG_D(fmt, ...) logWrite('D', fmt, ##__VA_ARGS__)
+#else
+#define LOG_D(fmt, ...) do { if (0) logWrite('D', fmt, ##__VA_ARGS__); } while (0)
+#endif
+
+#endif // LOG_H
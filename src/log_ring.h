@@ -0,0 +1,102 @@
+/**
+ * ============================================================
+ * 📝 log_ring.h — Кольцо строк лога (MPSC, без блокировок)
+ * ============================================================
+ *
+ * Ограниченная MPSC-очередь (схема Vyukov) из Slots слотов
+ * фиксированного размера:
+ *   - у слота порядковый номер seq; слот свободен для позиции
+ *     pos, если seq == pos, заполнен — если seq == pos + 1
+ *   - продюсер (любая задача) занимает позицию CAS'ом head,
+ *     пишет строку прямо в слот и публикует seq = pos + 1
+ *   - если seq слота < pos — кольцо полное: строка отброшена
+ *   - консьюмер (один) читает слоты по порядку и освобождает:
+ *     seq = pos + Slots
+ *
+ * Ни мьютексов, ни критических секций, ни вызовов ОС —
+ * вынесено из log.cpp, чтобы проверять на хосте
+ * (test/test_log_ring).
+ *
+ * ============================================================
+ */
+
+#ifndef LOG_RING_H
+#define LOG_RING_H
+
+#include <stdint.h>
+#include <atomic>
+
+template <uint32_t Slots, uint16_t LineMax>
+class LogRing {
+public:
+    struct Slot {
+        std::atomic<uint32_t> seq;
+        uint16_t len;
+        char     text[LineMax];
+    };
+
+    // Слоты свободны сразу после статической инициализации (до logInit)
+    LogRing() {
+        for (uint32_t i = 0; i < Slots; i++) slots[i].seq.store(i, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Занять слот под строку (любая задача)
+     * @param pos Позиция — передать в publish()
+     * @return nullptr если кольцо заполнено (строка отброшена, dropped + 1)
+     */
+    Slot* claim(uint32_t* pos) {
+        uint32_t p = head.load(std::memory_order_relaxed);
+        while (true) {
+            Slot* slot = &slots[p % Slots];
+            int32_t diff = (int32_t)(slot->seq.load(std::memory_order_acquire) - p);
+            if (diff == 0) {
+                if (head.compare_exchange_weak(p, p + 1, std::memory_order_relaxed)) {
+                    *pos = p;
+                    return slot;
+                }
+            } else if (diff < 0) {
+                droppedCount.fetch_add(1, std::memory_order_relaxed);
+                return nullptr;
+            } else {
+                p = head.load(std::memory_order_relaxed);       // Позицию занял другой
+            }
+        }
+    }
+
+    /** @brief Отдать заполненный слот консьюмеру */
+    void publish(Slot* slot, uint32_t pos) {
+        slot->seq.store(pos + 1, std::memory_order_release);
+        linesCount.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Следующая строка по порядку (только консьюмер)
+     * @return nullptr если слот на очереди ещё не опубликован
+     */
+    const Slot* front() const {
+        const Slot* slot = &slots[tail % Slots];
+        return slot->seq.load(std::memory_order_acquire) == tail + 1 ? slot : nullptr;
+    }
+
+    /** @brief Освободить строку, полученную из front() (только консьюмер) */
+    void pop() {
+        slots[tail % Slots].seq.store(tail + Slots, std::memory_order_release);
+        tail++;
+    }
+
+    /** @brief Принято строк */
+    uint32_t lines() const { return linesCount.load(std::memory_order_relaxed); }
+
+    /** @brief Отброшено строк (кольцо было заполнено) */
+    uint32_t dropped() const { return droppedCount.load(std::memory_order_relaxed); }
+
+private:
+    Slot slots[Slots];
+    std::atomic<uint32_t> head{0};       // Следующая позиция для продюсеров
+    uint32_t              tail = 0;      // Следующая позиция консьюмера
+    std::atomic<uint32_t> linesCount{0};
+    std::atomic<uint32_t> droppedCount{0};
+};
+
+#endif // LOG_RING_H
@@ -0,0 +1,75 @@
+/**
+ * ============================================================
+ * 📬 mailbox.h — Lock-free SPSC почтовый ящик «последнее значение»
+ * ============================================================
+ *
+ * Один продюсер (например, задача httpd) и один консьюмер
+ * (задача управления) обмениваются значениями без мьютексов
+ * и критических секций. Семантика latest-wins: если продюсер
+ * успел записать несколько значений до того, как консьюмер
+ * их забрал, консьюмер получит только последнее.
+ *
+ * Реализация — тройной буфер:
+ *   - back   — слот, в который пишет продюсер (только его)
+ *   - front  — слот, который читает консьюмер (только его)
+ *   - middle — обменный слот + флаг FRESH, единственное
+ *              разделяемое поле (std::atomic, S32C1I на Xtensa)
+ *
+ * Продюсер никогда не ждёт консьюмера и наоборот — post() и
+ * take() выполняются за постоянное время.
+ *
+ * ============================================================
+ */
+
+#ifndef MAILBOX_H
+#define MAILBOX_H
+
+#include <Arduino.h>
+#include <atomic>
+
+template <typename T>
+class LatestMailbox {
+public:
+    /**
+     * @brief Опубликовать значение (только задача-продюсер)
+     * Невзятое предыдущее значение вытесняется.
+     */
+    void post(const T& value) {
+        slots[back] = value;
+        uint32_t prev = middle.exchange(back | FRESH, std::memory_order_acq_rel);
+        back = prev & INDEX_MASK;
+        posted++;
+    }
+
+    /**
+     * @brief Забрать последнее значение (только задача-консьюмер)
+     * @return false если с прошлого take() ничего не публиковалось
+     */
+    bool take(T* out) {
+        if (!(middle.load(std::memory_order_acquire) & FRESH)) return false;
+        uint32_t prev = middle.exchange(front, std::memory_order_acq_rel);
+        front = prev & INDEX_MASK;
+        *out = slots[front];
+        taken++;
+        return true;
+    }
+
+    /** @brief Всего опубликовано (пишет продюсер) */
+    uint32_t postedCount() const { return posted; }
+
+    /** @brief Всего забрано (пишет консьюмер); posted − taken = схлопнуто */
+    uint32_t takenCount() const { return taken; }
+
+private:
+    static const uint32_t FRESH      = 0x04;  // В middle есть непрочитанное значение
+    static const uint32_t INDEX_MASK = 0x03;
+
+    T slots[3] = {};
+    uint8_t back  = 0;                      // Только продюсер
+    uint8_t front = 1;                      // Только консьюмер
+    std::atomic<uint32_t> middle{2};        // Обменный слот
+    volatile uint32_t posted = 0;
+    volatile uint32_t taken  = 0;
+};
+
+#endif // MAILBOX_H
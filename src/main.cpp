@@ -4,19 +4,28 @@
  * ============================================================
  *
  * Порядок инициализации (setup):
- *   1. Serial (115200 baud)
+ *   1. Serial (115200 baud) + задача асинхронного лога (logInit)
  *   2. IR LED пин (GPIO 4)
  *   3. PWM моторы (driveInit)
- *   4. Модуль управления с watchdog (controlInit)
+ *   4. Журнал команд (recorderInit), буферы проигрывателя форм
+ *      скважности (waveInit) и модуль управления:
+ *      задача CONTROL_RATE_HZ + watchdog + ВМ миссий (controlInit),
+ *      при MISSION_AUTOSTART_DEMO — запуск демо-программы
  *   5. SPIFFS файловая система (для веб-интерфейса)
  *   6. Камера OV2640 (cameraInit)
  *   7. WiFi (STA-режим, ожидание подключения)
- *   8. HTTP-сервер на порту 80 (webserverStartMain, Core 1)
- *   9. MJPEG стрим-сервер на порту 81 (streamServerTask, Core 0)
+ *   8. RTP/UDP сокет (rtpStreamInit)
+ *   9. Воркер миниатюр (thumbnailInit, Core 1), защита хода
+ *      вперёд по смене сцены (sceneGuardInit) и задача кадров
+ *      для анализа на устройстве (visionInit, Core 1)
+ *  10. UDP-канал управления (udpControlInit, Core 1) и
+ *      аварийного стопа (estopInit, Core 1)
+ *  11. HTTP-сервер на порту 80 (webserverStartMain, Core 1)
+ *  12. MJPEG стрим-сервер на порту 81 (streamServerTask, Core 0)
  *
  * Основной цикл (loop, ~50 Гц):
- *   - controlUpdate() — watchdog-проверка таймаута команд
  *   - WiFi reconnect — раз в 10 сек проверка связи
+ *   (моторы и watchdog — в задаче управления, см. control.h)
  *
  * ============================================================
  */
@@ -26,14 +35,25 @@
 #include <SPIFFS.h>
 
 #include "config.h"
+#include "log.h"
 #include "camera.h"
 #include "drive.h"
 #include "control.h"
+#include "recorder.h"
+#include "wave.h"
+#include "mission.h"
+#include "scene_guard.h"
+#include "vision.h"
+#include "estop.h"
 #include "webserver.h"
+#include "rtp_stream.h"
+#include "thumbnail.h"
+#include "udp_control.h"
 
 void setup() {
     Serial.begin(115200);
     Serial.println("\n🚀 ESP32-CAM Rover запускается...");
+    logInit();
 
     // IR LED
     pinMode(PIN_IR_LED, OUTPUT);
@@ -43,9 +63,18 @@ void setup() {
     driveInit();
     Serial.println("✅ PWM инициализирован");
 
+    // Журнал команд управления и формы скважности (до задачи управления)
+    recorderInit();
+    waveInit();
+
     // Модуль управления с watchdog
     controlInit();
 
+#if MISSION_AUTOSTART_DEMO
+    // Демо-программа моторов (до старта httpd — запросы миссий из одной задачи)
+    missionStart(MISSION_PROG_DEMO);
+#endif
+
     // SPIFFS
     if (!SPIFFS.begin(true)) {
         Serial.println("❌ SPIFFS Error");
@@ -69,6 +98,23 @@ void setup() {
     Serial.println();
     Serial.printf("✅ WiFi подключен! IP: %s\n", WiFi.localIP().toString().c_str());
 
+    // RTP/UDP сокет (адресат задаётся через /api/rtp)
+    rtpStreamInit();
+
+    // Воркер миниатюр (/photo?scale=N, /stream?scale=N)
+    thumbnailInit();
+
+    // Защита хода вперёд по смене сцены и следование за движением —
+    // кадры 1/8 от задачи Vision (работает и без зрителей)
+    sceneGuardInit();
+    visionInit();
+
+    // Бинарный UDP-канал управления (порт UDP_CONTROL_PORT)
+    udpControlInit();
+
+    // Аварийный стоп (порт ESTOP_PORT, приоритет выше управления)
+    estopInit();
+
     // HTTP сервер (порт 80) — Core 1
     webserverStartMain();
 
@@ -87,34 +133,34 @@ void setup() {
     Serial.println("\n========================================");
     Serial.printf("🌐 Web UI:    http://%s/\n", WiFi.localIP().toString().c_str());
     Serial.printf("📹 Стрим:     http://%s:%d/stream\n", WiFi.localIP().toString().c_str(), HTTP_PORT_STREAM);
-    Serial.printf("📷 Фото:      http://%s/photo\n", WiFi.localIP().toString().c_str());
+    Serial.printf("📷 Фото:      http://%s/photo  (?scale=2|4|8 — миниатюра)\n", WiFi.localIP().toString().c_str());
     Serial.printf("💡 LED:       http://%s/led\n", WiFi.localIP().toString().c_str());
     Serial.printf("🔧 Drive API:   http://%s/api/drive   (отладка)\n", WiFi.localIP().toString().c_str());
     Serial.printf("🎮 Control API: http://%s/api/control (с watchdog)\n", WiFi.localIP().toString().c_str());
+    Serial.printf("🎞️ Recorder:    http://%s/api/recorder (журнал, ?download=1)\n", WiFi.localIP().toString().c_str());
+    Serial.printf("📜 Mission API: http://%s/api/mission (сценарии, tools/mission.js)\n", WiFi.localIP().toString().c_str());
+    Serial.printf("〰️ Wave API:    http://%s/api/wave    (формы скважности, tools/wave.js)\n", WiFi.localIP().toString().c_str());
+    Serial.printf("🔑 Lease API:   http://%s/api/lease   (аренда управления)\n", WiFi.localIP().toString().c_str());
     Serial.printf("📊 Status API:  http://%s/api/status  (телеметрия)\n", WiFi.localIP().toString().c_str());
+    Serial.printf("🛰️ UDP control: %s:%d   (бинарный, tools/udp-control.js)\n", WiFi.localIP().toString().c_str(), UDP_CONTROL_PORT);
+    Serial.printf("🛑 E-stop:      %s:%d   (UDP, tools/estop.js; /api/estop)\n", WiFi.localIP().toString().c_str(), ESTOP_PORT);
+    Serial.printf("👁️ Scene guard: http://%s/api/scene   (смена сцены → стоп вперёд)\n", WiFi.localIP().toString().c_str());
+    Serial.printf("🎯 Follow API:  http://%s/api/follow  (следование за движением)\n", WiFi.localIP().toString().c_str());
+    Serial.printf("📡 RTP API:     http://%s/api/rtp     (RTP/UDP, SDP: /rtp.sdp)\n", WiFi.localIP().toString().c_str());
     Serial.println("========================================\n");
 }
 
 void loop() {
-    // =========================================================
-    // 🎮 Watchdog управления — ОБЯЗАТЕЛЬНО вызывать!
-    // Проверяет таймаут и останавливает моторы если нет команд
-    // =========================================================
-    controlUpdate();
-
-    // Демо движений (удалить при реальном управлении)
-    // driveDemoUpdate();
-
     // Проверка WiFi (раз в 10 сек)
     static unsigned long lastWifiCheck = 0;
     if (millis() - lastWifiCheck >= 10000) {
         lastWifiCheck = millis();
         if (WiFi.status() != WL_CONNECTED) {
-            Serial.println("⚠️ WiFi отключен, переподключение...");
+            LOG_W("⚠️ WiFi отключен, переподключение...");
             WiFi.reconnect();
         }
     }
 
-    // ~50 Гц цикл для плавного управления
+    // Моторы обслуживает задача управления — loop() не критичен по времени
     vTaskDelay(pdMS_TO_TICKS(20));
 }
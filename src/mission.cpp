@@ -0,0 +1,342 @@
+/**
+ * ============================================================
+ * 📜 mission.cpp — Байткод-сценарии движения (миссии)
+ * ============================================================
+ *
+ * ВМ живёт в задаче управления: missionTick() вызывается на
+ * каждом тике после разбора команд и до рампы (driveTick), цели
+ * моторов задаёт через driveSetAll(). Запуск и остановка приходят
+ * из httpd через почтовый ящик (latest-wins: stop после start
+ * отменяет запуск), keepalive — атомарная метка millis().
+ *
+ * Программы:
+ *   - демо (встроенная, во flash) — бывший driveDemoUpdate()
+ *   - пользовательская (missionLoad, до MISSION_PROGRAM_MAX байт)
+ * При запуске программа копируется в буфер исполнения задачи
+ * управления — повторная загрузка во время работы безопасна.
+ *
+ * Зависимости:
+ *   - drive.h   — driveSetAll(), driveStop(), driveGetState()
+ *   - lease.h   — проверка аренды при запуске
+ *   - mailbox.h — запросы httpd → задача управления
+ *   - mission_code.h — формат, missionValidate(), missionOpSize
+ *   - config.h  — MISSION_*, DEMO_*
+ *
+ * ============================================================
+ */
+
+#include "mission.h"
+#include "drive.h"
+#include "config.h"
+#include "log.h"
+#include "lease.h"
+#include "mailbox.h"
+#include <atomic>
+
+// --- Встроенная программа: демо (16 паттернов по DEMO_STEP_MS) ---
+// Скорости в порядке enum Motor: RL, FR, FL, RR
+#define U16(v) (uint8_t)((v) & 0xFF), (uint8_t)((v) >> 8)
+#define DEMO_STEP(n, fl, fr, rl, rr) \
+    MOP_MARK, n, MOP_SET, rl, fr, fl, rr, MOP_WAIT, U16(DEMO_STEP_MS)
+
+static_assert(DEMO_STEP_MS <= 0xFFFF, "DEMO_STEP_MS не помещается в WAIT");
+
+static const uint8_t demoProgram[] = {
+    MISSION_MAGIC_0, MISSION_MAGIC_1, MISSION_VERSION, 0,
+    MOP_LOOP, 0,
+    //          шаг  FL                   FR                   RL                   RR
+    DEMO_STEP(1,  DEMO_SPEED_DEFAULT,  0,                   0,                   0),                   // FL
+    DEMO_STEP(2,  0,                   DEMO_SPEED_DEFAULT,  0,                   0),                   // FR
+    DEMO_STEP(3,  0,                   0,                   DEMO_SPEED_DEFAULT,  0),                   // RL
+    DEMO_STEP(4,  0,                   0,                   0,                   DEMO_SPEED_DEFAULT),  // RR
+    DEMO_STEP(5,  DEMO_SPEED_DEFAULT,  0,                   DEMO_SPEED_DEFAULT,  0),                   // Левая сторона
+    DEMO_STEP(6,  0,                   DEMO_SPEED_DEFAULT,  0,                   DEMO_SPEED_DEFAULT),  // Правая сторона
+    DEMO_STEP(7,  DEMO_SPEED_DEFAULT,  DEMO_SPEED_DEFAULT,  0,                   0),                   // Перед
+    DEMO_STEP(8,  0,                   0,                   DEMO_SPEED_DEFAULT,  DEMO_SPEED_DEFAULT),  // Зад
+    DEMO_STEP(9,  DEMO_SPEED_DEFAULT,  0,                   0,                   DEMO_SPEED_DEFAULT),  // Диагональ FL+RR
+    DEMO_STEP(10, 0,                   DEMO_SPEED_DEFAULT,  DEMO_SPEED_DEFAULT,  0),                   // Диагональ FR+RL
+    DEMO_STEP(11, DEMO_SPEED_DEFAULT,  DEMO_SPEED_DEFAULT,  DEMO_SPEED_DEFAULT,  DEMO_SPEED_DEFAULT),  // Все
+    DEMO_STEP(12, 0,                   DEMO_SPEED_DEFAULT,  0,                   DEMO_SPEED_DEFAULT),  // Танк влево
+    DEMO_STEP(13, DEMO_SPEED_DEFAULT,  0,                   DEMO_SPEED_DEFAULT,  0),                   // Танк вправо
+    DEMO_STEP(14, DEMO_SPEED_RAMP_LOW, DEMO_SPEED_RAMP_LOW, DEMO_SPEED_RAMP_LOW, DEMO_SPEED_RAMP_LOW), // Все, низкая
+    DEMO_STEP(15, DEMO_SPEED_RAMP_MID, DEMO_SPEED_RAMP_MID, DEMO_SPEED_RAMP_MID, DEMO_SPEED_RAMP_MID), // Все, средняя
+    DEMO_STEP(16, 0,                   0,                   0,                   0),                   // Стоп
+    MOP_NEXT,
+    MOP_END
+};
+
+static const char* programNames[MISSION_PROG_COUNT] = {"demo", "user"};
+
+// --- Пользовательская программа (пишет httpd, копирует задача управления) ---
+static uint8_t  userCode[MISSION_PROGRAM_MAX];
+static uint16_t userLen = 0;
+static portMUX_TYPE missionMux = portMUX_INITIALIZER_UNLOCKED;
+
+// --- Запросы httpd → задача управления ---
+enum MissionAction : uint8_t { MISSION_REQ_START, MISSION_REQ_STOP };
+struct MissionRequest {
+    MissionAction  action;
+    MissionProgram program;
+};
+static LatestMailbox<MissionRequest> requests;
+static std::atomic<uint32_t> keepaliveMs{0};
+
+// --- Исполнение (только задача управления) ---
+struct MissionLoop {
+    uint16_t start;      // pc первой инструкции тела
+    uint8_t  left;       // Осталось проходов (0 — бесконечно)
+};
+
+static struct {
+    uint8_t     code[MISSION_PROGRAM_MAX];
+    uint16_t    len;
+    uint16_t    pc;
+    uint32_t    startUs;
+    uint32_t    clockUs;            // Виртуальные часы сценария
+    bool        busy;               // Идёт WAIT/RAMP
+    bool        yielded;            // Прошлый тик исчерпал MISSION_OPS_PER_TICK
+    uint32_t    segStartUs;
+    uint32_t    segUs;
+    bool        ramping;
+    DriveState  rampFrom;
+    DriveState  rampTo;
+    uint16_t    wdogMs;
+    MissionLoop loops[MISSION_LOOP_DEPTH];
+    uint8_t     depth;
+} run;
+
+static MissionStatus status = {};   // Под missionMux
+
+static inline uint16_t rd16(const uint8_t* p) {
+    return (uint16_t)p[0] | ((uint16_t)p[1] << 8);
+}
+
+bool missionLoad(const uint8_t* buf, size_t len, const char** error) {
+    if (!missionValidate(buf, len, error)) return false;
+
+    portENTER_CRITICAL(&missionMux);
+    memcpy(userCode, buf, len);
+    userLen = len;
+    status.userSize = len;
+    portEXIT_CRITICAL(&missionMux);
+    return true;
+}
+
+// ============================================================
+// Запросы (задача httpd)
+// ============================================================
+
+bool missionStart(MissionProgram program, uint32_t lease) {
+    if (program >= MISSION_PROG_COUNT) return false;
+    if (program == MISSION_PROG_USER) {
+        portENTER_CRITICAL(&missionMux);
+        bool loaded = userLen > 0;
+        portEXIT_CRITICAL(&missionMux);
+        if (!loaded) return false;
+    }
+    if (!leaseCheck(lease)) return false;
+
+    keepaliveMs.store(millis(), std::memory_order_relaxed);
+    requests.post({MISSION_REQ_START, program});
+    return true;
+}
+
+void missionStop() {
+    requests.post({MISSION_REQ_STOP, MISSION_PROG_DEMO});
+}
+
+void missionKeepalive() {
+    keepaliveMs.store(millis(), std::memory_order_relaxed);
+}
+
+MissionStatus missionGetStatus() {
+    portENTER_CRITICAL(&missionMux);
+    MissionStatus st = status;
+    portEXIT_CRITICAL(&missionMux);
+    return st;
+}
+
+// ============================================================
+// Исполнение (задача управления)
+// ============================================================
+
+static void publish(uint32_t nowUs) {
+    portENTER_CRITICAL(&missionMux);
+    status.pc = run.pc - MISSION_HEADER_LEN;
+    status.elapsedMs = (nowUs - run.startUs) / 1000;
+    portEXIT_CRITICAL(&missionMux);
+}
+
+static void finish(MissionState state, MissionAbort reason) {
+    portENTER_CRITICAL(&missionMux);
+    status.state = state;
+    status.abort = reason;
+    portEXIT_CRITICAL(&missionMux);
+}
+
+static void beginRun(MissionProgram program, uint32_t nowUs) {
+    portENTER_CRITICAL(&missionMux);
+    if (program == MISSION_PROG_USER) {
+        memcpy(run.code, userCode, userLen);
+        run.len = userLen;
+    } else {
+        memcpy(run.code, demoProgram, sizeof(demoProgram));
+        run.len = sizeof(demoProgram);
+    }
+    status.state = MISSION_RUNNING;
+    status.program = program;
+    status.abort = MISSION_ABORT_NONE;
+    status.mark = 0;
+    status.runs++;
+    portEXIT_CRITICAL(&missionMux);
+
+    run.pc = MISSION_HEADER_LEN;
+    run.startUs = run.clockUs = nowUs;
+    run.busy = run.yielded = run.ramping = false;
+    run.wdogMs = 0;
+    run.depth = 0;
+    LOG_I("📜 Миссия: старт %s (%u байт)", programNames[program], run.len);
+}
+
+static void abortRun(MissionAbort reason) {
+    driveStop();
+    finish(MISSION_ABORTED, reason);
+    LOG_W("📜 Миссия прервана (%s)",
+          reason == MISSION_ABORT_WATCHDOG ? "сторож" : "стоп");
+}
+
+/**
+ * Шаг текущей паузы/рампы.
+ * @return true — ещё не закончилась
+ */
+static bool stepSegment(uint32_t nowUs) {
+    uint32_t elapsed = nowUs - run.segStartUs;
+    bool pending = (int32_t)(nowUs - run.clockUs) < 0;
+
+    if (run.ramping) {
+        DriveState next;
+        for (int i = 0; i < MOTOR_COUNT; i++) {
+            int32_t from = run.rampFrom.speed[i];
+            int32_t delta = (int32_t)run.rampTo.speed[i] - from;
+            next.speed[i] = pending ? from + (int32_t)((int64_t)delta * elapsed / run.segUs)
+                                    : run.rampTo.speed[i];
+        }
+        driveSetAll(next);
+    }
+    if (pending) return true;
+
+    run.busy = run.ramping = false;
+    return false;
+}
+
+/**
+ * Начать паузу (и рампу) длиной ms от виртуальных часов.
+ */
+static void beginSegment(uint16_t ms) {
+    run.segStartUs = run.clockUs;
+    run.segUs = (uint32_t)ms * 1000;
+    run.clockUs += run.segUs;
+    run.busy = ms > 0;
+}
+
+void missionTick(uint32_t nowUs) {
+    MissionRequest req;
+    if (requests.take(&req)) {
+        if (req.action == MISSION_REQ_START) beginRun(req.program, nowUs);
+        else if (status.state == MISSION_RUNNING) abortRun(MISSION_ABORT_STOP);
+    }
+    if (status.state != MISSION_RUNNING) return;
+
+    // Сторож: клиент обязан слать keepalive чаще wdogMs
+    if (run.wdogMs != 0 &&
+        millis() - keepaliveMs.load(std::memory_order_relaxed) >= run.wdogMs) {
+        abortRun(MISSION_ABORT_WATCHDOG);
+        return;
+    }
+
+    if (run.yielded) {
+        run.clockUs = nowUs;
+        run.yielded = false;
+    }
+    if (run.busy && stepSegment(nowUs)) {
+        publish(nowUs);
+        return;
+    }
+
+    for (int ops = 0; ops < MISSION_OPS_PER_TICK; ops++) {
+        const uint8_t* ins = run.code + run.pc;
+        run.pc += missionOpSize[ins[0]];
+
+        switch (ins[0]) {
+            case MOP_END:
+                driveStop();
+                publish(nowUs);
+                finish(MISSION_DONE, MISSION_ABORT_NONE);
+                LOG_I("📜 Миссия завершена");
+                return;
+
+            case MOP_SET: {
+                DriveState next;
+                memcpy(next.speed, ins + 1, MOTOR_COUNT);
+                driveSetAll(next);
+                break;
+            }
+
+            case MOP_RAMP:
+                run.rampFrom = driveGetState();
+                memcpy(run.rampTo.speed, ins + 3, MOTOR_COUNT);
+                beginSegment(rd16(ins + 1));
+                run.ramping = run.busy;
+                if (!run.busy) driveSetAll(run.rampTo);
+                break;
+
+            case MOP_WAIT:
+                beginSegment(rd16(ins + 1));
+                break;
+
+            case MOP_LOOP:
+                run.loops[run.depth].start = run.pc;
+                run.loops[run.depth].left = ins[1];
+                run.depth++;
+                break;
+
+            case MOP_NEXT: {
+                MissionLoop& loop = run.loops[run.depth - 1];
+                if (loop.left == 0 || --loop.left > 0) run.pc = loop.start;
+                else run.depth--;
+                break;
+            }
+
+            case MOP_WDOG:
+                run.wdogMs = rd16(ins + 1);
+                missionKeepalive();
+                break;
+
+            case MOP_STOP:
+                driveStop();
+                break;
+
+            case MOP_MARK:
+                portENTER_CRITICAL(&missionMux);
+                status.mark = ins[1];
+                portEXIT_CRITICAL(&missionMux);
+                break;
+        }
+
+        // Пауза/рампа: продолжим со следующего тика (нулевая длина — сразу)
+        if (run.busy && stepSegment(nowUs)) {
+            publish(nowUs);
+            return;
+        }
+    }
+
+    // Бюджет инструкций исчерпан — уступаем тик
+    run.yielded = true;
+    publish(nowUs);
+}
+
+void missionOverride() {
+    if (status.state != MISSION_RUNNING) return;
+    finish(MISSION_ABORTED, MISSION_ABORT_OVERRIDE);
+    LOG_I("📜 Миссия прервана ручной командой");
+}
@@ -0,0 +1,108 @@
+/**
+ * ============================================================
+ * 📜 mission.h — Байткод-сценарии движения (миссии)
+ * ============================================================
+ *
+ * Маленькая виртуальная машина в задаче управления: исполняет
+ * загруженную программу движения с таймингом тика управления
+ * (CONTROL_RATE_HZ, esp_timer) — сеть в шагах сценария не
+ * участвует. Программы собираются на хосте:
+ *   tools/mission.js (текст → байткод, загрузка, запуск)
+ *
+ * Формат программы, опкоды и проверка при загрузке — в
+ * mission_code.h (без Arduino, проверяется на хосте): проверенная
+ * программа исполняется без проверки границ. Время сценария —
+ * виртуальные часы: пауза отсчитывается от конца предыдущей,
+ * опоздание тика не накапливается.
+ *
+ * Миссию прерывают:
+ *   - любая команда управления, дошедшая до задачи (ручной
+ *     перехват: джойстик, UDP, воспроизведение журнала)
+ *   - missionStop()
+ *   - сторож WDOG без missionKeepalive()
+ *
+ * Встроенная программа MISSION_PROG_DEMO — бывший демо-режим
+ * drive (16 паттернов моторов по кругу).
+ *
+ * ============================================================
+ */
+
+#ifndef MISSION_H
+#define MISSION_H
+
+#include <Arduino.h>
+#include "mission_code.h"
+
+// --- Программа ---
+enum MissionProgram : uint8_t {
+    MISSION_PROG_DEMO = 0,   // Встроенная: демо-паттерны моторов
+    MISSION_PROG_USER,       // Загруженная через /api/mission
+    MISSION_PROG_COUNT
+};
+
+// --- Состояние ВМ ---
+enum MissionState : uint8_t {
+    MISSION_IDLE = 0,        // Не запускалась
+    MISSION_RUNNING,
+    MISSION_DONE,            // Дошла до END
+    MISSION_ABORTED          // Прервана (см. MissionAbort)
+};
+
+// --- Причина прерывания ---
+enum MissionAbort : uint8_t {
+    MISSION_ABORT_NONE = 0,
+    MISSION_ABORT_STOP,      // missionStop()
+    MISSION_ABORT_OVERRIDE,  // Ручная команда управления
+    MISSION_ABORT_WATCHDOG   // Сторож WDOG: нет keepalive
+};
+
+// --- Состояние для /api/mission ---
+struct MissionStatus {
+    MissionState   state;
+    MissionProgram program;
+    MissionAbort   abort;
+    uint8_t        mark;        // Последний MARK
+    uint16_t       pc;          // Смещение инструкции (от начала кода)
+    uint32_t       elapsedMs;   // С запуска
+    uint16_t       userSize;    // Размер загруженной программы (0 — нет)
+    uint32_t       runs;        // Запусков всего
+};
+
+/**
+ * @brief Проверить и загрузить пользовательскую программу
+ * Запущенная программа исполняет свою копию — загрузка не мешает.
+ * @param error Текст ошибки проверки (может быть NULL)
+ * @return false — программа отклонена
+ */
+bool missionLoad(const uint8_t* buf, size_t len, const char** error);
+
+/**
+ * @brief Запустить программу (с ближайшего тика управления)
+ * Вызывать из одной задачи (httpd; до его старта — setup()).
+ * @param lease Токен аренды управления (lease.h)
+ * @return false — нет программы или отклонено арендой
+ */
+bool missionStart(MissionProgram program, uint32_t lease = 0);
+
+/** @brief Остановить программу (та же задача, что missionStart) */
+void missionStop();
+
+/** @brief Продлить сторож WDOG (любая задача) */
+void missionKeepalive();
+
+/** @brief Состояние ВМ (любая задача) */
+MissionStatus missionGetStatus();
+
+/**
+ * @brief Шаг ВМ (только задача управления, каждый тик)
+ * @param nowUs esp_timer_get_time() тика
+ */
+void missionTick(uint32_t nowUs);
+
+/**
+ * @brief Ручная команда дошла до задачи управления — прервать
+ * миссию (только задача управления)
+ */
+void missionOverride();
+
+#endif // MISSION_H
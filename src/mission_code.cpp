@@ -0,0 +1,79 @@
+/**
+ * ============================================================
+ * 📜 mission_code.cpp — Проверка байткода миссий
+ * ============================================================
+ *
+ * Один проход по коду: размер инструкции — из missionOpSize,
+ * для открытых циклов — стек «бесконечный / в теле был WAIT
+ * или RAMP». Вложенный WAIT засчитывается всем охватывающим
+ * циклам.
+ *
+ * Зависимости:
+ *   - config.h — MISSION_PROGRAM_MAX, MISSION_LOOP_DEPTH
+ *
+ * ============================================================
+ */
+
+#include "mission_code.h"
+#include "config.h"
+
+const uint8_t missionOpSize[MISSION_OP_COUNT] = {
+    1,   // END
+    5,   // SET  s[4]
+    7,   // RAMP ms:u16 s[4]
+    3,   // WAIT ms:u16
+    2,   // LOOP n:u8
+    1,   // NEXT
+    3,   // WDOG ms:u16
+    1,   // STOP
+    2    // MARK n:u8
+};
+
+bool missionValidate(const uint8_t* buf, size_t len, const char** error) {
+    const char* err = NULL;
+    bool loopWaits[MISSION_LOOP_DEPTH];   // Тело бесконечного цикла ждёт
+    bool loopForever[MISSION_LOOP_DEPTH];
+    uint8_t depth = 0;
+    bool ended = false;
+
+    if (len < MISSION_HEADER_LEN + 1 || len > MISSION_PROGRAM_MAX) {
+        err = "Bad size";
+    } else if (buf[0] != MISSION_MAGIC_0 || buf[1] != MISSION_MAGIC_1 ||
+               buf[2] != MISSION_VERSION) {
+        err = "Bad header";
+    }
+
+    for (size_t pc = MISSION_HEADER_LEN; !err && pc < len; ) {
+        uint8_t op = buf[pc];
+        if (ended) { err = "Code after END"; break; }
+        if (op >= MISSION_OP_COUNT) { err = "Unknown opcode"; break; }
+        if (pc + missionOpSize[op] > len) { err = "Truncated instruction"; break; }
+
+        switch (op) {
+            case MOP_END:
+                ended = true;
+                break;
+            case MOP_WAIT:
+            case MOP_RAMP:
+                for (uint8_t i = 0; i < depth; i++) loopWaits[i] = true;
+                break;
+            case MOP_LOOP:
+                if (depth >= MISSION_LOOP_DEPTH) { err = "Loops nested too deep"; break; }
+                loopForever[depth] = (buf[pc + 1] == 0);
+                loopWaits[depth] = false;
+                depth++;
+                break;
+            case MOP_NEXT:
+                if (depth == 0) { err = "NEXT without LOOP"; break; }
+                depth--;
+                if (loopForever[depth] && !loopWaits[depth]) err = "Endless loop without WAIT";
+                break;
+        }
+        pc += missionOpSize[op];
+    }
+
+    if (!err && depth != 0) err = "LOOP without NEXT";
+    if (!err && !ended) err = "Missing END";
+    if (error) *error = err;
+    return err == NULL;
+}
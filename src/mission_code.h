@@ -0,0 +1,75 @@
+/**
+ * ============================================================
+ * 📜 mission_code.h — Формат байткода миссий и его проверка
+ * ============================================================
+ *
+ * Формат программы (little-endian):
+ *
+ *   off  size  поле
+ *   0    2     magic    "RM"
+ *   2    1     version  MISSION_VERSION
+ *   3    1     reserved 0
+ *   4    ...   код
+ *
+ * Инструкции (опкод u8 + операнды):
+ *
+ *   END   0x00               стоп моторов, программа завершена
+ *   SET   0x01 s[4]          цели моторов (порядок enum Motor: RL FR FL RR)
+ *   RAMP  0x02 ms:u16 s[4]   линейно от текущих целей к s[4] за ms
+ *   WAIT  0x03 ms:u16        пауза
+ *   LOOP  0x04 n:u8          начало цикла на n проходов (0 — бесконечно)
+ *   NEXT  0x05               конец цикла
+ *   WDOG  0x06 ms:u16        сторож: нет keepalive за ms — аварийный стоп
+ *                            (0 — выключить)
+ *   STOP  0x07               все моторы 0 (программа продолжается)
+ *   MARK  0x08 n:u8          метка шага (видна в /api/mission)
+ *
+ * Программа проверяется целиком при загрузке (missionValidate):
+ * известные опкоды, операнды в границах, парные LOOP/NEXT не
+ * глубже MISSION_LOOP_DEPTH, бесконечный цикл содержит WAIT или
+ * RAMP, последний опкод — END. Исполнение (mission.cpp) поэтому
+ * не проверяет границы.
+ *
+ * Модуль не зависит от Arduino/IDF — проверка одна и та же
+ * на устройстве и на хосте.
+ *
+ * ============================================================
+ */
+
+#ifndef MISSION_CODE_H
+#define MISSION_CODE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define MISSION_MAGIC_0  'R'
+#define MISSION_MAGIC_1  'M'
+#define MISSION_VERSION  1
+#define MISSION_HEADER_LEN 4
+
+// --- Опкоды ---
+enum MissionOp : uint8_t {
+    MOP_END  = 0x00,
+    MOP_SET  = 0x01,
+    MOP_RAMP = 0x02,
+    MOP_WAIT = 0x03,
+    MOP_LOOP = 0x04,
+    MOP_NEXT = 0x05,
+    MOP_WDOG = 0x06,
+    MOP_STOP = 0x07,
+    MOP_MARK = 0x08
+};
+
+#define MISSION_OP_COUNT 9
+
+// Размер инструкции (опкод + операнды), индекс — опкод
+extern const uint8_t missionOpSize[MISSION_OP_COUNT];
+
+/**
+ * @brief Проверить программу целиком (заголовок и код)
+ * @param error Текст ошибки (может быть NULL; NULL — программа верна)
+ * @return false — программа отклонена
+ */
+bool missionValidate(const uint8_t* buf, size_t len, const char** error);
+
+#endif // MISSION_CODE_H
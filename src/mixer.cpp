@@ -0,0 +1,109 @@
+/**
+ * ============================================================
+ * 🎚️ mixer.cpp — Skid-steer микшер с expo/ремапом на таблицах
+ * ============================================================
+ *
+ * Формулы таблицы (как в data/control.js, для |v| = 0..255):
+ *
+ *   n = v / 255, a = |expo| / 100
+ *   expo > 0: e = (1 − a)·n + a·n³       (мягкий центр)
+ *   expo < 0: e = (1 − a)·n + a·∛n       (резкий центр)
+ *   e = round(e · 255)
+ *
+ *   ремап: 0 → 0, иначе round(outMin + e/255 · (outMax − outMin))
+ *
+ * Таблица считается в double (как JS), на тике — только
+ * чтение байта и целочисленная арифметика.
+ *
+ * ============================================================
+ */
+
+#include "mixer.h"
+#include <math.h>
+#include <stdlib.h>
+
+// Две копии таблицы на ось: активную читает задача управления
+static uint8_t tables[MIXER_AXIS_COUNT][2][MIXER_TABLE_SIZE];
+static const uint8_t* volatile activeTable[MIXER_AXIS_COUNT] = {
+    tables[MIXER_AXIS_X][0], tables[MIXER_AXIS_Y][0]
+};
+static MixerAxisConfig axisConfig[MIXER_AXIS_COUNT] = {
+    {0, 0, 255}, {0, 0, 255}
+};
+
+/**
+ * Значение таблицы для |v| по формулам ControlService.
+ */
+static uint8_t tableValue(const MixerAxisConfig& cfg, int v) {
+    if (v == 0) return 0;
+
+    int e = v;
+    if (cfg.expo != 0) {
+        double n = v / 255.0;
+        double a = abs(cfg.expo) / 100.0;
+        double shaped = (cfg.expo > 0) ? (1 - a) * n + a * n * n * n
+                                       : (1 - a) * n + a * pow(n, 1.0 / 3);
+        e = (int)floor(shaped * 255 + 0.5);
+    }
+
+    if (e == 0) return 0;
+    if (cfg.outMin == 0 && cfg.outMax == 255) return (uint8_t)e;
+
+    double mapped = cfg.outMin + (e / 255.0) * (cfg.outMax - cfg.outMin);
+    return (uint8_t)floor(mapped + 0.5);
+}
+
+void mixerInit() {
+    for (int a = 0; a < MIXER_AXIS_COUNT; a++) {
+        mixerSetAxis((MixerAxis)a, axisConfig[a]);
+    }
+}
+
+bool mixerSetAxis(MixerAxis axis, const MixerAxisConfig& cfg) {
+    if (axis >= MIXER_AXIS_COUNT || cfg.outMin >= cfg.outMax) return false;
+    if (cfg.expo < -100 || cfg.expo > 100) return false;
+
+    // Строим в неактивной копии, затем публикуем указатель
+    uint8_t* next = (activeTable[axis] == tables[axis][0]) ? tables[axis][1]
+                                                           : tables[axis][0];
+    for (int v = 0; v < MIXER_TABLE_SIZE; v++) {
+        next[v] = tableValue(cfg, v);
+    }
+    axisConfig[axis] = cfg;
+    activeTable[axis] = next;
+    return true;
+}
+
+MixerAxisConfig mixerGetAxis(MixerAxis axis) {
+    return axisConfig[axis < MIXER_AXIS_COUNT ? axis : MIXER_AXIS_X];
+}
+
+const uint8_t* mixerGetTable(MixerAxis axis) {
+    return activeTable[axis < MIXER_AXIS_COUNT ? axis : MIXER_AXIS_X];
+}
+
+int16_t mixerShape(MixerAxis axis, int16_t v) {
+    if (v > 255)  v = 255;
+    if (v < -255) v = -255;
+    const uint8_t* table = activeTable[axis];
+    return (v >= 0) ? table[v] : -(int16_t)table[-v];
+}
+
+void mixerMix(int16_t x, int16_t y, int16_t* left, int16_t* right) {
+    int32_t l = y + x;
+    int32_t r = y - x;
+
+    // Нормализация с сохранением пропорций: k = ⌈255·2^16 / max⌉ (Q16)
+    uint32_t al = abs(l), ar = abs(r);
+    uint32_t maxVal = (al > ar) ? al : ar;
+    if (maxVal > 255) {
+        uint32_t k = ((255u << 16) + maxVal - 1) / maxVal;
+        al = (al * k) >> 16;
+        ar = (ar * k) >> 16;
+        l = (l < 0) ? -(int32_t)al : (int32_t)al;
+        r = (r < 0) ? -(int32_t)ar : (int32_t)ar;
+    }
+
+    *left  = (int16_t)l;
+    *right = (int16_t)r;
+}
@@ -0,0 +1,79 @@
+/**
+ * ============================================================
+ * 🎚️ mixer.h — Skid-steer микшер с expo/ремапом на таблицах
+ * ============================================================
+ *
+ * Конвейер оси (X — руль, Y — газ):
+ *   |v| → таблица 256 байт (expo + ремап в диапазон мотора) → знак
+ *
+ * Затем микширование (целочисленное):
+ *   left  = Y + X
+ *   right = Y − X
+ *   при max(|left|, |right|) > 255 — масштаб обратной величиной
+ *   в Q16 (одно деление на команду, без float)
+ *
+ * Таблицы пересчитываются при смене настроек оси (mixerSetAxis)
+ * по тем же формулам, что ControlService._applyExpo/_remapOutput
+ * в data/control.js — клиентам больше не нужно их повторять.
+ * По умолчанию таблицы линейные (expo 0, диапазон 0..255).
+ *
+ * Модуль не зависит от Arduino/IDF — таблицы и микширование
+ * сверяются с JS на хосте (test/test_mixer).
+ *
+ * Потоки: настройку меняет задача httpd, читает задача
+ * управления. Таблица строится в неактивной копии и
+ * публикуется сменой указателя.
+ *
+ * ============================================================
+ */
+
+#ifndef MIXER_H
+#define MIXER_H
+
+#include <stdint.h>
+
+#define MIXER_TABLE_SIZE 256
+
+enum MixerAxis : uint8_t {
+    MIXER_AXIS_X = 0,    // Руль
+    MIXER_AXIS_Y,        // Газ
+    MIXER_AXIS_COUNT
+};
+
+// --- Настройки оси ---
+struct MixerAxisConfig {
+    int8_t  expo;        // Expo −100..+100 % (0 — линейная, >0 — мягкий центр)
+    uint8_t outMin;      // Мин. PWM выхода при ненулевом входе (мёртвая зона мотора)
+    uint8_t outMax;      // Макс. PWM выхода
+};
+
+/** @brief Построить линейные таблицы. Вызывается из controlInit(). */
+void mixerInit();
+
+/**
+ * @brief Задать настройки оси и пересчитать её таблицу
+ * @return false если ось неверна или outMin >= outMax
+ */
+bool mixerSetAxis(MixerAxis axis, const MixerAxisConfig& cfg);
+
+/** @brief Текущие настройки оси */
+MixerAxisConfig mixerGetAxis(MixerAxis axis);
+
+/** @brief Текущая таблица оси (MIXER_TABLE_SIZE байт: |вход| → |выход|) */
+const uint8_t* mixerGetTable(MixerAxis axis);
+
+/**
+ * @brief Применить таблицу оси к значению со знаком
+ * @param v −255..+255 (ограничивается)
+ */
+int16_t mixerShape(MixerAxis axis, int16_t v);
+
+/**
+ * @brief Skid-steer микширование уже сформированных осей
+ * @param x,y   Оси после mixerShape()
+ * @param left  [out] −255..+255
+ * @param right [out] −255..+255
+ */
+void mixerMix(int16_t x, int16_t y, int16_t* left, int16_t* right);
+
+#endif // MIXER_H
@@ -0,0 +1,95 @@
+/**
+ * ============================================================
+ * 🎯 motion_centroid.cpp — Центр крупнейшей движущейся области
+ * ============================================================
+ *
+ * Маска: 0 — покой, 1 — движение, 2 — уже в какой-то области.
+ * Пиксель помечается при ЗАКЛАДКЕ в стек, поэтому каждый попадает
+ * в стек не больше одного раза и стека w × h хватает всегда.
+ *
+ * На 80×60 весь проход — ~5 тыс. пикселей, доли миллисекунды
+ * против десятков на декодирование JPEG.
+ *
+ * ============================================================
+ */
+
+#include "motion_centroid.h"
+#include "scene_change.h"
+#include <string.h>
+
+void motionLumaRgb565(const uint8_t* rgb, uint16_t w, uint16_t h, uint8_t* luma) {
+    uint32_t n = (uint32_t)w * h;
+    for (uint32_t i = 0; i < n; i++) luma[i] = rgb565Luma(rgb + 2 * i);
+}
+
+bool motionCentroid(const uint8_t* cur, const uint8_t* prev, uint16_t w, uint16_t h,
+                    const MotionParams& p, uint8_t* mask, uint16_t* stack,
+                    MotionResult* out) {
+    memset(out, 0, sizeof(*out));
+    uint32_t n = (uint32_t)w * h;
+    if (n == 0 || n > 0xFFFF) return false;
+
+    // Общий сдвиг яркости (экспозиция, освещение)
+    int32_t shift = 0;
+    for (uint32_t i = 0; i < n; i++) shift += (int32_t)cur[i] - prev[i];
+    shift /= (int32_t)n;
+
+    uint32_t moving = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        int32_t diff = (int32_t)cur[i] - prev[i] - shift;
+        if (diff < 0) diff = -diff;
+        mask[i] = diff > p.pixelDelta;
+        moving += mask[i];
+    }
+    out->moving = moving;
+    if (moving * 100 > (uint32_t)p.maxAreaPct * n) {
+        out->global = true;
+        return false;
+    }
+
+    // Связные области, крупнейшая — цель
+    uint32_t bestArea = 0, bestX = 0, bestY = 0;
+    for (uint32_t seed = 0; seed < n; seed++) {
+        if (mask[seed] != 1) continue;
+        if (out->regions < 255) out->regions++;
+
+        uint32_t top = 0, area = 0, sumX = 0, sumY = 0;
+        mask[seed] = 2;
+        stack[top++] = seed;
+        while (top) {
+            uint16_t i = stack[--top];
+            uint16_t x = i % w, y = i / w;
+            area++;
+            sumX += x;
+            sumY += y;
+            for (int dy = -1; dy <= 1; dy++) {
+                int ny = y + dy;
+                if (ny < 0 || ny >= h) continue;
+                for (int dx = -1; dx <= 1; dx++) {
+                    int nx = x + dx;
+                    if (nx < 0 || nx >= w) continue;
+                    uint16_t j = ny * w + nx;
+                    if (mask[j] != 1) continue;
+                    mask[j] = 2;
+                    stack[top++] = j;
+                }
+            }
+        }
+        if (area > bestArea) {
+            bestArea = area;
+            bestX = sumX;
+            bestY = sumY;
+        }
+    }
+
+    out->area = bestArea;
+    if (bestArea == 0 || bestArea < p.minArea) return false;
+
+    // (среднее − (w−1)/2) / (w/2) × 256, центр пикселя — его середина
+    out->cx = (int16_t)(((int64_t)2 * bestX - (int64_t)bestArea * (w - 1)) * 256 /
+                        ((int64_t)bestArea * w));
+    out->cy = (int16_t)(((int64_t)2 * bestY - (int64_t)bestArea * (h - 1)) * 256 /
+                        ((int64_t)bestArea * h));
+    out->found = true;
+    return true;
+}
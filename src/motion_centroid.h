@@ -0,0 +1,69 @@
+/**
+ * ============================================================
+ * 🎯 motion_centroid.h — Центр крупнейшей движущейся области
+ * ============================================================
+ *
+ * То же, что MotionDetector в браузере (centerOfMass), но на
+ * уменьшенном кадре (VGA / 8 = 80×60) и в целых числах:
+ *
+ *   1. diff[i] = |cur[i] − prev[i] − общий сдвиг|
+ *      (общий сдвиг — разница средних яркостей: автоэкспозиция
+ *      и мигание освещения не «двигают» кадр)
+ *   2. маска: diff > pixelDelta
+ *   3. связные области маски (8-связность, обход явным стеком —
+ *      без рекурсии, стек задачи не растёт)
+ *   4. крупнейшая область: площадь и центр масс
+ *
+ * Если движется больше maxAreaPct кадра — это не цель, а
+ * собственное движение камеры (поворот ровера): global = true,
+ * области не ищутся. Область меньше minArea — шум, found = false.
+ *
+ * Центр — смещение от центра кадра в долях полукадра:
+ * −256 (левый/верхний край) .. +256 (правый/нижний).
+ *
+ * Буферы (маска и стек по w × h) выделяет вызывающий — модуль
+ * не зависит от Arduino/IDF и считается одинаково на хосте.
+ *
+ * ============================================================
+ */
+
+#ifndef MOTION_CENTROID_H
+#define MOTION_CENTROID_H
+
+#include <stdint.h>
+
+// --- Параметры ---
+struct MotionParams {
+    uint8_t  pixelDelta;     // Порог изменения яркости пикселя (0-255)
+    uint16_t minArea;        // Мин. площадь цели (пикселей)
+    uint8_t  maxAreaPct;     // Больше — движется весь кадр (%)
+};
+
+// --- Результат ---
+struct MotionResult {
+    bool     found;          // Есть область не меньше minArea
+    bool     global;         // Движется слишком большая часть кадра
+    uint16_t moving;         // Пикселей маски всего
+    uint16_t area;           // Пикселей крупнейшей области
+    uint8_t  regions;        // Областей (насыщается на 255)
+    int16_t  cx, cy;         // Центр крупнейшей области (−256..256)
+};
+
+/**
+ * @brief Яркости кадра RGB565 (как отдаёт jpg2rgb565)
+ * @param luma [out] w × h байт
+ */
+void motionLumaRgb565(const uint8_t* rgb, uint16_t w, uint16_t h, uint8_t* luma);
+
+/**
+ * @brief Найти крупнейшую движущуюся область
+ * @param cur, prev Яркости текущего и предыдущего кадра (w × h, w × h ≤ 65535)
+ * @param mask      Рабочий буфер w × h байт
+ * @param stack     Рабочий буфер w × h индексов
+ * @return out->found
+ */
+bool motionCentroid(const uint8_t* cur, const uint8_t* prev, uint16_t w, uint16_t h,
+                    const MotionParams& p, uint8_t* mask, uint16_t* stack,
+                    MotionResult* out);
+
+#endif // MOTION_CENTROID_H
@@ -0,0 +1,153 @@
+/**
+ * ============================================================
+ * 📈 ramp.cpp — Ограничитель скорости нарастания и рывка PWM
+ * ============================================================
+ *
+ * Шаг ограничителя (единицы — скважность, секунды):
+ *   1. rate = rateUp при росте, rateDown при спаде
+ *   2. vLimit = min(rate, √(2·jerk·|err|)) — успеть затормозить
+ *   3. vel тянется к ±vLimit не быстрее jerk·dt
+ *      (смена знака vel — сразу в 0: от цели не уходим)
+ *   4. pos += vel·dt, перелёт цели → ровно цель
+ *
+ * После шага, если скорость вышла на постоянную rate, остаток
+ * прямой (до точки начала торможения) отдаётся fade'у LEDC.
+ * Пока fade идёт, модель досчитывает прямую; цель, которую
+ * прямая проскочила бы (в т.ч. 0 при росте), прерывает участок —
+ * шаг считается программно с текущей точки модели.
+ *
+ * ============================================================
+ */
+
+#include "ramp.h"
+#include <math.h>
+#include <string.h>
+
+static const RampProfile profiles[RAMP_PROFILE_COUNT] = {
+    // name      rateUp   rateDown  jerk
+    { "off",     0.0f,    0.0f,     0.0f     },
+    { "soft",    400.0f,  800.0f,   2000.0f  },   // 0→255 ≈ 0.8 с
+    { "normal",  1000.0f, 2000.0f,  10000.0f },   // 0→255 ≈ 0.35 с
+    { "sport",   2500.0f, 4000.0f,  0.0f     },   // 0→255 ≈ 0.1 с, линейно
+};
+
+const RampProfile& rampGetProfile(RampProfileId id) {
+    return profiles[id < RAMP_PROFILE_COUNT ? id : RAMP_OFF];
+}
+
+bool rampProfileByName(const char* name, RampProfileId* id) {
+    for (int i = 0; i < RAMP_PROFILE_COUNT; i++) {
+        if (strcmp(name, profiles[i].name) == 0) {
+            *id = (RampProfileId)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+void rampReset(RampChannel* ch, float pos) {
+    ch->pos = pos;
+    ch->vel = 0.0f;
+    ch->holdUs = 0;
+    ch->holdEnd = pos;
+}
+
+uint8_t rampDuty(const RampChannel* ch) {
+    if (ch->pos <= 0.0f) return 0;
+    if (ch->pos >= 255.0f) return 255;
+    return (uint8_t)(ch->pos + 0.5f);
+}
+
+/**
+ * Шаг ограничителя вне аппаратного fade (см. алгоритм выше).
+ */
+static RampAction stepLimited(RampChannel* ch, const RampProfile& p, uint8_t target,
+                              uint32_t dtUs, uint32_t maxLinearUs,
+                              uint8_t* segDuty, uint32_t* segMs) {
+    float dt = dtUs * 1e-6f;
+
+    // --- Профиль без ограничений ---
+    if (p.rateUp <= 0.0f) {
+        rampReset(ch, target);
+        return RAMP_SOFTWARE;
+    }
+
+    float err = (float)target - ch->pos;
+    if (err == 0.0f) {
+        ch->vel = 0.0f;
+        return RAMP_SOFTWARE;
+    }
+
+    float dir  = (err > 0.0f) ? 1.0f : -1.0f;
+    float rate = (err > 0.0f) ? p.rateUp : p.rateDown;
+    float vLimit = rate;
+    if (p.jerk > 0.0f) {
+        float vBrake = sqrtf(2.0f * p.jerk * fabsf(err));
+        if (vBrake < vLimit) vLimit = vBrake;
+    }
+
+    // Скорость в сторону от цели — сбрасываем сразу
+    if (ch->vel * dir < 0.0f) ch->vel = 0.0f;
+
+    float vDesired = dir * vLimit;
+    if (p.jerk > 0.0f) {
+        float dvMax = p.jerk * dt;
+        float dv = vDesired - ch->vel;
+        if (dv > dvMax)  dv = dvMax;
+        if (dv < -dvMax) dv = -dvMax;
+        ch->vel += dv;
+    } else {
+        ch->vel = vDesired;
+    }
+
+    float step = ch->vel * dt;
+    if (fabsf(step) >= fabsf(err)) {
+        rampReset(ch, target);
+        return RAMP_SOFTWARE;
+    }
+    ch->pos += step;
+
+    // --- Линейный участок → аппаратный fade ---
+    if (maxLinearUs == 0 || fabsf(ch->vel) < rate * 0.999f) return RAMP_SOFTWARE;
+
+    float remaining = fabsf((float)target - ch->pos);
+    if (p.jerk > 0.0f) remaining -= ch->vel * ch->vel / (2.0f * p.jerk);
+    if (remaining <= 0.0f) return RAMP_SOFTWARE;
+
+    uint32_t segUs = (uint32_t)(remaining / fabsf(ch->vel) * 1e6f);
+    if (segUs > maxLinearUs) segUs = maxLinearUs;
+    segUs -= segUs % 1000;                        // fade задаётся в мс
+    if (segUs < 1000 || segUs < 2 * dtUs) return RAMP_SOFTWARE;
+
+    ch->holdUs  = segUs;
+    ch->holdEnd = ch->pos + ch->vel * segUs * 1e-6f;
+    RampChannel end = *ch;
+    end.pos = ch->holdEnd;
+    *segDuty = rampDuty(&end);
+    *segMs   = segUs / 1000;
+    return RAMP_FADE_START;
+}
+
+RampAction rampStep(RampChannel* ch, const RampProfile& p, uint8_t target,
+                    uint32_t dtUs, uint32_t maxLinearUs,
+                    uint8_t* segDuty, uint32_t* segMs) {
+    if (ch->holdUs == 0) return stepLimited(ch, p, target, dtUs, maxLinearUs, segDuty, segMs);
+
+    // --- Цель позади конца участка: fade проскочил бы её — прерываем ---
+    if (((float)target - ch->holdEnd) * ch->vel < 0.0f) {
+        ch->holdUs = 0;
+        ch->holdEnd = ch->pos;
+        stepLimited(ch, p, target, dtUs, 0, segDuty, segMs);
+        return RAMP_FADE_ABORT;
+    }
+
+    // --- Идёт аппаратный fade: досчитываем ту же прямую ---
+    if (dtUs >= ch->holdUs) {
+        ch->pos = ch->holdEnd;
+        ch->holdUs = 0;
+    } else {
+        ch->pos += ch->vel * dtUs * 1e-6f;
+        ch->holdUs -= dtUs;
+    }
+    return RAMP_FADE_HOLD;
+}
@@ -0,0 +1,104 @@
+/**
+ * ============================================================
+ * 📈 ramp.h — Ограничитель скорости нарастания и рывка PWM
+ * ============================================================
+ *
+ * Резкий скачок скважности (джойстик +255 → −255) бьёт по
+ * моторам как мгновенный реверс: бросок тока, просадка питания,
+ * перезагрузка камеры. Ограничитель ведёт выход канала к цели
+ * с заданными профилем скоростями:
+ *
+ *   rateUp   — макс. скорость роста скважности (ед./с)
+ *   rateDown — макс. скорость спада (ед./с), торможение быстрее
+ *   jerk     — макс. изменение скорости (ед./с²), 0 — без
+ *              ограничения рывка (линейная рампа)
+ *
+ * С ограничением рывка рампа получается S-образной: разгон
+ * скорости изменения, участок с постоянной скоростью rate,
+ * торможение к цели без перелёта (v ≤ √(2·jerk·|ошибка|)).
+ *
+ * Линейные участки можно отдать аппаратному fade'у LEDC:
+ * rampStep() возвращает RAMP_FADE_START с конечной точкой и
+ * длительностью участка, после чего канал «удерживается»
+ * (RAMP_FADE_HOLD) — модель досчитывает ту же прямую, а
+ * вызывающий не пишет в LEDC, пока fade не закончится.
+ * Новая цель в ту же сторону за концом участка учитывается
+ * после его окончания (участок не длиннее maxLinearUs). Цель
+ * позади конца участка — стоп в ноль, реверс, торможение
+ * раньше — прерывает fade (RAMP_FADE_ABORT): вызывающий сразу
+ * пишет пересчитанный программно выход.
+ *
+ * Модуль не зависит от Arduino/IDF — считается одинаково
+ * на устройстве и на хосте.
+ *
+ * ============================================================
+ */
+
+#ifndef RAMP_H
+#define RAMP_H
+
+#include <stdint.h>
+
+// --- Профили ---
+enum RampProfileId : uint8_t {
+    RAMP_OFF = 0,        // Без ограничений (скачок к цели)
+    RAMP_SOFT,           // Мягкий: медленный разгон, S-кривая
+    RAMP_NORMAL,         // Обычный: S-кривая
+    RAMP_SPORT,          // Резкий: линейная рампа (целиком на LEDC fade)
+    RAMP_PROFILE_COUNT
+};
+
+struct RampProfile {
+    const char* name;    // Имя для API ("off", "soft", "normal", "sport")
+    float rateUp;        // Ед. скважности в секунду при росте (0 — без ограничений)
+    float rateDown;      // Ед. скважности в секунду при спаде
+    float jerk;          // Ед./с² (0 — без ограничения рывка)
+};
+
+// --- Состояние канала ---
+struct RampChannel {
+    float    pos;        // Текущая скважность (модель выхода)
+    float    vel;        // Текущая скорость изменения (ед./с)
+    uint32_t holdUs;     // Остаток линейного участка на аппаратном fade (0 — нет)
+    float    holdEnd;    // Конечная скважность участка
+};
+
+// --- Что сделать с выходом после шага ---
+enum RampAction : uint8_t {
+    RAMP_SOFTWARE = 0,   // Записать rampDuty() (если изменилась)
+    RAMP_FADE_START,     // Запустить fade до segDuty за segMs
+    RAMP_FADE_HOLD,      // Идёт fade — выход не трогать
+    RAMP_FADE_ABORT      // Fade прерван новой целью — записать rampDuty() безусловно
+};
+
+/** @brief Профиль по идентификатору */
+const RampProfile& rampGetProfile(RampProfileId id);
+
+/**
+ * @brief Найти профиль по имени
+ * @return false если имя неизвестно
+ */
+bool rampProfileByName(const char* name, RampProfileId* id);
+
+/** @brief Сбросить канал в заданную скважность (без движения) */
+void rampReset(RampChannel* ch, float pos);
+
+/**
+ * @brief Один шаг ограничителя
+ *
+ * @param ch          Состояние канала
+ * @param p           Профиль
+ * @param target      Целевая скважность 0-255
+ * @param dtUs        Время с прошлого шага (мкс)
+ * @param maxLinearUs Макс. длительность участка для fade (0 — не использовать)
+ * @param segDuty     [out] Конечная скважность fade (RAMP_FADE_START)
+ * @param segMs       [out] Длительность fade в мс (RAMP_FADE_START)
+ */
+RampAction rampStep(RampChannel* ch, const RampProfile& p, uint8_t target,
+                    uint32_t dtUs, uint32_t maxLinearUs,
+                    uint8_t* segDuty, uint32_t* segMs);
+
+/** @brief Скважность выхода, округлённая до 0-255 */
+uint8_t rampDuty(const RampChannel* ch);
+
+#endif // RAMP_H
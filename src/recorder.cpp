@@ -0,0 +1,261 @@
+/**
+ * ============================================================
+ * 🎞️ recorder.cpp — Журнал команд управления и воспроизведение
+ * ============================================================
+ *
+ * Кольцо:
+ *   - пишет только задача управления (recorderAppend), читают
+ *     httpd (скачивание) и recorderReplayStart() — копирование
+ *     20-байтной записи под recMux, без ожиданий
+ *   - total — абсолютный номер следующей записи; в кольце
+ *     записи [total − count, total), count ≤ capacity
+ *   - PSRAM: RECORDER_ENTRIES_PSRAM записей, иначе
+ *     RECORDER_ENTRIES_DRAM во внутренней памяти
+ *
+ * Воспроизведение (задача Replay):
+ *   - журнал копируется в отдельный буфер, запись на время
+ *     прогона выключается (или журнал очищается и пишет прогон)
+ *   - команда i публикуется через интервал stampUs[i] − stampUs[i−1]
+ *     после предыдущей; паузы длиннее RECORDER_REPLAY_MAX_GAP_MS
+ *     сжимаются (watchdog всё равно остановил моторы)
+ *   - в журнал попадают только применённые команды, так что
+ *     схлопнутые почтовым ящиком при записи в прогон не попадут
+ *
+ * Зависимости:
+ *   - control.h   — controlSet*() с источником CTRL_SRC_REPLAY
+ *   - config.h    — RECORDER_*
+ *   - esp_heap_caps — буферы в PSRAM
+ *   - esp_timer   — тайминг воспроизведения
+ *
+ * ============================================================
+ */
+
+#include "recorder.h"
+#include "control.h"
+#include "config.h"
+#include "log.h"
+#include <esp_heap_caps.h>
+#include <esp_timer.h>
+
+static RecorderEntry* ring = NULL;
+static uint32_t       ringCapacity = 0;
+static bool           ringPsram = false;
+static uint32_t       ringTotal = 0;         // Абсолютный номер следующей записи
+static uint32_t       ringCount = 0;         // Записей в кольце
+static bool           recording = false;
+static portMUX_TYPE   recMux = portMUX_INITIALIZER_UNLOCKED;
+
+// --- Воспроизведение ---
+static TaskHandle_t   replayTask = NULL;
+static RecorderEntry* replayBuf = NULL;
+static uint32_t       replayTotal = 0;
+static volatile uint32_t replayed = 0;
+static volatile bool  replayAbort = false;
+static bool           replayRecord = false;   // Прогон пишется в журнал
+static bool           replayPrevRecording = false;
+static uint32_t       replayLease = 0;          // Токен аренды запустившего
+
+void recorderInit() {
+    ring = (RecorderEntry*)heap_caps_malloc(RECORDER_ENTRIES_PSRAM * sizeof(RecorderEntry),
+                                            MALLOC_CAP_SPIRAM);
+    if (ring) {
+        ringCapacity = RECORDER_ENTRIES_PSRAM;
+        ringPsram = true;
+    } else {
+        ring = (RecorderEntry*)malloc(RECORDER_ENTRIES_DRAM * sizeof(RecorderEntry));
+        ringCapacity = ring ? RECORDER_ENTRIES_DRAM : 0;
+    }
+    if (!ring) {
+        Serial.println("❌ Recorder: нет памяти под журнал");
+        return;
+    }
+
+    recording = RECORDER_AUTOSTART;
+    Serial.printf("✅ Recorder: %lu записей (%s, %u КБ)%s\n",
+                  (unsigned long)ringCapacity, ringPsram ? "PSRAM" : "DRAM",
+                  (unsigned)(ringCapacity * sizeof(RecorderEntry) / 1024),
+                  recording ? ", запись включена" : "");
+}
+
+// ============================================================
+// Кольцо
+// ============================================================
+
+void recorderAppend(const RecorderEntry& entry) {
+    portENTER_CRITICAL(&recMux);
+    if (recording && ring) {
+        ring[ringTotal % ringCapacity] = entry;
+        ringTotal++;
+        if (ringCount < ringCapacity) ringCount++;
+    }
+    portEXIT_CRITICAL(&recMux);
+}
+
+bool recorderSetRecording(bool on) {
+    portENTER_CRITICAL(&recMux);
+    bool prev = recording;
+    recording = on && ring;
+    portEXIT_CRITICAL(&recMux);
+    return prev;
+}
+
+bool recorderClear() {
+    if (replayTask) return false;
+    portENTER_CRITICAL(&recMux);
+    ringTotal = 0;
+    ringCount = 0;
+    portEXIT_CRITICAL(&recMux);
+    return true;
+}
+
+RecorderStatus recorderGetStatus() {
+    RecorderStatus st;
+    portENTER_CRITICAL(&recMux);
+    st.recording = recording;
+    st.count     = ringCount;
+    st.total     = ringTotal;
+    portEXIT_CRITICAL(&recMux);
+    st.replaying   = replayTask != NULL;
+    st.psram       = ringPsram;
+    st.capacity    = ringCapacity;
+    st.replayed    = replayed;
+    st.replayTotal = replayTotal;
+    return st;
+}
+
+size_t recorderRead(uint32_t index, RecorderEntry* out, size_t max) {
+    size_t n = 0;
+    while (n < max) {
+        portENTER_CRITICAL(&recMux);
+        bool inRange = index + n < ringCount;
+        if (inRange) {
+            out[n] = ring[(ringTotal - ringCount + index + n) % ringCapacity];
+        }
+        portEXIT_CRITICAL(&recMux);
+        if (!inRange) break;
+        n++;
+    }
+    return n;
+}
+
+// ============================================================
+// Воспроизведение
+// ============================================================
+
+/**
+ * Опубликовать команду записи от имени источника Replay.
+ * @return false — отклонено арендой
+ */
+static bool replayEntry(const RecorderEntry& e) {
+    switch (e.kind) {
+        case CMD_STOP:
+            return controlStop(CTRL_SRC_REPLAY, replayLease);
+        case CMD_MOVEMENT:
+            return controlSetMovement((ControlDirection)e.direction, e.speed, CTRL_SRC_REPLAY, replayLease);
+        case CMD_XY:
+            return controlSetXY(e.x, e.y, CTRL_SRC_REPLAY, replayLease);
+        case CMD_DRIVE: {
+            DriveState d;
+            memcpy(d.speed, e.drive, sizeof(d.speed));
+            return controlSetDrive(d, CTRL_SRC_REPLAY, replayLease);
+        }
+    }
+    return true;
+}
+
+/**
+ * FreeRTOS-задача: публикует записи с исходными интервалами и завершается.
+ */
+static void replayTaskLoop(void* pvParameters) {
+    int64_t dueUs = esp_timer_get_time();
+    bool leaseLost = false;
+
+    for (uint32_t i = 0; i < replayTotal && !replayAbort; i++) {
+        if (i > 0) {
+            uint32_t gapUs = replayBuf[i].stampUs - replayBuf[i - 1].stampUs;
+            dueUs += min(gapUs, (uint32_t)RECORDER_REPLAY_MAX_GAP_MS * 1000);
+        }
+
+        // Ждём срока (кусками, чтобы вовремя заметить прерывание)
+        while (!replayAbort) {
+            int64_t waitUs = dueUs - esp_timer_get_time();
+            if (waitUs <= 0) break;
+            TickType_t ticks = pdMS_TO_TICKS(min(waitUs / 1000, (int64_t)100));
+            vTaskDelay(ticks > 0 ? ticks : 1);
+        }
+        if (replayAbort) break;
+
+        // Аренду перехватил другой клиент — управление уже его
+        if (!replayEntry(replayBuf[i])) {
+            leaseLost = true;
+            break;
+        }
+        replayed = i + 1;
+    }
+
+    if (replayAbort) controlStop(CTRL_SRC_REPLAY, replayLease);
+    LOG_I("🎞️ Replay: %s, %lu/%lu команд",
+          leaseLost ? "прервано арендой" : replayAbort ? "прервано" : "готово",
+          (unsigned long)replayed, (unsigned long)replayTotal);
+
+    // Прогон с записью оставляет журнал как есть — его и скачивают
+    recorderSetRecording(replayRecord ? false : replayPrevRecording);
+
+    free(replayBuf);
+    replayBuf = NULL;
+    replayTask = NULL;
+    vTaskDelete(NULL);
+}
+
+bool recorderReplayStart(bool record, uint32_t lease) {
+    if (replayTask || !ring) return false;
+
+    // Снимок журнала — запись на время копирования выключена
+    bool prevRecording = recorderSetRecording(false);
+    uint32_t count = recorderGetStatus().count;
+    RecorderEntry* buf = NULL;
+    if (count > 0) {
+        size_t size = count * sizeof(RecorderEntry);
+        buf = (RecorderEntry*)heap_caps_malloc(size, ringPsram ? MALLOC_CAP_SPIRAM : MALLOC_CAP_8BIT);
+    }
+    if (!buf) {
+        recorderSetRecording(prevRecording);
+        return false;
+    }
+    recorderRead(0, buf, count);
+
+    replayBuf = buf;
+    replayTotal = count;
+    replayed = 0;
+    replayAbort = false;
+    replayRecord = record;
+    replayPrevRecording = prevRecording;
+    replayLease = lease;
+    if (record) {
+        recorderClear();
+        recorderSetRecording(true);
+    }
+
+    BaseType_t res = xTaskCreatePinnedToCore(
+        replayTaskLoop,
+        "Replay",
+        3072,
+        NULL,
+        RECORDER_REPLAY_PRIORITY,
+        &replayTask,
+        RECORDER_REPLAY_CORE
+    );
+    if (res != pdPASS) {
+        free(replayBuf);
+        replayBuf = NULL;
+        replayTask = NULL;
+        recorderSetRecording(prevRecording);
+        return false;
+    }
+    LOG_I("🎞️ Replay: %lu команд%s", (unsigned long)count, record ? ", с записью" : "");
+    return true;
+}
+
+void recorderReplayStop() {
+    replayAbort = true;
+}
@@ -0,0 +1,118 @@
+/**
+ * ============================================================
+ * 🎞️ recorder.h — Журнал команд управления и воспроизведение
+ * ============================================================
+ *
+ * Задача управления пишет каждую применённую команду в
+ * бинарное кольцо (PSRAM, при её отсутствии — маленькое в DRAM):
+ * время публикации, источник, параметры команды и цели моторов
+ * ПОСЛЕ применения. X/Y, прошедшие джиттер-буфер, пишутся
+ * отсчётами, которые он применил (X/Y после интерполяции, время
+ * применения). Переполненное кольцо затирает старые записи.
+ *
+ * Журнал скачивается через GET /api/recorder?download=1
+ * (файл .rec — заголовок RecorderFileHeader + записи) и
+ * воспроизводится:
+ *   - на устройстве — задача Replay публикует команды через
+ *     controlSet*(…, CTRL_SRC_REPLAY) с исходными интервалами
+ *     и токеном аренды запустившего клиента;
+ *     с record=true журнал очищается и пишет результат прогона
+ *   - на хосте — tools/recorder.js (разбор, сравнение прогонов,
+ *     повтор по UDP/HTTP)
+ *
+ * Сравнение out[] двух прогонов одного журнала показывает,
+ * изменили ли правки пути управления (микшер, таблицы, режимы)
+ * реакцию на реальный трафик.
+ *
+ * ============================================================
+ */
+
+#ifndef RECORDER_H
+#define RECORDER_H
+
+#include <Arduino.h>
+#include "drive.h"
+
+#define RECORDER_FILE_MAGIC   "RREC"
+#define RECORDER_FILE_VERSION 1
+
+// --- Запись журнала (20 байт, little-endian) ---
+struct __attribute__((packed)) RecorderEntry {
+    uint32_t stampUs;               // esp_timer публикации команды, из буфера — применения (мкс, mod 2^32)
+    uint8_t  source;                // ControlSource
+    uint8_t  kind;                  // ControlCommandKind
+    uint8_t  direction;             // CMD_MOVEMENT: ControlDirection
+    uint8_t  speed;                 // CMD_MOVEMENT: скорость
+    int16_t  x;                     // CMD_XY
+    int16_t  y;                     // CMD_XY
+    uint8_t  drive[MOTOR_COUNT];    // CMD_DRIVE: скорости команды
+    uint8_t  out[MOTOR_COUNT];      // Цели моторов после применения
+};
+
+// --- Заголовок скачиваемого файла (16 байт) ---
+struct __attribute__((packed)) RecorderFileHeader {
+    char     magic[4];              // "RREC"
+    uint8_t  version;               // RECORDER_FILE_VERSION
+    uint8_t  entrySize;             // sizeof(RecorderEntry)
+    uint16_t rateHz;                // CONTROL_RATE_HZ прошивки
+    uint32_t count;                 // Записей в файле
+    uint32_t lost;                  // Затёрто переполнением до начала файла
+};
+
+// --- Состояние ---
+struct RecorderStatus {
+    bool     recording;             // Запись включена
+    bool     replaying;             // Идёт воспроизведение
+    bool     psram;                 // Кольцо в PSRAM
+    uint32_t capacity;              // Ёмкость кольца (записей)
+    uint32_t count;                 // Записей в кольце
+    uint32_t total;                 // Записано с последней очистки
+    uint32_t replayed;              // Отправлено текущим/последним воспроизведением
+    uint32_t replayTotal;           // Записей в воспроизводимом журнале
+};
+
+/**
+ * @brief Выделить кольцо. Вызывать в setup() до controlInit().
+ * Запись включается, если RECORDER_AUTOSTART.
+ */
+void recorderInit();
+
+/**
+ * @brief Добавить запись (только задача управления)
+ * Ничего не делает, если запись выключена.
+ */
+void recorderAppend(const RecorderEntry& entry);
+
+/**
+ * @brief Включить/выключить запись
+ * @return Предыдущее состояние
+ */
+bool recorderSetRecording(bool on);
+
+/** @brief Очистить журнал (не во время воспроизведения) */
+bool recorderClear();
+
+/** @brief Состояние журнала и воспроизведения */
+RecorderStatus recorderGetStatus();
+
+/**
+ * @brief Скопировать записи журнала
+ * @param index Номер первой записи (0 — самая старая в кольце)
+ * @return Скопировано записей (0 — index за концом)
+ */
+size_t recorderRead(uint32_t index, RecorderEntry* out, size_t max);
+
+/**
+ * @brief Запустить воспроизведение журнала на устройстве
+ * @param record true — очистить журнал и записать прогон
+ * @param lease  Токен аренды запустившего (проверен вызывающим) —
+ *               команды прогона идут с ним; вытеснение аренды
+ *               прерывает прогон
+ * @return false если журнал пуст, нет памяти или уже идёт
+ */
+bool recorderReplayStart(bool record, uint32_t lease = 0);
+
+/** @brief Прервать воспроизведение (моторы — стоп) */
+void recorderReplayStop();
+
+#endif // RECORDER_H
@@ -0,0 +1,192 @@
+/**
+ * ============================================================
+ * 📡 rtp_stream.cpp — RTP/UDP MJPEG стрим (RFC 2435)
+ * ============================================================
+ *
+ * Формат пакета (RFC 3550 + RFC 2435):
+ *
+ *   [RTP header 12 B] [JPEG header 8 B] [Q-table header 4 B + 128 B]* [scan]
+ *                                        * только в первом фрагменте кадра
+ *
+ *   RTP:  V=2, PT=26 (JPEG), M=1 на последнем фрагменте кадра,
+ *         timestamp 90 кГц от момента захвата кадра
+ *   JPEG: fragment offset (24 бит), type 0/1, Q=255 (таблицы в потоке),
+ *         width/8, height/8
+ *
+ * Заголовки JFIF не передаются: получатель восстанавливает их
+ * из Q-таблиц и стандартных таблиц Хаффмана (RFC 2435, Appendix A).
+ *
+ * Отправка — non-blocking sendto(). Если у lwIP закончились
+ * буферы, остаток кадра отбрасывается: для пилотирования лучше
+ * потерять кадр, чем получить его с опозданием.
+ *
+ * Зависимости:
+ *   - jpeg_util.h  — разбор заголовка JPEG
+ *   - lwip/sockets — UDP-сокет
+ *   - config.h     — RTP_MTU, RTP_MULTICAST_TTL
+ *
+ * ============================================================
+ */
+
+#include "rtp_stream.h"
+#include "jpeg_util.h"
+#include "config.h"
+#include "log.h"
+#include <esp_system.h>
+#include <lwip/sockets.h>
+
+#define RTP_HEADER_LEN      12
+#define RTP_JPEG_HEADER_LEN 8
+#define RTP_PAYLOAD_JPEG    26
+#define RTP_Q_DYNAMIC       255   // Q >= 128: таблицы передаются в потоке
+
+static int       rtpFd    = -1;      // UDP-сокет
+static uint32_t  rtpSsrc  = 0;       // Идентификатор источника
+static uint16_t  rtpSeq   = 0;       // Номер пакета RTP
+
+// Адресат (меняется из httpd, читается стрим-задачей)
+static portMUX_TYPE rtpMux = portMUX_INITIALIZER_UNLOCKED;
+static uint32_t  rtpDestIp   = 0;
+static uint16_t  rtpDestPort = 0;
+
+static RtpStreamStats rtpStats = {0, 0, 0, 0, 0};
+
+bool rtpStreamInit() {
+    rtpFd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (rtpFd < 0) {
+        Serial.println("❌ RTP: ошибка создания сокета");
+        return false;
+    }
+
+    // TTL multicast — по умолчанию не выходим за пределы LAN
+    uint8_t ttl = RTP_MULTICAST_TTL;
+    setsockopt(rtpFd, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof(ttl));
+
+    rtpSsrc = esp_random();
+    rtpSeq  = (uint16_t)esp_random();
+    return true;
+}
+
+void rtpStreamStart(uint32_t destIp, uint16_t port) {
+    portENTER_CRITICAL(&rtpMux);
+    rtpDestIp   = destIp;
+    rtpDestPort = port;
+    portEXIT_CRITICAL(&rtpMux);
+
+    struct in_addr a;
+    a.s_addr = destIp;
+    LOG_I("📡 RTP стрим → %s:%u", inet_ntoa(a), port);
+}
+
+void rtpStreamStop() {
+    portENTER_CRITICAL(&rtpMux);
+    rtpDestIp   = 0;
+    rtpDestPort = 0;
+    portEXIT_CRITICAL(&rtpMux);
+    LOG_I("📡 RTP стрим остановлен");
+}
+
+bool rtpStreamGetDest(uint32_t* destIp, uint16_t* port) {
+    portENTER_CRITICAL(&rtpMux);
+    uint32_t ip = rtpDestIp;
+    uint16_t p  = rtpDestPort;
+    portEXIT_CRITICAL(&rtpMux);
+
+    if (destIp) *destIp = ip;
+    if (port)   *port   = p;
+    return ip != 0 && p != 0;
+}
+
+bool rtpStreamActive() {
+    return rtpFd >= 0 && rtpStreamGetDest(NULL, NULL);
+}
+
+RtpStreamStats rtpStreamGetStats() {
+    return rtpStats;
+}
+
+// Запись 16/24/32-битных big-endian значений
+static inline void putBe16(uint8_t* p, uint16_t v) { p[0] = v >> 8; p[1] = v; }
+static inline void putBe24(uint8_t* p, uint32_t v) { p[0] = v >> 16; p[1] = v >> 8; p[2] = v; }
+static inline void putBe32(uint8_t* p, uint32_t v) { p[0] = v >> 24; p[1] = v >> 16; p[2] = v >> 8; p[3] = v; }
+
+void rtpSendFrame(const camera_fb_t* fb) {
+    uint32_t destIp;
+    uint16_t destPort;
+    if (rtpFd < 0 || !rtpStreamGetDest(&destIp, &destPort)) return;
+
+    struct sockaddr_in dest;
+    memset(&dest, 0, sizeof(dest));
+    dest.sin_family      = AF_INET;
+    dest.sin_addr.s_addr = destIp;
+    dest.sin_port        = htons(destPort);
+
+    JpegInfo jpeg;
+    if (!jpegParse(fb->buf, fb->len, &jpeg)) {
+        rtpStats.framesSkipped++;
+        return;
+    }
+
+    // RTP timestamp — 90 кГц от момента захвата
+    uint64_t captureUs = (uint64_t)fb->timestamp.tv_sec * 1000000ULL + fb->timestamp.tv_usec;
+    uint32_t rtpTs = (uint32_t)(captureUs * 9 / 100);
+
+    static uint8_t packet[RTP_MTU];
+    const uint8_t* scan = fb->buf + jpeg.headerLen;
+    size_t offset = 0;
+
+    while (offset < jpeg.scanLen) {
+        uint8_t* p = packet;
+
+        // --- RTP header ---
+        p[0] = 0x80;                        // V=2, P=0, X=0, CC=0
+        p[1] = RTP_PAYLOAD_JPEG;            // M выставляется ниже
+        putBe16(p + 2, rtpSeq++);
+        putBe32(p + 4, rtpTs);
+        putBe32(p + 8, rtpSsrc);
+        p += RTP_HEADER_LEN;
+
+        // --- JPEG header ---
+        p[0] = 0;                           // Type-specific
+        putBe24(p + 1, offset);             // Fragment offset
+        p[4] = jpeg.rtpType;
+        p[5] = RTP_Q_DYNAMIC;
+        p[6] = jpeg.width / 8;
+        p[7] = jpeg.height / 8;
+        p += RTP_JPEG_HEADER_LEN;
+
+        // --- Quantization Table header (только первый фрагмент) ---
+        if (offset == 0) {
+            uint16_t qLen = jpeg.qtableCount * 64;
+            p[0] = 0;                       // MBZ
+            p[1] = 0;                       // Precision: 8 бит
+            putBe16(p + 2, qLen);
+            p += 4;
+            for (uint8_t t = 0; t < jpeg.qtableCount; t++) {
+                memcpy(p, jpeg.qtables[t], 64);
+                p += 64;
+            }
+        }
+
+        size_t room  = RTP_MTU - (p - packet);
+        size_t chunk = min(room, jpeg.scanLen - offset);
+        memcpy(p, scan + offset, chunk);
+        p += chunk;
+        offset += chunk;
+
+        if (offset >= jpeg.scanLen) packet[1] |= 0x80;  // Marker: конец кадра
+
+        size_t pktLen = p - packet;
+        int n = sendto(rtpFd, packet, pktLen, MSG_DONTWAIT,
+                       (struct sockaddr*)&dest, sizeof(dest));
+        if (n < 0) {
+            // Нет буферов — бросаем остаток кадра, следующий придёт вовремя
+            rtpStats.framesDropped++;
+            return;
+        }
+        rtpStats.packets++;
+        rtpStats.bytes += pktLen;
+    }
+
+    rtpStats.frames++;
+}
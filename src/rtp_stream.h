@@ -0,0 +1,69 @@
+/**
+ * ============================================================
+ * 📡 rtp_stream.h — RTP/UDP MJPEG стрим (RFC 2435)
+ * ============================================================
+ *
+ * Альтернатива TCP-стриму на порту 81 для управления ровером:
+ * потерянный UDP-пакет = потерянный кадр, но без ретрансмитов
+ * и накопления задержки.
+ *
+ * Адресат — один unicast-получатель или multicast-группа
+ * (любое кол-во зрителей в LAN за одну отправку в эфир).
+ *
+ * Кадры передаёт streamServerTask() — каждый захваченный кадр
+ * уходит в RTP целиком, независимо от round-robin TCP-клиентов.
+ *
+ * ============================================================
+ */
+
+#ifndef RTP_STREAM_H
+#define RTP_STREAM_H
+
+#include <Arduino.h>
+#include <esp_camera.h>
+
+// --- Статистика RTP-стрима ---
+struct RtpStreamStats {
+    uint32_t frames;         // Отправлено кадров целиком
+    uint32_t framesDropped;  // Кадров, оборванных ошибкой sendto (нет буферов lwIP)
+    uint32_t framesSkipped;  // Кадров, не разобранных jpegParse()
+    uint32_t packets;        // Отправлено RTP-пакетов
+    uint32_t bytes;          // Отправлено байт (RTP payload + заголовки)
+};
+
+/**
+ * @brief Создать UDP-сокет RTP. Вызывать в setup() после WiFi.
+ * @return true — сокет готов
+ */
+bool rtpStreamInit();
+
+/**
+ * @brief Начать RTP-стрим на адрес (unicast или multicast 224.0.0.0/4)
+ * @param destIp Адрес получателя в network byte order
+ * @param port   UDP-порт получателя
+ */
+void rtpStreamStart(uint32_t destIp, uint16_t port);
+
+/** @brief Остановить RTP-стрим */
+void rtpStreamStop();
+
+/** @brief Активен ли RTP-стрим (есть адресат) */
+bool rtpStreamActive();
+
+/**
+ * @brief Получить адресат стрима
+ * @return false если стрим не активен
+ */
+bool rtpStreamGetDest(uint32_t* destIp, uint16_t* port);
+
+/**
+ * @brief Разбить JPEG-кадр на RTP-пакеты и отправить адресату
+ * Вызывается из streamServerTask() для каждого кадра.
+ * @param fb Кадр камеры (JPEG)
+ */
+void rtpSendFrame(const camera_fb_t* fb);
+
+/** @brief Получить статистику отправки */
+RtpStreamStats rtpStreamGetStats();
+
+#endif // RTP_STREAM_H
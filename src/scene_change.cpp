@@ -0,0 +1,82 @@
+/**
+ * ============================================================
+ * 👁️ scene_change.cpp — Детектор резкой смены сцены
+ * ============================================================
+ *
+ * Яркость пикселя — rgb565Luma(): (2R + 5G + B) / 8 по 5/6/5
+ * битам, без умножений с плавающей точкой. Сетка 8×4 на кадре 80×60
+ * (VGA / 8) — блоки по 10 пикселей в ширину.
+ *
+ * ============================================================
+ */
+
+#include "scene_change.h"
+#include <string.h>
+
+void sceneReset(SceneDetector* d) {
+    memset(d, 0, sizeof(*d));
+}
+
+void sceneGridRgb565(const uint8_t* rgb, uint16_t w, uint16_t h, uint8_t roiPct,
+                     uint8_t* grid) {
+    uint32_t sum[SCENE_GRID] = {};
+    uint32_t cnt[SCENE_GRID] = {};
+
+    if (roiPct == 0 || roiPct > 100) roiPct = 100;
+    uint16_t roiH = (uint32_t)h * roiPct / 100;
+    if (roiH == 0) roiH = 1;
+    uint16_t top = h - roiH;
+
+    for (uint16_t y = top; y < h; y++) {
+        uint8_t gy = (uint32_t)(y - top) * SCENE_GRID_H / roiH;
+        const uint8_t* row = rgb + (uint32_t)y * w * 2;
+        for (uint16_t x = 0; x < w; x++) {
+            uint8_t gx = (uint32_t)x * SCENE_GRID_W / w;
+            sum[gy * SCENE_GRID_W + gx] += rgb565Luma(row + 2 * x);
+            cnt[gy * SCENE_GRID_W + gx]++;
+        }
+    }
+    for (int i = 0; i < SCENE_GRID; i++) {
+        grid[i] = cnt[i] ? sum[i] / cnt[i] : 0;
+    }
+}
+
+bool sceneUpdate(SceneDetector* d, const SceneParams& p, const uint8_t* grid, uint32_t nowUs) {
+    bool fresh = d->hasPrev && (uint32_t)(nowUs - d->prevUs) <= p.maxGapUs;
+    if (!fresh) {
+        memcpy(d->prev, grid, SCENE_GRID);
+        d->hasPrev = true;
+        d->prevUs = nowUs;
+        d->lastScore = 0;
+        return false;
+    }
+
+    // Общий сдвиг яркости (экспозиция, освещение)
+    int32_t shift = 0;
+    for (int i = 0; i < SCENE_GRID; i++) shift += (int32_t)grid[i] - d->prev[i];
+    shift /= SCENE_GRID;
+
+    uint8_t changed = 0;
+    for (int i = 0; i < SCENE_GRID; i++) {
+        int32_t diff = (int32_t)grid[i] - d->prev[i] - shift;
+        if (diff < 0) diff = -diff;
+        if (diff > p.blockDelta) changed++;
+    }
+    uint8_t score = changed * 100 / SCENE_GRID;
+
+    memcpy(d->prev, grid, SCENE_GRID);
+    d->prevUs = nowUs;
+    d->lastScore = score;
+    d->frames++;
+
+    bool trigger = score >= p.triggerPct &&
+                   ((uint32_t)score << 4) * 16 >= (uint32_t)d->baselineQ4 * p.spikeRatioQ4;
+    if (trigger) {
+        d->triggers++;
+    } else {
+        // Фон — только спокойные кадры, вес нового 1/8
+        int32_t s = (int32_t)score << 4;
+        d->baselineQ4 += (s - (int32_t)d->baselineQ4) / 8;
+    }
+    return trigger;
+}
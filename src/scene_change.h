@@ -0,0 +1,92 @@
+/**
+ * ============================================================
+ * 👁️ scene_change.h — Детектор резкой смены сцены перед ровером
+ * ============================================================
+ *
+ * Кадр уменьшается до сетки средних яркостей нижней части поля
+ * зрения (SCENE_GRID_W × SCENE_GRID_H блоков) — там пол перед
+ * колёсами и всё, что на него выходит. Каждая сетка
+ * сравнивается с предыдущей:
+ *
+ *   diff[i] = |cur[i] − prev[i] − общий сдвиг|
+ *
+ * Общий сдвиг — разница средних яркостей кадров, так что
+ * автоэкспозиция и мигание освещения блоки не «меняют».
+ * Блок изменился, если diff > blockDelta; доля изменившихся
+ * блоков — score (0-100 %).
+ *
+ * На ходу пол «течёт» и score не ноль даже без препятствий.
+ * Поэтому срабатывание — РЕЗКИЙ скачок относительно фона:
+ *
+ *   score ≥ triggerPct  и  score ≥ baseline × spikeRatio
+ *
+ * baseline — EMA score спокойных кадров (вес 1/8), кадры со
+ * срабатыванием в неё не попадают. После разрыва дольше
+ * maxGapUs (камера спала, ровер стоял) первая сетка только
+ * запоминается — сравнивать с устаревшим кадром нельзя.
+ *
+ * Модуль не зависит от Arduino/IDF — считается одинаково
+ * на устройстве и на хосте.
+ *
+ * ============================================================
+ */
+
+#ifndef SCENE_CHANGE_H
+#define SCENE_CHANGE_H
+
+#include <stdint.h>
+
+#define SCENE_GRID_W 8
+#define SCENE_GRID_H 4
+#define SCENE_GRID   (SCENE_GRID_W * SCENE_GRID_H)
+
+/**
+ * @brief Яркость пикселя RGB565 (старший байт первым): (2R + 5G + B) / 8
+ */
+static inline uint8_t rgb565Luma(const uint8_t* px) {
+    uint16_t v = ((uint16_t)px[0] << 8) | px[1];
+    uint32_t r = (v >> 11) << 3;             // 0-248
+    uint32_t g = ((v >> 5) & 0x3F) << 2;     // 0-252
+    uint32_t b = (v & 0x1F) << 3;            // 0-248
+    return (2 * r + 5 * g + b) >> 3;
+}
+
+// --- Параметры ---
+struct SceneParams {
+    uint8_t  blockDelta;     // Порог изменения яркости блока (0-255)
+    uint8_t  triggerPct;     // Мин. доля изменившихся блоков (%)
+    uint8_t  spikeRatioQ4;   // Во сколько раз выше фона (Q4: 16 = ×1)
+    uint32_t maxGapUs;       // Разрыв, после которого сравнение начинается заново
+};
+
+// --- Состояние детектора ---
+struct SceneDetector {
+    uint8_t  prev[SCENE_GRID];
+    bool     hasPrev;
+    uint32_t prevUs;         // Время предыдущей сетки
+    uint16_t baselineQ4;     // Фон score (Q4, %)
+    uint8_t  lastScore;      // Score последнего кадра (%)
+    uint32_t frames;         // Сравнений
+    uint32_t triggers;       // Срабатываний
+};
+
+/** @brief Сбросить детектор (фон и предыдущий кадр) */
+void sceneReset(SceneDetector* d);
+
+/**
+ * @brief Сетка средних яркостей нижней части кадра RGB565
+ * @param rgb    Пиксели RGB565 (как отдаёт jpg2rgb565: старший байт первым)
+ * @param roiPct Высота области снизу кадра (% высоты, 1-100)
+ * @param grid   [out] SCENE_GRID яркостей 0-255, построчно
+ */
+void sceneGridRgb565(const uint8_t* rgb, uint16_t w, uint16_t h, uint8_t roiPct,
+                     uint8_t* grid);
+
+/**
+ * @brief Сравнить сетку с предыдущей
+ * @param nowUs Время кадра (мкс, по модулю 2^32)
+ * @return true — резкая смена сцены (срабатывание)
+ */
+bool sceneUpdate(SceneDetector* d, const SceneParams& p, const uint8_t* grid, uint32_t nowUs);
+
+#endif // SCENE_CHANGE_H
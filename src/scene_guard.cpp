@@ -0,0 +1,149 @@
+/**
+ * ============================================================
+ * 👁️ scene_guard.cpp — Защита хода вперёд по смене сцены
+ * ============================================================
+ *
+ * Потребитель кадров Vision (vision.h), всё — в задаче Vision:
+ *   - sceneGuardPoll():    снять потолок, если удержание истекло;
+ *                          взвести/разоружить по ходу вперёд
+ *   - sceneGuardOnFrame(): сетка яркостей → sceneUpdate()
+ *
+ * reactUs считается от снимка кадра (fb->timestamp), то есть
+ * включает ожидание в очереди и декодирование.
+ *
+ * Зависимости:
+ *   - scene_change.h — сетка и детектор
+ *   - drive.h        — driveSetForwardCap(), цели и выход FL/FR
+ *   - vision.h       — пробуждение задачи при включении/выключении
+ *   - config.h       — SCENE_*
+ *
+ * ============================================================
+ */
+
+#include "scene_guard.h"
+#include "scene_change.h"
+#include "vision.h"
+#include "drive.h"
+#include "config.h"
+#include "log.h"
+#include <atomic>
+#include <esp_timer.h>
+
+static const SceneParams params = {
+    SCENE_BLOCK_DELTA,
+    SCENE_TRIGGER_PCT,
+    SCENE_SPIKE_RATIO_Q4,
+    (uint32_t)SCENE_MAX_GAP_MS * 1000
+};
+
+static portMUX_TYPE  guardMux = portMUX_INITIALIZER_UNLOCKED;
+static SceneGuardStats stats = {};                       // Под guardMux
+static std::atomic<bool> guardEnabled(SCENE_GUARD_ENABLE);
+static std::atomic<bool> guardArmed(false);
+
+// --- Только задача Vision ---
+static SceneDetector detector;
+static int64_t       capUntilUs = 0;                     // 0 — потолка нет
+
+static inline uint32_t ema(uint32_t avg, uint32_t sample) {
+    return avg == 0 ? sample : avg - avg / 8 + sample / 8;
+}
+
+/** Ровер едет или собирается ехать вперёд */
+static bool wantsForward() {
+    const DriveState& target = driveGetState();
+    const DriveState& out = driveGetOutput();
+    return target.speed[MOTOR_FL] || target.speed[MOTOR_FR] ||
+           out.speed[MOTOR_FL] || out.speed[MOTOR_FR];
+}
+
+static void releaseCap(const char* why) {
+    capUntilUs = 0;
+    driveSetForwardCap(PWM_MAX_DUTY);
+    portENTER_CRITICAL(&guardMux);
+    stats.capped = false;
+    portEXIT_CRITICAL(&guardMux);
+    LOG_I("👁️ Scene guard: ход вперёд разрешён (%s)", why);
+}
+
+bool sceneGuardInit() {
+    sceneReset(&detector);
+    stats.enabled = guardEnabled.load();
+
+    Serial.printf("✅ Scene guard (%s, %s вперёд)\n",
+                  stats.enabled ? "включена" : "выключена",
+                  SCENE_CAP_DUTY == 0 ? "отсечка" : "потолок");
+    return true;
+}
+
+void sceneGuardPoll(int64_t nowUs) {
+    bool enabled = guardEnabled.load();
+    if (capUntilUs && (!enabled || nowUs >= capUntilUs)) {
+        releaseCap(enabled ? "удержание истекло" : "защита выключена");
+    }
+
+    bool armed = enabled && wantsForward();
+    if (armed != guardArmed.load()) {
+        guardArmed.store(armed);
+        portENTER_CRITICAL(&guardMux);
+        stats.armed = armed;
+        portEXIT_CRITICAL(&guardMux);
+    }
+}
+
+bool sceneGuardWants() {
+    return guardArmed.load();
+}
+
+void sceneGuardOnFrame(const uint8_t* rgb, uint16_t w, uint16_t h, uint32_t frameUs) {
+    int64_t t0 = esp_timer_get_time();
+
+    uint8_t grid[SCENE_GRID];
+    sceneGridRgb565(rgb, w, h, SCENE_ROI_PCT, grid);
+    bool hit = sceneUpdate(&detector, params, grid, frameUs);
+
+    int64_t now = esp_timer_get_time();
+    bool newly = false;
+    if (hit) {
+        driveSetForwardCap(SCENE_CAP_DUTY);
+        newly = capUntilUs == 0;
+        capUntilUs = now + (int64_t)SCENE_HOLD_MS * 1000;
+    }
+    uint32_t analyzeUs = (uint32_t)(now - t0);
+    uint32_t reactUs = (uint32_t)now - frameUs;
+
+    portENTER_CRITICAL(&guardMux);
+    stats.frames++;
+    stats.score = detector.lastScore;
+    stats.baseline = detector.baselineQ4 >> 4;
+    stats.analyzeUsAvg = ema(stats.analyzeUsAvg, analyzeUs);
+    if (analyzeUs > stats.analyzeUsMax) stats.analyzeUsMax = analyzeUs;
+    if (hit) {
+        stats.capped = true;
+        stats.triggers++;
+        stats.reactUsLast = reactUs;
+        if (reactUs > stats.reactUsMax) stats.reactUsMax = reactUs;
+    }
+    portEXIT_CRITICAL(&guardMux);
+
+    if (newly) {
+        LOG_W("👁️ Scene guard: смена сцены %u%% (фон %u%%) — %s вперёд, %lu мкс от кадра",
+              detector.lastScore, detector.baselineQ4 >> 4,
+              SCENE_CAP_DUTY == 0 ? "отсечка" : "потолок", (unsigned long)reactUs);
+    }
+}
+
+void sceneGuardSetEnabled(bool on) {
+    guardEnabled.store(on);
+    portENTER_CRITICAL(&guardMux);
+    stats.enabled = on;
+    portEXIT_CRITICAL(&guardMux);
+    visionWake();                                // Снять потолок сразу
+}
+
+SceneGuardStats sceneGuardGetStats() {
+    portENTER_CRITICAL(&guardMux);
+    SceneGuardStats st = stats;
+    portEXIT_CRITICAL(&guardMux);
+    return st;
+}
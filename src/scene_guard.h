@@ -0,0 +1,68 @@
+/**
+ * ============================================================
+ * 👁️ scene_guard.h — Защита хода вперёд по смене сцены
+ * ============================================================
+ *
+ * Без видеосвязи единственная защита — watchdog CONTROL_TIMEOUT_MS,
+ * и за 2 с ровер успевает въехать в то, что MotionDetector в
+ * браузере заметил бы. Защита работает на устройстве и не
+ * требует клиента:
+ *
+ *   - пока цель или выход каналов «вперёд» (FL/FR) не ноль,
+ *     каждый кадр уменьшается декодером JPEG в 8 раз (80×60) и
+ *     идёт в детектор резкой смены сцены (scene_change.h)
+ *   - кадры даёт задача Vision (vision.h): стрим или свой
+ *     захват раз в VISION_SELF_CAPTURE_MS (камера не уснёт)
+ *   - срабатывание — driveSetForwardCap(SCENE_CAP_DUTY): потолок
+ *     или отсечка FL/FR на ближайшем тике управления (≤ 5 мс),
+ *     то есть в пределах периода кадра. Назад ехать можно.
+ *   - потолок держится SCENE_HOLD_MS с последнего срабатывания
+ *
+ * Детектор ловит ВНЕЗАПНОЕ изменение (выбежал человек, открылась
+ * дверь, край стола), а не медленное приближение к стоящему
+ * препятствию — это не дальномер, а страховка на время без связи.
+ *
+ * ============================================================
+ */
+
+#ifndef SCENE_GUARD_H
+#define SCENE_GUARD_H
+
+#include <Arduino.h>
+
+// --- Статистика ---
+struct SceneGuardStats {
+    bool     enabled;
+    bool     armed;           // Ровер едет вперёд — кадры анализируются
+    bool     capped;          // Потолок «вперёд» действует
+    uint8_t  score;           // Доля изменившихся блоков, последний кадр (%)
+    uint8_t  baseline;        // Фон score на ходу (%)
+    uint32_t frames;          // Проанализировано кадров
+    uint32_t triggers;        // Срабатываний
+    uint32_t analyzeUsAvg;    // Сетка + сравнение (мкс, EMA; декодирование — в VisionStats)
+    uint32_t analyzeUsMax;
+    uint32_t reactUsLast;     // Снимок кадра → потолок выставлен (мкс)
+    uint32_t reactUsMax;
+};
+
+/** @brief Сбросить детектор. Вызывать до visionInit(). */
+bool sceneGuardInit();
+
+// --- Потребитель Vision (вызываются только из задачи Vision) ---
+
+/** @brief Снять истёкший потолок, взвести/разоружить защиту */
+void sceneGuardPoll(int64_t nowUs);
+
+/** @brief Защита взведена — нужны кадры */
+bool sceneGuardWants();
+
+/** @brief Кадр 1/8 RGB565; frameUs — время снимка (esp_timer) */
+void sceneGuardOnFrame(const uint8_t* rgb, uint16_t w, uint16_t h, uint32_t frameUs);
+
+/** @brief Включить/выключить защиту (выключение снимает потолок) */
+void sceneGuardSetEnabled(bool on);
+
+/** @brief Статистика (копия) */
+SceneGuardStats sceneGuardGetStats();
+
+#endif // SCENE_GUARD_H
@@ -0,0 +1,108 @@
+/**
+ * ============================================================
+ * 🔢 seqlock.h — Версионированное значение для читателей без блокировок
+ * ============================================================
+ *
+ * Писатели публикуют значение, читатели копируют его, не беря
+ * никаких блокировок и не задерживая писателя. Читатель, попавший
+ * на запись, просто повторяет копирование.
+ *
+ * Протокол (счётчик seq — std::atomic):
+ *   - запись:  seq → нечётный, изменить значение, seq → чётный
+ *   - чтение:  s1 = seq; копия; s2 = seq; s1 чётный и s1 == s2 —
+ *              копия целостна, иначе повторить
+ *
+ * Писателей может быть несколько (у каждого своя часть значения):
+ * между собой они сериализуются коротким portMUX на время правки
+ * в памяти. Внутри критической секции писатель не вытесняется,
+ * поэтому нечётное окно длится микросекунды и читатель на другом
+ * ядре крутится не дольше. Читатель в критическую секцию не
+ * входит никогда — запись в него не упирается.
+ *
+ * Отличие от mailbox.h: значение не «забирается», его читает
+ * сколько угодно задач сколько угодно раз (последнее
+ * опубликованное). T — тривиально копируемый, небольшой.
+ *
+ * Вне ESP-IDF (нативные тесты) писателей сериализует std::mutex —
+ * протокол чтения тот же.
+ *
+ * ============================================================
+ */
+
+#ifndef SEQLOCK_H
+#define SEQLOCK_H
+
+#include <atomic>
+#include <stdint.h>
+#include <type_traits>
+
+#if defined(ESP_PLATFORM)
+#include <freertos/FreeRTOS.h>
+
+/** Блокировка писателей: portMUX (ядро не отдаётся, прерывания закрыты) */
+class SeqlockWriterLock {
+public:
+    void lock()   { portENTER_CRITICAL(&mux); }
+    void unlock() { portEXIT_CRITICAL(&mux); }
+private:
+    portMUX_TYPE mux = portMUX_INITIALIZER_UNLOCKED;
+};
+#else
+#include <mutex>
+
+/** Блокировка писателей на хосте */
+class SeqlockWriterLock {
+public:
+    void lock()   { mux.lock(); }
+    void unlock() { mux.unlock(); }
+private:
+    std::mutex mux;
+};
+#endif
+
+template <typename T>
+class Seqlock {
+    static_assert(std::is_trivially_copyable<T>::value, "Seqlock<T>: T должен быть тривиально копируемым");
+
+public:
+    /**
+     * @brief Изменить значение на месте (любой писатель)
+     * @param fn Вызывается как fn(T&) внутри критической секции —
+     *           только присваивания, без вызовов ОС и логов
+     */
+    template <typename F>
+    void write(F fn) {
+        writeLock.lock();
+        uint32_t s = seq.load(std::memory_order_relaxed);
+        seq.store(s + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        fn(value);
+        seq.store(s + 2, std::memory_order_release);
+        writeLock.unlock();
+    }
+
+    /**
+     * @brief Целостная копия (любая задача, не ISR)
+     * @return Номер публикации копии (растёт на 1 с каждой write())
+     */
+    uint32_t read(T* out) const {
+        while (true) {
+            uint32_t s1 = seq.load(std::memory_order_acquire);
+            if (s1 & 1) continue;                        // Идёт запись
+            *out = value;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            uint32_t s2 = seq.load(std::memory_order_relaxed);
+            if (s1 == s2) return s1 / 2;
+        }
+    }
+
+    /** @brief Номер последней публикации */
+    uint32_t version() const { return seq.load(std::memory_order_acquire) / 2; }
+
+private:
+    T value = {};
+    std::atomic<uint32_t> seq{0};                        // Нечётный — идёт запись
+    SeqlockWriterLock writeLock;
+};
+
+#endif // SEQLOCK_H
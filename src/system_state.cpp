@@ -0,0 +1,66 @@
+/**
+ * ============================================================
+ * 🧭 system_state.cpp — Снимок состояния системы
+ * ============================================================
+ *
+ * Одно значение Seqlock<SystemSnapshot>; каждый писатель правит
+ * только свою часть. Поле version заполняется при чтении —
+ * номером публикации, которую увидел читатель.
+ *
+ * Зависимости:
+ *   - seqlock.h — публикация без блокировок для читателей
+ *
+ * ============================================================
+ */
+
+#include "system_state.h"
+#include "seqlock.h"
+#include <string.h>
+
+static Seqlock<SystemSnapshot> snapshot;
+
+// --- Последняя публикация управления (только задача управления) ---
+static ControlState lastControl = {};
+static DriveState   lastMotors = {};
+static bool         controlPublished = false;
+
+/** Поля по одному — memcmp сравнил бы и байты выравнивания */
+static bool sameControl(const ControlState& a, const ControlState& b) {
+    return a.direction == b.direction && a.speed == b.speed &&
+           a.lastCommandMs == b.lastCommandMs && a.active == b.active;
+}
+
+void systemStatePublishControl(const ControlState& control, const DriveState& motors) {
+    if (controlPublished && sameControl(control, lastControl) &&
+        memcmp(motors.speed, lastMotors.speed, sizeof(motors.speed)) == 0) {
+        return;
+    }
+    lastControl = control;
+    lastMotors = motors;
+    controlPublished = true;
+
+    snapshot.write([&](SystemSnapshot& s) {
+        s.control = control;
+        s.motors = motors;
+    });
+}
+
+void systemStatePublishStream(uint8_t clients, uint32_t bps, uint32_t savedBps) {
+    snapshot.write([&](SystemSnapshot& s) {
+        s.streamClients = clients;
+        s.streamBps = bps;
+        s.streamSavedBps = savedBps;
+    });
+}
+
+void systemStatePublishLed(bool on) {
+    snapshot.write([&](SystemSnapshot& s) {
+        s.led = on;
+    });
+}
+
+SystemSnapshot systemStateRead() {
+    SystemSnapshot s;
+    s.version = snapshot.read(&s);
+    return s;
+}
@@ -0,0 +1,63 @@
+/**
+ * ============================================================
+ * 🧭 system_state.h — Снимок состояния системы (seqlock)
+ * ============================================================
+ *
+ * Обработчики httpd и телеметрия стрима читали ControlState,
+ * DriveState, irLedOn и streamClientCount прямо из статиков
+ * модулей, пока их пишут другие задачи, — значения могли
+ * «порваться» (моторы от одного тика, управление от другого).
+ *
+ * Здесь одно версионированное значение: каждый владелец
+ * публикует свою часть, читатели получают целостную копию всех
+ * частей сразу (seqlock.h) — без мьютекса, задача управления
+ * никого не ждёт.
+ *
+ * Писатели (по одному на часть):
+ *   - задача управления — цели моторов и ControlState, в конце
+ *     тика и только при изменении
+ *   - задача стрима     — клиенты и байт/с (подключение,
+ *     отключение, пересчёт раз в секунду)
+ *   - задача httpd      — IR-подсветка (/led/toggle)
+ *
+ * Читатели: /api/status, GET и ответ POST /api/control, ACK
+ * /ws/control, телеметрия стрима. Ответ на команду показывает
+ * снимок до её применения — задача управления заберёт её на
+ * следующем тике.
+ *
+ * ============================================================
+ */
+
+#ifndef SYSTEM_STATE_H
+#define SYSTEM_STATE_H
+
+#include <Arduino.h>
+#include "control.h"
+#include "drive.h"
+
+struct SystemSnapshot {
+    uint32_t     version;         // Номер публикации (растёт с каждым изменением)
+    DriveState   motors;          // Цели моторов
+    ControlState control;
+    bool         led;             // IR-подсветка
+    uint8_t      streamClients;   // Подключённых стрим-клиентов
+    uint32_t     streamBps;       // Байт/с стрима за последнюю секунду
+    uint32_t     streamSavedBps;  // Сэкономлено байт/с (abbrev)
+};
+
+/**
+ * @brief Опубликовать управление и цели моторов (только задача управления)
+ * Без изменений с прошлой публикации — ничего не делает.
+ */
+void systemStatePublishControl(const ControlState& control, const DriveState& motors);
+
+/** @brief Опубликовать состояние стрима (только задача стрима) */
+void systemStatePublishStream(uint8_t clients, uint32_t bps, uint32_t savedBps);
+
+/** @brief Опубликовать состояние IR-подсветки (только задача httpd) */
+void systemStatePublishLed(bool on);
+
+/** @brief Целостная копия снимка (любая задача, без блокировок) */
+SystemSnapshot systemStateRead();
+
+#endif // SYSTEM_STATE_H
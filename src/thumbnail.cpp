@@ -0,0 +1,313 @@
+/**
+ * ============================================================
+ * 🖼️ thumbnail.cpp — Миниатюры и уменьшенный стрим (1/2, 1/4, 1/8)
+ * ============================================================
+ *
+ * Конвейер воркера:
+ *   1. jpg2rgb565(scale) — декодирование сразу в уменьшенный RGB565
+ *      (масштабирование внутри декодера: IDCT меньшего размера)
+ *   2. fmt2jpg(RGB565)   — сжатие обратно в JPEG (THUMB_JPEG_QUALITY)
+ *
+ * Задания:
+ *   - Синхронные (photo) — кадр копируется и возвращается камере
+ *     до постановки в очередь thumbQueue, вызывающий ждёт
+ *     уведомления. При таймауте задание помечается abandoned
+ *     и освобождается воркером.
+ *   - Асинхронное (стрим) — один слот thumbPending, новый кадр
+ *     вытесняет ещё не взятый. Результаты лежат в thumbReady[]
+ *     по одному на масштаб до thumbnailTake().
+ *
+ * Буферы RGB и копии кадров выделяются в PSRAM.
+ *
+ * Зависимости:
+ *   - img_converters.h — jpg2rgb565(), fmt2jpg() (esp32-camera)
+ *   - jpeg_util.h      — размеры исходного кадра
+ *   - config.h         — THUMB_TASK_CORE, THUMB_JPEG_QUALITY
+ *
+ * ============================================================
+ */
+
+#include "thumbnail.h"
+#include "jpeg_util.h"
+#include "config.h"
+#include <img_converters.h>
+#include <esp_heap_caps.h>
+#include <esp_timer.h>
+
+#define THUMB_SCALES 3   // 1/2, 1/4, 1/8
+
+// --- Задание воркеру ---
+struct ThumbJob {
+    uint8_t*     src;         // Копия исходного JPEG (PSRAM)
+    size_t       srcLen;
+    uint8_t      scaleMask;   // Какие масштабы нужны
+    TaskHandle_t waiter;      // Кого разбудить (NULL — асинхронное)
+    uint8_t*     out;         // Результат (только синхронное, один масштаб)
+    size_t       outLen;
+    bool         ok;
+    bool         done;
+    bool         abandoned;   // Вызывающий ушёл по таймауту
+};
+
+// --- Готовая миниатюра для стрима ---
+struct ThumbSlot {
+    uint8_t* jpg;
+    size_t   len;
+};
+
+static TaskHandle_t  thumbTask  = NULL;
+static QueueHandle_t thumbQueue = NULL;                      // Синхронные задания
+static portMUX_TYPE  thumbMux   = portMUX_INITIALIZER_UNLOCKED;
+static ThumbJob*     thumbPending = NULL;                    // Асинхронное задание
+static ThumbSlot     thumbReady[THUMB_SCALES] = {};          // Результаты по масштабам
+
+static ThumbnailStats thumbStats = {};
+
+// Индекс слота по масштабу: 2 → 0, 4 → 1, 8 → 2
+static int scaleIndex(uint8_t scale) {
+    switch (scale) {
+        case 2: return 0;
+        case 4: return 1;
+        case 8: return 2;
+        default: return -1;
+    }
+}
+
+bool thumbnailValidScale(uint8_t scale) {
+    return scaleIndex(scale) >= 0;
+}
+
+static void freeJob(ThumbJob* job) {
+    if (!job) return;
+    free(job->src);
+    free(job->out);
+    free(job);
+}
+
+/**
+ * Создать задание с копией исходного JPEG в PSRAM.
+ * @return NULL при нехватке памяти
+ */
+static ThumbJob* newJob(const uint8_t* jpg, size_t len, uint8_t scaleMask, TaskHandle_t waiter) {
+    ThumbJob* job = (ThumbJob*)calloc(1, sizeof(ThumbJob));
+    if (!job) return NULL;
+
+    job->src = (uint8_t*)heap_caps_malloc(len, MALLOC_CAP_SPIRAM);
+    if (!job->src) {
+        free(job);
+        return NULL;
+    }
+    memcpy(job->src, jpg, len);
+    job->srcLen    = len;
+    job->scaleMask = scaleMask;
+    job->waiter    = waiter;
+    return job;
+}
+
+// Экспоненциальное среднее (вес нового значения 1/8)
+static inline uint32_t ema(uint32_t avg, uint32_t sample) {
+    return avg == 0 ? sample : avg - avg / 8 + sample / 8;
+}
+
+/**
+ * Перекодировать JPEG в уменьшенный масштаб.
+ * @return true при успехе, *out освобождать через free()
+ */
+static bool transcode(const uint8_t* src, size_t srcLen, uint8_t scale,
+                      uint8_t** out, size_t* outLen) {
+    JpegInfo info;
+    if (!jpegParse(src, srcLen, &info)) return false;
+
+    uint16_t w = info.width / scale;
+    uint16_t h = info.height / scale;
+    size_t rgbLen = (size_t)w * h * 2;
+    uint8_t* rgb = (uint8_t*)heap_caps_malloc(rgbLen, MALLOC_CAP_SPIRAM);
+    if (!rgb) return false;
+
+    jpg_scale_t jpgScale = (scale == 2) ? JPG_SCALE_2X
+                         : (scale == 4) ? JPG_SCALE_4X
+                         : JPG_SCALE_8X;
+
+    int64_t t0 = esp_timer_get_time();
+    bool ok = jpg2rgb565(src, srcLen, rgb, jpgScale);
+    int64_t t1 = esp_timer_get_time();
+    if (ok) {
+        ok = fmt2jpg(rgb, rgbLen, w, h, PIXFORMAT_RGB565, THUMB_JPEG_QUALITY, out, outLen);
+    }
+    int64_t t2 = esp_timer_get_time();
+    free(rgb);
+
+    uint32_t decodeUs = (uint32_t)(t1 - t0);
+    uint32_t encodeUs = (uint32_t)(t2 - t1);
+    thumbStats.decodeUsAvg = ema(thumbStats.decodeUsAvg, decodeUs);
+    thumbStats.encodeUsAvg = ema(thumbStats.encodeUsAvg, encodeUs);
+    if (decodeUs > thumbStats.decodeUsMax) thumbStats.decodeUsMax = decodeUs;
+    if (encodeUs > thumbStats.encodeUsMax) thumbStats.encodeUsMax = encodeUs;
+
+    if (ok) thumbStats.frames++;
+    else    thumbStats.failed++;
+    return ok;
+}
+
+/**
+ * Положить готовую миниатюру в слот стрима (вытесняя невзятую).
+ */
+static void publishReady(int idx, uint8_t* jpg, size_t len) {
+    portENTER_CRITICAL(&thumbMux);
+    uint8_t* old = thumbReady[idx].jpg;
+    thumbReady[idx].jpg = jpg;
+    thumbReady[idx].len = len;
+    portEXIT_CRITICAL(&thumbMux);
+    free(old);
+}
+
+/**
+ * FreeRTOS-задача воркера: сначала синхронные задания, затем асинхронное.
+ */
+static void thumbnailTask(void* pvParameters) {
+    static const uint8_t scales[THUMB_SCALES] = {2, 4, 8};
+    unsigned long windowStart = millis();
+    uint32_t framesAtStart = 0;
+
+    while (true) {
+        ThumbJob* job = NULL;
+
+        if (xQueueReceive(thumbQueue, &job, 0) != pdTRUE) {
+            portENTER_CRITICAL(&thumbMux);
+            job = thumbPending;
+            thumbPending = NULL;
+            portEXIT_CRITICAL(&thumbMux);
+        }
+
+        if (!job) {
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(1000));
+        } else if (job->waiter) {
+            // --- Синхронное задание: один масштаб, результат вызывающему ---
+            uint8_t scale = (job->scaleMask & 0x01) ? 2 : (job->scaleMask & 0x02) ? 4 : 8;
+            job->ok = transcode(job->src, job->srcLen, scale, &job->out, &job->outLen);
+
+            portENTER_CRITICAL(&thumbMux);
+            bool abandoned = job->abandoned;
+            job->done = true;
+            portEXIT_CRITICAL(&thumbMux);
+
+            if (abandoned) freeJob(job);
+            else           xTaskNotifyGive(job->waiter);
+        } else {
+            // --- Асинхронное задание: все запрошенные масштабы в слоты ---
+            for (int i = 0; i < THUMB_SCALES; i++) {
+                if (!(job->scaleMask & (1 << i))) continue;
+                uint8_t* out = NULL;
+                size_t outLen = 0;
+                if (transcode(job->src, job->srcLen, scales[i], &out, &outLen)) {
+                    publishReady(i, out, outLen);
+                }
+            }
+            freeJob(job);
+        }
+
+        // Пропускная способность за последнюю секунду
+        unsigned long now = millis();
+        if (now - windowStart >= 1000) {
+            thumbStats.fps = (thumbStats.frames - framesAtStart) * 1000 / (now - windowStart);
+            framesAtStart = thumbStats.frames;
+            windowStart = now;
+        }
+    }
+}
+
+bool thumbnailInit() {
+    thumbQueue = xQueueCreate(4, sizeof(ThumbJob*));
+    if (!thumbQueue) return false;
+
+    BaseType_t res = xTaskCreatePinnedToCore(
+        thumbnailTask,
+        "Thumbnail",
+        8192,
+        NULL,
+        THUMB_TASK_PRIORITY,
+        &thumbTask,
+        THUMB_TASK_CORE
+    );
+    if (res != pdPASS) {
+        Serial.println("❌ Thumbnail: ошибка запуска воркера");
+        return false;
+    }
+
+    Serial.printf("✅ Thumbnail воркер на Core %d\n", THUMB_TASK_CORE);
+    return true;
+}
+
+bool thumbnailEncode(camera_fb_t* fb, uint8_t scale,
+                     uint8_t** out, size_t* outLen, uint32_t timeoutMs) {
+    ThumbJob* job = NULL;
+    if (thumbTask && thumbnailValidScale(scale)) {
+        job = newJob(fb->buf, fb->len, THUMB_MASK(scale), xTaskGetCurrentTaskHandle());
+    }
+    esp_camera_fb_return(fb);                    // Копия снята — буфер камере
+    if (!job) return false;
+
+    ulTaskNotifyTake(pdTRUE, 0);  // Сброс запоздавшего уведомления от прошлого вызова
+
+    if (xQueueSend(thumbQueue, &job, 0) != pdTRUE) {
+        freeJob(job);
+        return false;
+    }
+    xTaskNotifyGive(thumbTask);
+
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(timeoutMs));
+
+    portENTER_CRITICAL(&thumbMux);
+    bool done = job->done;
+    if (!done) job->abandoned = true;  // Воркер освободит сам
+    portEXIT_CRITICAL(&thumbMux);
+
+    if (!done) return false;
+
+    bool ok = job->ok;
+    if (ok) {
+        *out    = job->out;
+        *outLen = job->outLen;
+        job->out = NULL;
+    }
+    freeJob(job);
+    return ok;
+}
+
+void thumbnailSubmit(const camera_fb_t* fb, uint8_t scaleMask) {
+    if (!thumbTask || scaleMask == 0) return;
+
+    ThumbJob* job = newJob(fb->buf, fb->len, scaleMask, NULL);
+    if (!job) return;
+
+    portENTER_CRITICAL(&thumbMux);
+    ThumbJob* old = thumbPending;
+    thumbPending = job;
+    portEXIT_CRITICAL(&thumbMux);
+
+    if (old) {
+        thumbStats.dropped++;
+        freeJob(old);
+    }
+    xTaskNotifyGive(thumbTask);
+}
+
+bool thumbnailTake(uint8_t scale, uint8_t** out, size_t* outLen) {
+    int idx = scaleIndex(scale);
+    if (idx < 0) return false;
+
+    portENTER_CRITICAL(&thumbMux);
+    uint8_t* jpg = thumbReady[idx].jpg;
+    size_t len = thumbReady[idx].len;
+    thumbReady[idx].jpg = NULL;
+    portEXIT_CRITICAL(&thumbMux);
+
+    if (!jpg) return false;
+    *out = jpg;
+    *outLen = len;
+    return true;
+}
+
+ThumbnailStats thumbnailGetStats() {
+    return thumbStats;
+}
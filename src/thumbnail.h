@@ -0,0 +1,88 @@
+/**
+ * ============================================================
+ * 🖼️ thumbnail.h — Миниатюры и уменьшенный стрим (1/2, 1/4, 1/8)
+ * ============================================================
+ *
+ * Перекодирование JPEG-кадров OV2640 в меньшее разрешение без
+ * перенастройки сенсора: декодирование с масштабом (jpg2rgb565)
+ * и повторное сжатие (fmt2jpg) из esp32-camera.
+ *
+ * Вся работа выполняется фоновой задачей-воркером на
+ * THUMB_TASK_CORE — стрим-задача и httpd только ставят задания.
+ *
+ * Два режима:
+ *   - Синхронный (thumbnailEncode) — для /photo?scale=N
+ *   - Асинхронный (thumbnailSubmit + thumbnailTake) — для стрима
+ *     /stream?scale=N: последний кадр вытесняет предыдущий,
+ *     готовые миниатюры забираются без ожидания
+ *
+ * ============================================================
+ */
+
+#ifndef THUMBNAIL_H
+#define THUMBNAIL_H
+
+#include <Arduino.h>
+#include <esp_camera.h>
+
+// Маска масштаба для thumbnailSubmit(): бит для 1/2, 1/4, 1/8
+#define THUMB_MASK(scale) ((scale) == 2 ? 0x01 : (scale) == 4 ? 0x02 : (scale) == 8 ? 0x04 : 0)
+
+// --- Статистика воркера (бенчмарк перекодирования) ---
+struct ThumbnailStats {
+    uint32_t frames;          // Всего перекодировано кадров
+    uint32_t failed;          // Ошибок декодирования/сжатия
+    uint32_t dropped;         // Асинхронных кадров, вытесненных более новым
+    uint32_t decodeUsAvg;     // Среднее время декодирования (мкс, EMA)
+    uint32_t encodeUsAvg;     // Среднее время сжатия (мкс, EMA)
+    uint32_t decodeUsMax;     // Максимум декодирования (мкс)
+    uint32_t encodeUsMax;     // Максимум сжатия (мкс)
+    uint32_t fps;             // Перекодировано кадров за последнюю секунду
+};
+
+/**
+ * @brief Запуск задачи-воркера миниатюр. Вызывать в setup().
+ * @return true — воркер запущен
+ */
+bool thumbnailInit();
+
+/** @brief Допустимый ли масштаб (2, 4 или 8) */
+bool thumbnailValidScale(uint8_t scale);
+
+/**
+ * @brief Синхронно перекодировать кадр камеры в уменьшенный JPEG
+ *
+ * Кадр копируется в PSRAM и сразу возвращается драйверу
+ * (esp_camera_fb_return) — до перекодирования, камера не ждёт
+ * воркера. fb возвращается всегда, в том числе при ошибке.
+ * Результат освобождать через free().
+ *
+ * @param fb        Кадр камеры (возвращается драйверу внутри)
+ * @param scale     Масштаб: 2, 4 или 8
+ * @param out       [out] Указатель на JPEG миниатюры
+ * @param outLen    [out] Размер миниатюры
+ * @param timeoutMs Макс. время ожидания воркера (мс)
+ * @return true при успехе
+ */
+bool thumbnailEncode(camera_fb_t* fb, uint8_t scale,
+                     uint8_t** out, size_t* outLen, uint32_t timeoutMs = 2000);
+
+/**
+ * @brief Асинхронно отдать кадр воркеру (без ожидания)
+ * Если воркер ещё не взял предыдущий кадр — он вытесняется.
+ * @param fb        Кадр камеры (копируется)
+ * @param scaleMask Набор масштабов (THUMB_MASK(2) | THUMB_MASK(4) ...)
+ */
+void thumbnailSubmit(const camera_fb_t* fb, uint8_t scaleMask);
+
+/**
+ * @brief Забрать последнюю готовую миниатюру масштаба scale
+ * Владение буфером переходит вызывающему (освободить через free()).
+ * @return false если новой миниатюры ещё нет
+ */
+bool thumbnailTake(uint8_t scale, uint8_t** out, size_t* outLen);
+
+/** @brief Получить статистику воркера */
+ThumbnailStats thumbnailGetStats();
+
+#endif // THUMBNAIL_H
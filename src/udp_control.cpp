@@ -0,0 +1,224 @@
+/**
+ * ============================================================
+ * 🛰️ udp_control.cpp — Бинарный UDP-канал управления
+ * ============================================================
+ *
+ * Отдельная задача блокируется в recvfrom() и применяет команду
+ * сразу по приходу пакета — без httpd, JSON и TCP-рукопожатий.
+ *
+ * Отбрасывание устаревших пакетов:
+ *   - seq сравнивается с последним применённым по модулю 2^32
+ *     ((int32_t)(seq - lastSeq) > 0), переполнение не страшно
+ *   - сессия (и счётчик seq) сбрасывается, если пакет пришёл
+ *     с другого адреса/порта или управление простаивало дольше
+ *     CONTROL_TIMEOUT_MS — перезапущенный клиент начнёт с seq=1
+ *
+ * Аренда: токен из пакета версии 2 передаётся в controlSetXY()/
+ * controlStop(); отклонённая команда не считается применённой
+ * (ACK с флагом UDP_CTRL_ACK_LEASE).
+ *
+ * Зависимости:
+ *   - control.h    — controlSetXY(), controlStop(), замер латентности
+ *   - lwip/sockets — UDP-сокет
+ *   - config.h     — UDP_CONTROL_PORT, CONTROL_TIMEOUT_MS
+ *
+ * ============================================================
+ */
+
+#include "udp_control.h"
+#include "control.h"
+#include "config.h"
+#include "log.h"
+#include <esp_timer.h>
+#include <lwip/sockets.h>
+
+static int udpCtrlFd = -1;
+static UdpControlStats udpCtrlStats = {};
+
+// --- Текущая сессия (только задача приёма) ---
+static uint32_t      sessionAddr = 0;       // Адрес клиента (network order)
+static uint16_t      sessionPort = 0;       // Порт клиента (network order)
+static unsigned long sessionLastMs = 0;     // millis() последней применённой команды
+static bool          sessionValid = false;
+
+// Little-endian чтение/запись (не зависят от выравнивания буфера)
+static inline uint32_t rd32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+static inline int16_t rd16(const uint8_t* p) {
+    return (int16_t)((uint16_t)p[0] | ((uint16_t)p[1] << 8));
+}
+static inline void wr32(uint8_t* p, uint32_t v) {
+    p[0] = v; p[1] = v >> 8; p[2] = v >> 16; p[3] = v >> 24;
+}
+static inline void wr16(uint8_t* p, int16_t v) {
+    p[0] = (uint16_t)v; p[1] = (uint16_t)v >> 8;
+}
+
+bool udpControlDecode(const uint8_t* buf, size_t len, UdpControlPacket* pkt) {
+    if (buf[0] != UDP_CTRL_MAGIC) return false;
+    if (!(buf[1] == UDP_CTRL_VERSION_V1 && len == UDP_CTRL_PACKET_LEN) &&
+        !(buf[1] == UDP_CTRL_VERSION && len == UDP_CTRL_PACKET_LEN_V2)) return false;
+
+    pkt->version      = buf[1];
+    pkt->type         = buf[2];
+    pkt->flags        = buf[3];
+    pkt->seq          = rd32(buf + 4);
+    pkt->clientTimeUs = rd32(buf + 8);
+    pkt->x            = rd16(buf + 12);
+    pkt->y            = rd16(buf + 14);
+    pkt->lease        = (pkt->version == UDP_CTRL_VERSION) ? rd32(buf + 16) : 0;
+    return true;
+}
+
+void udpControlEncode(const UdpControlPacket* pkt, uint8_t* buf) {
+    buf[0] = UDP_CTRL_MAGIC;
+    buf[1] = pkt->version;
+    buf[2] = pkt->type;
+    buf[3] = pkt->flags;
+    wr32(buf + 4, pkt->seq);
+    wr32(buf + 8, pkt->clientTimeUs);
+    wr16(buf + 12, pkt->x);
+    wr16(buf + 14, pkt->y);
+}
+
+/**
+ * Проверить seq пакета относительно текущей сессии.
+ * @return true если пакет новее последнего применённого
+ */
+static bool sessionAccept(const struct sockaddr_in* from, uint32_t seq) {
+    bool sameSource = sessionValid &&
+                      from->sin_addr.s_addr == sessionAddr &&
+                      from->sin_port == sessionPort;
+    bool expired = millis() - sessionLastMs >= CONTROL_TIMEOUT_MS;
+
+    if (sameSource && !expired && (int32_t)(seq - udpCtrlStats.lastSeq) <= 0) {
+        return false;
+    }
+
+    if (!sameSource) {
+        LOG_I("🛰️ UDP control: клиент %s:%u",
+              inet_ntoa(from->sin_addr), ntohs(from->sin_port));
+    }
+    sessionAddr  = from->sin_addr.s_addr;
+    sessionPort  = from->sin_port;
+    sessionValid = true;
+    sessionLastMs = millis();
+    udpCtrlStats.lastSeq = seq;
+    return true;
+}
+
+/**
+ * FreeRTOS-задача: приём пакетов, применение команд, ACK.
+ */
+static void udpControlTask(void* pvParameters) {
+    uint8_t buf[UDP_CTRL_PROBE_ACK_LEN];
+    struct sockaddr_in from;
+
+    while (true) {
+        socklen_t fromLen = sizeof(from);
+        int n = recvfrom(udpCtrlFd, buf, sizeof(buf), 0, (struct sockaddr*)&from, &fromLen);
+        if (n < 0) {
+            vTaskDelay(pdMS_TO_TICKS(10));
+            continue;
+        }
+        uint32_t recvUs = (uint32_t)esp_timer_get_time();
+        udpCtrlStats.received++;
+
+        UdpControlPacket pkt;
+        if (!udpControlDecode(buf, n, &pkt)) {
+            udpCtrlStats.malformed++;
+            continue;
+        }
+
+        bool applied = false;
+        bool rejected = false;
+        bool probe = false;
+        if (pkt.type != UDP_CTRL_PING) {
+            if (!sessionAccept(&from, pkt.seq)) {
+                udpCtrlStats.stale++;
+            } else {
+                // Замер: метка — seq (не 0), ответ — после записи LEDC
+                probe = (pkt.flags & UDP_CTRL_FLAG_PROBE) && (pkt.flags & UDP_CTRL_FLAG_ACK) &&
+                        pkt.seq != 0;
+                if (probe) controlProbeNext(CTRL_SRC_UDP, pkt.seq);
+                if (pkt.type == UDP_CTRL_XY) {
+                    applied = controlSetXY(pkt.x, pkt.y, CTRL_SRC_UDP, pkt.lease, pkt.clientTimeUs);
+                } else {
+                    applied = controlStop(CTRL_SRC_UDP, pkt.lease);
+                    pkt.x = pkt.y = 0;
+                }
+                if (applied) {
+                    udpCtrlStats.applied++;
+                } else {
+                    udpCtrlStats.leaseRejected++;
+                    rejected = true;
+                    probe = false;
+                }
+            }
+        }
+
+        if (pkt.flags & UDP_CTRL_FLAG_ACK) {
+            // ACK: seq/clientTimeUs эхом; flags бит 0 — применена, бит 1 — аренда
+            pkt.type  = UDP_CTRL_ACK;
+            pkt.flags = (applied ? 0x01 : 0x00) | (rejected ? UDP_CTRL_ACK_LEASE : 0x00);
+            size_t len = UDP_CTRL_PACKET_LEN;
+
+            ControlProbe pr;
+            if (probe && controlProbeWait(CTRL_SRC_UDP, pkt.seq, &pr, CONTROL_PROBE_TIMEOUT_MS)) {
+                pkt.type = UDP_CTRL_PROBE_ACK;
+                wr32(buf + 16, recvUs);
+                wr32(buf + 20, pr.postUs);
+                wr32(buf + 24, pr.applyUs);
+                wr32(buf + 28, pr.pwmUs);
+                wr32(buf + 32, (uint32_t)esp_timer_get_time());
+                len = UDP_CTRL_PROBE_ACK_LEN;
+            }
+            udpControlEncode(&pkt, buf);
+            sendto(udpCtrlFd, buf, len, MSG_DONTWAIT,
+                   (struct sockaddr*)&from, fromLen);
+        }
+    }
+}
+
+bool udpControlInit() {
+    udpCtrlFd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (udpCtrlFd < 0) {
+        Serial.println("❌ UDP control: ошибка создания сокета");
+        return false;
+    }
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family      = AF_INET;
+    addr.sin_addr.s_addr = INADDR_ANY;
+    addr.sin_port        = htons(UDP_CONTROL_PORT);
+
+    if (bind(udpCtrlFd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        Serial.println("❌ UDP control: ошибка bind");
+        close(udpCtrlFd);
+        udpCtrlFd = -1;
+        return false;
+    }
+
+    BaseType_t res = xTaskCreatePinnedToCore(
+        udpControlTask,
+        "UdpControl",
+        4096,
+        NULL,
+        UDP_CONTROL_TASK_PRIORITY,
+        NULL,
+        UDP_CONTROL_TASK_CORE
+    );
+    if (res != pdPASS) {
+        Serial.println("❌ UDP control: ошибка запуска задачи");
+        return false;
+    }
+
+    Serial.printf("✅ UDP control на порту %d\n", UDP_CONTROL_PORT);
+    return true;
+}
+
+UdpControlStats udpControlGetStats() {
+    return udpCtrlStats;
+}
@@ -0,0 +1,119 @@
+/**
+ * ============================================================
+ * 🛰️ udp_control.h — Бинарный UDP-канал управления
+ * ============================================================
+ *
+ * Альтернатива POST /api/control для джойстика: один UDP-пакет
+ * 16 байт на тик вместо HTTP-запроса с JSON (и CORS preflight).
+ *
+ * Формат пакета (little-endian, 16 байт; версия 2 — 20 байт):
+ *
+ *   off  size  поле
+ *   0    1     magic        'R' (0x52)
+ *   1    1     version      UDP_CTRL_VERSION
+ *   2    1     type         UdpControlType
+ *   3    1     flags        бит 0 — ответить ACK, бит 1 — замер латентности
+ *   4    4     seq          номер пакета (растёт на каждый пакет)
+ *   8    4     clientTimeUs время отправки клиента (мкс, для RTT)
+ *   12   2     x            -255..+255
+ *   14   2     y            -255..+255
+ *   16   4     lease        токен аренды (только версия 2, lease.h)
+ *
+ * Версия 1 (без токена) принимается по-прежнему — как команда
+ * с lease = 0.
+ *
+ * ACK — заголовок 16 байт той же версии, type = UDP_CTRL_ACK,
+ * seq и clientTimeUs эхом из запроса, x/y — применённые значения,
+ * flags: бит 0 — команда применена, бит 1 — отклонена арендой.
+ *
+ * Замер латентности (флаги ACK | PROBE, только XY/STOP): ответ
+ * ждёт записи LEDC (до CONTROL_PROBE_TIMEOUT_MS) и приходит
+ * длиной UDP_CTRL_PROBE_ACK_LEN, type = UDP_CTRL_PROBE_ACK —
+ * те же 16 байт и метки esp_timer устройства (мкс, u32):
+ *
+ *   16   4     recvUs       пакет принят (после recvfrom)
+ *   20   4     postUs       команда опубликована задаче управления
+ *   24   4     applyUs      команда применена
+ *   28   4     pwmUs        запись LEDC (0 — цели не изменились)
+ *   32   4     sendUs       отправка ответа
+ *
+ * Устаревшие пакеты (seq не больше последнего применённого)
+ * отбрасываются: UDP может переупорядочить пакеты, а старая
+ * команда джойстика хуже, чем никакой.
+ *
+ * Хост-клиенты: tools/udp-control.js (RTT),
+ * tools/latency-probe.js (задержка до записи PWM)
+ *
+ * ============================================================
+ */
+
+#ifndef UDP_CONTROL_H
+#define UDP_CONTROL_H
+
+#include <Arduino.h>
+
+#define UDP_CTRL_MAGIC      0x52   // 'R'
+#define UDP_CTRL_VERSION    2      // Текущая версия (с токеном аренды)
+#define UDP_CTRL_VERSION_V1 1      // Без токена аренды
+#define UDP_CTRL_PACKET_LEN 16     // Заголовок (= пакет версии 1, = ACK)
+#define UDP_CTRL_PACKET_LEN_V2 20  // Пакет версии 2
+#define UDP_CTRL_FLAG_ACK   0x01   // Клиент просит ACK
+#define UDP_CTRL_ACK_LEASE  0x02   // ACK: команда отклонена арендой
+#define UDP_CTRL_FLAG_PROBE 0x02   // Замер латентности (с ACK)
+#define UDP_CTRL_PROBE_ACK_LEN 36  // Длина ответа на замер
+
+// --- Тип пакета ---
+enum UdpControlType : uint8_t {
+    UDP_CTRL_XY   = 1,     // Джойстик: x/y → controlSetXY()
+    UDP_CTRL_STOP = 2,     // Остановка → controlStop()
+    UDP_CTRL_PING = 3,     // Только ACK (замер RTT без движения)
+    UDP_CTRL_ACK  = 0x81,  // Ответ устройства
+    UDP_CTRL_PROBE_ACK = 0x82  // Ответ на замер латентности (36 байт)
+};
+
+// --- Пакет управления (разобранный) ---
+struct UdpControlPacket {
+    uint8_t  version;      // UDP_CTRL_VERSION_V1 или UDP_CTRL_VERSION
+    uint8_t  type;
+    uint8_t  flags;
+    uint32_t seq;
+    uint32_t clientTimeUs;
+    int16_t  x;
+    int16_t  y;
+    uint32_t lease;        // Токен аренды (версия 1 — 0)
+};
+
+// --- Статистика канала ---
+struct UdpControlStats {
+    uint32_t received;     // Всего принято пакетов
+    uint32_t applied;      // Применено команд
+    uint32_t stale;        // Отброшено устаревших (seq <= последнего)
+    uint32_t malformed;    // Отброшено битых (размер/magic/версия)
+    uint32_t leaseRejected; // Отклонено арендой (чужой токен)
+    uint32_t lastSeq;      // Последний применённый seq
+};
+
+/**
+ * @brief Разобрать пакет управления
+ * @return false если размер, magic или версия не совпадают
+ */
+bool udpControlDecode(const uint8_t* buf, size_t len, UdpControlPacket* pkt);
+
+/**
+ * @brief Собрать заголовок пакета (UDP_CTRL_PACKET_LEN байт)
+ * Версия — pkt->version; токен аренды версии 2 пишет вызывающий
+ * (ACK его не несёт).
+ */
+void udpControlEncode(const UdpControlPacket* pkt, uint8_t* buf);
+
+/**
+ * @brief Запустить задачу приёма на UDP_CONTROL_PORT.
+ * Вызывать в setup() после WiFi и controlInit().
+ * @return true — сокет и задача готовы
+ */
+bool udpControlInit();
+
+/** @brief Получить статистику канала */
+UdpControlStats udpControlGetStats();
+
+#endif // UDP_CONTROL_H
@@ -0,0 +1,210 @@
+/**
+ * ============================================================
+ * 🎥 vision.cpp — Кадры для анализа на устройстве
+ * ============================================================
+ *
+ * Задача Vision (VISION_TASK_CORE, приоритет выше httpd):
+ *   1. ждёт кадр стрима или VISION_SELF_CAPTURE_MS
+ *   2. *Poll() потребителей (снятие удержаний, таймауты)
+ *   3. кадры никому не нужны — ничего не делает
+ *   4. кадр стрима или, если его нет, свой cameraCapture()
+ *   5. jpg2rgb565(1/8) → *OnFrame() заинтересованных потребителей
+ *
+ * Буфер RGB565 выделяется в PSRAM один раз под размер кадра.
+ *
+ * Зависимости:
+ *   - scene_guard.h    — защита по смене сцены
+ *   - follow.h         — следование за движением
+ *   - camera.h         — захват без зрителей
+ *   - img_converters.h — jpg2rgb565() (esp32-camera)
+ *   - jpeg_util.h      — размеры кадра
+ *   - config.h         — VISION_*
+ *
+ * ============================================================
+ */
+
+#include "vision.h"
+#include "scene_guard.h"
+#include "follow.h"
+#include "camera.h"
+#include "jpeg_util.h"
+#include "config.h"
+#include "log.h"
+#include <atomic>
+#include <img_converters.h>
+#include <esp_heap_caps.h>
+#include <esp_timer.h>
+
+// --- Кадр стрима, ждущий анализа ---
+struct VisionFrame {
+    uint8_t* jpg;
+    size_t   len;
+    uint32_t frameUs;
+};
+
+static TaskHandle_t  visionTask = NULL;
+static portMUX_TYPE  visionMux = portMUX_INITIALIZER_UNLOCKED;
+static VisionFrame   pending = {};                       // Под visionMux
+static VisionStats   stats = {};                         // Под visionMux
+static std::atomic<bool> visionActive(false);
+
+// --- Только задача Vision ---
+static uint8_t*      rgb = NULL;
+static size_t        rgbSize = 0;
+static uint32_t      lastDecodedUs = 0;
+
+static inline uint32_t ema(uint32_t avg, uint32_t sample) {
+    return avg == 0 ? sample : avg - avg / 8 + sample / 8;
+}
+
+static inline uint32_t frameTimeUs(const camera_fb_t* fb) {
+    return (uint32_t)((int64_t)fb->timestamp.tv_sec * 1000000 + fb->timestamp.tv_usec);
+}
+
+static void dropPending() {
+    portENTER_CRITICAL(&visionMux);
+    uint8_t* jpg = pending.jpg;
+    pending.jpg = NULL;
+    portEXIT_CRITICAL(&visionMux);
+    free(jpg);
+}
+
+/**
+ * Декодировать кадр 1/8 и раздать потребителям.
+ */
+static void process(const uint8_t* jpg, size_t len, uint32_t frameUs, bool fromStream,
+                    bool scene, bool follow) {
+    int64_t t0 = esp_timer_get_time();
+
+    JpegInfo info = {};
+    bool ok = jpegParse(jpg, len, &info);
+    uint16_t w = info.width / 8;
+    uint16_t h = info.height / 8;
+    size_t need = (size_t)w * h * 2;
+    if (ok && need > rgbSize) {
+        free(rgb);
+        rgb = (uint8_t*)heap_caps_malloc(need, MALLOC_CAP_SPIRAM);
+        rgbSize = rgb ? need : 0;
+    }
+    ok = ok && rgb && w > 0 && h > 0 && jpg2rgb565(jpg, len, rgb, JPG_SCALE_8X);
+    uint32_t decodeUs = (uint32_t)(esp_timer_get_time() - t0);
+
+    portENTER_CRITICAL(&visionMux);
+    if (!ok) {
+        stats.failed++;
+    } else {
+        stats.frames++;
+        if (fromStream) stats.streamFrames++;
+        else            stats.selfFrames++;
+        stats.decodeUsAvg = ema(stats.decodeUsAvg, decodeUs);
+        if (decodeUs > stats.decodeUsMax) stats.decodeUsMax = decodeUs;
+        if (lastDecodedUs) stats.periodUsAvg = ema(stats.periodUsAvg, frameUs - lastDecodedUs);
+    }
+    portEXIT_CRITICAL(&visionMux);
+    if (!ok) return;
+    lastDecodedUs = frameUs;
+
+    if (scene)  sceneGuardOnFrame(rgb, w, h, frameUs);
+    if (follow) followOnFrame(rgb, w, h, frameUs);
+}
+
+/**
+ * FreeRTOS-задача: кадры стрима или свой захват, пока они кому-то нужны.
+ */
+static void visionTaskFn(void* pvParameters) {
+    int64_t lastFrameUs = 0;
+
+    while (true) {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(VISION_SELF_CAPTURE_MS));
+        int64_t now = esp_timer_get_time();
+
+        sceneGuardPoll(now);
+        followPoll(now);
+
+        bool scene = sceneGuardWants();
+        bool follow = followWants();
+        bool active = scene || follow;
+        if (active != visionActive.load()) {
+            visionActive.store(active);
+            portENTER_CRITICAL(&visionMux);
+            stats.active = active;
+            portEXIT_CRITICAL(&visionMux);
+        }
+        if (!active) {
+            dropPending();
+            lastDecodedUs = 0;
+            continue;
+        }
+
+        // Кадр стрима, если есть
+        portENTER_CRITICAL(&visionMux);
+        VisionFrame frame = pending;
+        pending.jpg = NULL;
+        portEXIT_CRITICAL(&visionMux);
+
+        if (frame.jpg) {
+            process(frame.jpg, frame.len, frame.frameUs, true, scene, follow);
+            free(frame.jpg);
+            lastFrameUs = now;
+            continue;
+        }
+
+        // Стрим молчит — снимаем сами
+        if (now - lastFrameUs < (int64_t)VISION_SELF_CAPTURE_MS * 1000) continue;
+        camera_fb_t* fb = cameraCapture(VISION_SELF_CAPTURE_MS);
+        if (!fb) continue;
+        process(fb->buf, fb->len, frameTimeUs(fb), false, scene, follow);
+        esp_camera_fb_return(fb);
+        lastFrameUs = esp_timer_get_time();
+    }
+}
+
+bool visionInit() {
+    BaseType_t res = xTaskCreatePinnedToCore(
+        visionTaskFn,
+        "Vision",
+        6144,
+        NULL,
+        VISION_TASK_PRIORITY,
+        &visionTask,
+        VISION_TASK_CORE
+    );
+    if (res != pdPASS) {
+        Serial.println("❌ Vision: ошибка запуска задачи");
+        return false;
+    }
+
+    Serial.printf("✅ Vision на Core %d (кадры 1/8 для анализа на устройстве)\n",
+                  VISION_TASK_CORE);
+    return true;
+}
+
+void visionSubmit(const camera_fb_t* fb) {
+    if (!visionTask || !visionActive.load()) return;
+
+    uint8_t* copy = (uint8_t*)heap_caps_malloc(fb->len, MALLOC_CAP_SPIRAM);
+    if (!copy) return;
+    memcpy(copy, fb->buf, fb->len);
+
+    portENTER_CRITICAL(&visionMux);
+    uint8_t* old = pending.jpg;
+    pending.jpg = copy;
+    pending.len = fb->len;
+    pending.frameUs = frameTimeUs(fb);
+    if (old) stats.dropped++;
+    portEXIT_CRITICAL(&visionMux);
+
+    free(old);
+    xTaskNotifyGive(visionTask);
+}
+
+void visionWake() {
+    if (visionTask) xTaskNotifyGive(visionTask);
+}
+
+VisionStats visionGetStats() {
+    portENTER_CRITICAL(&visionMux);
+    VisionStats st = stats;
+    portEXIT_CRITICAL(&visionMux);
+    return st;
+}
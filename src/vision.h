@@ -0,0 +1,60 @@
+/**
+ * ============================================================
+ * 🎥 vision.h — Кадры для анализа на устройстве (1/8, RGB565)
+ * ============================================================
+ *
+ * Общий источник уменьшенных кадров для потребителей на
+ * устройстве — защиты по смене сцены (scene_guard.h) и
+ * следования за движением (follow.h). Задача Vision:
+ *
+ *   - работает, пока кадры нужны хотя бы одному потребителю
+ *     (sceneGuardWants() / followWants())
+ *   - берёт кадры стрима (visionSubmit, копия, новый вытесняет
+ *     невзятый), а без зрителей снимает сама раз в
+ *     VISION_SELF_CAPTURE_MS — клиент не нужен
+ *   - декодирует JPEG один раз с масштабом 1/8 (jpg2rgb565,
+ *     VGA → 80×60) и отдаёт кадр всем заинтересованным
+ *     потребителям (*OnFrame) вместе с временем снимка
+ *   - на каждом пробуждении вызывает *Poll() потребителей
+ *     (удержания, таймауты) — и без кадров тоже
+ *
+ * Время кадра — fb->timestamp (esp_timer, как в camera.cpp).
+ *
+ * ============================================================
+ */
+
+#ifndef VISION_H
+#define VISION_H
+
+#include <Arduino.h>
+#include <esp_camera.h>
+
+// --- Статистика источника ---
+struct VisionStats {
+    bool     active;          // Кадры кому-то нужны
+    uint32_t frames;          // Декодировано кадров
+    uint32_t streamFrames;    // Из них кадров стрима
+    uint32_t selfFrames;      // Снято самой задачей
+    uint32_t dropped;         // Кадров стрима, вытесненных более новым
+    uint32_t failed;          // Ошибок декодирования
+    uint32_t decodeUsAvg;     // jpg2rgb565 1/8 (мкс, EMA)
+    uint32_t decodeUsMax;
+    uint32_t periodUsAvg;     // Между кадрами анализа (мкс, EMA)
+};
+
+/** @brief Запустить задачу Vision. Вызывать после cameraInit(). */
+bool visionInit();
+
+/**
+ * @brief Отдать кадр стрима на анализ (без ожидания)
+ * Копируется, только пока кадры кому-то нужны.
+ */
+void visionSubmit(const camera_fb_t* fb);
+
+/** @brief Разбудить задачу (потребитель включился/выключился) */
+void visionWake();
+
+/** @brief Статистика (копия) */
+VisionStats visionGetStats();
+
+#endif // VISION_H
@@ -0,0 +1,270 @@
+/**
+ * ============================================================
+ * 〰️ wave.cpp — Проигрыватель форм скважности
+ * ============================================================
+ *
+ * Проигрыватель живёт в задаче управления: waveTick() — после
+ * разбора команд и до миссии и рампы, waveAfterTick() — сразу
+ * после driveTick(), когда выход уже записан в бэкенд. Запуск и
+ * остановка приходят из httpd через почтовый ящик (latest-wins,
+ * как у mission.cpp).
+ *
+ * Форма и журнал — в PSRAM, по одному буферу: пока прогон идёт
+ * или ждёт тика (waveBusy), загрузка формы и чтение журнала
+ * отклоняются — копия для исполнения не нужна.
+ *
+ * Зависимости:
+ *   - drive.h   — driveSetAll(), driveSetRawMask(), driveGetOutput()
+ *   - lease.h   — проверка аренды при запуске
+ *   - mailbox.h — запросы httpd → задача управления
+ *   - wave_format.h — формат, waveValidate()
+ *   - config.h  — WAVE_*, CONTROL_RATE_HZ
+ *
+ * ============================================================
+ */
+
+#include "wave.h"
+#include "config.h"
+#include "log.h"
+#include "lease.h"
+#include "mailbox.h"
+#include <atomic>
+#include <esp_heap_caps.h>
+#include <esp_timer.h>
+
+static_assert(WAVE_CHANNELS == MOTOR_COUNT, "WAVE_CHANNELS ≠ MOTOR_COUNT");
+
+// --- Форма и журнал (PSRAM) ---
+static uint8_t*      waveBuf = NULL;                     // Пишет httpd, когда !waveBusy()
+static WaveLogEntry* logBuf = NULL;                      // Пишет задача управления
+static portMUX_TYPE  waveMux = portMUX_INITIALIZER_UNLOCKED;
+static WaveStatus    status = {};                        // Под waveMux
+
+// --- Запросы httpd → задача управления ---
+enum WaveAction : uint8_t { WAVE_REQ_START, WAVE_REQ_STOP };
+struct WaveRequest {
+    WaveAction action;
+};
+static LatestMailbox<WaveRequest> requests;
+static std::atomic<bool> startPending(false);
+static std::atomic<bool> running(false);
+
+// --- Прогон (только задача управления) ---
+static struct {
+    uint8_t  mask;
+    uint8_t  n;                     // Каналов в маске
+    uint8_t  channels[MOTOR_COUNT]; // Индексы каналов по возрастанию
+    uint16_t count;
+    uint16_t div;                   // Тиков на отсчёт
+    uint32_t periodUs;              // Период отсчёта
+    uint32_t startUs;
+    uint16_t index;                 // Следующий отсчёт
+    uint16_t ticks;                 // Тиков с последнего отсчёта
+    uint32_t logged;
+    bool     pendingLog;            // Отсчёт применён, журнал — после driveTick
+    uint32_t tickUs;
+    uint16_t sample;
+} run;
+
+static inline uint16_t rd16(const uint8_t* p) {
+    return (uint16_t)p[0] | ((uint16_t)p[1] << 8);
+}
+
+void waveInit() {
+    waveBuf = (uint8_t*)heap_caps_malloc(WAVE_FORMAT_MAX, MALLOC_CAP_SPIRAM);
+    logBuf = (WaveLogEntry*)heap_caps_malloc((size_t)WAVE_MAX_SAMPLES * sizeof(WaveLogEntry),
+                                             MALLOC_CAP_SPIRAM);
+    if (!waveBuf || !logBuf) {
+        free(waveBuf);
+        free(logBuf);
+        waveBuf = NULL;
+        logBuf = NULL;
+        Serial.println("⚠️ Wave: нет PSRAM — проигрыватель форм выключен");
+        return;
+    }
+    Serial.printf("✅ Wave: до %d отсчётов (%u КБ PSRAM)\n", WAVE_MAX_SAMPLES,
+                  (unsigned)((WAVE_FORMAT_MAX + WAVE_MAX_SAMPLES * sizeof(WaveLogEntry)) / 1024));
+}
+
+// ============================================================
+// Запросы (задача httpd)
+// ============================================================
+
+bool waveLoad(const uint8_t* buf, size_t len, const char** error) {
+    if (!waveBuf) {
+        if (error) *error = "No memory";
+        return false;
+    }
+    if (waveBusy()) {
+        if (error) *error = "Busy";
+        return false;
+    }
+    if (!waveValidate(buf, len, error)) return false;
+
+    memcpy(waveBuf, buf, len);
+    portENTER_CRITICAL(&waveMux);
+    status.mask = buf[3];
+    status.rateHz = rd16(buf + 4);
+    status.count = rd16(buf + 6);
+    portEXIT_CRITICAL(&waveMux);
+    return true;
+}
+
+bool waveStart(uint32_t lease) {
+    portENTER_CRITICAL(&waveMux);
+    bool loaded = status.count > 0;
+    portEXIT_CRITICAL(&waveMux);
+    if (!loaded) return false;
+    if (!leaseCheck(lease)) return false;
+
+    startPending.store(true);
+    requests.post({WAVE_REQ_START});
+    return true;
+}
+
+void waveStop() {
+    requests.post({WAVE_REQ_STOP});
+}
+
+bool waveBusy() {
+    return startPending.load() || running.load();
+}
+
+WaveStatus waveGetStatus() {
+    portENTER_CRITICAL(&waveMux);
+    WaveStatus st = status;
+    portEXIT_CRITICAL(&waveMux);
+    return st;
+}
+
+size_t waveReadLog(uint32_t index, WaveLogEntry* out, size_t max) {
+    if (!logBuf || waveBusy()) return 0;
+    uint32_t logged = waveGetStatus().logged;
+    if (index >= logged) return 0;
+    size_t n = logged - index;
+    if (n > max) n = max;
+    memcpy(out, logBuf + index, n * sizeof(WaveLogEntry));
+    return n;
+}
+
+// ============================================================
+// Проигрывание (задача управления)
+// ============================================================
+
+static void beginRun(uint32_t nowUs) {
+    run.mask = waveBuf[3];
+    run.n = 0;
+    for (uint8_t i = 0; i < MOTOR_COUNT; i++) {
+        if (run.mask & (1 << i)) run.channels[run.n++] = i;
+    }
+    uint16_t rate = rd16(waveBuf + 4);
+    run.count = rd16(waveBuf + 6);
+    run.div = CONTROL_RATE_HZ / rate;
+    run.periodUs = 1000000UL / rate;
+    run.startUs = nowUs;
+    run.index = 0;
+    run.ticks = 0;
+    run.logged = 0;
+    run.pendingLog = false;
+
+    DriveState zero = {};
+    driveSetAll(zero);
+    driveSetRawMask(run.mask);
+    running.store(true);
+
+    portENTER_CRITICAL(&waveMux);
+    status.state = WAVE_RUNNING;
+    status.abort = WAVE_ABORT_NONE;
+    status.played = 0;
+    status.logged = 0;
+    status.devUsMax = 0;
+    status.runs++;
+    portEXIT_CRITICAL(&waveMux);
+    LOG_I("〰️ Форма: %u отсчётов × %u кан. по %u Гц", run.count, run.n, rate);
+}
+
+static void finish(WaveState state, WaveAbort reason, bool zeroTargets) {
+    driveSetRawMask(0);
+    if (zeroTargets) {
+        DriveState zero = {};
+        driveSetAll(zero);
+    }
+    run.pendingLog = false;
+    running.store(false);
+
+    portENTER_CRITICAL(&waveMux);
+    status.state = state;
+    status.abort = reason;
+    portEXIT_CRITICAL(&waveMux);
+}
+
+bool waveTick(uint32_t nowUs) {
+    bool began = false;
+    WaveRequest req;
+    if (requests.take(&req)) {
+        if (req.action == WAVE_REQ_START && waveBuf) {
+            beginRun(nowUs);
+            began = true;
+        } else if (req.action == WAVE_REQ_STOP && running.load()) {
+            finish(WAVE_ABORTED, WAVE_ABORT_STOP, true);
+            LOG_I("〰️ Форма остановлена на отсчёте %u", run.index);
+        }
+        startPending.store(false);
+    }
+    if (!running.load()) return began;
+
+    if (run.ticks == 0) {
+        if (run.index >= run.count) {
+            finish(WAVE_DONE, WAVE_ABORT_NONE, true);
+            LOG_I("〰️ Форма проиграна: %u отсчётов", run.count);
+            return began;
+        }
+
+        DriveState next = driveGetState();
+        const uint8_t* s = waveBuf + WAVE_HEADER_LEN + (size_t)run.index * run.n;
+        for (uint8_t k = 0; k < run.n; k++) next.speed[run.channels[k]] = s[k];
+        driveSetAll(next);
+
+        uint32_t ideal = run.startUs + (uint32_t)run.index * run.periodUs;
+        int32_t dev = (int32_t)(nowUs - ideal);
+        if (dev < 0) dev = -dev;
+        portENTER_CRITICAL(&waveMux);
+        if ((uint32_t)dev > status.devUsMax) status.devUsMax = dev;
+        portEXIT_CRITICAL(&waveMux);
+
+        run.pendingLog = true;
+        run.tickUs = nowUs;
+        run.sample = run.index;
+        run.index++;
+    }
+    if (++run.ticks >= run.div) run.ticks = 0;
+    return began;
+}
+
+void waveAfterTick(uint8_t written) {
+    if (!run.pendingLog) return;
+    run.pendingLog = false;
+
+    WaveLogEntry& e = logBuf[run.logged++];
+    e.tickUs = run.tickUs;
+    e.doneUs = (uint32_t)esp_timer_get_time();
+    e.sample = run.sample;
+    e.written = written;
+    memcpy(e.out, driveGetOutput().speed, MOTOR_COUNT);
+    e.reserved = 0;
+
+    portENTER_CRITICAL(&waveMux);
+    status.played = run.sample + 1;
+    status.logged = run.logged;
+    portEXIT_CRITICAL(&waveMux);
+}
+
+bool waveRunning() {
+    return running.load();
+}
+
+void waveOverride(bool zeroTargets) {
+    if (!running.load()) return;
+    finish(WAVE_ABORTED, WAVE_ABORT_OVERRIDE, zeroTargets);
+    LOG_I("〰️ Форма прервана на отсчёте %u", run.index);
+}
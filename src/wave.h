@@ -0,0 +1,145 @@
+/**
+ * ============================================================
+ * 〰️ wave.h — Проигрыватель форм скважности (характеризация моторов)
+ * ============================================================
+ *
+ * Ступеньки, чирпы и ПСП через инкременты /api/drive получают
+ * джиттер HTTP на каждом отсчёте. Здесь форма загружается целиком
+ * (/api/wave?upload=1, собирает tools/wave.js) и проигрывается
+ * задачей управления — отсчёт на каждом N-м тике esp_timer'а
+ * (CONTROL_RATE_HZ / rateHz), без сети.
+ *
+ * Формат формы и проверка при загрузке — в wave_format.h (без
+ * Arduino, проверяется на хосте).
+ *
+ * Проигрывание:
+ *   - старт останавливает всё (цели 0), прерывает миссию и
+ *     следование; каналы маски выводятся мимо рампы и контура
+ *     скорости (driveSetRawMask) — скважность ровно из формы
+ *   - каждый отсчёт применяется ровно один раз, по порядку;
+ *     пропущенный тик сдвигает остаток формы — это видно по tickUs
+ *   - после последнего отсчёта — один период удержания, затем
+ *     цели 0 и обычный режим
+ *   - прерывают: ручная команда, миссия, аварийный стоп, waveStop()
+ *   - потолок «вперёд» и реверс через ноль действуют — журнал
+ *     показывает фактически выведенную скважность
+ *
+ * Журнал прогона — запись на каждый отсчёт (WaveLogEntry): время
+ * тика, время после записи в бэкенд и выход всех каналов.
+ * Скачивается GET /api/wave?download=1 (WaveLogHeader + записи).
+ *
+ * ============================================================
+ */
+
+#ifndef WAVE_H
+#define WAVE_H
+
+#include <Arduino.h>
+#include "drive.h"
+#include "wave_format.h"
+
+#define WAVE_LOG_MAGIC   "RWLG"
+#define WAVE_LOG_VERSION 1
+
+// --- Состояние ---
+enum WaveState : uint8_t {
+    WAVE_IDLE = 0,           // Не запускалась
+    WAVE_RUNNING,
+    WAVE_DONE,               // Проиграна целиком
+    WAVE_ABORTED             // Прервана (см. WaveAbort)
+};
+
+// --- Причина прерывания ---
+enum WaveAbort : uint8_t {
+    WAVE_ABORT_NONE = 0,
+    WAVE_ABORT_STOP,         // waveStop()
+    WAVE_ABORT_OVERRIDE      // Ручная команда, миссия, аварийный стоп
+};
+
+// --- Запись журнала прогона (16 байт) ---
+struct __attribute__((packed)) WaveLogEntry {
+    uint32_t tickUs;                // esp_timer пробуждения тика, применившего отсчёт
+    uint32_t doneUs;                // esp_timer после записи в бэкенд (driveTick)
+    uint16_t sample;                // Индекс отсчёта
+    uint8_t  written;               // Маска каналов, в которые записано на этом тике
+    uint8_t  out[MOTOR_COUNT];      // Выход всех каналов после тика
+    uint8_t  reserved;
+};
+
+// --- Заголовок скачиваемого журнала (16 байт) ---
+struct __attribute__((packed)) WaveLogHeader {
+    char     magic[4];              // "RWLG"
+    uint8_t  version;               // WAVE_LOG_VERSION
+    uint8_t  entrySize;             // sizeof(WaveLogEntry)
+    uint8_t  mask;                  // Каналы формы
+    uint8_t  reserved;
+    uint16_t rateHz;                // Частота отсчётов формы
+    uint16_t controlHz;             // CONTROL_RATE_HZ прошивки
+    uint32_t count;                 // Записей
+};
+
+// --- Состояние для /api/wave ---
+struct WaveStatus {
+    WaveState state;
+    WaveAbort abort;
+    uint8_t   mask;                 // Каналы загруженной формы
+    uint16_t  rateHz;               // Частота отсчётов загруженной формы
+    uint16_t  count;                // Отсчётов в загруженной форме (0 — нет)
+    uint16_t  played;               // Применено отсчётов в текущем/последнем прогоне
+    uint32_t  logged;               // Записей журнала прогона
+    uint32_t  devUsMax;             // Макс. |tickUs − старт − i × период| (мкс)
+    uint32_t  runs;                 // Запусков всего
+};
+
+/** @brief Выделить буферы формы и журнала (PSRAM). Вызывать до controlInit(). */
+void waveInit();
+
+/**
+ * @brief Проверить и загрузить форму (только httpd)
+ * @param error Текст ошибки (может быть NULL)
+ * @return false — форма отклонена или идёт проигрывание
+ */
+bool waveLoad(const uint8_t* buf, size_t len, const char** error);
+
+/**
+ * @brief Запустить проигрывание (с ближайшего тика управления)
+ * @param lease Токен аренды управления (lease.h)
+ * @return false — нет формы или отклонено арендой
+ */
+bool waveStart(uint32_t lease = 0);
+
+/** @brief Остановить проигрывание */
+void waveStop();
+
+/** @brief Форма проигрывается или запуск ожидает тика */
+bool waveBusy();
+
+/** @brief Состояние (копия) */
+WaveStatus waveGetStatus();
+
+/**
+ * @brief Прочитать записи журнала последнего прогона (только когда не waveBusy())
+ * @return Прочитано записей
+ */
+size_t waveReadLog(uint32_t index, WaveLogEntry* out, size_t max);
+
+/**
+ * @brief Шаг проигрывателя до рампы (только задача управления)
+ * @param nowUs esp_timer_get_time() тика
+ * @return true — на этом тике начат прогон
+ */
+bool waveTick(uint32_t nowUs);
+
+/** @brief После driveTick(): запись журнала (только задача управления) */
+void waveAfterTick(uint8_t written);
+
+/** @brief Прогон идёт (только задача управления) */
+bool waveRunning();
+
+/**
+ * @brief Ручная команда / миссия / e-stop — прервать (только задача управления)
+ * @param zeroTargets false — цели уже задал новый владелец (миссия)
+ */
+void waveOverride(bool zeroTargets = true);
+
+#endif // WAVE_H
@@ -0,0 +1,48 @@
+/**
+ * ============================================================
+ * 〰️ wave_format.cpp — Проверка формы скважности
+ * ============================================================
+ *
+ * Зависимости:
+ *   - config.h — WAVE_MAX_SAMPLES, CONTROL_RATE_HZ
+ *
+ * ============================================================
+ */
+
+#include "wave_format.h"
+
+static_assert(WAVE_MAX_SAMPLES <= 0xFFFF, "WAVE_MAX_SAMPLES не помещается в count:u16");
+
+static inline uint16_t rd16(const uint8_t* p) {
+    return (uint16_t)p[0] | ((uint16_t)p[1] << 8);
+}
+
+uint8_t waveChannelCount(uint8_t mask) {
+    uint8_t n = 0;
+    for (uint8_t i = 0; i < WAVE_CHANNELS; i++) n += (mask >> i) & 1;
+    return n;
+}
+
+bool waveValidate(const uint8_t* buf, size_t len, const char** error) {
+    const char* err = NULL;
+    if (len < WAVE_HEADER_LEN || len > WAVE_FORMAT_MAX) {
+        err = "Bad size";
+    } else if (buf[0] != WAVE_MAGIC_0 || buf[1] != WAVE_MAGIC_1 || buf[2] != WAVE_VERSION) {
+        err = "Bad header";
+    } else {
+        uint8_t mask = buf[3];
+        uint16_t rate = rd16(buf + 4);
+        uint16_t count = rd16(buf + 6);
+        if (mask == 0 || mask >= (1 << WAVE_CHANNELS)) {
+            err = "Bad channel mask";
+        } else if (rate == 0 || rate > CONTROL_RATE_HZ || CONTROL_RATE_HZ % rate != 0) {
+            err = "Rate must divide CONTROL_RATE_HZ";
+        } else if (count == 0 || count > WAVE_MAX_SAMPLES) {
+            err = "Bad sample count";
+        } else if (len != WAVE_HEADER_LEN + (size_t)count * waveChannelCount(mask)) {
+            err = "Size does not match count";
+        }
+    }
+    if (error) *error = err;
+    return err == NULL;
+}
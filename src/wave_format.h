@@ -0,0 +1,54 @@
+/**
+ * ============================================================
+ * 〰️ wave_format.h — Формат формы скважности и его проверка
+ * ============================================================
+ *
+ * Формат формы (little-endian):
+ *
+ *   off  size  поле
+ *   0    2     magic    "RW"
+ *   2    1     version  WAVE_VERSION
+ *   3    1     mask     каналы (бит = индекс enum Motor: RL FR FL RR)
+ *   4    2     rateHz   частота отсчётов, делитель CONTROL_RATE_HZ
+ *   6    2     count    отсчётов, 1..WAVE_MAX_SAMPLES
+ *   8    ...   count × n байт: скважность 0-255 каналов маски по
+ *              возрастанию индекса (n — число каналов маски)
+ *
+ * Форма проверяется целиком при загрузке (waveValidate):
+ * заголовок, непустая маска из WAVE_CHANNELS каналов, частота
+ * делит CONTROL_RATE_HZ, размер ровно под count отсчётов.
+ * Проигрыватель (wave.cpp) поэтому не проверяет границы.
+ *
+ * Модуль не зависит от Arduino/IDF — проверка одна и та же
+ * на устройстве и на хосте.
+ *
+ * ============================================================
+ */
+
+#ifndef WAVE_FORMAT_H
+#define WAVE_FORMAT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "config.h"
+
+#define WAVE_MAGIC_0     'R'
+#define WAVE_MAGIC_1     'W'
+#define WAVE_VERSION     1
+#define WAVE_HEADER_LEN  8
+#define WAVE_CHANNELS    4           // = MOTOR_COUNT (drive.h)
+
+// Наибольшая форма: все каналы, WAVE_MAX_SAMPLES отсчётов
+#define WAVE_FORMAT_MAX  (WAVE_HEADER_LEN + (size_t)WAVE_MAX_SAMPLES * WAVE_CHANNELS)
+
+/** @brief Число каналов в маске */
+uint8_t waveChannelCount(uint8_t mask);
+
+/**
+ * @brief Проверить форму целиком (заголовок и размер)
+ * @param error Текст ошибки (может быть NULL; NULL — форма верна)
+ * @return false — форма отклонена
+ */
+bool waveValidate(const uint8_t* buf, size_t len, const char** error);
+
+#endif // WAVE_FORMAT_H
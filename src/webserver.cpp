@@ -10,9 +10,21 @@
  *      • REST API:
  *        - GET/POST /api/drive    — отладочное управление моторами (без watchdog)
  *        - GET/POST /api/control  — живое управление (джойстик, с watchdog)
+ *        - GET/POST /api/lease    — аренда управления (приоритет, TTL)
+ *        - GET/POST /api/estop    — аварийный стоп: состояние, снятие защёлки
+ *        - GET/POST /api/scene    — защита хода вперёд по смене сцены
+ *        - GET/POST /api/follow   — следование за движением (цикл на устройстве)
+ *        - GET/POST /api/mixer    — expo/ремап осей джойстика (таблицы)
+ *        - GET/POST /api/recorder — журнал команд: скачивание, воспроизведение
+ *        - GET/POST /api/mission  — байткод-сценарии движения (загрузка, запуск)
+ *        - GET/POST /api/wave     — формы скважности (загрузка, прогон, журнал)
+ *        - WS        /ws/control  — то же управление по WebSocket
  *        - GET       /api/status  — телеметрия для OSD-виджетов
- *        - GET       /photo       — одиночный JPEG-снимок
+ *        - GET       /photo       — одиночный JPEG-снимок (?scale=2|4|8 — миниатюра)
+ *        - GET   /api/thumbnail   — бенчмарк воркера миниатюр
  *        - GET/POST  /led         — управление IR-подсветкой
+ *        - GET/POST /api/rtp      — RTP/UDP стрим (старт/стоп, статистика)
+ *        - GET       /rtp.sdp     — SDP-описание RTP-стрима для VLC/ffplay
  *
  *   2. MJPEG стрим-сервер (порт 81) — Raw TCP, Round-Robin
  *      • Работает в отдельной FreeRTOS-задаче (streamServerTask)
@@ -20,11 +32,22 @@
  *      • Кадры распределяются по round-robin: каждый клиент получает
  *        каждый N-й кадр (где N = кол-во клиентов)
  *      • Non-blocking accept для приёма новых подключений
+ *      • /stream?abbrev=1 — сокращённые JPEG (таблицы один раз)
+ *      • /stream?scale=4  — уменьшенный стрим (перекодирование в фоне)
+ *      • /stream?telemetry=5 — JSON-телеметрия part'ами между кадрами
+ *      • Параллельно каждый кадр уходит в RTP/UDP (rtp_stream.h),
+ *        если задан адресат
  *
  * Зависимости:
  *   - camera.h  — cameraCapture() для получения JPEG-кадров
  *   - drive.h   — driveGetState() для текущего состояния моторов
- *   - control.h — controlGetState(), controlSetXY() и др.
+ *   - control.h — controlSetXY(), controlSetMovement() и др.
+ *   - rtp_stream.h — RTP/UDP отправка кадров (RFC 2435)
+ *   - jpeg_util.h  — разбор JPEG для сокращённого режима стрима
+ *   - thumbnail.h  — перекодирование в 1/2, 1/4, 1/8 (фоновый воркер)
+ *   - recorder.h   — журнал команд управления
+ *   - system_state.h — снимок моторов/управления/стрима для /api/status,
+ *                      /api/control, ACK /ws/control и телеметрии (seqlock)
  *   - config.h  — пины, порты, таймауты
  *   - ArduinoJson — парсинг JSON в POST-запросах
  *   - SPIFFS     — файловая система для статических ресурсов
@@ -35,15 +58,32 @@
 
 #include "webserver.h"
 #include "config.h"
+#include "log.h"
 #include "camera.h"
 #include "drive.h"
+#include "encoder.h"
 #include "control.h"
+#include "rtp_stream.h"
+#include "jpeg_util.h"
+#include "thumbnail.h"
+#include "udp_control.h"
+#include "mixer.h"
+#include "recorder.h"
+#include "lease.h"
+#include "mission.h"
+#include "wave.h"
+#include "estop.h"
+#include "scene_guard.h"
+#include "vision.h"
+#include "follow.h"
+#include "system_state.h"
 #include <esp_http_server.h>
 #include <SPIFFS.h>
 #include <ArduinoJson.h>
 
 #include <WiFi.h>
 #include <esp_heap_caps.h>
+#include <esp_timer.h>
 #include <lwip/sockets.h>
 #include <lwip/netdb.h>
 
@@ -73,15 +113,59 @@ static bool irLedOn = false;             // Текущее состояние IR
 //   - Массив сдвигается, RR-индекс корректируется
 //   - При переполнении (>4 клиентов) — HTTP 503
 //
+// Режимы клиента (query-параметры запроса /stream):
+//   - по умолчанию — обычный MJPEG, каждый part = полный JPEG
+//   - ?abbrev=1   — сокращённый JPEG: заголовок (DQT/SOF/DHT/SOS) уходит
+//     отдельным part'ом application/x-jpeg-tables при подключении и при
+//     смене качества/разрешения, далее только scan-данные
+//     (image/x-jpeg-scan, без EOI). Сборка — data/mjpeg-reader.js
+//   - ?scale=2|4|8 — уменьшенный стрим: кадры перекодирует воркер
+//     миниатюр (thumbnail.h) на другом ядре, клиент получает последнюю
+//     готовую миниатюру в свою очередь round-robin (без ожидания)
+//   - ?telemetry=N — N раз в секунду (1..STREAM_TELEMETRY_MAX_HZ) между
+//     кадрами вставляется part application/json с той же телеметрией,
+//     что и /api/status: OSD получает данные без отдельного polling'а
+//
 
 #define STREAM_MAX_CLIENTS 4     // Макс. одновременных стрим-клиентов
 #define STREAM_BOUNDARY    "----ESP32CAM"  // MIME boundary для multipart
 #define STREAM_FRAME_DELAY 50    // Задержка между кадрами (мс), ~20 FPS базовая
-
-static int  streamClients[STREAM_MAX_CLIENTS];  // Массив файловых дескрипторов клиентов
+#define STREAM_REQ_TIMEOUT 200   // Таймаут чтения строки запроса клиента (мс)
+
+// --- Режимы стрим-клиента ---
+enum StreamMode : uint8_t {
+    STREAM_MODE_FULL = 0,    // Полные JPEG-кадры (совместимо с <img>)
+    STREAM_MODE_ABBREV       // Таблицы один раз + только scan-данные
+};
+
+// --- Состояние стрим-клиента ---
+struct StreamClient {
+    int        fd;           // Файловый дескриптор сокета
+    StreamMode mode;         // Режим отправки кадров
+    uint8_t    scale;        // 1 = полный кадр, 2/4/8 — уменьшенный
+    uint32_t   tablesHash;   // Хэш последнего отправленного заголовка (0 = ещё не отправлен)
+    uint16_t   telemetryMs;  // Период телеметрии (мс), 0 = выключена
+    unsigned long lastTelemetry;  // millis() последней отправки телеметрии
+};
+
+static StreamClient streamClients[STREAM_MAX_CLIENTS];  // Подключённые клиенты
 static int  streamClientCount = 0;               // Текущее кол-во подключённых клиентов
 static int  streamRRIndex     = 0;               // Текущий индекс round-robin
 
+// --- Учёт трафика (для оценки экономии сокращённого режима) ---
+#define STATUS_JSON_SIZE 768                           // Буфер JSON телеметрии
+static int statusJsonBuild(char* json, size_t size);  // Status API (ниже)
+
+static uint32_t streamBytesSent    = 0;  // Всего отправлено байт кадров
+static uint32_t streamBytesSaved   = 0;  // Не отправлено байт заголовков (abbrev)
+static uint32_t streamBps          = 0;  // Байт/с за последнюю секунду
+static uint32_t streamSavedBps     = 0;  // Сэкономлено байт/с за последнюю секунду
+
+/** Клиенты и байт/с — в снимок состояния (только задача стрима) */
+static void streamPublishState() {
+    systemStatePublishStream((uint8_t)streamClientCount, streamBps, streamSavedBps);
+}
+
 // HTTP-заголовки для нового MJPEG-клиента (отправляются один раз при подключении)
 static const char STREAM_HTTP_RESPONSE[] =
     "HTTP/1.1 200 OK\r\n"
@@ -99,8 +183,8 @@ static const char STREAM_HTTP_RESPONSE[] =
 static void streamRemoveClient(int idx) {
     if (idx < 0 || idx >= streamClientCount) return;
     
-    close(streamClients[idx]);
-    Serial.printf("🎥 Клиент #%d отключён (fd=%d)\n", idx, streamClients[idx]);
+    close(streamClients[idx].fd);
+    LOG_I("🎥 Клиент #%d отключён (fd=%d)", idx, streamClients[idx].fd);
     
     // Сдвигаем массив
     for (int i = idx; i < streamClientCount - 1; i++) {
@@ -114,8 +198,9 @@ static void streamRemoveClient(int idx) {
     } else {
         streamRRIndex = streamRRIndex % streamClientCount;
     }
+    streamPublishState();
     
-    Serial.printf("📊 Стрим-клиентов: %d\n", streamClientCount);
+    LOG_I("📊 Стрим-клиентов: %d", streamClientCount);
 }
 
 /**
@@ -136,12 +221,57 @@ static bool streamSendAll(int fd, const char* buf, size_t len) {
     return true;
 }
 
+/**
+ * Прочитать строку HTTP-запроса клиента и определить режим стрима.
+ * Ждёт не дольше STREAM_REQ_TIMEOUT мс; при таймауте — обычный режим.
+ * @param fd     Сокет клиента
+ * @param client Заполняемое состояние клиента
+ */
+static void streamParseRequest(int fd, StreamClient* client) {
+    client->mode = STREAM_MODE_FULL;
+    client->scale = 1;
+    client->tablesHash = 0;
+    client->telemetryMs = 0;
+    client->lastTelemetry = 0;
+
+    struct timeval tv;
+    tv.tv_sec = 0;
+    tv.tv_usec = STREAM_REQ_TIMEOUT * 1000;
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+    // Достаточно первой строки: "GET /stream?abbrev=1&t=... HTTP/1.1"
+    char req[256];
+    int n = recv(fd, req, sizeof(req) - 1, 0);
+    if (n <= 0) return;
+    req[n] = '\0';
+
+    char* lineEnd = strstr(req, "\r\n");
+    if (lineEnd) *lineEnd = '\0';
+    const char* query = strchr(req, '?');
+    if (!query) return;
+
+    if (strstr(query, "abbrev=1")) client->mode = STREAM_MODE_ABBREV;
+
+    const char* scaleParam = strstr(query, "scale=");
+    if (scaleParam) {
+        uint8_t scale = (uint8_t)atoi(scaleParam + 6);
+        if (thumbnailValidScale(scale)) client->scale = scale;
+    }
+
+    const char* telemetryParam = strstr(query, "telemetry=");
+    if (telemetryParam) {
+        int hz = constrain(atoi(telemetryParam + 10), 0, STREAM_TELEMETRY_MAX_HZ);
+        if (hz > 0) client->telemetryMs = 1000 / hz;
+    }
+}
+
 /**
  * Принять новых TCP-клиентов (non-blocking accept).
  * Для каждого нового клиента:
+ *   - Читает строку запроса (режим стрима из query)
  *   - Отправляет HTTP-заголовки MJPEG multipart
  *   - Устанавливает таймаут на send (2 сек)
- *   - Добавляет fd в массив streamClients
+ *   - Добавляет клиента в массив streamClients
  * При превышении лимита клиентов отвечает HTTP 503.
  * @param serverFd Серверный сокет (non-blocking)
  */
@@ -158,10 +288,14 @@ static void streamAcceptClients(int serverFd) {
             const char* busy = "HTTP/1.1 503 Service Unavailable\r\n\r\nMax stream clients reached\n";
             send(clientFd, busy, strlen(busy), 0);
             close(clientFd);
-            Serial.println("⚠️ Стрим: макс. клиентов, отклонён");
+            LOG_W("⚠️ Стрим: макс. клиентов, отклонён");
             continue;
         }
         
+        StreamClient client;
+        client.fd = clientFd;
+        streamParseRequest(clientFd, &client);
+
         // Отправляем HTTP-заголовки MJPEG
         if (!streamSendAll(clientFd, STREAM_HTTP_RESPONSE, strlen(STREAM_HTTP_RESPONSE))) {
             close(clientFd);
@@ -175,37 +309,117 @@ static void streamAcceptClients(int serverFd) {
         setsockopt(clientFd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
         
         // Добавляем в массив
-        streamClients[streamClientCount] = clientFd;
+        streamClients[streamClientCount] = client;
         streamClientCount++;
+        streamPublishState();
         
-        Serial.printf("🎥 Новый стрим-клиент (fd=%d), всего: %d\n", clientFd, streamClientCount);
+        LOG_I("🎥 Новый стрим-клиент (fd=%d, %s, 1/%d%s), всего: %d", clientFd,
+              client.mode == STREAM_MODE_ABBREV ? "abbrev" : "full",
+              client.scale, client.telemetryMs ? ", telemetry" : "",
+              streamClientCount);
+    }
+}
+
+/**
+ * Отправить один multipart part клиенту.
+ * @param fd          Сокет клиента
+ * @param contentType MIME-тип part'а
+ * @param data        Тело part'а
+ * @param len         Размер тела (байт)
+ * @return true если отправлено целиком
+ */
+static bool streamSendPart(int fd, const char* contentType, const uint8_t* data, size_t len) {
+    char partHeader[128];
+    int headerLen = snprintf(partHeader, sizeof(partHeader),
+        "\r\n--" STREAM_BOUNDARY "\r\n"
+        "Content-Type: %s\r\n"
+        "Content-Length: %u\r\n\r\n",
+        contentType, (unsigned)len);
+
+    if (!streamSendAll(fd, partHeader, headerLen) ||
+        !streamSendAll(fd, (const char*)data, len)) {
+        return false;
+    }
+    streamBytesSent += headerLen + len;
+    return true;
+}
+
+/**
+ * Отправить кадр клиенту в сокращённом режиме.
+ * Заголовок JPEG уходит только если клиент его ещё не получал
+ * или он изменился (смена качества/разрешения).
+ * Кадры, которые не удалось разобрать, отправляются целиком.
+ */
+static bool streamSendAbbrev(StreamClient* client, camera_fb_t* fb) {
+    JpegInfo jpeg;
+    if (!jpegParse(fb->buf, fb->len, &jpeg)) {
+        return streamSendPart(client->fd, "image/jpeg", fb->buf, fb->len);
+    }
+
+    uint32_t hash = jpegHash(fb->buf, jpeg.headerLen);
+    if (hash != client->tablesHash) {
+        if (!streamSendPart(client->fd, "application/x-jpeg-tables", fb->buf, jpeg.headerLen)) {
+            return false;
+        }
+        client->tablesHash = hash;
+    } else {
+        streamBytesSaved += jpeg.headerLen;
+    }
+
+    // EOI (2 байта) клиент дописывает сам
+    streamBytesSaved += fb->len - jpeg.headerLen - jpeg.scanLen;
+    return streamSendPart(client->fd, "image/x-jpeg-scan", fb->buf + jpeg.headerLen, jpeg.scanLen);
+}
+
+/**
+ * Отправить клиенту уменьшенного стрима последнюю готовую миниатюру.
+ * Если воркер ещё не успел — клиент пропускает свою очередь.
+ */
+static bool streamSendThumbnail(StreamClient* client) {
+    uint8_t* jpg = NULL;
+    size_t len = 0;
+    if (!thumbnailTake(client->scale, &jpg, &len)) return true;
+
+    bool ok = streamSendPart(client->fd, "image/jpeg", jpg, len);
+    free(jpg);
+    return ok;
+}
+
+/**
+ * Маска масштабов, нужных подключённым клиентам уменьшенного стрима.
+ */
+static uint8_t streamThumbMask() {
+    uint8_t mask = 0;
+    for (int i = 0; i < streamClientCount; i++) {
+        mask |= THUMB_MASK(streamClients[i].scale);
     }
+    return mask;
 }
 
 /**
  * Отправить JPEG-кадр следующему клиенту по round-robin.
- * Формирует MJPEG part (boundary + Content-Type + Content-Length + данные).
- * При ошибке отправки удаляет клиента из массива.
+ * Формирует MJPEG part (boundary + Content-Type + Content-Length + данные)
+ * в режиме клиента. При ошибке отправки удаляет клиента из массива.
  * @param fb Указатель на framebuffer камеры (JPEG)
  */
 static void streamSendFrame(camera_fb_t* fb) {
     if (streamClientCount == 0) return;
     
+    // Кадр для уменьшенных клиентов перекодируется в фоне
+    thumbnailSubmit(fb, streamThumbMask());
+
     // Round-robin: берём текущего клиента
     int idx = streamRRIndex;
-    int fd  = streamClients[idx];
-    
-    // Формируем MJPEG part
-    char partHeader[128];
-    int headerLen = snprintf(partHeader, sizeof(partHeader),
-        "\r\n--" STREAM_BOUNDARY "\r\n"
-        "Content-Type: image/jpeg\r\n"
-        "Content-Length: %u\r\n\r\n",
-        (unsigned)fb->len);
+    StreamClient* client = &streamClients[idx];
     
-    // Отправляем заголовок + данные
-    bool ok = streamSendAll(fd, partHeader, headerLen) &&
-              streamSendAll(fd, (const char*)fb->buf, fb->len);
+    bool ok;
+    if (client->scale > 1) {
+        ok = streamSendThumbnail(client);
+    } else if (client->mode == STREAM_MODE_ABBREV) {
+        ok = streamSendAbbrev(client, fb);
+    } else {
+        ok = streamSendPart(client->fd, "image/jpeg", fb->buf, fb->len);
+    }
     
     if (!ok) {
         // Клиент отвалился — удаляем
@@ -217,16 +431,81 @@ static void streamSendFrame(camera_fb_t* fb) {
     }
 }
 
+/**
+ * Отправить part телеметрии всем клиентам, у которых подошёл период.
+ * В отличие от кадров — не round-robin: JSON маленький, а OSD должен
+ * обновляться с заданной частотой при любом числе клиентов.
+ * JSON собирается один раз на проход и только если он кому-то нужен.
+ */
+static void streamSendTelemetry() {
+    char json[STATUS_JSON_SIZE];
+    int jsonLen = -1;
+    unsigned long now = millis();
+
+    // Обратный порядок: удаление клиента сдвигает хвост массива
+    for (int i = streamClientCount - 1; i >= 0; i--) {
+        StreamClient* client = &streamClients[i];
+        if (client->telemetryMs == 0 || now - client->lastTelemetry < client->telemetryMs) continue;
+
+        if (jsonLen < 0) jsonLen = statusJsonBuild(json, sizeof(json));
+        client->lastTelemetry = now;
+        if (!streamSendPart(client->fd, "application/json", (const uint8_t*)json, jsonLen)) {
+            streamRemoveClient(i);
+        }
+    }
+}
+
+/**
+ * Пересчитать байт/с стрима и экономии раз в секунду.
+ * Вызывается из цикла streamServerTask().
+ */
+static void streamUpdateRates() {
+    static unsigned long windowStart = 0;
+    static uint32_t sentAtStart = 0;
+    static uint32_t savedAtStart = 0;
+
+    unsigned long now = millis();
+    if (now - windowStart < 1000) return;
+
+    unsigned long elapsed = now - windowStart;
+    streamBps      = (uint64_t)(streamBytesSent - sentAtStart) * 1000 / elapsed;
+    streamSavedBps = (uint64_t)(streamBytesSaved - savedAtStart) * 1000 / elapsed;
+
+    windowStart  = now;
+    sentAtStart  = streamBytesSent;
+    savedAtStart = streamBytesSaved;
+    streamPublishState();
+}
+
 // ============================================================
 // 📷 Фото — GET /photo
 // ============================================================
 // Делает одиночный JPEG-снимок через камеру и отдаёт клиенту.
 // Используется кнопкой "Фото" в UI.
+// GET /photo?scale=4 — миниатюра (1/2, 1/4, 1/8) без перенастройки сенсора.
+
+/**
+ * Прочитать целочисленный query-параметр запроса.
+ * @return defaultValue если параметра нет
+ */
+static int queryInt(httpd_req_t* req, const char* key, int defaultValue) {
+    char query[64];
+    char value[16];
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) != ESP_OK) return defaultValue;
+    if (httpd_query_key_value(query, key, value, sizeof(value)) != ESP_OK) return defaultValue;
+    return atoi(value);
+}
 
 /**
  * @brief Обработчик GET /photo — захват и отдача одного JPEG-кадра
  */
 static esp_err_t photoHandler(httpd_req_t* req) {
+    uint8_t scale = (uint8_t)queryInt(req, "scale", 1);
+    if (scale != 1 && !thumbnailValidScale(scale)) {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "scale: 1, 2, 4 or 8");
+        return ESP_FAIL;
+    }
+
     camera_fb_t* fb = cameraCapture(500);
     if (!fb) {
         httpd_resp_send_500(req);
@@ -236,11 +515,58 @@ static esp_err_t photoHandler(httpd_req_t* req) {
     httpd_resp_set_type(req, "image/jpeg");
     httpd_resp_set_hdr(req, "Content-Disposition", "inline; filename=capture.jpg");
     httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
-    esp_err_t res = httpd_resp_send(req, (const char*)fb->buf, fb->len);
-    esp_camera_fb_return(fb);
+
+    if (scale == 1) {
+        esp_err_t res = httpd_resp_send(req, (const char*)fb->buf, fb->len);
+        esp_camera_fb_return(fb);
+        return res;
+    }
+
+    // Миниатюра: кадр копируется и возвращается камере до перекодирования
+    uint8_t* thumb = NULL;
+    size_t thumbLen = 0;
+    if (!thumbnailEncode(fb, scale, &thumb, &thumbLen)) {
+        httpd_resp_send_500(req);
+        return ESP_FAIL;
+    }
+
+    esp_err_t res = httpd_resp_send(req, (const char*)thumb, thumbLen);
+    free(thumb);
     return res;
 }
 
+// ============================================================
+// 🖼️ Thumbnail API — GET /api/thumbnail (бенчмарк)
+// ============================================================
+// Пропускная способность и время этапов воркера миниатюр:
+//   { "frames", "failed", "dropped", "fps",
+//     "decode_us": {"avg","max"}, "encode_us": {"avg","max"} }
+
+static esp_err_t thumbnailApiHandler(httpd_req_t* req) {
+    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+    httpd_resp_set_type(req, "application/json");
+
+    ThumbnailStats st = thumbnailGetStats();
+    char json[256];
+    snprintf(json, sizeof(json),
+        "{"
+        "\"frames\":%lu,"
+        "\"failed\":%lu,"
+        "\"dropped\":%lu,"
+        "\"fps\":%lu,"
+        "\"decode_us\":{\"avg\":%lu,\"max\":%lu},"
+        "\"encode_us\":{\"avg\":%lu,\"max\":%lu}"
+        "}",
+        (unsigned long)st.frames,
+        (unsigned long)st.failed,
+        (unsigned long)st.dropped,
+        (unsigned long)st.fps,
+        (unsigned long)st.decodeUsAvg, (unsigned long)st.decodeUsMax,
+        (unsigned long)st.encodeUsAvg, (unsigned long)st.encodeUsMax
+    );
+    return httpd_resp_send(req, json, strlen(json));
+}
+
 // ============================================================
 // 💡 LED — GET /led, POST /led/toggle
 // ============================================================
@@ -255,6 +581,7 @@ static esp_err_t ledHandler(httpd_req_t* req) {
     if (req->method == HTTP_POST) {
         irLedOn = !irLedOn;
         digitalWrite(PIN_IR_LED, irLedOn ? HIGH : LOW);
+        systemStatePublishLed(irLedOn);
     }
 
     char json[32];
@@ -263,6 +590,341 @@ static esp_err_t ledHandler(httpd_req_t* req) {
     return httpd_resp_send(req, json, strlen(json));
 }
 
+// ============================================================
+// 🔑 Lease API — /api/lease (аренда управления)
+// ============================================================
+//
+// GET  — состояние аренды:
+//   {"held":true,"owner":"pilot","priority":10,"ttl_ms":3000,
+//    "remaining_ms":2710,"granted":3,"preempted":1,"expired":0,"rejected":42}
+// POST — { "action": "acquire", "priority": 10, "ttl_ms": 3000,
+//          "owner": "pilot", "token": 0 }   // свой токен — продление
+//        { "action": "release", "token": 123456 }
+//   acquire → 200 {"result":"granted|renewed","token":N,...состояние}
+//             409 {"result":"denied",...состояние держателя}
+//
+// Токен передаётся в командах: поле "lease" (POST /api/control,
+// /api/drive, /ws/control) или u32 в UDP-пакете версии 2.
+// Стоп принимается и без токена — и аренду не продлевает.
+//
+
+/**
+ * Сформировать JSON состояния аренды (без закрывающей скобки).
+ * @return Длина (как у snprintf)
+ */
+static int leaseJsonBuild(char* json, size_t size) {
+    LeaseInfo info = leaseGetInfo();
+    return snprintf(json, size,
+        "{"
+        "\"held\":%s,"
+        "\"owner\":\"%s\","
+        "\"priority\":%u,"
+        "\"ttl_ms\":%lu,"
+        "\"remaining_ms\":%lu,"
+        "\"granted\":%lu,"
+        "\"preempted\":%lu,"
+        "\"expired\":%lu,"
+        "\"rejected\":%lu",
+        info.held ? "true" : "false",
+        info.owner,
+        info.priority,
+        (unsigned long)info.ttlMs,
+        (unsigned long)info.remainingMs,
+        (unsigned long)info.granted,
+        (unsigned long)info.preempted,
+        (unsigned long)info.expired,
+        (unsigned long)info.rejected
+    );
+}
+
+/**
+ * Ответ на команду с чужим токеном: 409 и состояние аренды.
+ */
+static esp_err_t leaseRejected(httpd_req_t* req) {
+    char json[320];
+    int len = leaseJsonBuild(json, sizeof(json) - 32);
+    len += snprintf(json + len, sizeof(json) - len, ",\"error\":\"lease\"}");
+    httpd_resp_set_status(req, "409 Conflict");
+    httpd_resp_set_type(req, "application/json");
+    return httpd_resp_send(req, json, len);
+}
+
+/**
+ * @brief Обработчик /api/lease — взять/вернуть аренду управления
+ */
+static esp_err_t leaseApiHandler(httpd_req_t* req) {
+    // CORS preflight
+    if (req->method == HTTP_OPTIONS) {
+        httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+        httpd_resp_set_hdr(req, "Access-Control-Allow-Methods", "GET, POST, OPTIONS");
+        httpd_resp_set_hdr(req, "Access-Control-Allow-Headers", "Content-Type");
+        httpd_resp_send(req, NULL, 0);
+        return ESP_OK;
+    }
+
+    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+    httpd_resp_set_type(req, "application/json");
+
+    char json[384];
+    if (req->method == HTTP_GET) {
+        int len = leaseJsonBuild(json, sizeof(json) - 1);
+        json[len++] = '}';
+        return httpd_resp_send(req, json, len);
+    }
+
+    char body[192];
+    int recvLen = httpd_req_recv(req, body, sizeof(body) - 1);
+    if (recvLen <= 0) {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Empty body");
+        return ESP_FAIL;
+    }
+    body[recvLen] = '\0';
+
+    JsonDocument doc;
+    DeserializationError err = deserializeJson(doc, body);
+    if (err) {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid JSON");
+        return ESP_FAIL;
+    }
+
+    const char* action = doc["action"] | "";
+    uint32_t token = doc["token"] | 0UL;
+
+    if (strcmp(action, "release") == 0) {
+        bool ok = leaseRelease(token);
+        int len = leaseJsonBuild(json, sizeof(json) - 32);
+        len += snprintf(json + len, sizeof(json) - len, ",\"released\":%s}", ok ? "true" : "false");
+        return httpd_resp_send(req, json, len);
+    }
+    if (strcmp(action, "acquire") != 0) {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Unknown action");
+        return ESP_FAIL;
+    }
+
+    uint8_t priority = constrain((int)(doc["priority"] | 0), 0, 255);
+    uint32_t ttlMs = doc["ttl_ms"] | (uint32_t)LEASE_TTL_DEFAULT_MS;
+    LeaseResult res = leaseAcquire(priority, ttlMs, doc["owner"] | "", &token);
+
+    static const char* resultNames[] = {"granted", "renewed", "denied"};
+    int len = leaseJsonBuild(json, sizeof(json) - 64);
+    if (res == LEASE_DENIED) {
+        httpd_resp_set_status(req, "409 Conflict");
+        len += snprintf(json + len, sizeof(json) - len, ",\"result\":\"denied\"}");
+    } else {
+        len += snprintf(json + len, sizeof(json) - len, ",\"result\":\"%s\",\"token\":%lu}",
+                        resultNames[res], (unsigned long)token);
+    }
+    return httpd_resp_send(req, json, len);
+}
+
+// ============================================================
+// 🛑 E-stop API — /api/estop (аварийный стоп)
+// ============================================================
+//
+// Быстрый путь стопа — UDP-порт ESTOP_PORT (estop.h); этот API —
+// состояние защёлки и её снятие (и стоп, если UDP недоступен).
+//
+// GET  — {"latched":true,"source":"udp","stops":3,"clears":2,"malformed":0,
+//         "last_stop_us":41,"max_stop_us":97,"port":4211}
+//   last/max_stop_us — от приёма пакета до погашенных каналов LEDC
+// POST — { "action": "stop" | "clear" }
+//
+
+static esp_err_t estopApiHandler(httpd_req_t* req) {
+    uint32_t recvUs = (uint32_t)esp_timer_get_time();
+
+    // CORS preflight
+    if (req->method == HTTP_OPTIONS) {
+        httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+        httpd_resp_set_hdr(req, "Access-Control-Allow-Methods", "GET, POST, OPTIONS");
+        httpd_resp_set_hdr(req, "Access-Control-Allow-Headers", "Content-Type");
+        httpd_resp_send(req, NULL, 0);
+        return ESP_OK;
+    }
+
+    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+    httpd_resp_set_type(req, "application/json");
+
+    if (req->method == HTTP_POST) {
+        char body[64];
+        int len = httpd_req_recv(req, body, sizeof(body) - 1);
+        if (len <= 0) {
+            httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Empty body");
+            return ESP_FAIL;
+        }
+        body[len] = '\0';
+
+        JsonDocument doc;
+        if (deserializeJson(doc, body)) {
+            httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid JSON");
+            return ESP_FAIL;
+        }
+        const char* action = doc["action"] | "";
+        if (strcmp(action, "stop") == 0) {
+            estopTrigger(ESTOP_SRC_HTTP, recvUs);
+        } else if (strcmp(action, "clear") == 0) {
+            estopClear();
+        } else {
+            httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Unknown action");
+            return ESP_FAIL;
+        }
+    }
+
+    static const char* sourceNames[] = {"none", "udp", "http"};
+    EstopStats st = estopGetStats();
+    char json[224];
+    int len = snprintf(json, sizeof(json),
+        "{\"latched\":%s,\"source\":\"%s\",\"stops\":%lu,\"clears\":%lu,\"malformed\":%lu,"
+        "\"last_stop_us\":%lu,\"max_stop_us\":%lu,\"port\":%d}",
+        st.latched ? "true" : "false",
+        sourceNames[st.lastSource <= ESTOP_SRC_HTTP ? st.lastSource : ESTOP_SRC_NONE],
+        (unsigned long)st.stops, (unsigned long)st.clears, (unsigned long)st.malformed,
+        (unsigned long)st.lastStopUs, (unsigned long)st.maxStopUs, ESTOP_PORT);
+    return httpd_resp_send(req, json, len);
+}
+
+// ============================================================
+// 👁️ Scene guard API — /api/scene (защита по смене сцены)
+// ============================================================
+//
+// GET  — {"enabled":true,"armed":false,"capped":false,"score":12,"baseline":9,
+//         "frames":340,"stream_frames":300,"self_frames":40,"dropped":3,"failed":0,
+//         "triggers":1,"decode_us":13900,"analyze_us":300,"analyze_max_us":900,
+//         "react_us":31000,"react_max_us":52000,"cap":255}
+//   stream_frames … decode_us — общий источник кадров Vision (vision.h)
+//   react_us — от снимка кадра до выставленного потолка «вперёд»
+//   cap      — текущий потолок FL/FR (255 — без ограничения)
+// POST — { "enabled": true | false }
+//
+
+static esp_err_t sceneApiHandler(httpd_req_t* req) {
+    // CORS preflight
+    if (req->method == HTTP_OPTIONS) {
+        httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+        httpd_resp_set_hdr(req, "Access-Control-Allow-Methods", "GET, POST, OPTIONS");
+        httpd_resp_set_hdr(req, "Access-Control-Allow-Headers", "Content-Type");
+        httpd_resp_send(req, NULL, 0);
+        return ESP_OK;
+    }
+
+    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+    httpd_resp_set_type(req, "application/json");
+
+    if (req->method == HTTP_POST) {
+        char body[64];
+        int len = httpd_req_recv(req, body, sizeof(body) - 1);
+        if (len <= 0) {
+            httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Empty body");
+            return ESP_FAIL;
+        }
+        body[len] = '\0';
+
+        JsonDocument doc;
+        if (deserializeJson(doc, body)) {
+            httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid JSON");
+            return ESP_FAIL;
+        }
+        if (!doc["enabled"].is<bool>()) {
+            httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Missing enabled");
+            return ESP_FAIL;
+        }
+        sceneGuardSetEnabled(doc["enabled"].as<bool>());
+    }
+
+    SceneGuardStats st = sceneGuardGetStats();
+    VisionStats vs = visionGetStats();
+    char json[384];
+    int len = snprintf(json, sizeof(json),
+        "{\"enabled\":%s,\"armed\":%s,\"capped\":%s,\"score\":%u,\"baseline\":%u,"
+        "\"frames\":%lu,\"stream_frames\":%lu,\"self_frames\":%lu,\"dropped\":%lu,\"failed\":%lu,"
+        "\"triggers\":%lu,\"decode_us\":%lu,\"analyze_us\":%lu,\"analyze_max_us\":%lu,"
+        "\"react_us\":%lu,\"react_max_us\":%lu,\"cap\":%u}",
+        st.enabled ? "true" : "false", st.armed ? "true" : "false", st.capped ? "true" : "false",
+        st.score, st.baseline,
+        (unsigned long)st.frames, (unsigned long)vs.streamFrames, (unsigned long)vs.selfFrames,
+        (unsigned long)vs.dropped, (unsigned long)vs.failed, (unsigned long)st.triggers,
+        (unsigned long)vs.decodeUsAvg, (unsigned long)st.analyzeUsAvg, (unsigned long)st.analyzeUsMax,
+        (unsigned long)st.reactUsLast, (unsigned long)st.reactUsMax, driveGetForwardCap());
+    return httpd_resp_send(req, json, len);
+}
+
+// ============================================================
+// 🎯 Follow API — /api/follow (следование за движением)
+// ============================================================
+//
+// GET  — {"enabled":true,"tracking":true,"speed":0,"cx":-84,"cy":40,"area":57,
+//         "x":-126,"y":0,"frames":210,"found":150,"global":12,"lost":2,
+//         "applied":162,"overrides":0,"frame_us":66000,"decode_us":13900,
+//         "analyze_us":900,"analyze_max_us":1700,"steer_us":21000,"steer_max_us":48000,
+//         "loop_us":22000,"loop_avg_us":21500,"loop_max_us":49000}
+//   cx/cy    — центр цели (−256..256 от центра кадра), x/y — руль
+//   frame_us — период кадров анализа, steer_us — снимок → руль,
+//   loop_us  — снимок → руль применён задачей управления
+// POST — { "action": "start", "speed": 0, "lease": 0 } | { "action": "stop" }
+//
+// Запуск с чужим токеном аренды — 409 (как у /api/control).
+//
+
+static esp_err_t followApiHandler(httpd_req_t* req) {
+    // CORS preflight
+    if (req->method == HTTP_OPTIONS) {
+        httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+        httpd_resp_set_hdr(req, "Access-Control-Allow-Methods", "GET, POST, OPTIONS");
+        httpd_resp_set_hdr(req, "Access-Control-Allow-Headers", "Content-Type");
+        httpd_resp_send(req, NULL, 0);
+        return ESP_OK;
+    }
+
+    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+
+    if (req->method == HTTP_POST) {
+        char body[128];
+        int len = httpd_req_recv(req, body, sizeof(body) - 1);
+        if (len <= 0) {
+            httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Empty body");
+            return ESP_FAIL;
+        }
+        body[len] = '\0';
+
+        JsonDocument doc;
+        if (deserializeJson(doc, body)) {
+            httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid JSON");
+            return ESP_FAIL;
+        }
+
+        const char* action = doc["action"] | "";
+        if (strcmp(action, "start") == 0) {
+            int speed = constrain(doc["speed"] | FOLLOW_SPEED, 0, 255);
+            if (!followStart((uint8_t)speed, doc["lease"] | 0UL)) return leaseRejected(req);
+        } else if (strcmp(action, "stop") == 0) {
+            followStop();
+        } else {
+            httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Unknown action");
+            return ESP_FAIL;
+        }
+    }
+
+    FollowStats st = followGetStats();
+    VisionStats vs = visionGetStats();
+    char json[512];
+    int len = snprintf(json, sizeof(json),
+        "{\"enabled\":%s,\"tracking\":%s,\"speed\":%u,\"cx\":%d,\"cy\":%d,\"area\":%u,"
+        "\"x\":%d,\"y\":%d,\"frames\":%lu,\"found\":%lu,\"global\":%lu,\"lost\":%lu,"
+        "\"applied\":%lu,\"overrides\":%lu,\"frame_us\":%lu,\"decode_us\":%lu,"
+        "\"analyze_us\":%lu,\"analyze_max_us\":%lu,\"steer_us\":%lu,\"steer_max_us\":%lu,"
+        "\"loop_us\":%lu,\"loop_avg_us\":%lu,\"loop_max_us\":%lu}",
+        st.enabled ? "true" : "false", st.tracking ? "true" : "false", st.speed,
+        st.cx, st.cy, st.area, st.x, st.y,
+        (unsigned long)st.frames, (unsigned long)st.found, (unsigned long)st.global,
+        (unsigned long)st.lost, (unsigned long)st.applied, (unsigned long)st.overrides,
+        (unsigned long)vs.periodUsAvg, (unsigned long)vs.decodeUsAvg,
+        (unsigned long)st.analyzeUsAvg, (unsigned long)st.analyzeUsMax,
+        (unsigned long)st.steerUsAvg, (unsigned long)st.steerUsMax,
+        (unsigned long)st.loopUsLast, (unsigned long)st.loopUsAvg, (unsigned long)st.loopUsMax);
+    httpd_resp_set_type(req, "application/json");
+    return httpd_resp_send(req, json, len);
+}
+
 // ============================================================
 // 🚗 Drive API — /api/drive (отладочный)
 // ============================================================
@@ -270,10 +932,54 @@ static esp_err_t ledHandler(httpd_req_t* req) {
 // Отладочный API для прямого управления каждым мотором.
 // В отличие от /api/control — БЕЗ watchdog-таймаута.
 //
-// GET  — текущие скорости: { "fl":0, "fr":0, "rl":0, "rr":0 }
+// GET  — целевые скорости + выход рампы + профиль:
+//   { "fl":0, "fr":0, "rl":0, "rr":0,
+//     "out":{"fl":0,...}, "profile":"normal",
+//     "commits":0, "unchanged":0, "writes":0, "fades":0,
+//     "loop":{"source":"off|pcnt|sim","load":100,
+//             "sp":{...},"cps":{...},"duty":{...},"settle_ms":{...}} }
 // POST — команда: { "action":"increment|decrement|set|stop", "motor":"fl|fr|rl|rr|all", "value":25 }
+//   Скорости применяет задача управления (в течение одного тика),
+//   ответ содержит уже рассчитанные новые значения.
+// POST — профиль рампы: { "action":"profile", "profile":"off|soft|normal|sport" }
+// POST — контур скорости: { "action":"loop", "source":"off|pcnt|sim", "load":100 }
+//   С контуром цели 0-255 — уставки скорости колёс; load — нагрузка модели (%)
 //
 
+/**
+ * Сформировать JSON состояния моторов для /api/drive.
+ * @param st Целевые скорости (могут быть ещё не применены задачей)
+ */
+static int driveJsonBuild(char* json, size_t size, const DriveState& st) {
+    const DriveState& out = driveGetOutput();
+    DriveStats ds = driveGetStats();
+    DriveLoopStatus lp = driveGetLoopStatus();
+    return snprintf(json, size,
+        "{\"fl\":%d,\"fr\":%d,\"rl\":%d,\"rr\":%d,"
+        "\"out\":{\"fl\":%d,\"fr\":%d,\"rl\":%d,\"rr\":%d},"
+        "\"profile\":\"%s\",\"commits\":%lu,\"unchanged\":%lu,\"writes\":%lu,\"fades\":%lu,"
+        "\"loop\":{\"source\":\"%s\",\"load\":%u,"
+        "\"sp\":{\"fl\":%ld,\"fr\":%ld,\"rl\":%ld,\"rr\":%ld},"
+        "\"cps\":{\"fl\":%ld,\"fr\":%ld,\"rl\":%ld,\"rr\":%ld},"
+        "\"duty\":{\"fl\":%d,\"fr\":%d,\"rl\":%d,\"rr\":%d},"
+        "\"settle_ms\":{\"fl\":%lu,\"fr\":%lu,\"rl\":%lu,\"rr\":%lu}}}",
+        st.speed[MOTOR_FL], st.speed[MOTOR_FR],
+        st.speed[MOTOR_RL], st.speed[MOTOR_RR],
+        out.speed[MOTOR_FL], out.speed[MOTOR_FR],
+        out.speed[MOTOR_RL], out.speed[MOTOR_RR],
+        rampGetProfile(driveGetRampProfile()).name,
+        (unsigned long)ds.commits, (unsigned long)ds.unchanged,
+        (unsigned long)ds.writes, (unsigned long)ds.fades,
+        encoderSourceName((EncoderSourceId)lp.source), encoderSimGetLoad(),
+        (long)lp.setpointCps[MOTOR_FL], (long)lp.setpointCps[MOTOR_FR],
+        (long)lp.setpointCps[MOTOR_RL], (long)lp.setpointCps[MOTOR_RR],
+        (long)lp.measuredCps[MOTOR_FL], (long)lp.measuredCps[MOTOR_FR],
+        (long)lp.measuredCps[MOTOR_RL], (long)lp.measuredCps[MOTOR_RR],
+        lp.duty[MOTOR_FL], lp.duty[MOTOR_FR], lp.duty[MOTOR_RL], lp.duty[MOTOR_RR],
+        (unsigned long)lp.settleMs[MOTOR_FL], (unsigned long)lp.settleMs[MOTOR_FR],
+        (unsigned long)lp.settleMs[MOTOR_RL], (unsigned long)lp.settleMs[MOTOR_RR]);
+}
+
 /**
  * @brief Обработчик /api/drive — отладочное управление моторами
  */
@@ -292,13 +998,9 @@ static esp_err_t driveApiHandler(httpd_req_t* req) {
 
     // GET — вернуть текущее состояние
     if (req->method == HTTP_GET) {
-        const DriveState& st = driveGetState();
-        char json[128];
-        snprintf(json, sizeof(json), 
-            "{\"fl\":%d,\"fr\":%d,\"rl\":%d,\"rr\":%d}",
-            st.speed[MOTOR_FL], st.speed[MOTOR_FR], 
-            st.speed[MOTOR_RL], st.speed[MOTOR_RR]);
-        return httpd_resp_send(req, json, strlen(json));
+        char json[640];
+        int len = driveJsonBuild(json, sizeof(json), driveGetState());
+        return httpd_resp_send(req, json, len);
     }
 
     // POST — команда
@@ -321,6 +1023,7 @@ static esp_err_t driveApiHandler(httpd_req_t* req) {
     const char* action = doc["action"] | "";
     const char* motorStr = doc["motor"] | "all";
     int value = doc["value"] | 10;
+    uint32_t lease = doc["lease"] | 0UL;
 
     // Определяем мотор
     Motor motor = MOTOR_FL;
@@ -331,37 +1034,44 @@ static esp_err_t driveApiHandler(httpd_req_t* req) {
     else if (strcmp(motorStr, "rr") == 0) motor = MOTOR_RR;
     else if (strcmp(motorStr, "all") == 0) allMotors = true;
 
-    // Выполняем действие
-    if (strcmp(action, "stop") == 0) {
-        driveStop();
-    } else if (strcmp(action, "set") == 0) {
-        if (allMotors) {
-            for (int i = 0; i < MOTOR_COUNT; i++) driveSetSpeed((Motor)i, value);
-        } else {
-            driveSetSpeed(motor, value);
+    // Считаем новые скорости от текущих, применяет задача управления
+    DriveState st = driveGetState();
+    if (strcmp(action, "profile") == 0) {
+        RampProfileId profile;
+        if (!rampProfileByName(doc["profile"] | "", &profile)) {
+            httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Unknown profile");
+            return ESP_FAIL;
         }
-    } else if (strcmp(action, "increment") == 0) {
-        if (allMotors) {
-            for (int i = 0; i < MOTOR_COUNT; i++) driveIncrement((Motor)i, value);
-        } else {
-            driveIncrement(motor, value);
+        driveSetRampProfile(profile);
+    } else if (strcmp(action, "loop") == 0) {
+        EncoderSourceId source;
+        if (!encoderSourceByName(doc["source"] | "", &source)) {
+            httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Unknown encoder source");
+            return ESP_FAIL;
         }
-    } else if (strcmp(action, "decrement") == 0) {
-        if (allMotors) {
-            for (int i = 0; i < MOTOR_COUNT; i++) driveDecrement((Motor)i, value);
-        } else {
-            driveDecrement(motor, value);
+        int load = doc["load"] | (int)encoderSimGetLoad();
+        encoderSimSetLoad(constrain(load, 0, 200));
+        driveSetSpeedLoop(source);
+    } else if (strcmp(action, "stop") == 0) {
+        memset(&st, 0, sizeof(st));
+        controlStop(CTRL_SRC_HTTP, lease);                 // Стоп — без аренды
+    } else {
+        for (int i = 0; i < MOTOR_COUNT; i++) {
+            if (!allMotors && i != motor) continue;
+
+            int speed = st.speed[i];
+            if (strcmp(action, "set") == 0)            speed = value;
+            else if (strcmp(action, "increment") == 0) speed += value;
+            else if (strcmp(action, "decrement") == 0) speed -= value;
+            st.speed[i] = constrain(speed, 0, PWM_MAX_DUTY);
         }
+        if (!controlSetDrive(st, CTRL_SRC_HTTP, lease)) return leaseRejected(req);
     }
 
     // Возвращаем новое состояние
-    const DriveState& st = driveGetState();
-    char json[128];
-    snprintf(json, sizeof(json), 
-        "{\"fl\":%d,\"fr\":%d,\"rl\":%d,\"rr\":%d}",
-        st.speed[MOTOR_FL], st.speed[MOTOR_FR], 
-        st.speed[MOTOR_RL], st.speed[MOTOR_RR]);
-    return httpd_resp_send(req, json, strlen(json));
+    char json[640];
+    int jsonLen = driveJsonBuild(json, sizeof(json), st);
+    return httpd_resp_send(req, json, jsonLen);
 }
 
 // ============================================================
@@ -380,14 +1090,102 @@ static esp_err_t driveApiHandler(httpd_req_t* req) {
 //   "direction": "forward" | "backward" | "left" | "right" | "rotate_left" | "rotate_right",
 //   "speed": 0-255,
 //   "x": -255..+255,  // для type: "xy"
-//   "y": -255..+255   // для type: "xy"
+//   "y": -255..+255,  // для type: "xy"
+//   "probe": true,    // замер латентности (ответ ждёт записи LEDC)
+//   "t": 123456,      // время клиента (мкс): метка для джиттер-буфера X/Y, эхом в "probe"
+//   "lease": 123456   // токен аренды (/api/lease), если клиент её брал
 // }
 //
-// GET /api/control — текущее состояние
+// Пока действует чужая аренда — 409 и состояние аренды (lease.h);
+// "stop" принимается от любого клиента.
+//
+// Замер латентности — в ответе объект "probe" с метками esp_timer (мкс):
+//   {"t":эхо,"recv":приём запроса,"post":публикация команды,
+//    "apply":применение задачей управления,"pwm":запись LEDC
+//    (0 — цели не изменились),"send":отправка ответа}
+// Хост-клиент: tools/latency-probe.js
+//
+// GET /api/control — текущее состояние + счётчики UDP-канала +
+//   "loop": тайминг задачи управления — гистограмма |период − номинал|
+//   (ключ — верхняя граница корзины в мкс), jitter_max_us, overruns;
+//   "mailbox": posted/taken по источникам (разница — схлопнутые команды);
+//   "jitter": стадия и счётчики джиттер-буфера X/Y (jitter_buffer.h)
+//
+// Тот же JSON по одному соединению — WebSocket /ws/control (ниже).
+//
+// Тот же X/Y без HTTP — бинарный UDP-канал (udp_control.h).
 //
 // ============================================================
 
+/**
+ * Применить JSON-команду управления (общая для POST и WebSocket).
+ * Поля — см. описание POST /api/control.
+ * @return false — отклонено арендой (чужой токен "lease")
+ */
+static bool controlApplyCommand(const JsonDocument& doc) {
+    const char* type = doc["type"] | "stop";
+    uint32_t lease = doc["lease"] | 0UL;
+    
+    // --- Тип: stop ---
+    if (strcmp(type, "stop") == 0) {
+        return controlStop(CTRL_SRC_HTTP, lease);
+    }
+    // --- Тип: direction (направление + скорость) ---
+    else if (strcmp(type, "direction") == 0) {
+        const char* dir = doc["direction"] | "stop";
+        uint8_t speed = doc["speed"] | 200;
+        
+        ControlDirection direction = CTRL_STOP;
+        if (strcmp(dir, "forward") == 0)       direction = CTRL_FORWARD;
+        else if (strcmp(dir, "backward") == 0) direction = CTRL_BACKWARD;
+        else if (strcmp(dir, "left") == 0)     direction = CTRL_LEFT;
+        else if (strcmp(dir, "right") == 0)    direction = CTRL_RIGHT;
+        else if (strcmp(dir, "rotate_left") == 0)  direction = CTRL_ROTATE_LEFT;
+        else if (strcmp(dir, "rotate_right") == 0) direction = CTRL_ROTATE_RIGHT;
+        
+        return controlSetMovement(direction, speed, CTRL_SRC_HTTP, lease);
+    }
+    // --- Тип: xy (джойстик) ---
+    else if (strcmp(type, "xy") == 0) {
+        int16_t x = doc["x"] | 0;
+        int16_t y = doc["y"] | 0;
+        uint32_t t = doc["t"] | 0UL;
+        return controlSetXY(x, y, CTRL_SRC_HTTP, lease, t);
+    }
+    return true;
+}
+
+// Метки замеров HTTP/WS (источник CTRL_SRC_HTTP — одна задача httpd)
+static uint32_t httpProbeId = 0;
+
+/**
+ * Пометить следующую команду HTTP-источника меткой замера.
+ * @return Метка для controlProbeWait()
+ */
+static uint32_t controlProbeArm() {
+    if (++httpProbeId == 0) httpProbeId = 1;
+    controlProbeNext(CTRL_SRC_HTTP, httpProbeId);
+    return httpProbeId;
+}
+
+/**
+ * Дописать объект "probe" (с ведущей запятой) по результату замера.
+ * @return Длина (как у snprintf), 0 — замер не удался
+ */
+static int controlProbeJson(char* buf, size_t size, uint32_t probeId,
+                            uint32_t recvUs, uint32_t clientT) {
+    ControlProbe pr;
+    if (!controlProbeWait(CTRL_SRC_HTTP, probeId, &pr, CONTROL_PROBE_TIMEOUT_MS)) return 0;
+    return snprintf(buf, size,
+        ",\"probe\":{\"t\":%lu,\"recv\":%lu,\"post\":%lu,\"apply\":%lu,\"pwm\":%lu,\"send\":%lu}",
+        (unsigned long)clientT, (unsigned long)recvUs,
+        (unsigned long)pr.postUs, (unsigned long)pr.applyUs, (unsigned long)pr.pwmUs,
+        (unsigned long)esp_timer_get_time());
+}
+
 static esp_err_t controlApiHandler(httpd_req_t* req) {
+    uint32_t recvUs = (uint32_t)esp_timer_get_time();
+
     // --- CORS preflight ---
     if (req->method == HTTP_OPTIONS) {
         httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
@@ -402,27 +1200,68 @@ static esp_err_t controlApiHandler(httpd_req_t* req) {
 
     // --- GET: вернуть состояние управления ---
     if (req->method == HTTP_GET) {
-        const ControlState& st = controlGetState();
-        const DriveState& drv = driveGetState();
+        SystemSnapshot snap = systemStateRead();
+        const ControlState& st = snap.control;
+        const DriveState& drv = snap.motors;
+        UdpControlStats udp = udpControlGetStats();
+        ControlTimingStats tm = controlGetTiming();
+        ControlMailboxStats mbHttp = controlGetMailboxStats(CTRL_SRC_HTTP);
+        ControlMailboxStats mbUdp = controlGetMailboxStats(CTRL_SRC_UDP);
+        ControlMailboxStats mbReplay = controlGetMailboxStats(CTRL_SRC_REPLAY);
+        ControlJitterStatus jb = controlGetJitter();
         
         // Формируем JSON с полным состоянием
-        char json[256];
-        snprintf(json, sizeof(json), 
+        char json[1024];
+        int len = snprintf(json, sizeof(json), 
             "{"
             "\"active\":%s,"
             "\"direction\":%d,"
             "\"speed\":%d,"
             "\"motors\":{\"fl\":%d,\"fr\":%d,\"rl\":%d,\"rr\":%d},"
-            "\"timeout_ms\":%d"
+            "\"state_version\":%lu,"
+            "\"timeout_ms\":%d,"
+            "\"udp\":{\"port\":%d,\"received\":%lu,\"applied\":%lu,\"stale\":%lu,\"malformed\":%lu,\"lease_rejected\":%lu},"
+            "\"loop\":{\"hz\":%lu,\"ticks\":%lu,\"overruns\":%lu,\"jitter_max_us\":%lu,"
+            "\"hist_us\":{\"10\":%lu,\"25\":%lu,\"50\":%lu,\"100\":%lu,\"250\":%lu,\"500\":%lu,\"1000\":%lu,\"inf\":%lu}},"
+            "\"mailbox\":{\"http\":{\"posted\":%lu,\"taken\":%lu},\"udp\":{\"posted\":%lu,\"taken\":%lu},"
+            "\"replay\":{\"posted\":%lu,\"taken\":%lu}},"
+            "\"jitter\":{\"enabled\":%s,\"delay_ms\":%d,\"stage\":\"%s\",\"depth\":%u,"
+            "\"pushed\":%lu,\"late\":%lu,\"reordered\":%lu,\"overflow\":%lu,\"resyncs\":%lu,"
+            "\"grace_ticks\":%lu,\"hold_ticks\":%lu,\"decay_ticks\":%lu,\"stops\":%lu}"
             "}",
             st.active ? "true" : "false",
             st.direction,
             st.speed,
             drv.speed[MOTOR_FL], drv.speed[MOTOR_FR],
             drv.speed[MOTOR_RL], drv.speed[MOTOR_RR],
-            CONTROL_TIMEOUT_MS
+            (unsigned long)snap.version,
+            CONTROL_TIMEOUT_MS,
+            UDP_CONTROL_PORT,
+            (unsigned long)udp.received,
+            (unsigned long)udp.applied,
+            (unsigned long)udp.stale,
+            (unsigned long)udp.malformed,
+            (unsigned long)udp.leaseRejected,
+            (unsigned long)tm.rateHz,
+            (unsigned long)tm.ticks,
+            (unsigned long)tm.overruns,
+            (unsigned long)tm.jitterMaxUs,
+            (unsigned long)tm.hist[0], (unsigned long)tm.hist[1],
+            (unsigned long)tm.hist[2], (unsigned long)tm.hist[3],
+            (unsigned long)tm.hist[4], (unsigned long)tm.hist[5],
+            (unsigned long)tm.hist[6], (unsigned long)tm.hist[7],
+            (unsigned long)mbHttp.posted, (unsigned long)mbHttp.taken,
+            (unsigned long)mbUdp.posted, (unsigned long)mbUdp.taken,
+            (unsigned long)mbReplay.posted, (unsigned long)mbReplay.taken,
+            JITTER_ENABLE ? "true" : "false", JITTER_DELAY_MS,
+            jitterStageName(jb.stage), jb.depth,
+            (unsigned long)jb.stats.pushed, (unsigned long)jb.stats.late,
+            (unsigned long)jb.stats.reordered, (unsigned long)jb.stats.overflow,
+            (unsigned long)jb.stats.resyncs, (unsigned long)jb.stats.extrapolated,
+            (unsigned long)jb.stats.held, (unsigned long)jb.stats.decayed,
+            (unsigned long)jb.stats.stops
         );
-        return httpd_resp_send(req, json, strlen(json));
+        return httpd_resp_send(req, json, len);
     }
 
     // --- POST: команда управления ---
@@ -442,54 +1281,821 @@ static esp_err_t controlApiHandler(httpd_req_t* req) {
         return ESP_FAIL;
     }
 
-    const char* type = doc["type"] | "stop";
-    
-    // --- Тип: stop ---
-    if (strcmp(type, "stop") == 0) {
-        controlStop();
-    }
-    // --- Тип: direction (направление + скорость) ---
-    else if (strcmp(type, "direction") == 0) {
-        const char* dir = doc["direction"] | "stop";
-        uint8_t speed = doc["speed"] | 200;
-        
-        ControlDirection direction = CTRL_STOP;
-        if (strcmp(dir, "forward") == 0)       direction = CTRL_FORWARD;
-        else if (strcmp(dir, "backward") == 0) direction = CTRL_BACKWARD;
-        else if (strcmp(dir, "left") == 0)     direction = CTRL_LEFT;
-        else if (strcmp(dir, "right") == 0)    direction = CTRL_RIGHT;
-        else if (strcmp(dir, "rotate_left") == 0)  direction = CTRL_ROTATE_LEFT;
-        else if (strcmp(dir, "rotate_right") == 0) direction = CTRL_ROTATE_RIGHT;
-        
-        controlSetMovement(direction, speed);
-    }
-    // --- Тип: xy (джойстик) ---
-    else if (strcmp(type, "xy") == 0) {
-        int16_t x = doc["x"] | 0;
-        int16_t y = doc["y"] | 0;
-        controlSetXY(x, y);
+    bool probe = doc["probe"] | false;
+    uint32_t probeId = probe ? controlProbeArm() : 0;
+    if (!controlApplyCommand(doc)) return leaseRejected(req);
+
+    // Замер латентности — ждём применения и записи LEDC
+    char probeJson[160] = "";
+    if (probe) {
+        controlProbeJson(probeJson, sizeof(probeJson), probeId, recvUs, doc["t"] | 0UL);
     }
 
-    // Возвращаем обновлённое состояние
-    const ControlState& st = controlGetState();
-    const DriveState& drv = driveGetState();
-    char json[256];
-    snprintf(json, sizeof(json), 
+    // Состояние — снимок конца последнего тика управления (system_state.h):
+    // команда этого запроса лежит в почтовом ящике и, как правило, ещё
+    // не применена — ответ показывает состояние ДО неё (с probe — после,
+    // замер дождался применения)
+    SystemSnapshot snap = systemStateRead();
+    const ControlState& st = snap.control;
+    const DriveState& drv = snap.motors;
+    char json[384];
+    int jsonLen = snprintf(json, sizeof(json), 
         "{"
         "\"active\":%s,"
         "\"direction\":%d,"
         "\"speed\":%d,"
         "\"motors\":{\"fl\":%d,\"fr\":%d,\"rl\":%d,\"rr\":%d}"
+        "%s"
         "}",
         st.active ? "true" : "false",
         st.direction,
         st.speed,
         drv.speed[MOTOR_FL], drv.speed[MOTOR_FR],
-        drv.speed[MOTOR_RL], drv.speed[MOTOR_RR]
+        drv.speed[MOTOR_RL], drv.speed[MOTOR_RR],
+        probeJson
+    );
+    return httpd_resp_send(req, json, jsonLen);
+}
+
+// ============================================================
+// 🔌 WebSocket управление — /ws/control
+// ============================================================
+//
+// Одно долгоживущее соединение вместо POST на каждый тик джойстика:
+// нет установки/обрыва запросов в httpd (max_open_sockets = 5),
+// нет заголовков и CORS preflight.
+//
+// Сообщения — текстовые фреймы с тем же JSON, что и POST /api/control.
+// Каждое сообщение сбрасывает watchdog. ACK — по желанию клиента:
+//   → {"type":"xy","x":120,"y":-40,"seq":17,"t":123456}
+//   ← {"ack":17,"t":123456,"motors":{...}}     (только если есть "seq")
+// Поле "t" возвращается эхом — клиент считает RTT.
+// С "probe":true ACK ждёт записи LEDC и несёт объект "probe"
+// (как у POST /api/control). Команда с чужим токеном аренды —
+// ACK с "rejected":"lease" (кроме стопа).
+//
+// Latest-wins обеспечивает клиент (ControlService): пока предыдущее
+// сообщение не ушло из буфера сокета, новое не ставится в очередь.
+//
+
+#define WS_CONTROL_MAX_MSG 128   // Макс. размер сообщения (байт)
+
+static esp_err_t controlWsHandler(httpd_req_t* req) {
+    // GET — завершено рукопожатие, дальше приходят только фреймы
+    if (req->method == HTTP_GET) {
+        LOG_I("🔌 WS control: клиент подключён (fd=%d)", httpd_req_to_sockfd(req));
+        return ESP_OK;
+    }
+
+    // Сначала длина фрейма, затем payload
+    httpd_ws_frame_t frame;
+    memset(&frame, 0, sizeof(frame));
+    esp_err_t ret = httpd_ws_recv_frame(req, &frame, 0);
+    if (ret != ESP_OK) return ret;
+    if (frame.len >= WS_CONTROL_MAX_MSG) return ESP_FAIL;  // Закрываем соединение
+
+    char msg[WS_CONTROL_MAX_MSG];
+    frame.payload = (uint8_t*)msg;
+    ret = httpd_ws_recv_frame(req, &frame, frame.len);
+    if (ret != ESP_OK) return ret;
+    if (frame.type != HTTPD_WS_TYPE_TEXT) return ESP_OK;
+    msg[frame.len] = '\0';
+    uint32_t recvUs = (uint32_t)esp_timer_get_time();
+
+    JsonDocument doc;
+    if (deserializeJson(doc, msg)) return ESP_OK;  // Битое сообщение — пропускаем
+
+    bool probe = !doc["seq"].isNull() && (doc["probe"] | false);
+    uint32_t probeId = probe ? controlProbeArm() : 0;
+    bool accepted = controlApplyCommand(doc);
+
+    // ACK только по запросу (есть "seq")
+    if (doc["seq"].isNull()) return ESP_OK;
+
+    char probeJson[160] = "";
+    if (!accepted) {
+        strcpy(probeJson, ",\"rejected\":\"lease\"");
+    } else if (probe) {
+        controlProbeJson(probeJson, sizeof(probeJson), probeId, recvUs, doc["t"] | 0UL);
+    }
+
+    // Моторы — снимок конца последнего тика, как в ответе POST /api/control:
+    // до применения этой команды (кроме probe)
+    const DriveState drv = systemStateRead().motors;
+    char ack[320];
+    int len = snprintf(ack, sizeof(ack),
+        "{\"ack\":%lu,\"t\":%lu,\"motors\":{\"fl\":%d,\"fr\":%d,\"rl\":%d,\"rr\":%d}%s}",
+        (unsigned long)(doc["seq"] | 0UL),
+        (unsigned long)(doc["t"] | 0UL),
+        drv.speed[MOTOR_FL], drv.speed[MOTOR_FR],
+        drv.speed[MOTOR_RL], drv.speed[MOTOR_RR],
+        probeJson);
+
+    httpd_ws_frame_t out;
+    memset(&out, 0, sizeof(out));
+    out.type    = HTTPD_WS_TYPE_TEXT;
+    out.payload = (uint8_t*)ack;
+    out.len     = len;
+    return httpd_ws_send_frame(req, &out);
+}
+
+// ============================================================
+// 🎚️ Mixer API — /api/mixer (expo и ремап осей джойстика)
+// ============================================================
+//
+// Кривые осей живут в прошивке (mixer.h): клиент шлёт сырые X/Y.
+//
+// GET  — настройки осей:
+//   {"x":{"expo":30,"min":0,"max":255},"y":{...}}
+//   ?table=1 — плюс таблицы: "table":[256 чисел] (сверка с JS)
+// POST — { "axis":"x|y|both", "expo":-100..100, "min":0, "max":255 }
+//   Отсутствующие поля не меняются.
+//
+
+/**
+ * Отправить настройки (и таблицы) осей частями — таблицы не
+ * помещаются в буфер на стеке.
+ */
+static esp_err_t mixerSendJson(httpd_req_t* req, bool withTables) {
+    static const char* axisNames[MIXER_AXIS_COUNT] = {"x", "y"};
+    char buf[192];
+
+    for (int a = 0; a < MIXER_AXIS_COUNT; a++) {
+        MixerAxisConfig cfg = mixerGetAxis((MixerAxis)a);
+        int len = snprintf(buf, sizeof(buf), "%s\"%s\":{\"expo\":%d,\"min\":%d,\"max\":%d",
+                           a == 0 ? "{" : ",", axisNames[a], cfg.expo, cfg.outMin, cfg.outMax);
+        httpd_resp_send_chunk(req, buf, len);
+
+        if (withTables) {
+            const uint8_t* table = mixerGetTable((MixerAxis)a);
+            httpd_resp_send_chunk(req, ",\"table\":[", HTTPD_RESP_USE_STRLEN);
+            for (int i = 0; i < MIXER_TABLE_SIZE; i += 32) {
+                len = 0;
+                for (int j = i; j < i + 32; j++) {
+                    len += snprintf(buf + len, sizeof(buf) - len, j ? ",%d" : "%d", table[j]);
+                }
+                httpd_resp_send_chunk(req, buf, len);
+            }
+            httpd_resp_send_chunk(req, "]", 1);
+        }
+        httpd_resp_send_chunk(req, "}", 1);
+    }
+    httpd_resp_send_chunk(req, "}", 1);
+    return httpd_resp_send_chunk(req, NULL, 0);
+}
+
+static esp_err_t mixerApiHandler(httpd_req_t* req) {
+    // CORS preflight
+    if (req->method == HTTP_OPTIONS) {
+        httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+        httpd_resp_set_hdr(req, "Access-Control-Allow-Methods", "GET, POST, OPTIONS");
+        httpd_resp_set_hdr(req, "Access-Control-Allow-Headers", "Content-Type");
+        httpd_resp_send(req, NULL, 0);
+        return ESP_OK;
+    }
+
+    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+    httpd_resp_set_type(req, "application/json");
+
+    if (req->method == HTTP_POST) {
+        char body[256];
+        int len = httpd_req_recv(req, body, sizeof(body) - 1);
+        if (len <= 0) {
+            httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Empty body");
+            return ESP_FAIL;
+        }
+        body[len] = '\0';
+
+        JsonDocument doc;
+        DeserializationError err = deserializeJson(doc, body);
+        if (err) {
+            httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid JSON");
+            return ESP_FAIL;
+        }
+
+        const char* axis = doc["axis"] | "both";
+        bool ok = true;
+        for (int a = 0; a < MIXER_AXIS_COUNT; a++) {
+            if (strcmp(axis, "both") != 0 && strcmp(axis, a == 0 ? "x" : "y") != 0) continue;
+
+            MixerAxisConfig cfg = mixerGetAxis((MixerAxis)a);
+            cfg.expo   = constrain((int)(doc["expo"] | (int)cfg.expo), -100, 100);
+            cfg.outMin = constrain((int)(doc["min"] | (int)cfg.outMin), 0, 255);
+            cfg.outMax = constrain((int)(doc["max"] | (int)cfg.outMax), 0, 255);
+            ok = mixerSetAxis((MixerAxis)a, cfg) && ok;
+        }
+        if (!ok) {
+            httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid range");
+            return ESP_FAIL;
+        }
+    }
+
+    return mixerSendJson(req, queryInt(req, "table", 0) != 0);
+}
+
+// ============================================================
+// 🎞️ Recorder API — /api/recorder (журнал команд управления)
+// ============================================================
+//
+// GET  — состояние журнала:
+//   {"recording":true,"replaying":false,"psram":true,"capacity":16384,
+//    "count":812,"total":812,"replayed":0,"replay_total":0}
+//   ?download=1 — файл rover.rec: RecorderFileHeader + записи
+//   (формат — recorder.h, разбор — tools/recorder.js)
+// POST — { "action": "start" | "stop" | "clear" | "replay" | "abort",
+//          "record": true,    // replay: очистить журнал и записать прогон
+//          "lease": 0 }       // replay: токен аренды (чужой — 409)
+//
+// На время скачивания запись приостанавливается — файл целостный.
+//
+
+#define RECORDER_DOWNLOAD_CHUNK 64   // Записей на один chunk (1280 байт)
+
+/**
+ * Отдать журнал бинарным файлом частями.
+ */
+static esp_err_t recorderSendFile(httpd_req_t* req) {
+    bool wasRecording = recorderSetRecording(false);
+    RecorderStatus st = recorderGetStatus();
+
+    RecorderFileHeader hdr;
+    memcpy(hdr.magic, RECORDER_FILE_MAGIC, sizeof(hdr.magic));
+    hdr.version   = RECORDER_FILE_VERSION;
+    hdr.entrySize = sizeof(RecorderEntry);
+    hdr.rateHz    = CONTROL_RATE_HZ;
+    hdr.count     = st.count;
+    hdr.lost      = st.total - st.count;
+
+    httpd_resp_set_type(req, "application/octet-stream");
+    httpd_resp_set_hdr(req, "Content-Disposition", "attachment; filename=\"rover.rec\"");
+    esp_err_t res = httpd_resp_send_chunk(req, (const char*)&hdr, sizeof(hdr));
+
+    RecorderEntry chunk[RECORDER_DOWNLOAD_CHUNK];
+    for (uint32_t i = 0; res == ESP_OK && i < st.count; ) {
+        size_t n = recorderRead(i, chunk, RECORDER_DOWNLOAD_CHUNK);
+        if (n == 0) break;
+        res = httpd_resp_send_chunk(req, (const char*)chunk, n * sizeof(RecorderEntry));
+        i += n;
+    }
+
+    recorderSetRecording(wasRecording);
+    if (res != ESP_OK) return res;
+    return httpd_resp_send_chunk(req, NULL, 0);
+}
+
+/**
+ * @brief Обработчик /api/recorder — журнал команд и воспроизведение
+ */
+static esp_err_t recorderApiHandler(httpd_req_t* req) {
+    // CORS preflight
+    if (req->method == HTTP_OPTIONS) {
+        httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+        httpd_resp_set_hdr(req, "Access-Control-Allow-Methods", "GET, POST, OPTIONS");
+        httpd_resp_set_hdr(req, "Access-Control-Allow-Headers", "Content-Type");
+        httpd_resp_send(req, NULL, 0);
+        return ESP_OK;
+    }
+
+    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+
+    if (req->method == HTTP_GET && queryInt(req, "download", 0) != 0) {
+        return recorderSendFile(req);
+    }
+
+    if (req->method == HTTP_POST) {
+        char body[128];
+        int len = httpd_req_recv(req, body, sizeof(body) - 1);
+        if (len <= 0) {
+            httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Empty body");
+            return ESP_FAIL;
+        }
+        body[len] = '\0';
+
+        JsonDocument doc;
+        DeserializationError err = deserializeJson(doc, body);
+        if (err) {
+            httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid JSON");
+            return ESP_FAIL;
+        }
+
+        const char* action = doc["action"] | "";
+        bool ok = true;
+        if (strcmp(action, "start") == 0)       recorderSetRecording(true);
+        else if (strcmp(action, "stop") == 0)   recorderSetRecording(false);
+        else if (strcmp(action, "clear") == 0)  ok = recorderClear();
+        else if (strcmp(action, "replay") == 0) {
+            // Прогон — такой же клиент: без аренды держателя не запускается
+            uint32_t lease = doc["lease"] | 0UL;
+            if (!leaseCheck(lease)) return leaseRejected(req);
+            ok = recorderReplayStart(doc["record"] | false, lease);
+        }
+        else if (strcmp(action, "abort") == 0)  recorderReplayStop();
+        else {
+            httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Unknown action");
+            return ESP_FAIL;
+        }
+        if (!ok) {
+            httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Busy or empty");
+            return ESP_FAIL;
+        }
+    }
+
+    RecorderStatus st = recorderGetStatus();
+    char json[256];
+    int len = snprintf(json, sizeof(json),
+        "{"
+        "\"recording\":%s,"
+        "\"replaying\":%s,"
+        "\"psram\":%s,"
+        "\"capacity\":%lu,"
+        "\"count\":%lu,"
+        "\"total\":%lu,"
+        "\"replayed\":%lu,"
+        "\"replay_total\":%lu"
+        "}",
+        st.recording ? "true" : "false",
+        st.replaying ? "true" : "false",
+        st.psram ? "true" : "false",
+        (unsigned long)st.capacity,
+        (unsigned long)st.count,
+        (unsigned long)st.total,
+        (unsigned long)st.replayed,
+        (unsigned long)st.replayTotal
+    );
+    httpd_resp_set_type(req, "application/json");
+    return httpd_resp_send(req, json, len);
+}
+
+// ============================================================
+// 📜 Mission API — /api/mission (байткод-сценарии движения)
+// ============================================================
+//
+// GET  — состояние ВМ:
+//   {"state":"running","program":"demo","abort":"none","mark":3,
+//    "pc":24,"elapsed_ms":5210,"user_size":0,"runs":1}
+// POST ?upload=1 — тело: байткод программы (mission.h,
+//   собирает tools/mission.js), до MISSION_PROGRAM_MAX байт
+// POST — { "action": "start", "program": "demo" | "user", "lease": 0 }
+//        { "action": "stop" }
+//        { "action": "keepalive" }   // сторож WDOG программы
+//
+// Запуск с чужим токеном аренды — 409 (как у /api/control).
+//
+
+static const char* missionStateNames[] = {"idle", "running", "done", "aborted"};
+static const char* missionAbortNames[] = {"none", "stop", "override", "watchdog"};
+
+/**
+ * Принять байткод программы (тело может прийти несколькими частями).
+ */
+static esp_err_t missionUpload(httpd_req_t* req) {
+    if (req->content_len == 0 || req->content_len > MISSION_PROGRAM_MAX) {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Bad program size");
+        return ESP_FAIL;
+    }
+
+    uint8_t* code = (uint8_t*)malloc(req->content_len);
+    if (!code) {
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "No memory");
+        return ESP_FAIL;
+    }
+    size_t got = 0;
+    while (got < req->content_len) {
+        int n = httpd_req_recv(req, (char*)code + got, req->content_len - got);
+        if (n == HTTPD_SOCK_ERR_TIMEOUT) continue;
+        if (n <= 0) {
+            free(code);
+            return ESP_FAIL;
+        }
+        got += n;
+    }
+
+    const char* error = NULL;
+    bool ok = missionLoad(code, got, &error);
+    free(code);
+    if (!ok) {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, error);
+        return ESP_FAIL;
+    }
+    LOG_I("📜 Миссия загружена: %u байт", (unsigned)got);
+    return ESP_OK;
+}
+
+/**
+ * @brief Обработчик /api/mission — загрузка, запуск и состояние сценариев
+ */
+static esp_err_t missionApiHandler(httpd_req_t* req) {
+    // CORS preflight
+    if (req->method == HTTP_OPTIONS) {
+        httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+        httpd_resp_set_hdr(req, "Access-Control-Allow-Methods", "GET, POST, OPTIONS");
+        httpd_resp_set_hdr(req, "Access-Control-Allow-Headers", "Content-Type");
+        httpd_resp_send(req, NULL, 0);
+        return ESP_OK;
+    }
+
+    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+
+    if (req->method == HTTP_POST && queryInt(req, "upload", 0) != 0) {
+        esp_err_t res = missionUpload(req);
+        if (res != ESP_OK) return res;
+    } else if (req->method == HTTP_POST) {
+        char body[128];
+        int len = httpd_req_recv(req, body, sizeof(body) - 1);
+        if (len <= 0) {
+            httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Empty body");
+            return ESP_FAIL;
+        }
+        body[len] = '\0';
+
+        JsonDocument doc;
+        DeserializationError err = deserializeJson(doc, body);
+        if (err) {
+            httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid JSON");
+            return ESP_FAIL;
+        }
+
+        const char* action = doc["action"] | "";
+        if (strcmp(action, "start") == 0) {
+            const char* name = doc["program"] | "demo";
+            MissionProgram program = MISSION_PROG_COUNT;
+            if (strcmp(name, "demo") == 0)      program = MISSION_PROG_DEMO;
+            else if (strcmp(name, "user") == 0) program = MISSION_PROG_USER;
+            if (program == MISSION_PROG_COUNT ||
+                (program == MISSION_PROG_USER && missionGetStatus().userSize == 0)) {
+                httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "No such program");
+                return ESP_FAIL;
+            }
+            if (!missionStart(program, doc["lease"] | 0UL)) return leaseRejected(req);
+        } else if (strcmp(action, "stop") == 0) {
+            missionStop();
+        } else if (strcmp(action, "keepalive") == 0) {
+            missionKeepalive();
+        } else {
+            httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Unknown action");
+            return ESP_FAIL;
+        }
+    }
+
+    MissionStatus st = missionGetStatus();
+    char json[256];
+    int len = snprintf(json, sizeof(json),
+        "{"
+        "\"state\":\"%s\","
+        "\"program\":\"%s\","
+        "\"abort\":\"%s\","
+        "\"mark\":%u,"
+        "\"pc\":%u,"
+        "\"elapsed_ms\":%lu,"
+        "\"user_size\":%u,"
+        "\"runs\":%lu"
+        "}",
+        missionStateNames[st.state],
+        st.program == MISSION_PROG_USER ? "user" : "demo",
+        missionAbortNames[st.abort],
+        st.mark,
+        st.pc,
+        (unsigned long)st.elapsedMs,
+        st.userSize,
+        (unsigned long)st.runs
+    );
+    httpd_resp_set_type(req, "application/json");
+    return httpd_resp_send(req, json, len);
+}
+
+// ============================================================
+// 〰️ Wave API — /api/wave (формы скважности для характеризации)
+// ============================================================
+//
+// GET  — состояние проигрывателя:
+//   {"state":"done","abort":"none","mask":6,"rate_hz":200,"count":4000,
+//    "played":4000,"logged":4000,"dev_max_us":180,"runs":1}
+//   ?download=1 — журнал прогона rover.wlg: WaveLogHeader + записи
+//   (формат — wave.h, разбор — tools/wave.js)
+// POST ?upload=1 — тело: форма (wave_format.h, собирает tools/wave.js)
+// POST — { "action": "start", "lease": 0 } | { "action": "stop" }
+//
+// Пока форма проигрывается, загрузка и скачивание журнала — 400 Busy.
+// Запуск с чужим токеном аренды — 409 (как у /api/control).
+//
+
+#define WAVE_DOWNLOAD_CHUNK 64       // Записей на один chunk (1 КБ)
+
+static const char* waveStateNames[] = {"idle", "running", "done", "aborted"};
+static const char* waveAbortNames[] = {"none", "stop", "override"};
+
+/**
+ * Принять форму (тело может прийти несколькими частями).
+ */
+static esp_err_t waveUpload(httpd_req_t* req) {
+    if (req->content_len == 0 ||
+        req->content_len > WAVE_FORMAT_MAX) {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Bad waveform size");
+        return ESP_FAIL;
+    }
+
+    uint8_t* buf = (uint8_t*)heap_caps_malloc(req->content_len, MALLOC_CAP_SPIRAM);
+    if (!buf) {
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "No memory");
+        return ESP_FAIL;
+    }
+    size_t got = 0;
+    while (got < req->content_len) {
+        int n = httpd_req_recv(req, (char*)buf + got, req->content_len - got);
+        if (n == HTTPD_SOCK_ERR_TIMEOUT) continue;
+        if (n <= 0) {
+            free(buf);
+            return ESP_FAIL;
+        }
+        got += n;
+    }
+
+    const char* error = NULL;
+    bool ok = waveLoad(buf, got, &error);
+    free(buf);
+    if (!ok) {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, error);
+        return ESP_FAIL;
+    }
+    LOG_I("〰️ Форма загружена: %u байт", (unsigned)got);
+    return ESP_OK;
+}
+
+/**
+ * Отдать журнал последнего прогона бинарным файлом частями.
+ */
+static esp_err_t waveSendLog(httpd_req_t* req) {
+    if (waveBusy()) {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Busy");
+        return ESP_FAIL;
+    }
+    WaveStatus st = waveGetStatus();
+
+    WaveLogHeader hdr;
+    memcpy(hdr.magic, WAVE_LOG_MAGIC, sizeof(hdr.magic));
+    hdr.version   = WAVE_LOG_VERSION;
+    hdr.entrySize = sizeof(WaveLogEntry);
+    hdr.mask      = st.mask;
+    hdr.reserved  = 0;
+    hdr.rateHz    = st.rateHz;
+    hdr.controlHz = CONTROL_RATE_HZ;
+    hdr.count     = st.logged;
+
+    httpd_resp_set_type(req, "application/octet-stream");
+    httpd_resp_set_hdr(req, "Content-Disposition", "attachment; filename=\"rover.wlg\"");
+    esp_err_t res = httpd_resp_send_chunk(req, (const char*)&hdr, sizeof(hdr));
+
+    WaveLogEntry chunk[WAVE_DOWNLOAD_CHUNK];
+    for (uint32_t i = 0; res == ESP_OK && i < st.logged; ) {
+        size_t n = waveReadLog(i, chunk, WAVE_DOWNLOAD_CHUNK);
+        if (n == 0) break;
+        res = httpd_resp_send_chunk(req, (const char*)chunk, n * sizeof(WaveLogEntry));
+        i += n;
+    }
+
+    if (res != ESP_OK) return res;
+    return httpd_resp_send_chunk(req, NULL, 0);
+}
+
+/**
+ * @brief Обработчик /api/wave — загрузка, запуск и журнал форм скважности
+ */
+static esp_err_t waveApiHandler(httpd_req_t* req) {
+    // CORS preflight
+    if (req->method == HTTP_OPTIONS) {
+        httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+        httpd_resp_set_hdr(req, "Access-Control-Allow-Methods", "GET, POST, OPTIONS");
+        httpd_resp_set_hdr(req, "Access-Control-Allow-Headers", "Content-Type");
+        httpd_resp_send(req, NULL, 0);
+        return ESP_OK;
+    }
+
+    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+
+    if (req->method == HTTP_GET && queryInt(req, "download", 0) != 0) {
+        return waveSendLog(req);
+    }
+
+    if (req->method == HTTP_POST && queryInt(req, "upload", 0) != 0) {
+        esp_err_t res = waveUpload(req);
+        if (res != ESP_OK) return res;
+    } else if (req->method == HTTP_POST) {
+        char body[128];
+        int len = httpd_req_recv(req, body, sizeof(body) - 1);
+        if (len <= 0) {
+            httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Empty body");
+            return ESP_FAIL;
+        }
+        body[len] = '\0';
+
+        JsonDocument doc;
+        if (deserializeJson(doc, body)) {
+            httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid JSON");
+            return ESP_FAIL;
+        }
+
+        const char* action = doc["action"] | "";
+        if (strcmp(action, "start") == 0) {
+            if (waveGetStatus().count == 0) {
+                httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "No waveform");
+                return ESP_FAIL;
+            }
+            if (!waveStart(doc["lease"] | 0UL)) return leaseRejected(req);
+        } else if (strcmp(action, "stop") == 0) {
+            waveStop();
+        } else {
+            httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Unknown action");
+            return ESP_FAIL;
+        }
+    }
+
+    WaveStatus st = waveGetStatus();
+    char json[256];
+    int len = snprintf(json, sizeof(json),
+        "{\"state\":\"%s\",\"abort\":\"%s\",\"mask\":%u,\"rate_hz\":%u,\"count\":%u,"
+        "\"played\":%u,\"logged\":%lu,\"dev_max_us\":%lu,\"runs\":%lu}",
+        waveStateNames[st.state], waveAbortNames[st.abort],
+        st.mask, st.rateHz, st.count, st.played,
+        (unsigned long)st.logged, (unsigned long)st.devUsMax, (unsigned long)st.runs);
+    httpd_resp_set_type(req, "application/json");
+    return httpd_resp_send(req, json, len);
+}
+
+// ============================================================
+// 📡 RTP API — /api/rtp, /rtp.sdp
+// ============================================================
+//
+// Управление RTP/UDP стримом (RFC 2435). Кадры берутся из того же
+// цикла захвата, что и TCP-стрим на порту 81.
+//
+// POST /api/rtp
+// {
+//   "action": "start" | "stop",
+//   "multicast": true,        // адресат = RTP_MULTICAST_GROUP
+//   "host": "192.168.1.50",   // unicast-адресат (по умолчанию — IP клиента)
+//   "port": 5004              // по умолчанию RTP_DEFAULT_PORT
+// }
+//
+// GET /api/rtp — состояние и статистика отправки
+// GET /rtp.sdp — SDP для плееров: ffplay -protocol_whitelist file,udp,rtp -i rtp.sdp
+//
+// ============================================================
+
+/**
+ * IPv4-адрес клиента запроса (network byte order).
+ * httpd слушает dual-stack сокет, поэтому IPv4 приходит как ::ffff:a.b.c.d.
+ * @return 0 если адрес не определён
+ */
+static uint32_t requestPeerIp(httpd_req_t* req) {
+    int fd = httpd_req_to_sockfd(req);
+    struct sockaddr_in6 peer;
+    socklen_t peerLen = sizeof(peer);
+    if (getpeername(fd, (struct sockaddr*)&peer, &peerLen) < 0) return 0;
+
+    if (peer.sin6_family == AF_INET) {
+        return ((struct sockaddr_in*)&peer)->sin_addr.s_addr;
+    }
+    uint32_t ip;
+    memcpy(&ip, ((const uint8_t*)&peer.sin6_addr) + 12, sizeof(ip));
+    return ip;
+}
+
+/**
+ * Сформировать JSON состояния RTP-стрима.
+ * @return Длина строки (как у snprintf)
+ */
+static int rtpStatusJson(char* json, size_t size) {
+    uint32_t destIp = 0;
+    uint16_t destPort = 0;
+    bool active = rtpStreamGetDest(&destIp, &destPort);
+    RtpStreamStats st = rtpStreamGetStats();
+
+    struct in_addr a;
+    a.s_addr = destIp;
+    return snprintf(json, size,
+        "{"
+        "\"active\":%s,"
+        "\"host\":\"%s\","
+        "\"port\":%u,"
+        "\"frames\":%lu,"
+        "\"dropped\":%lu,"
+        "\"skipped\":%lu,"
+        "\"packets\":%lu,"
+        "\"bytes\":%lu"
+        "}",
+        active ? "true" : "false",
+        active ? inet_ntoa(a) : "",
+        destPort,
+        (unsigned long)st.frames,
+        (unsigned long)st.framesDropped,
+        (unsigned long)st.framesSkipped,
+        (unsigned long)st.packets,
+        (unsigned long)st.bytes
     );
+}
+
+/**
+ * @brief Обработчик /api/rtp — старт/стоп RTP-стрима и статистика
+ */
+static esp_err_t rtpApiHandler(httpd_req_t* req) {
+    // CORS preflight
+    if (req->method == HTTP_OPTIONS) {
+        httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+        httpd_resp_set_hdr(req, "Access-Control-Allow-Methods", "GET, POST, OPTIONS");
+        httpd_resp_set_hdr(req, "Access-Control-Allow-Headers", "Content-Type");
+        httpd_resp_send(req, NULL, 0);
+        return ESP_OK;
+    }
+
+    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+    httpd_resp_set_type(req, "application/json");
+
+    if (req->method == HTTP_POST) {
+        char body[256];
+        int len = httpd_req_recv(req, body, sizeof(body) - 1);
+        if (len <= 0) {
+            httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Empty body");
+            return ESP_FAIL;
+        }
+        body[len] = '\0';
+
+        JsonDocument doc;
+        DeserializationError err = deserializeJson(doc, body);
+        if (err) {
+            httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid JSON");
+            return ESP_FAIL;
+        }
+
+        const char* action = doc["action"] | "start";
+        if (strcmp(action, "stop") == 0) {
+            rtpStreamStop();
+        } else if (strcmp(action, "start") == 0) {
+            bool multicast = doc["multicast"] | false;
+            const char* host = doc["host"] | "";
+            uint16_t port = doc["port"] | RTP_DEFAULT_PORT;
+
+            uint32_t destIp = 0;
+            if (multicast) {
+                destIp = inet_addr(RTP_MULTICAST_GROUP);
+            } else if (host[0] != '\0') {
+                destIp = inet_addr(host);
+                if (destIp == INADDR_NONE) destIp = 0;
+            } else {
+                destIp = requestPeerIp(req);
+            }
+
+            if (destIp == 0 || port == 0) {
+                httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid destination");
+                return ESP_FAIL;
+            }
+            rtpStreamStart(destIp, port);
+        }
+    }
+
+    char json[256];
+    rtpStatusJson(json, sizeof(json));
     return httpd_resp_send(req, json, strlen(json));
 }
 
+/**
+ * @brief Обработчик GET /rtp.sdp — SDP-описание текущего RTP-стрима
+ * Если стрим не запущен — описывает multicast-группу по умолчанию.
+ */
+static esp_err_t rtpSdpHandler(httpd_req_t* req) {
+    uint32_t destIp = 0;
+    uint16_t destPort = 0;
+    if (!rtpStreamGetDest(&destIp, &destPort)) {
+        destIp   = inet_addr(RTP_MULTICAST_GROUP);
+        destPort = RTP_DEFAULT_PORT;
+    }
+
+    struct in_addr a;
+    a.s_addr = destIp;
+    char dest[16];
+    strlcpy(dest, inet_ntoa(a), sizeof(dest));
+    bool multicast = (ntohl(destIp) >> 28) == 0xE;  // 224.0.0.0/4
+
+    char ttl[8] = "";
+    if (multicast) snprintf(ttl, sizeof(ttl), "/%d", RTP_MULTICAST_TTL);
+
+    char sdp[320];
+    snprintf(sdp, sizeof(sdp),
+        "v=0\r\n"
+        "o=- 0 0 IN IP4 %s\r\n"
+        "s=ESP32-CAM Rover\r\n"
+        "c=IN IP4 %s%s\r\n"
+        "t=0 0\r\n"
+        "m=video %u RTP/AVP 26\r\n"
+        "a=rtpmap:26 JPEG/90000\r\n",
+        WiFi.localIP().toString().c_str(),
+        dest, ttl,
+        destPort);
+
+    httpd_resp_set_type(req, "application/sdp");
+    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+    return httpd_resp_send(req, sdp, strlen(sdp));
+}
+
 // ============================================================
 // 📁 Статика (SPIFFS)
 // ============================================================
@@ -533,7 +2139,7 @@ static esp_err_t staticHandler(httpd_req_t* req) {
 
     File file = SPIFFS.open(filepath, "r");
     if (!file) {
-        Serial.printf("❌ Файл не найден: %s\n", filepath);
+        LOG_W("❌ Файл не найден: %s", filepath);
         httpd_resp_send_404(req);
         return ESP_FAIL;
     }
@@ -563,7 +2169,7 @@ static esp_err_t staticHandler(httpd_req_t* req) {
 
     free(buf);
     file.close();
-    Serial.printf("✅ Отдан: %s (%d байт)\n", filepath, fileSize);
+    LOG_D("✅ Отдан: %s (%d байт)", filepath, fileSize);
     return ESP_OK;
 }
 
@@ -573,52 +2179,95 @@ static esp_err_t staticHandler(httpd_req_t* req) {
 //
 // Возвращает JSON со всей доступной телеметрией:
 //   uptime, heap, psram, rssi, ip, stream_clients,
-//   cpu_mhz, motors, control, led, vbat
+//   stream_bps / stream_saved_bps (трафик стрима и экономия abbrev-режима),
+//   cpu_mhz, motors, control, led, vbat,
+//   camera (sleep — камера в standby, resume_us — латентность пробуждения),
+//   follow (следование: руль x/y, frame_us — период кадров анализа,
+//           loop_us — снимок кадра → руль применён, см. /api/follow)
+//   state_version — номер публикации снимка (system_state.h): motors,
+//           control, led и stream_* в одном ответе — из одного снимка
 //
 // Используется фронтендом для OSD-виджетов поверх видеопотока.
 // Polling-интервал настраивается на клиенте (по умолчанию 5 сек).
+// Тот же JSON приходит part'ами стрима при /stream?telemetry=N.
 //
 
-static esp_err_t statusApiHandler(httpd_req_t* req) {
-    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
-    httpd_resp_set_type(req, "application/json");
-
-    // Собираем телеметрию
-    const DriveState& drv = driveGetState();
-    const ControlState& ctrl = controlGetState();
+/**
+ * Собрать JSON телеметрии. Общий для /api/status и телеметрии в стриме.
+ * @return длина JSON (без '\0')
+ */
+static int statusJsonBuild(char* json, size_t size) {
+    // Собираем телеметрию: моторы, управление, стрим и LED — одним
+    // целостным снимком (system_state.h), без ожидания писателей
+    SystemSnapshot snap = systemStateRead();
+    const DriveState& drv = snap.motors;
+    const ControlState& ctrl = snap.control;
+    CameraPowerStats cam = cameraGetPowerStats();
+    LogStats logStats = logGetStats();
+    FollowStats fol = followGetStats();
+    VisionStats vis = visionGetStats();
 
     // Форматируем JSON
-    char json[512];
-    snprintf(json, sizeof(json),
+    int len = snprintf(json, size,
         "{"
         "\"uptime\":%lu,"
+        "\"state_version\":%lu,"
         "\"heap\":%u,"
         "\"psram\":%u,"
         "\"rssi\":%d,"
         "\"ip\":\"%s\","
         "\"stream_clients\":%d,"
+        "\"stream_bps\":%lu,"
+        "\"stream_saved_bps\":%lu,"
         "\"cpu_mhz\":%u,"
         "\"vbat\":null,"
         "\"motors\":{\"fl\":%d,\"fr\":%d,\"rl\":%d,\"rr\":%d},"
         "\"control\":{\"active\":%s,\"direction\":%d,\"speed\":%d},"
-        "\"led\":%s"
+        "\"led\":%s,"
+        "\"camera\":{\"sleep\":%s,\"resumes\":%lu,\"resume_us\":%lu,\"resume_us_max\":%lu},"
+        "\"log\":{\"lines\":%lu,\"dropped\":%lu},"
+        "\"follow\":{\"enabled\":%s,\"tracking\":%s,\"x\":%d,\"y\":%d,"
+        "\"frame_us\":%lu,\"loop_us\":%lu,\"loop_max_us\":%lu}"
         "}",
         millis(),
+        (unsigned long)snap.version,
         (unsigned)ESP.getFreeHeap(),
         (unsigned)heap_caps_get_free_size(MALLOC_CAP_SPIRAM),
         WiFi.RSSI(),
         WiFi.localIP().toString().c_str(),
-        streamClientCount,
+        snap.streamClients,
+        (unsigned long)snap.streamBps,
+        (unsigned long)snap.streamSavedBps,
         (unsigned)ESP.getCpuFreqMHz(),
         drv.speed[MOTOR_FL], drv.speed[MOTOR_FR],
         drv.speed[MOTOR_RL], drv.speed[MOTOR_RR],
         ctrl.active ? "true" : "false",
         ctrl.direction,
         ctrl.speed,
-        irLedOn ? "true" : "false"
+        snap.led ? "true" : "false",
+        cam.suspended ? "true" : "false",
+        (unsigned long)cam.resumes,
+        (unsigned long)cam.resumeUsLast,
+        (unsigned long)cam.resumeUsMax,
+        (unsigned long)logStats.lines,
+        (unsigned long)logStats.dropped,
+        fol.enabled ? "true" : "false",
+        fol.tracking ? "true" : "false",
+        fol.x, fol.y,
+        (unsigned long)vis.periodUsAvg,
+        (unsigned long)fol.loopUsLast,
+        (unsigned long)fol.loopUsMax
     );
+    return (len < (int)size) ? len : (int)size - 1;
+}
 
-    return httpd_resp_send(req, json, strlen(json));
+static esp_err_t statusApiHandler(httpd_req_t* req) {
+    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+    httpd_resp_set_type(req, "application/json");
+
+    char json[STATUS_JSON_SIZE];
+    int len = statusJsonBuild(json, sizeof(json));
+    return httpd_resp_send(req, json, len);
 }
 
 // ============================================================
@@ -630,14 +2279,15 @@ static esp_err_t statusApiHandler(httpd_req_t* req) {
  *
  * Конфигурирует httpd и регистрирует все URI-обработчики:
  *   - Статические файлы из SPIFFS
- *   - REST API эндпоинты (/api/drive, /api/control, /api/status, /photo, /led)
+ *   - REST API эндпоинты (/api/drive, /api/control, /api/status, /api/rtp,
+ *     /api/thumbnail, /photo, /led)
  */
 void webserverStartMain() {
     httpd_config_t config = HTTPD_DEFAULT_CONFIG();
     config.server_port = HTTP_PORT_MAIN;
     config.ctrl_port = 32768;        // Порт управления httpd (внутренний)
     config.max_open_sockets = 5;     // Макс. одновременных HTTP-соединений
-    config.max_uri_handlers = 20;    // Макс. зарегистрированных маршрутов
+    config.max_uri_handlers = 56;    // Макс. зарегистрированных маршрутов
     config.lru_purge_enable = true;  // Автоочистка старых соединений
 
     if (httpd_start(&mainHttpd, &config) != ESP_OK) {
@@ -649,6 +2299,7 @@ void webserverStartMain() {
     httpd_uri_t uriIndex   = {"/",            HTTP_GET, staticHandler, NULL};
     httpd_uri_t uriConfigJs = {"/config.js",  HTTP_GET, staticHandler, NULL};  // Config
     httpd_uri_t uriCtrlJs  = {"/control.js",      HTTP_GET, staticHandler, NULL};  // ControlService
+    httpd_uri_t uriMjpegJs = {"/mjpeg-reader.js", HTTP_GET, staticHandler, NULL};  // MjpegReader
     httpd_uri_t uriCvJs   = {"/cv-processor.js", HTTP_GET, staticHandler, NULL};  // CV Processor
     httpd_uri_t uriMotionJs = {"/motion-detector.js", HTTP_GET, staticHandler, NULL};  // Motion Detector
     httpd_uri_t uriCompJs = {"/compositor.js",    HTTP_GET, staticHandler, NULL};  // Compositor
@@ -659,6 +2310,7 @@ void webserverStartMain() {
     httpd_register_uri_handler(mainHttpd, &uriIndex);
     httpd_register_uri_handler(mainHttpd, &uriConfigJs);
     httpd_register_uri_handler(mainHttpd, &uriCtrlJs);
+    httpd_register_uri_handler(mainHttpd, &uriMjpegJs);
     httpd_register_uri_handler(mainHttpd, &uriCvJs);
     httpd_register_uri_handler(mainHttpd, &uriMotionJs);
     httpd_register_uri_handler(mainHttpd, &uriCompJs);
@@ -681,9 +2333,61 @@ void webserverStartMain() {
     httpd_uri_t uriCtrlGet    = {"/api/control", HTTP_GET,  controlApiHandler, NULL};
     httpd_uri_t uriCtrlPost   = {"/api/control", HTTP_POST, controlApiHandler, NULL};
     httpd_uri_t uriCtrlOpts   = {"/api/control", HTTP_OPTIONS, controlApiHandler, NULL};
+
+    // API — /api/lease (аренда управления)
+    httpd_uri_t uriLeaseGet   = {"/api/lease",   HTTP_GET,     leaseApiHandler, NULL};
+    httpd_uri_t uriLeasePost  = {"/api/lease",   HTTP_POST,    leaseApiHandler, NULL};
+    httpd_uri_t uriLeaseOpts  = {"/api/lease",   HTTP_OPTIONS, leaseApiHandler, NULL};
+
+    // API — /api/estop (аварийный стоп: состояние, снятие защёлки)
+    httpd_uri_t uriEstopGet   = {"/api/estop",   HTTP_GET,     estopApiHandler, NULL};
+    httpd_uri_t uriEstopPost  = {"/api/estop",   HTTP_POST,    estopApiHandler, NULL};
+    httpd_uri_t uriEstopOpts  = {"/api/estop",   HTTP_OPTIONS, estopApiHandler, NULL};
+
+    // API — /api/scene (защита хода вперёд по смене сцены)
+    httpd_uri_t uriSceneGet   = {"/api/scene",   HTTP_GET,     sceneApiHandler, NULL};
+    httpd_uri_t uriScenePost  = {"/api/scene",   HTTP_POST,    sceneApiHandler, NULL};
+    httpd_uri_t uriSceneOpts  = {"/api/scene",   HTTP_OPTIONS, sceneApiHandler, NULL};
+
+    // API — /api/follow (следование за движением)
+    httpd_uri_t uriFollowGet  = {"/api/follow",  HTTP_GET,     followApiHandler, NULL};
+    httpd_uri_t uriFollowPost = {"/api/follow",  HTTP_POST,    followApiHandler, NULL};
+    httpd_uri_t uriFollowOpts = {"/api/follow",  HTTP_OPTIONS, followApiHandler, NULL};
+
+    // WebSocket — /ws/control (то же управление по одному соединению)
+    httpd_uri_t uriCtrlWs     = {"/ws/control",  HTTP_GET,  controlWsHandler,  NULL, true};
+    
+    // API — /api/mixer (expo/ремап осей джойстика)
+    httpd_uri_t uriMixerGet   = {"/api/mixer",   HTTP_GET,     mixerApiHandler, NULL};
+    httpd_uri_t uriMixerPost  = {"/api/mixer",   HTTP_POST,    mixerApiHandler, NULL};
+    httpd_uri_t uriMixerOpts  = {"/api/mixer",   HTTP_OPTIONS, mixerApiHandler, NULL};
+    
+    // API — /api/recorder (журнал команд управления)
+    httpd_uri_t uriRecGet     = {"/api/recorder", HTTP_GET,     recorderApiHandler, NULL};
+    httpd_uri_t uriRecPost    = {"/api/recorder", HTTP_POST,    recorderApiHandler, NULL};
+    httpd_uri_t uriRecOpts    = {"/api/recorder", HTTP_OPTIONS, recorderApiHandler, NULL};
+    
+    // API — /api/mission (байткод-сценарии движения)
+    httpd_uri_t uriMissionGet  = {"/api/mission", HTTP_GET,     missionApiHandler, NULL};
+    httpd_uri_t uriMissionPost = {"/api/mission", HTTP_POST,    missionApiHandler, NULL};
+    httpd_uri_t uriMissionOpts = {"/api/mission", HTTP_OPTIONS, missionApiHandler, NULL};
+
+    // API — /api/wave (формы скважности)
+    httpd_uri_t uriWaveGet     = {"/api/wave",    HTTP_GET,     waveApiHandler, NULL};
+    httpd_uri_t uriWavePost    = {"/api/wave",    HTTP_POST,    waveApiHandler, NULL};
+    httpd_uri_t uriWaveOpts    = {"/api/wave",    HTTP_OPTIONS, waveApiHandler, NULL};
     
     // API — /api/status (телеметрия для OSD)
     httpd_uri_t uriStatus     = {"/api/status",  HTTP_GET,  statusApiHandler,  NULL};
+
+    // API — /api/rtp (RTP/UDP стрим, RFC 2435)
+    httpd_uri_t uriRtpGet     = {"/api/rtp",     HTTP_GET,     rtpApiHandler, NULL};
+    httpd_uri_t uriRtpPost    = {"/api/rtp",     HTTP_POST,    rtpApiHandler, NULL};
+    httpd_uri_t uriRtpOpts    = {"/api/rtp",     HTTP_OPTIONS, rtpApiHandler, NULL};
+    httpd_uri_t uriRtpSdp     = {"/rtp.sdp",     HTTP_GET,     rtpSdpHandler, NULL};
+
+    // API — /api/thumbnail (бенчмарк перекодирования миниатюр)
+    httpd_uri_t uriThumb      = {"/api/thumbnail", HTTP_GET,   thumbnailApiHandler, NULL};
     
     httpd_register_uri_handler(mainHttpd, &uriPhoto);
     httpd_register_uri_handler(mainHttpd, &uriLedGet);
@@ -694,12 +2398,49 @@ void webserverStartMain() {
     httpd_register_uri_handler(mainHttpd, &uriCtrlGet);
     httpd_register_uri_handler(mainHttpd, &uriCtrlPost);
     httpd_register_uri_handler(mainHttpd, &uriCtrlOpts);
+    httpd_register_uri_handler(mainHttpd, &uriCtrlWs);
+    httpd_register_uri_handler(mainHttpd, &uriLeaseGet);
+    httpd_register_uri_handler(mainHttpd, &uriLeasePost);
+    httpd_register_uri_handler(mainHttpd, &uriLeaseOpts);
+    httpd_register_uri_handler(mainHttpd, &uriEstopGet);
+    httpd_register_uri_handler(mainHttpd, &uriEstopPost);
+    httpd_register_uri_handler(mainHttpd, &uriEstopOpts);
+    httpd_register_uri_handler(mainHttpd, &uriSceneGet);
+    httpd_register_uri_handler(mainHttpd, &uriScenePost);
+    httpd_register_uri_handler(mainHttpd, &uriSceneOpts);
+    httpd_register_uri_handler(mainHttpd, &uriFollowGet);
+    httpd_register_uri_handler(mainHttpd, &uriFollowPost);
+    httpd_register_uri_handler(mainHttpd, &uriFollowOpts);
+    httpd_register_uri_handler(mainHttpd, &uriMixerGet);
+    httpd_register_uri_handler(mainHttpd, &uriMixerPost);
+    httpd_register_uri_handler(mainHttpd, &uriMixerOpts);
+    httpd_register_uri_handler(mainHttpd, &uriRecGet);
+    httpd_register_uri_handler(mainHttpd, &uriRecPost);
+    httpd_register_uri_handler(mainHttpd, &uriRecOpts);
+    httpd_register_uri_handler(mainHttpd, &uriMissionGet);
+    httpd_register_uri_handler(mainHttpd, &uriMissionPost);
+    httpd_register_uri_handler(mainHttpd, &uriMissionOpts);
+    httpd_register_uri_handler(mainHttpd, &uriWaveGet);
+    httpd_register_uri_handler(mainHttpd, &uriWavePost);
+    httpd_register_uri_handler(mainHttpd, &uriWaveOpts);
     httpd_register_uri_handler(mainHttpd, &uriStatus);
+    httpd_register_uri_handler(mainHttpd, &uriRtpGet);
+    httpd_register_uri_handler(mainHttpd, &uriRtpPost);
+    httpd_register_uri_handler(mainHttpd, &uriRtpOpts);
+    httpd_register_uri_handler(mainHttpd, &uriRtpSdp);
+    httpd_register_uri_handler(mainHttpd, &uriThumb);
 
     Serial.printf("🌐 Основной сервер на порту %d, Core %d\n", HTTP_PORT_MAIN, xPortGetCoreID());
     Serial.println("   📡 /api/drive   — отладка (без таймаута)");
     Serial.println("   🎮 /api/control — управление (с watchdog)");
+    Serial.println("   🔌 /ws/control  — управление по WebSocket");
+    Serial.println("   🔑 /api/lease   — аренда управления");
+    Serial.println("   🛑 /api/estop   — аварийный стоп (защёлка)");
+    Serial.println("   👁️ /api/scene   — защита по смене сцены");
+    Serial.println("   🎯 /api/follow  — следование за движением");
+    Serial.println("   〰️ /api/wave    — формы скважности (характеризация)");
     Serial.println("   📊 /api/status  — телеметрия (OSD)");
+    Serial.println("   📡 /api/rtp     — RTP/UDP стрим (RFC 2435)");
 }
 
 /**
@@ -707,9 +2448,10 @@ void webserverStartMain() {
  *
  * Основной цикл:
  *   1. accept() новых клиентов (non-blocking)
- *   2. Если нет клиентов — sleep 100ms
+ *   2. Если нет клиентов и RTP не активен — sleep 100ms
  *   3. Захват кадра с камеры (cameraCapture)
- *   4. Отправка кадра одному клиенту (round-robin)
+ *   4. Отправка кадра одному клиенту (round-robin) и в RTP,
+ *      копия — анализу на устройстве (visionSubmit)
  *   5. Возврат framebuffer'а камеры
  *   6. Задержка STREAM_FRAME_DELAY мс
  *
@@ -762,9 +2504,12 @@ void streamServerTask(void* pvParameters) {
     while (true) {
         // 1. Принимаем новых клиентов (non-blocking)
         streamAcceptClients(serverFd);
+        streamUpdateRates();
 
-        // 2. Если нет клиентов — просто ждём
-        if (streamClientCount == 0) {
+        // 2. Если нет ни TCP-клиентов, ни RTP-адресата — ждём,
+        //    после CAM_IDLE_SUSPEND_MS простоя камера засыпает
+        if (streamClientCount == 0 && !rtpStreamActive()) {
+            cameraPowerTick();
             vTaskDelay(pdMS_TO_TICKS(100));
             continue;
         }
@@ -776,8 +2521,12 @@ void streamServerTask(void* pvParameters) {
             continue;
         }
 
-        // 4. Отправка по round-robin
+        // 4. Отправка по round-robin + RTP (каждый кадр) + телеметрия,
+        //    копия — анализу на устройстве (защита, следование — если нужны)
+        visionSubmit(fb);
         streamSendFrame(fb);
+        rtpSendFrame(fb);
+        streamSendTelemetry();
 
         // 5. Возврат буфера камеры
         esp_camera_fb_return(fb);
@@ -0,0 +1,89 @@
+/**
+ * ============================================================
+ * 🎯 wheel_pid.cpp — PID скорости колеса и модель мотора
+ * ============================================================
+ *
+ * Вся арифметика целочисленная: Q16 в int64 — произведения
+ * «коэффициент × ошибка» не переполняются на любых имп/с.
+ *
+ * ============================================================
+ */
+
+#include "wheel_pid.h"
+
+void wheelPidReset(WheelPid* pid) {
+    pid->integQ16 = 0;
+    pid->measCps = 0;
+    pid->prevMeasCps = 0;
+    pid->prevSetpointCps = 0;
+    pid->lastDuty = 0;
+    pid->primed = false;
+}
+
+uint8_t wheelPidStep(WheelPid* pid, const WheelPidGains& g,
+                     int32_t setpointCps, int32_t rawCps, uint8_t maxDuty,
+                     uint8_t appliedDuty) {
+    // Фильтр измерения (первый шаг — без истории)
+    if (!pid->primed) {
+        pid->measCps = pid->prevMeasCps = rawCps;
+        pid->primed = true;
+    } else {
+        pid->measCps += (rawCps - pid->measCps) >> g.filterShift;
+    }
+    int32_t meas = pid->measCps;
+    int32_t dMeas = meas - pid->prevMeasCps;
+    pid->prevMeasCps = meas;
+
+    bool ramping = setpointCps != pid->prevSetpointCps;
+    pid->prevSetpointCps = setpointCps;
+
+    if (setpointCps <= 0) {
+        pid->integQ16 = 0;
+        pid->lastDuty = 0;
+        return 0;
+    }
+
+    int32_t err = setpointCps - meas;
+    const int64_t maxQ16 = (int64_t)maxDuty << 16;
+    int64_t base = (int64_t)g.ffQ16 * setpointCps
+                 + (int64_t)g.kpQ16 * err
+                 - (int64_t)g.kdQ16 * dMeas;
+
+    // Условное интегрирование: в насыщении в сторону ошибки не копим,
+    // пока уставка идёт по рампе и пока ограничители после регулятора
+    // не дают мотору его выход
+    bool held = ramping ||
+                (err > 0 && appliedDuty < pid->lastDuty) ||
+                (err < 0 && appliedDuty > pid->lastDuty);
+    int64_t integ = pid->integQ16 + (int64_t)g.kiQ16 * err;
+    int64_t out = base + integ;
+    if (held || (out > maxQ16 && err > 0) || (out < 0 && err < 0)) {
+        integ = pid->integQ16;
+        out = base + integ;
+    }
+    if (integ > maxQ16) integ = maxQ16;
+    if (integ < -maxQ16) integ = -maxQ16;
+    pid->integQ16 = integ;
+
+    uint8_t duty;
+    if (out <= 0) duty = 0;
+    else if (out >= maxQ16) duty = maxDuty;
+    else duty = (uint8_t)((out + 0x8000) >> 16);
+    pid->lastDuty = duty;
+    return duty;
+}
+
+void motorModelStep(MotorModel* m, const MotorModelParams& p, uint8_t duty, uint32_t dtUs) {
+    // Установившаяся скорость для этой скважности (Q16)
+    int64_t targetQ16 = 0;
+    if (duty > p.deadband) {
+        targetQ16 = ((int64_t)p.gainCps << 16) * (duty - p.deadband) / (255 - p.deadband);
+        targetQ16 = targetQ16 * p.loadPct / 100;
+    }
+
+    // Неявный Эйлер: v += (цель − v)·dt/(tau + dt)
+    m->speedQ16 += (targetQ16 - m->speedQ16) * dtUs / (p.tauUs + dtUs);
+
+    // Импульсы: v·dt (мкс → с), дробная часть копится в Q16
+    m->countsQ16 += (uint64_t)(m->speedQ16 * dtUs / 1000000);
+}
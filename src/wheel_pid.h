@@ -0,0 +1,114 @@
+/**
+ * ============================================================
+ * 🎯 wheel_pid.h — PID скорости колеса и модель мотора
+ * ============================================================
+ *
+ * Разомкнутый PWM даёт разную скорость при одной скважности:
+ * садится батарея, меняется покрытие. Регулятор держит скорость
+ * колеса по энкодеру (импульсы в секунду, имп/с).
+ *
+ * Регулятор (wheelPidStep) — целочисленный, Q16, вызывается с
+ * фиксированной частотой, поэтому период вшит в коэффициенты
+ * (ki, kd — на один шаг):
+ *
+ *   meas = фильтр(измерение)         IIR, сдвиг filterShift
+ *   out  = ff·sp + kp·e + I − kd·Δmeas
+ *   I   += ki·e                      условное интегрирование:
+ *                                    не копим в насыщении, пока
+ *                                    уставка меняется и пока мотор
+ *                                    получает меньше/больше, чем
+ *                                    просили
+ *
+ *   Между выходом и мотором — блокировка реверса, срез переда
+ *   (driveSetForwardCap), каналы прямого вывода. Их регулятор не
+ *   видит, поэтому получает обратно скважность, фактически
+ *   поданную на мотор: если она отстаёт от прошлого выхода в
+ *   сторону ошибки, интеграл заморожен (tracking anti-windup) —
+ *   иначе он копится всё время ограничения и колесо проскакивает
+ *   цель, когда оно уйдёт. Рампа профиля ведёт уставку, а не
+ *   выход (drive.cpp): внутри контура её запаздывание раскачивало
+ *   бы колесо за уставку. Пока уставка идёт по рампе, её ведут
+ *   ff и P; ошибку слежения за рампой (инерция, мёртвая зона)
+ *   интеграл не копит — иначе она выходит проскоком в конце.
+ *
+ *   ff — прямая связь (скважность на имп/с), основную часть
+ *   выхода даёт она, PID добирает потери (мёртвая зона, нагрузка).
+ *   Дифференцирование — по измерению, без броска на смене цели.
+ *   Цель 0 — выход 0 и сброс состояния (накат, без торможения).
+ *
+ * Модель мотора (motorModelStep) — объект первого порядка для
+ * отладки без железа (источник энкодера «sim»):
+ *
+ *   цель = gain·(duty − deadband)/(255 − deadband) · load
+ *   v   += (цель − v)·dt/(tau + dt)   (неявный Эйлер, устойчив)
+ *   импульсы += v·dt
+ *
+ * Модуль не зависит от Arduino/IDF — считается одинаково
+ * на устройстве и на хосте.
+ *
+ * ============================================================
+ */
+
+#ifndef WHEEL_PID_H
+#define WHEEL_PID_H
+
+#include <stdint.h>
+
+// --- Коэффициенты регулятора (Q16, на один шаг) ---
+struct WheelPidGains {
+    int32_t ffQ16;        // Прямая связь: скважность на 1 имп/с
+    int32_t kpQ16;        // Пропорциональный: скважность на 1 имп/с ошибки
+    int32_t kiQ16;        // Интегральный: за шаг
+    int32_t kdQ16;        // Дифференциальный: на 1 имп/с изменения за шаг
+    uint8_t filterShift;  // IIR измерения: meas += (raw − meas) >> shift
+};
+
+// --- Состояние регулятора колеса ---
+struct WheelPid {
+    int64_t integQ16;     // Интеграл (в единицах скважности, Q16)
+    int32_t measCps;      // Отфильтрованное измерение
+    int32_t prevMeasCps;  // Измерение прошлого шага (для D)
+    int32_t prevSetpointCps;  // Уставка прошлого шага (рампа идёт — не интегрируем)
+    uint8_t lastDuty;     // Выход прошлого шага
+    bool    primed;       // Фильтр инициализирован
+};
+
+/** @brief Сбросить регулятор (интеграл, фильтр) */
+void wheelPidReset(WheelPid* pid);
+
+/**
+ * @brief Шаг регулятора
+ * @param setpointCps Цель (имп/с), 0 — стоп со сбросом
+ * @param rawCps      Измерение за период (имп/с)
+ * @param maxDuty     Верхняя граница выхода
+ * @param appliedDuty Скважность, фактически поданная на мотор за
+ *                    период (после рампы и ограничителей)
+ * @return Скважность 0..maxDuty
+ */
+uint8_t wheelPidStep(WheelPid* pid, const WheelPidGains& g,
+                     int32_t setpointCps, int32_t rawCps, uint8_t maxDuty,
+                     uint8_t appliedDuty);
+
+// --- Параметры модели мотора ---
+struct MotorModelParams {
+    int32_t  gainCps;     // Установившаяся скорость при скважности 255 (имп/с)
+    uint32_t tauUs;       // Постоянная времени
+    uint8_t  deadband;    // Скважность трогания (ниже — стоит)
+    uint8_t  loadPct;     // Нагрузка/батарея: 100 — номинал, меньше — медленнее
+};
+
+// --- Состояние модели ---
+struct MotorModel {
+    int64_t  speedQ16;    // Скорость (имп/с, Q16)
+    uint64_t countsQ16;   // Накопленные импульсы (Q16)
+};
+
+/** @brief Шаг модели: скважность duty в течение dtUs */
+void motorModelStep(MotorModel* m, const MotorModelParams& p, uint8_t duty, uint32_t dtUs);
+
+/** @brief Накопленные импульсы (по модулю 2^32, как у счётчика) */
+static inline uint32_t motorModelCounts(const MotorModel* m) {
+    return (uint32_t)(m->countsQ16 >> 16);
+}
+
+#endif // WHEEL_PID_H
@@ -0,0 +1,230 @@
+/**
+ * ============================================================
+ * 🧪 test_drive_output — Выходной каскад моторов (drive_output.h), хост
+ * ============================================================
+ *
+ * DriveOutput над MockDriveBackend (drive_backend_mock.h): что
+ * и когда уходит в бэкенд — программная запись или fade, реверс
+ * через ноль, прерывание fade стопом, cut() и stopAll(), каналы
+ * мимо рампы (rawMask, формы скважности wave.h). Бэкенд без
+ * fade (MCPWM) — MockDriveBackendT<false>.
+ *
+ *   pio test -e native -f test_drive_output
+ *
+ * ============================================================
+ */
+
+#include <unity.h>
+#include "drive_output.h"
+#include "drive_backend_mock.h"
+
+typedef MockDriveBackendT<false> MockNoFade;
+
+// Индексы enum Motor (drive.h)
+enum { RL = 0, FR, FL, RR };
+
+static const uint32_t TICK_US = 5000;
+static const uint32_t FADE_US = 40000;          // RAMP_FADE_CHUNK_MS
+
+static DriveOutput<MockDriveBackend> out;
+static DriveOutput<MockNoFade> outNoFade;
+static uint8_t targets[DRIVE_CHANNELS];
+
+void setUp() {
+    out = DriveOutput<MockDriveBackend>();
+    outNoFade = DriveOutput<MockNoFade>();
+    out.begin();
+    outNoFade.begin();
+    for (uint8_t i = 0; i < DRIVE_CHANNELS; i++) targets[i] = 0;
+}
+
+void tearDown() {}
+
+template <typename Out>
+static uint8_t tick(Out& o, RampProfileId id, uint32_t maxFadeUs = FADE_US, uint8_t rawMask = 0) {
+    return o.tick(targets, rampGetProfile(id), TICK_US, maxFadeUs, rawMask);
+}
+
+// ------------------------------------------------------------
+
+void test_begin_zeroes_backend() {
+    TEST_ASSERT_EQUAL_UINT32(1, MockDriveBackend::begins);
+    TEST_ASSERT_EQUAL_UINT32(1, MockNoFade::begins);
+    // Нулевые цели — в бэкенд ничего не пишется
+    TEST_ASSERT_EQUAL_UINT8(0, tick(out, RAMP_NORMAL));
+    TEST_ASSERT_EQUAL_UINT32(0, MockDriveBackend::writes + MockDriveBackend::fades);
+}
+
+void test_software_ramp_without_fade() {
+    targets[FL] = 200;
+    int ticks = 0;
+    while (MockNoFade::duty[FL] != 200 && ticks < 200) {
+        uint8_t written = tick(outNoFade, RAMP_SPORT);
+        TEST_ASSERT_EQUAL_UINT8(1 << FL, written);
+        TEST_ASSERT_EQUAL_UINT8(outNoFade.duty[FL], MockNoFade::duty[FL]);
+        ticks++;
+    }
+    // Бэкенд без fade: каждый шаг — запись, fade не вызывается
+    TEST_ASSERT_EQUAL_UINT8(200, MockNoFade::duty[FL]);
+    TEST_ASSERT_EQUAL_UINT32(ticks, MockNoFade::writes);
+    TEST_ASSERT_EQUAL_UINT32(0, MockNoFade::fades);
+    // На цели — тишина
+    TEST_ASSERT_EQUAL_UINT8(0, tick(outNoFade, RAMP_SPORT));
+}
+
+void test_linear_segment_goes_to_fade() {
+    targets[FR] = 255;
+    TEST_ASSERT_EQUAL_UINT8(1 << FR, tick(out, RAMP_SPORT));
+    TEST_ASSERT_EQUAL_UINT32(1, MockDriveBackend::fades);
+    TEST_ASSERT_EQUAL_UINT32(40, MockDriveBackend::fadeMs[FR]);
+    TEST_ASSERT_EQUAL_UINT8(out.duty[FR], MockDriveBackend::duty[FR]);
+
+    // Пока идёт участок — бэкенд не трогаем
+    for (int t = 0; t < 7; t++) TEST_ASSERT_EQUAL_UINT8(0, tick(out, RAMP_SPORT));
+    TEST_ASSERT_EQUAL_UINT32(1, MockDriveBackend::fades);
+    TEST_ASSERT_EQUAL_UINT32(0, MockDriveBackend::writes);
+}
+
+void test_stop_aborts_fade_with_write() {
+    targets[FR] = 255;
+    tick(out, RAMP_SPORT);
+    tick(out, RAMP_SPORT);
+    targets[FR] = 0;
+    // Стоп посреди участка: запись на этом же тике, мимо fade
+    TEST_ASSERT_EQUAL_UINT8(1 << FR, tick(out, RAMP_SPORT));
+    TEST_ASSERT_EQUAL_UINT32(1, MockDriveBackend::writes);
+    TEST_ASSERT_EQUAL_UINT32(0, MockDriveBackend::fadeMs[FR]);
+    TEST_ASSERT_TRUE(MockDriveBackend::duty[FR] < 40);
+}
+
+void test_reverse_waits_for_opposite_channel() {
+    targets[FL] = 150;
+    for (int t = 0; t < 100; t++) tick(out, RAMP_NORMAL, 0);
+    TEST_ASSERT_EQUAL_UINT8(150, MockDriveBackend::duty[FL]);
+
+    // Реверс левой стороны: RL стоит, пока FL не погаснет
+    targets[FL] = 0;
+    targets[RL] = 150;
+    int t = 0;
+    while (MockDriveBackend::duty[FL] > 0 && t < 200) {
+        tick(out, RAMP_NORMAL, 0);
+        if (MockDriveBackend::duty[FL] > 0) TEST_ASSERT_EQUAL_UINT8(0, MockDriveBackend::duty[RL]);
+        t++;
+    }
+    TEST_ASSERT_EQUAL_UINT8(0, MockDriveBackend::duty[FL]);
+    for (int k = 0; k < 200; k++) tick(out, RAMP_NORMAL, 0);
+    TEST_ASSERT_EQUAL_UINT8(150, MockDriveBackend::duty[RL]);
+    TEST_ASSERT_EQUAL_UINT8(0, MockDriveBackend::duty[FL]);
+}
+
+void test_cut_zeroes_without_ramp() {
+    targets[FL] = 200;
+    targets[FR] = 200;
+    for (int t = 0; t < 100; t++) tick(out, RAMP_SOFT, 0);
+    uint32_t writes = MockDriveBackend::writes;
+
+    TEST_ASSERT_EQUAL_UINT8(1 << FL, out.cut(1 << FL));
+    TEST_ASSERT_EQUAL_UINT8(0, MockDriveBackend::duty[FL]);
+    TEST_ASSERT_TRUE(MockDriveBackend::duty[FR] > 0);
+    TEST_ASSERT_EQUAL_UINT32(writes + 1, MockDriveBackend::writes);
+    // Погашенный канал и неактивный — повторно не пишутся
+    TEST_ASSERT_EQUAL_UINT8(0, out.cut((1 << FL) | (1 << RR)));
+}
+
+void test_cut_interrupts_fade() {
+    targets[FL] = 255;
+    tick(out, RAMP_SPORT);                      // Старт fade: 0 → ~112
+    TEST_ASSERT_EQUAL_UINT32(1, MockDriveBackend::fades);
+    TEST_ASSERT_EQUAL_UINT8(1 << FL, out.cut(1 << FL));
+    TEST_ASSERT_EQUAL_UINT8(0, MockDriveBackend::duty[FL]);
+    TEST_ASSERT_EQUAL_UINT32(0, MockDriveBackend::fadeMs[FL]);
+}
+
+void test_cut_during_fade_to_zero_still_writes() {
+    targets[FL] = 100;
+    for (int t = 0; t < 100; t++) tick(out, RAMP_SPORT, 0);
+    // Спад на fade до нуля: duty[] уже 0 (конец участка), железо — посреди
+    targets[FL] = 0;
+    tick(out, RAMP_SPORT);
+    TEST_ASSERT_EQUAL_UINT32(1, MockDriveBackend::fades);
+    TEST_ASSERT_EQUAL_UINT8(0, out.duty[FL]);
+    TEST_ASSERT_TRUE(MockDriveBackend::fadeMs[FL] > 0);
+    uint32_t writes = MockDriveBackend::writes;
+    TEST_ASSERT_EQUAL_UINT8(1 << FL, out.cut(1 << FL));
+    TEST_ASSERT_EQUAL_UINT32(writes + 1, MockDriveBackend::writes);
+    TEST_ASSERT_EQUAL_UINT32(0, MockDriveBackend::fadeMs[FL]);
+}
+
+void test_stop_all_then_reset_resumes() {
+    targets[RL] = 120;
+    for (int t = 0; t < 100; t++) tick(out, RAMP_SPORT, 0);
+    TEST_ASSERT_EQUAL_UINT8(120, MockDriveBackend::duty[RL]);
+
+    // Аварийный стоп: бэкенд гасит всё мимо рампы
+    DriveOutput<MockDriveBackend>::stopAll();
+    TEST_ASSERT_EQUAL_UINT32(1, MockDriveBackend::stops);
+    TEST_ASSERT_EQUAL_UINT8(0, MockDriveBackend::duty[RL]);
+
+    // Защёлка: driveTick() сбрасывает каскад; после снятия — разгон с нуля
+    out.reset();
+    uint8_t written = tick(out, RAMP_SPORT, 0);
+    TEST_ASSERT_EQUAL_UINT8(1 << RL, written);
+    TEST_ASSERT_TRUE(MockDriveBackend::duty[RL] > 0 && MockDriveBackend::duty[RL] < 120);
+}
+
+void test_raw_channels_skip_ramp() {
+    targets[FR] = 180;
+    targets[FL] = 180;
+    // FR мимо рампы — сразу цель; FL — по профилю
+    uint8_t written = tick(out, RAMP_SOFT, FADE_US, 1 << FR);
+    TEST_ASSERT_EQUAL_UINT8(1 << FR, written & (1 << FR));
+    TEST_ASSERT_EQUAL_UINT8(180, MockDriveBackend::duty[FR]);
+    TEST_ASSERT_TRUE(MockDriveBackend::duty[FL] < 180);
+
+    // Тот же отсчёт — без записи; новый — запись
+    TEST_ASSERT_EQUAL_UINT8(0, tick(out, RAMP_SOFT, FADE_US, 1 << FR) & (1 << FR));
+    targets[FR] = 40;
+    TEST_ASSERT_EQUAL_UINT8(1 << FR, tick(out, RAMP_SOFT, FADE_US, 1 << FR) & (1 << FR));
+    TEST_ASSERT_EQUAL_UINT8(40, MockDriveBackend::duty[FR]);
+}
+
+void test_raw_channel_keeps_reverse_interlock() {
+    targets[RR] = 100;
+    for (int t = 0; t < 100; t++) tick(out, RAMP_SPORT, 0);
+    // Встречный FR мимо рампы всё равно ждёт, пока RR погаснет
+    targets[RR] = 0;
+    targets[FR] = 200;
+    tick(out, RAMP_SPORT, 0, 1 << FR);
+    TEST_ASSERT_TRUE(MockDriveBackend::duty[RR] > 0);
+    TEST_ASSERT_EQUAL_UINT8(0, MockDriveBackend::duty[FR]);
+    for (int t = 0; t < 100; t++) tick(out, RAMP_SPORT, 0, 1 << FR);
+    TEST_ASSERT_EQUAL_UINT8(200, MockDriveBackend::duty[FR]);
+}
+
+void test_raw_takeover_aborts_fade() {
+    targets[FL] = 255;
+    tick(out, RAMP_SPORT);                      // Участок на fade
+    TEST_ASSERT_EQUAL_UINT32(1, MockDriveBackend::fades);
+    // Канал переходит под форму: запись сразу, даже если отсчёт равен duty[]
+    targets[FL] = out.duty[FL];
+    TEST_ASSERT_EQUAL_UINT8(1 << FL, tick(out, RAMP_SPORT, FADE_US, 1 << FL));
+    TEST_ASSERT_EQUAL_UINT32(1, MockDriveBackend::writes);
+    TEST_ASSERT_EQUAL_UINT32(0, MockDriveBackend::fadeMs[FL]);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_begin_zeroes_backend);
+    RUN_TEST(test_software_ramp_without_fade);
+    RUN_TEST(test_linear_segment_goes_to_fade);
+    RUN_TEST(test_stop_aborts_fade_with_write);
+    RUN_TEST(test_reverse_waits_for_opposite_channel);
+    RUN_TEST(test_cut_zeroes_without_ramp);
+    RUN_TEST(test_cut_interrupts_fade);
+    RUN_TEST(test_cut_during_fade_to_zero_still_writes);
+    RUN_TEST(test_stop_all_then_reset_resumes);
+    RUN_TEST(test_raw_channels_skip_ramp);
+    RUN_TEST(test_raw_channel_keeps_reverse_interlock);
+    RUN_TEST(test_raw_takeover_aborts_fade);
+    return UNITY_END();
+}
@@ -0,0 +1,185 @@
+/**
+ * ============================================================
+ * 🧪 test_jitter_buffer — Джиттер-буфер X/Y (jitter_buffer.h), хост
+ * ============================================================
+ *
+ * Поток команд-рампы с псевдослучайной задержкой сети должен
+ * проигрываться ровной рампой; опоздавшие отбрасываются;
+ * без команд выход проходит grace → hold → decay → stop;
+ * метки переживают переполнение 2^32 и перезапуск клиента.
+ * Параметры — JITTER_* из config.h, тик — CONTROL_RATE_HZ.
+ *
+ *   pio test -e native -f test_jitter_buffer
+ *
+ * ============================================================
+ */
+
+#include <unity.h>
+#include <stdlib.h>
+#include "config.h"
+#include "jitter_buffer.h"
+
+static const uint32_t TICK_US = 1000000 / CONTROL_RATE_HZ;
+static const JitterParams params = {
+    JITTER_DELAY_MS * 1000,
+    JITTER_GRACE_MS * 1000,
+    JITTER_HOLD_MS * 1000,
+    JITTER_DECAY_MS * 1000
+};
+
+static JitterBuffer jb;
+
+void setUp() {
+    jb = JitterBuffer{};
+}
+
+void tearDown() {}
+
+/** Детерминированная задержка сети 5..50 мс */
+static uint32_t netDelayUs(uint32_t i) {
+    static const uint8_t ms[] = {5, 31, 12, 50, 8, 44, 19, 5, 27, 38, 6, 15};
+    return ms[i % sizeof(ms)] * 1000;
+}
+
+/**
+ * Рампа X = 0, 10, 20, … каждые 20 мс у отправителя, доставка
+ * с задержкой netDelayUs(); тик буфера каждые TICK_US.
+ * @return Максимальный шаг выхода за тик
+ */
+static int playRamp(uint32_t senderBase, uint32_t localBase, int commands, bool* monotonic) {
+    const uint32_t periodUs = 20000;
+    int prevX = -1, maxStep = 0;
+    *monotonic = true;
+    uint32_t endUs = commands * periodUs + 200000;
+    for (uint32_t t = 0; t <= endUs; t += TICK_US) {
+        // Всё, что «пришло» к моменту t (в порядке прихода)
+        for (int i = 0; i < commands; i++) {
+            uint32_t arrive = i * periodUs + netDelayUs(i);
+            if (arrive > t - TICK_US && arrive <= t) {
+                jitterPush(&jb, senderBase + i * periodUs, localBase + arrive, (int16_t)(i * 10), 0);
+            }
+        }
+        int16_t x, y;
+        JitterStage st = jitterSample(&jb, params, localBase + t, &x, &y);
+        if (st != JITTER_PLAY && st != JITTER_EXTRAPOLATE) continue;
+        if (prevX >= 0) {
+            if (x < prevX) *monotonic = false;
+            if (abs(x - prevX) > maxStep) maxStep = abs(x - prevX);
+        }
+        prevX = x;
+    }
+    return maxStep;
+}
+
+// ------------------------------------------------------------
+
+void test_idle_until_first_command_is_due() {
+    int16_t x, y;
+    TEST_ASSERT_EQUAL(JITTER_IDLE, jitterSample(&jb, params, 1000, &x, &y));
+    jitterPush(&jb, 500, 1000, 100, 50);
+    // Раньше задержки проигрывания — ещё ничего
+    TEST_ASSERT_EQUAL(JITTER_IDLE, jitterSample(&jb, params, 1000 + params.delayUs - TICK_US, &x, &y));
+    TEST_ASSERT_EQUAL(JITTER_EXTRAPOLATE, jitterSample(&jb, params, 1000 + params.delayUs, &x, &y));
+    TEST_ASSERT_EQUAL_INT16(100, x);
+    TEST_ASSERT_EQUAL_INT16(50, y);
+}
+
+void test_jittered_ramp_plays_smoothly() {
+    bool monotonic;
+    int maxStep = playRamp(7000000, 123456, 25, &monotonic);
+    TEST_ASSERT_TRUE(monotonic);
+    // 10 единиц за 20 мс → 2.5 за тик 5 мс; ступенек нет
+    TEST_ASSERT_LESS_OR_EQUAL(3, maxStep);
+    TEST_ASSERT_EQUAL_UINT32(0, jb.stats.late);
+    TEST_ASSERT_TRUE(jb.stats.reordered > 0);
+    TEST_ASSERT_EQUAL_UINT32(25, jb.stats.pushed);
+}
+
+void test_ramp_across_timestamp_wrap() {
+    bool monotonic;
+    // Обе шкалы переходят через 2^32 посреди потока
+    int maxStep = playRamp(0xFFFFFFFFu - 150000, 0xFFFFFFFFu - 100000, 25, &monotonic);
+    TEST_ASSERT_TRUE(monotonic);
+    TEST_ASSERT_LESS_OR_EQUAL(3, maxStep);
+    TEST_ASSERT_EQUAL_UINT32(0, jb.stats.late);
+    TEST_ASSERT_EQUAL_UINT32(0, jb.stats.resyncs);
+}
+
+void test_late_command_is_dropped() {
+    int16_t x, y;
+    jitterPush(&jb, 100000, 100000, 10, 0);
+    jitterPush(&jb, 120000, 120000, 20, 0);
+    jitterSample(&jb, params, 120000 + params.delayUs, &x, &y);     // Проиграна вторая
+    TEST_ASSERT_FALSE(jitterPush(&jb, 110000, 125000, 15, 0));
+    TEST_ASSERT_EQUAL_UINT32(1, jb.stats.late);
+}
+
+void test_stages_after_last_command() {
+    int16_t x, y;
+    jitterPush(&jb, 0, 0, 200, -100);
+    uint32_t t0 = params.delayUs;                                    // Команда наступила
+
+    TEST_ASSERT_EQUAL(JITTER_EXTRAPOLATE, jitterSample(&jb, params, t0 + params.graceUs - 1, &x, &y));
+    TEST_ASSERT_EQUAL(JITTER_HOLD, jitterSample(&jb, params, t0 + params.graceUs, &x, &y));
+    TEST_ASSERT_EQUAL_INT16(200, x);
+    TEST_ASSERT_EQUAL(JITTER_HOLD, jitterSample(&jb, params, t0 + params.holdUs - 1, &x, &y));
+
+    // Спад: линейно от hold до hold + decay
+    TEST_ASSERT_EQUAL(JITTER_DECAY, jitterSample(&jb, params, t0 + params.holdUs + params.decayUs / 2, &x, &y));
+    TEST_ASSERT_INT_WITHIN(1, 100, x);
+    TEST_ASSERT_INT_WITHIN(1, -50, y);
+    TEST_ASSERT_EQUAL(JITTER_DECAY, jitterSample(&jb, params, t0 + params.holdUs + params.decayUs - 1000, &x, &y));
+    TEST_ASSERT_TRUE(abs(x) <= 1 && abs(y) <= 1);
+
+    // Стоп ровно один раз, дальше тишина
+    TEST_ASSERT_EQUAL(JITTER_STOP, jitterSample(&jb, params, t0 + params.holdUs + params.decayUs, &x, &y));
+    TEST_ASSERT_EQUAL(JITTER_IDLE, jitterSample(&jb, params, t0 + params.holdUs + params.decayUs + TICK_US, &x, &y));
+    TEST_ASSERT_EQUAL_UINT32(1, jb.stats.stops);
+}
+
+void test_stages_end_before_watchdog() {
+    TEST_ASSERT_TRUE(JITTER_DELAY_MS + JITTER_HOLD_MS + JITTER_DECAY_MS < CONTROL_TIMEOUT_MS);
+}
+
+void test_client_restart_resyncs() {
+    int16_t x, y;
+    jitterPush(&jb, 5000000, 100000, 50, 0);
+    jitterSample(&jb, params, 100000 + params.delayUs, &x, &y);
+    // Клиент перезапущен: его часы начались заново
+    TEST_ASSERT_TRUE(jitterPush(&jb, 1000, 200000, 80, 0));
+    TEST_ASSERT_EQUAL_UINT32(1, jb.stats.resyncs);
+    TEST_ASSERT_EQUAL_UINT32(0, jb.stats.late);
+    jitterSample(&jb, params, 200000 + params.delayUs, &x, &y);
+    TEST_ASSERT_EQUAL_INT16(80, x);
+}
+
+void test_overflow_plays_oldest_early() {
+    // Пачка больше глубины за один тик: старейшие проигрываются досрочно
+    for (int i = 0; i < JITTER_DEPTH + 3; i++) {
+        TEST_ASSERT_TRUE(jitterPush(&jb, 1000 + i * 1000, 50000, (int16_t)i, 0));
+    }
+    TEST_ASSERT_EQUAL_UINT32(3, jb.stats.overflow);
+    TEST_ASSERT_EQUAL_UINT8(JITTER_DEPTH, jb.count);
+    TEST_ASSERT_EQUAL_INT16(2, jb.last.x);
+}
+
+void test_same_stamp_replaces() {
+    jitterPush(&jb, 1000, 2000, 10, 0);
+    jitterPush(&jb, 1000, 2100, 30, 0);
+    TEST_ASSERT_EQUAL_UINT8(1, jb.count);
+    TEST_ASSERT_EQUAL_INT16(30, jb.q[0].x);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_idle_until_first_command_is_due);
+    RUN_TEST(test_jittered_ramp_plays_smoothly);
+    RUN_TEST(test_ramp_across_timestamp_wrap);
+    RUN_TEST(test_late_command_is_dropped);
+    RUN_TEST(test_stages_after_last_command);
+    RUN_TEST(test_stages_end_before_watchdog);
+    RUN_TEST(test_client_restart_resyncs);
+    RUN_TEST(test_overflow_plays_oldest_early);
+    RUN_TEST(test_same_stamp_replaces);
+    return UNITY_END();
+}
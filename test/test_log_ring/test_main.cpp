@@ -0,0 +1,149 @@
+/**
+ * ============================================================
+ * 🧪 test_log_ring — Кольцо строк лога (log_ring.h), хост
+ * ============================================================
+ *
+ * Порядок и переполнение в одном потоке, затем несколько
+ * продюсеров-потоков против одного консьюмера: каждая строка
+ * либо доходит ровно один раз и в порядке своего продюсера,
+ * либо учтена в dropped.
+ *
+ *   pio test -e native -f test_log_ring
+ *
+ * ============================================================
+ */
+
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "log_ring.h"
+
+typedef LogRing<8, 32> Ring;
+
+/** Записать строку как logWrite(): занять, заполнить, опубликовать */
+static bool put(Ring& ring, const char* text) {
+    uint32_t pos = 0;
+    Ring::Slot* slot = ring.claim(&pos);
+    if (!slot) return false;
+    slot->len = snprintf(slot->text, sizeof(slot->text), "%s", text);
+    ring.publish(slot, pos);
+    return true;
+}
+
+void setUp() {}
+void tearDown() {}
+
+// ------------------------------------------------------------
+
+void test_empty_ring_has_nothing() {
+    Ring ring;
+    TEST_ASSERT_TRUE(ring.front() == nullptr);
+    TEST_ASSERT_EQUAL_UINT32(0, ring.lines());
+}
+
+void test_fifo_order_across_wrap() {
+    Ring ring;
+    char line[16];
+    int next = 0;
+    // Несколько оборотов кольца по 5 строк
+    for (int round = 0; round < 10; round++) {
+        for (int i = 0; i < 5; i++) {
+            snprintf(line, sizeof(line), "line %d", round * 5 + i);
+            TEST_ASSERT_TRUE(put(ring, line));
+        }
+        while (const Ring::Slot* slot = ring.front()) {
+            snprintf(line, sizeof(line), "line %d", next++);
+            TEST_ASSERT_EQUAL_INT(strlen(line), slot->len);
+            TEST_ASSERT_EQUAL_INT(0, memcmp(line, slot->text, slot->len));
+            ring.pop();
+        }
+    }
+    TEST_ASSERT_EQUAL_INT(50, next);
+    TEST_ASSERT_EQUAL_UINT32(50, ring.lines());
+    TEST_ASSERT_EQUAL_UINT32(0, ring.dropped());
+}
+
+void test_full_ring_drops_without_waiting() {
+    Ring ring;
+    for (int i = 0; i < 8; i++) TEST_ASSERT_TRUE(put(ring, "x"));
+    TEST_ASSERT_FALSE(put(ring, "lost"));
+    TEST_ASSERT_FALSE(put(ring, "lost"));
+    TEST_ASSERT_EQUAL_UINT32(2, ring.dropped());
+
+    // Освободили один слот — снова пишется
+    ring.pop();
+    TEST_ASSERT_TRUE(put(ring, "y"));
+    TEST_ASSERT_EQUAL_UINT32(9, ring.lines());
+}
+
+void test_claimed_but_unpublished_blocks_consumer() {
+    Ring ring;
+    uint32_t pos = 0;
+    Ring::Slot* first = ring.claim(&pos);
+    TEST_ASSERT_TRUE(put(ring, "second"));
+    // Консьюмер не обгоняет незаконченную строку
+    TEST_ASSERT_TRUE(ring.front() == nullptr);
+    first->len = snprintf(first->text, sizeof(first->text), "first");
+    ring.publish(first, pos);
+    TEST_ASSERT_EQUAL_INT(0, memcmp("first", ring.front()->text, 5));
+    ring.pop();
+    TEST_ASSERT_EQUAL_INT(0, memcmp("second", ring.front()->text, 6));
+}
+
+void test_concurrent_producers() {
+    static Ring ring;
+    const int PRODUCERS = 4, PER = 20000;
+    std::atomic<int> running{PRODUCERS};
+    std::atomic<uint32_t> accepted{0};
+
+    std::vector<std::thread> producers;
+    for (int p = 0; p < PRODUCERS; p++) {
+        producers.emplace_back([&, p] {
+            char line[32];
+            for (int i = 0; i < PER; i++) {
+                snprintf(line, sizeof(line), "%d %d", p, i);
+                if (put(ring, line)) accepted++;
+            }
+            running--;
+        });
+    }
+
+    int last[PRODUCERS];
+    for (int p = 0; p < PRODUCERS; p++) last[p] = -1;
+    uint32_t received = 0;
+    bool ordered = true;
+    while (running.load() > 0 || ring.front()) {
+        const Ring::Slot* slot = ring.front();
+        if (!slot) continue;
+        char text[32];
+        memcpy(text, slot->text, slot->len);
+        text[slot->len] = 0;
+        ring.pop();
+        int p, i;
+        if (sscanf(text, "%d %d", &p, &i) != 2 || p < 0 || p >= PRODUCERS || i <= last[p]) {
+            ordered = false;
+        } else {
+            last[p] = i;
+        }
+        received++;
+    }
+    for (auto& t : producers) t.join();
+
+    TEST_ASSERT_TRUE(ordered);
+    TEST_ASSERT_EQUAL_UINT32(accepted.load(), received);
+    TEST_ASSERT_EQUAL_UINT32(received, ring.lines());
+    TEST_ASSERT_EQUAL_UINT32((uint32_t)(PRODUCERS * PER), received + ring.dropped());
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_empty_ring_has_nothing);
+    RUN_TEST(test_fifo_order_across_wrap);
+    RUN_TEST(test_full_ring_drops_without_waiting);
+    RUN_TEST(test_claimed_but_unpublished_blocks_consumer);
+    RUN_TEST(test_concurrent_producers);
+    return UNITY_END();
+}
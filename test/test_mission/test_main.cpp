@@ -0,0 +1,148 @@
+/**
+ * ============================================================
+ * 🧪 test_mission — Проверка байткода миссий (mission_code.h), хост
+ * ============================================================
+ *
+ * Программы собираются байтами прямо в тесте: верные (простая,
+ * вложенные циклы до MISSION_LOOP_DEPTH, бесконечный цикл с
+ * WAIT во вложенном) принимаются, а на каждое правило проверки —
+ * своя отклонённая программа с ожидаемым текстом ошибки:
+ * заголовок и размер, неизвестный опкод, обрезанная
+ * инструкция, баланс LOOP/NEXT, глубина вложенности,
+ * бесконечный цикл без WAIT, код после END и без END.
+ *
+ *   pio test -e native -f test_mission
+ *
+ * ============================================================
+ */
+
+#include <unity.h>
+#include <string.h>
+#include "config.h"
+#include "mission_code.h"
+
+#define HDR MISSION_MAGIC_0, MISSION_MAGIC_1, MISSION_VERSION, 0
+#define WAIT(ms) MOP_WAIT, (uint8_t)((ms) & 0xFF), (uint8_t)((ms) >> 8)
+
+static uint8_t buf[MISSION_PROGRAM_MAX + 1];
+static const char* err;
+
+static bool check(const uint8_t* prog, size_t len) {
+    err = "not set";
+    return missionValidate(prog, len, &err);
+}
+
+#define ACCEPT(...) do {                                              \
+        static const uint8_t p[] = {__VA_ARGS__};                     \
+        TEST_ASSERT_TRUE(check(p, sizeof(p)));                        \
+        TEST_ASSERT_NULL(err);                                        \
+    } while (0)
+
+#define REJECT(msg, ...) do {                                         \
+        static const uint8_t p[] = {__VA_ARGS__};                     \
+        TEST_ASSERT_FALSE(check(p, sizeof(p)));                       \
+        TEST_ASSERT_EQUAL_STRING(msg, err);                           \
+    } while (0)
+
+void setUp() {}
+
+void tearDown() {}
+
+// ------------------------------------------------------------
+
+void test_valid_programs() {
+    ACCEPT(HDR, MOP_END);
+    ACCEPT(HDR, MOP_SET, 1, 2, 3, 4, WAIT(500), MOP_STOP, MOP_END);
+    ACCEPT(HDR, MOP_WDOG, 0xE8, 0x03, MOP_MARK, 7,
+           MOP_RAMP, 0xF4, 0x01, 10, 20, 30, 40, MOP_END);
+    ACCEPT(HDR, MOP_LOOP, 3, MOP_SET, 0, 0, 0, 0, MOP_NEXT, MOP_END);  // Конечный цикл без WAIT
+}
+
+void test_endless_loop_with_nested_wait() {
+    // Как демо: бесконечный цикл; WAIT во вложенном засчитан внешнему
+    ACCEPT(HDR, MOP_LOOP, 0, MOP_LOOP, 2, WAIT(100), MOP_NEXT, MOP_NEXT, MOP_END);
+    ACCEPT(HDR, MOP_LOOP, 0, MOP_RAMP, 0x10, 0, 1, 1, 1, 1, MOP_NEXT, MOP_END);
+}
+
+void test_nesting_up_to_depth() {
+    static_assert(MISSION_LOOP_DEPTH == 4, "тест рассчитан на 4 уровня");
+    ACCEPT(HDR, MOP_LOOP, 2, MOP_LOOP, 2, MOP_LOOP, 2, MOP_LOOP, 2,
+           WAIT(1), MOP_NEXT, MOP_NEXT, MOP_NEXT, MOP_NEXT, MOP_END);
+    REJECT("Loops nested too deep",
+           HDR, MOP_LOOP, 2, MOP_LOOP, 2, MOP_LOOP, 2, MOP_LOOP, 2, MOP_LOOP, 2,
+           WAIT(1), MOP_NEXT, MOP_NEXT, MOP_NEXT, MOP_NEXT, MOP_NEXT, MOP_END);
+}
+
+void test_bad_size_and_header() {
+    REJECT("Bad size", HDR);                                          // Нет ни одной инструкции
+    REJECT("Bad header", 'R', 'X', MISSION_VERSION, 0, MOP_END);
+    REJECT("Bad header", MISSION_MAGIC_0, MISSION_MAGIC_1, MISSION_VERSION + 1, 0, MOP_END);
+
+    memset(buf, MOP_STOP, sizeof(buf));
+    const uint8_t hdr[] = {HDR};
+    memcpy(buf, hdr, sizeof(hdr));
+    buf[MISSION_PROGRAM_MAX - 1] = MOP_END;
+    TEST_ASSERT_TRUE(check(buf, MISSION_PROGRAM_MAX));
+    buf[MISSION_PROGRAM_MAX] = MOP_END;
+    TEST_ASSERT_FALSE(check(buf, MISSION_PROGRAM_MAX + 1));
+    TEST_ASSERT_EQUAL_STRING("Bad size", err);
+}
+
+void test_unknown_opcode() {
+    REJECT("Unknown opcode", HDR, MISSION_OP_COUNT, MOP_END);
+    REJECT("Unknown opcode", HDR, 0xFF, MOP_END);
+}
+
+void test_truncated_instruction() {
+    // Каждый опкод с операндами, обрезанный на последнем байте
+    for (uint8_t op = 0; op < MISSION_OP_COUNT; op++) {
+        if (missionOpSize[op] == 1) continue;
+        uint8_t p[MISSION_HEADER_LEN + 8] = {HDR, op};
+        TEST_ASSERT_FALSE(check(p, MISSION_HEADER_LEN + missionOpSize[op] - 1));
+        TEST_ASSERT_EQUAL_STRING("Truncated instruction", err);
+    }
+    REJECT("Truncated instruction", HDR, MOP_SET, 1, 2, 3, 4, MOP_WAIT, 0x10);
+}
+
+void test_loop_next_balance() {
+    REJECT("NEXT without LOOP", HDR, MOP_NEXT, MOP_END);
+    REJECT("NEXT without LOOP", HDR, MOP_LOOP, 2, MOP_NEXT, MOP_NEXT, MOP_END);
+    REJECT("LOOP without NEXT", HDR, MOP_LOOP, 2, WAIT(1), MOP_END);
+    REJECT("LOOP without NEXT", HDR, MOP_LOOP, 2, MOP_LOOP, 2, MOP_NEXT, MOP_END);
+}
+
+void test_endless_loop_without_wait() {
+    REJECT("Endless loop without WAIT", HDR, MOP_LOOP, 0, MOP_SET, 1, 1, 1, 1, MOP_NEXT, MOP_END);
+    REJECT("Endless loop without WAIT", HDR, MOP_LOOP, 0, MOP_NEXT, MOP_END);
+    // WAIT до цикла не считается
+    REJECT("Endless loop without WAIT", HDR, WAIT(10), MOP_LOOP, 0, MOP_STOP, MOP_NEXT, MOP_END);
+    // Бесконечный вложенный без WAIT: внешнему конечному WAIT не поможет
+    REJECT("Endless loop without WAIT",
+           HDR, MOP_LOOP, 2, WAIT(10), MOP_LOOP, 0, MOP_STOP, MOP_NEXT, MOP_NEXT, MOP_END);
+}
+
+void test_end_placement() {
+    REJECT("Missing END", HDR, MOP_STOP);
+    REJECT("Code after END", HDR, MOP_END, MOP_STOP);
+    REJECT("Code after END", HDR, MOP_END, MOP_END);
+}
+
+void test_error_pointer_optional() {
+    static const uint8_t bad[] = {HDR, MOP_NEXT, MOP_END};
+    TEST_ASSERT_FALSE(missionValidate(bad, sizeof(bad), NULL));
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_valid_programs);
+    RUN_TEST(test_endless_loop_with_nested_wait);
+    RUN_TEST(test_nesting_up_to_depth);
+    RUN_TEST(test_bad_size_and_header);
+    RUN_TEST(test_unknown_opcode);
+    RUN_TEST(test_truncated_instruction);
+    RUN_TEST(test_loop_next_balance);
+    RUN_TEST(test_endless_loop_without_wait);
+    RUN_TEST(test_end_placement);
+    RUN_TEST(test_error_pointer_optional);
+    return UNITY_END();
+}
@@ -0,0 +1,275 @@
+/**
+ * ============================================================
+ * 🧪 test_mixer — Микшер против JS (mixer.h), хост
+ * ============================================================
+ *
+ * Эталон — ControlService._applyExpo() + _remapOutput() из
+ * data/control.js (как слал клиент до переноса в прошивку) и
+ * skid-steer с точным делением при нормализации:
+ *
+ *   left = Y + X, right = Y − X
+ *   max > 255: v = trunc(v · 255 / max)
+ *   left ≥ 0 → FL, иначе RL;  right ≥ 0 → FR, иначе RR
+ *
+ * Значения ниже посчитаны node'ом по самому data/control.js.
+ * При изменении формул в JS — пересчитать (см. tools/mixer-check.js:
+ * referenceTable) и обновить.
+ *
+ * Бенчмарк — таблица + Q16 против прежнего пути (expo в double на
+ * каждую команду + нормализация во float); печатает нс/команду.
+ *
+ *   pio test -e native -f test_mixer -v
+ *
+ * ============================================================
+ */
+
+#include <unity.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include "mixer.h"
+
+// Индексы enum Motor (drive.h): RL=0, FR=1, FL=2, RR=3
+enum { RL = 0, FR, FL, RR };
+
+struct GoldenXY {
+    int16_t x, y;
+    uint8_t duty[4];        // FL, FR, RL, RR
+};
+
+struct GoldenCase {
+    MixerAxisConfig axisX, axisY;
+    GoldenXY xy[12];
+};
+
+static const GoldenCase golden[] = {
+    {{0, 0, 255}, {0, 0, 255}, {
+        {   0,  255, {255, 255,   0,   0}},
+        { 255,    0, {255,   0,   0, 255}},
+        {   0, -255, {  0,   0, 255, 255}},
+        { 128,  128, {255,   0,   0,   0}},
+        { 255,  255, {255,   0,   0,   0}},
+        {-255,  200, {  0, 255,  30,   0}},
+        { 100, -180, {  0,   0,  72, 255}},
+        {  37,   90, {127,  53,   0,   0}},
+        { -64,  -64, {  0,   0, 128,   0}},
+        { 200,  -30, {170,   0,   0, 230}},
+        {  12,  250, {255, 231,   0,   0}},
+        {-180,   45, {  0, 225, 135,   0}},
+    }},
+    {{30, 0, 255}, {50, 0, 255}, {
+        {   0,  255, {255, 255,   0,   0}},
+        { 255,    0, {255,   0,   0, 255}},
+        {   0, -255, {  0,   0, 255, 255}},
+        { 128,  128, {179,   0,   0,  19}},
+        { 255,  255, {255,   0,   0,   0}},
+        {-255,  200, {  0, 255,  56,   0}},
+        { 100, -180, {  0,   0,  60, 210}},
+        {  37,   90, { 77,  25,   0,   0}},
+        { -64,  -64, {  0,  12,  80,   0}},
+        { 200,  -30, {162,   0,   0, 192}},
+        {  12,  250, {253, 237,   0,   0}},
+        {-180,   45, {  0, 176, 130,   0}},
+    }},
+    {{-40, 0, 255}, {-100, 0, 255}, {
+        {   0,  255, {255, 255,   0,   0}},
+        { 255,    0, {255,   0,   0, 255}},
+        {   0, -255, {  0,   0, 255, 255}},
+        { 128,  128, {255,  31,   0,   0}},
+        { 255,  255, {255,   0,   0,   0}},
+        {-255,  200, {  0, 255,  10,   0}},
+        { 100, -180, {  0,   0,  64, 255}},
+        {  37,   90, {255, 103,   0,   0}},
+        { -64,  -64, {  0,   0, 255,  56}},
+        { 200,  -30, { 66,   0,   0, 255}},
+        {  12,  250, {255, 179,   0,   0}},
+        {-180,   45, {  0, 255,  41,   0}},
+    }},
+    {{25, 40, 200}, {60, 60, 255}, {
+        {   0,  255, {255, 255,   0,   0}},
+        { 255,    0, {200,   0,   0, 200}},
+        {   0, -255, {  0,   0, 255, 255}},
+        { 128,  128, {219,   9,   0,   0}},
+        { 255,  255, {255,  30,   0,   0}},
+        {-255,  200, {  0, 255,  14,   0}},
+        { 100, -180, {  0,   0,  66, 246}},
+        {  37,   90, {151,  35,   0,   0}},
+        { -64,  -64, {  0,   0, 152,  10}},
+        { 200,  -30, { 85,   0,   0, 223}},
+        {  12,  250, {255, 174,   0,   0}},
+        {-180,   45, {  0, 214,  64,   0}},
+    }},
+};
+
+// Точки таблицы оси: _remapOutput(_applyExpo(v, expo / 100), min, max)
+static const uint8_t tablePoints[] = {1, 5, 10, 32, 64, 100, 127, 128, 200, 254, 255};
+
+struct GoldenTable {
+    MixerAxisConfig cfg;
+    uint8_t out[sizeof(tablePoints)];
+};
+
+static const GoldenTable goldenTables[] = {
+    {{30, 0, 255},   {  1,   4,   7,  23,  46,  75,  98,  99, 177, 253, 255}},
+    {{-40, 0, 255},  { 17,  31,  41,  70, 103, 135, 157, 158, 214, 254, 255}},
+    {{100, 0, 255},  {  0,   0,   0,   1,   4,  15,  32,  32, 123, 252, 255}},
+    {{-100, 0, 255}, { 40,  69,  87, 128, 161, 187, 202, 203, 235, 255, 255}},
+    {{25, 40, 200},  { 41,  43,  45,  55,  71,  90, 105, 105, 154, 199, 200}},
+    {{0, 60, 255},   { 61,  64,  68,  84, 109, 136, 157, 158, 213, 254, 255}},
+};
+
+/** Оси → микшер → каналы, как applyXY() в control.cpp */
+static void mixDuty(int16_t x, int16_t y, uint8_t out[4]) {
+    int16_t l, r;
+    mixerMix(mixerShape(MIXER_AXIS_X, x), mixerShape(MIXER_AXIS_Y, y), &l, &r);
+    uint8_t speed[4] = {};
+    if (l >= 0) speed[FL] = (uint8_t)l; else speed[RL] = (uint8_t)(-l);
+    if (r >= 0) speed[FR] = (uint8_t)r; else speed[RR] = (uint8_t)(-r);
+    out[0] = speed[FL];
+    out[1] = speed[FR];
+    out[2] = speed[RL];
+    out[3] = speed[RR];
+}
+
+void setUp() {
+    mixerSetAxis(MIXER_AXIS_X, {0, 0, 255});
+    mixerSetAxis(MIXER_AXIS_Y, {0, 0, 255});
+}
+
+void tearDown() {}
+
+// ------------------------------------------------------------
+
+void test_default_tables_are_linear() {
+    mixerInit();
+    const uint8_t* t = mixerGetTable(MIXER_AXIS_X);
+    for (int v = 0; v < MIXER_TABLE_SIZE; v++) TEST_ASSERT_EQUAL_UINT8(v, t[v]);
+}
+
+void test_tables_match_js() {
+    for (const GoldenTable& g : goldenTables) {
+        TEST_ASSERT_TRUE(mixerSetAxis(MIXER_AXIS_Y, g.cfg));
+        const uint8_t* t = mixerGetTable(MIXER_AXIS_Y);
+        TEST_ASSERT_EQUAL_UINT8(0, t[0]);
+        for (size_t i = 0; i < sizeof(tablePoints); i++) {
+            char msg[64];
+            snprintf(msg, sizeof(msg), "expo %d min %u max %u v %u",
+                     g.cfg.expo, g.cfg.outMin, g.cfg.outMax, tablePoints[i]);
+            TEST_ASSERT_EQUAL_INT_MESSAGE(g.out[i], t[tablePoints[i]], msg);
+        }
+    }
+}
+
+void test_shape_keeps_sign() {
+    mixerSetAxis(MIXER_AXIS_X, {30, 0, 255});
+    for (int v = 1; v <= 255; v++) {
+        TEST_ASSERT_EQUAL_INT16(-mixerShape(MIXER_AXIS_X, v), mixerShape(MIXER_AXIS_X, -v));
+    }
+    TEST_ASSERT_EQUAL_INT16(mixerShape(MIXER_AXIS_X, 255), mixerShape(MIXER_AXIS_X, 400));
+}
+
+void test_duty_vectors_match_js() {
+    for (const GoldenCase& g : golden) {
+        TEST_ASSERT_TRUE(mixerSetAxis(MIXER_AXIS_X, g.axisX));
+        TEST_ASSERT_TRUE(mixerSetAxis(MIXER_AXIS_Y, g.axisY));
+        for (const GoldenXY& c : g.xy) {
+            uint8_t duty[4];
+            mixDuty(c.x, c.y, duty);
+            for (int i = 0; i < 4; i++) {
+                char msg[96];
+                snprintf(msg, sizeof(msg), "X expo %d, Y expo %d, (%d, %d) канал %d",
+                         g.axisX.expo, g.axisY.expo, c.x, c.y, i);
+                TEST_ASSERT_EQUAL_INT_MESSAGE(c.duty[i], duty[i], msg);
+            }
+        }
+    }
+}
+
+void test_mix_normalization_exact() {
+    // Q16 с округлением k вверх = точное trunc(v · 255 / max) на всей сетке
+    for (int y = -255; y <= 255; y += 3) {
+        for (int x = -255; x <= 255; x += 3) {
+            int16_t l, r;
+            mixerMix(x, y, &l, &r);
+            int32_t el = y + x, er = y - x;
+            int32_t m = abs(el) > abs(er) ? abs(el) : abs(er);
+            if (m > 255) {
+                el = el * 255 / m;                 // Деление C — к нулю, как Math.trunc
+                er = er * 255 / m;
+            }
+            TEST_ASSERT_EQUAL_INT16(el, l);
+            TEST_ASSERT_EQUAL_INT16(er, r);
+        }
+    }
+}
+
+void test_rejects_bad_config() {
+    TEST_ASSERT_FALSE(mixerSetAxis(MIXER_AXIS_X, {0, 200, 100}));
+    TEST_ASSERT_FALSE(mixerSetAxis(MIXER_AXIS_X, {101, 0, 255}));
+    TEST_ASSERT_FALSE(mixerSetAxis(MIXER_AXIS_COUNT, {0, 0, 255}));
+}
+
+// --- Бенчмарк ---
+
+/** Прежний путь: expo/ремап в double на команду + float-нормализация */
+static void legacyMix(int16_t x, int16_t y, double ex, double ey, int16_t* l, int16_t* r) {
+    auto shape = [](int16_t v, double expo) -> int16_t {
+        double n = v / 255.0, a = fabs(expo);
+        double e = expo > 0 ? (1 - a) * n + a * n * n * n
+                            : (1 - a) * n + a * (n < 0 ? -cbrt(-n) : cbrt(n));
+        return (int16_t)lround(e * 255);
+    };
+    int16_t sx = shape(x, ex), sy = shape(y, ey);
+    int16_t left = sy + sx, right = sy - sx;
+    int16_t m = abs(left) > abs(right) ? abs(left) : abs(right);
+    if (m > 255) {
+        float scale = 255.0f / m;
+        left = (int16_t)(left * scale);
+        right = (int16_t)(right * scale);
+    }
+    *l = left;
+    *r = right;
+}
+
+void test_benchmark() {
+    mixerSetAxis(MIXER_AXIS_X, {30, 0, 255});
+    mixerSetAxis(MIXER_AXIS_Y, {-40, 0, 255});
+    const int N = 2000000;
+    volatile int32_t sink = 0;
+
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < N; i++) {
+        int16_t l, r;
+        mixerMix(mixerShape(MIXER_AXIS_X, (i * 7) % 511 - 255),
+                 mixerShape(MIXER_AXIS_Y, (i * 13) % 511 - 255), &l, &r);
+        sink = sink + l - r;
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    for (int i = 0; i < N; i++) {
+        int16_t l, r;
+        legacyMix((i * 7) % 511 - 255, (i * 13) % 511 - 255, 0.3, -0.4, &l, &r);
+        sink = sink + l - r;
+    }
+    auto t2 = std::chrono::steady_clock::now();
+
+    double tableNs = std::chrono::duration<double, std::nano>(t1 - t0).count() / N;
+    double legacyNs = std::chrono::duration<double, std::nano>(t2 - t1).count() / N;
+    char msg[96];
+    snprintf(msg, sizeof(msg), "таблица + Q16: %.1f нс/команду, double + float: %.1f нс/команду",
+             tableNs, legacyNs);
+    TEST_MESSAGE(msg);
+    (void)sink;
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_default_tables_are_linear);
+    RUN_TEST(test_tables_match_js);
+    RUN_TEST(test_shape_keeps_sign);
+    RUN_TEST(test_duty_vectors_match_js);
+    RUN_TEST(test_mix_normalization_exact);
+    RUN_TEST(test_rejects_bad_config);
+    RUN_TEST(test_benchmark);
+    return UNITY_END();
+}
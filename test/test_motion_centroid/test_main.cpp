@@ -0,0 +1,164 @@
+/**
+ * ============================================================
+ * 🧪 test_motion_centroid — Центр движущейся области (motion_centroid.h), хост
+ * ============================================================
+ *
+ * Синтетические яркости 80×60 (кадр режима «следование») с
+ * параметрами FOLLOW_* из config.h: центр одиночного пятна,
+ * выбор крупнейшей из двух областей, 8-связность, движение
+ * всего кадра, сдвиг экспозиции, шум меньше minArea. Кадр,
+ * целиком ставший одной областью, проверяет, что стеку w × h
+ * хватает.
+ *
+ *   pio test -e native -f test_motion_centroid
+ *
+ * ============================================================
+ */
+
+#include <unity.h>
+#include <string.h>
+#include "config.h"
+#include "motion_centroid.h"
+
+static const uint16_t W = 80, H = 60;
+static const uint32_t N = W * H;
+static const MotionParams params = {
+    FOLLOW_PIXEL_DELTA,
+    FOLLOW_MIN_AREA,
+    FOLLOW_MAX_AREA_PCT
+};
+
+static uint8_t  prev[N], cur[N], mask[N];
+static uint16_t stack[N + 1];                     // +1 — контрольное слово за концом
+static MotionResult res;
+
+static const uint16_t CANARY = 0xA5A5;
+
+static void rect(uint8_t* buf, uint16_t x0, uint16_t y0, uint16_t w, uint16_t h, uint8_t l) {
+    for (uint16_t y = y0; y < y0 + h && y < H; y++) {
+        for (uint16_t x = x0; x < x0 + w && x < W; x++) buf[y * W + x] = l;
+    }
+}
+
+static bool run(const MotionParams& p) {
+    return motionCentroid(cur, prev, W, H, p, mask, stack, &res);
+}
+
+void setUp() {
+    memset(prev, 100, sizeof(prev));
+    memset(cur, 100, sizeof(cur));
+    stack[N] = CANARY;
+}
+
+void tearDown() {
+    TEST_ASSERT_EQUAL_UINT16(CANARY, stack[N]);
+}
+
+// ------------------------------------------------------------
+
+void test_static_frame_finds_nothing() {
+    TEST_ASSERT_FALSE(run(params));
+    TEST_ASSERT_FALSE(res.global);
+    TEST_ASSERT_EQUAL_UINT16(0, res.moving);
+    TEST_ASSERT_EQUAL_UINT8(0, res.regions);
+}
+
+void test_single_blob_centroid() {
+    // Справа сверху: x 60..69, y 10..19
+    rect(cur, 60, 10, 10, 10, 200);
+    TEST_ASSERT_TRUE(run(params));
+    TEST_ASSERT_EQUAL_UINT16(100, res.area);
+    TEST_ASSERT_EQUAL_UINT8(1, res.regions);
+    TEST_ASSERT_EQUAL_INT16(160, res.cx);                          // (64.5 − 39.5) / 40
+    TEST_ASSERT_EQUAL_INT16(-128, res.cy);                         // (14.5 − 29.5) / 30
+}
+
+void test_centered_blob_is_zero() {
+    rect(cur, 35, 25, 10, 10, 20);
+    TEST_ASSERT_TRUE(run(params));
+    TEST_ASSERT_EQUAL_INT16(0, res.cx);
+    TEST_ASSERT_EQUAL_INT16(0, res.cy);
+}
+
+void test_largest_of_two_regions_wins() {
+    rect(cur, 2, 40, 4, 4, 200);                                   // Мелкая слева снизу
+    rect(cur, 60, 10, 10, 10, 200);                                // Крупная справа сверху
+    TEST_ASSERT_TRUE(run(params));
+    TEST_ASSERT_EQUAL_UINT8(2, res.regions);
+    TEST_ASSERT_EQUAL_UINT16(116, res.moving);
+    TEST_ASSERT_EQUAL_UINT16(100, res.area);
+    TEST_ASSERT_EQUAL_INT16(160, res.cx);
+}
+
+void test_diagonal_is_one_region() {
+    // Пиксели касаются только углами — одна область при 8-связности
+    for (uint16_t i = 0; i < 14; i++) cur[(10 + i) * W + 10 + i] = 220;
+    TEST_ASSERT_TRUE(run(params));
+    TEST_ASSERT_EQUAL_UINT8(1, res.regions);
+    TEST_ASSERT_EQUAL_UINT16(14, res.area);
+}
+
+void test_whole_frame_motion_is_global() {
+    // Поворот ровера: меняется почти весь кадр
+    for (uint32_t i = 0; i < N; i++) {
+        prev[i] = (i % W) % 8 < 4 ? 60 : 160;
+        cur[i] = ((i % W) + 3) % 8 < 4 ? 60 : 160;
+    }
+    TEST_ASSERT_FALSE(run(params));
+    TEST_ASSERT_TRUE(res.global);
+    TEST_ASSERT_EQUAL_UINT8(0, res.regions);
+}
+
+void test_exposure_shift_is_ignored() {
+    for (uint32_t i = 0; i < N; i++) {
+        prev[i] = 40 + (i * 37) % 120;                             // Текстура
+        cur[i] = prev[i] + 50;                                     // Автоэкспозиция
+    }
+    TEST_ASSERT_FALSE(run(params));
+    TEST_ASSERT_FALSE(res.global);
+    TEST_ASSERT_EQUAL_UINT16(0, res.moving);
+}
+
+void test_small_region_is_noise() {
+    rect(cur, 30, 30, 3, 3, 200);                                  // 9 < FOLLOW_MIN_AREA
+    TEST_ASSERT_FALSE(run(params));
+    TEST_ASSERT_FALSE(res.global);
+    TEST_ASSERT_EQUAL_UINT8(1, res.regions);
+    TEST_ASSERT_EQUAL_UINT16(9, res.area);
+}
+
+void test_full_frame_region_fits_stack() {
+    // Шахматка вокруг прежнего уровня: сдвиг 0, движется каждый
+    // пиксель, всё — одна область по диагоналям
+    for (uint32_t i = 0; i < N; i++) cur[i] = ((i % W) + (i / W)) % 2 ? 200 : 0;
+    MotionParams all = params;
+    all.maxAreaPct = 100;
+    TEST_ASSERT_TRUE(run(all));
+    TEST_ASSERT_EQUAL_UINT8(1, res.regions);
+    TEST_ASSERT_EQUAL_UINT16(N, res.area);
+    TEST_ASSERT_EQUAL_INT16(0, res.cx);
+    TEST_ASSERT_EQUAL_INT16(0, res.cy);
+}
+
+void test_luma_rgb565() {
+    uint8_t rgb[4] = {0xFF, 0xFF, 0x00, 0x00};
+    uint8_t luma[2];
+    motionLumaRgb565(rgb, 2, 1, luma);
+    TEST_ASSERT_EQUAL_UINT8(250, luma[0]);
+    TEST_ASSERT_EQUAL_UINT8(0, luma[1]);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_static_frame_finds_nothing);
+    RUN_TEST(test_single_blob_centroid);
+    RUN_TEST(test_centered_blob_is_zero);
+    RUN_TEST(test_largest_of_two_regions_wins);
+    RUN_TEST(test_diagonal_is_one_region);
+    RUN_TEST(test_whole_frame_motion_is_global);
+    RUN_TEST(test_exposure_shift_is_ignored);
+    RUN_TEST(test_small_region_is_noise);
+    RUN_TEST(test_full_frame_region_fits_stack);
+    RUN_TEST(test_luma_rgb565);
+    return UNITY_END();
+}
@@ -0,0 +1,208 @@
+/**
+ * ============================================================
+ * 🧪 test_ramp — Форма рампы (ramp.h), хост
+ * ============================================================
+ *
+ * Шагаем ограничитель с периодом задачи управления и проверяем
+ * форму выхода: скорость не выше rateUp/rateDown, изменение
+ * скорости не больше jerk·dt, без перелёта цели, время выхода
+ * на цель; участки на fade — удержание и прерывание новой целью.
+ *
+ *   pio test -e native -f test_ramp
+ *
+ * ============================================================
+ */
+
+#include <unity.h>
+#include <math.h>
+#include "ramp.h"
+
+static const uint32_t TICK_US = 5000;           // 200 Гц, как CONTROL_RATE_HZ
+static const float    DT = TICK_US * 1e-6f;
+
+static RampChannel ch;
+static uint8_t  segDuty;
+static uint32_t segMs;
+
+void setUp() {
+    rampReset(&ch, 0);
+    segDuty = 0;
+    segMs = 0;
+}
+
+void tearDown() {}
+
+/** Шаг без fade */
+static RampAction step(RampProfileId id, uint8_t target) {
+    return rampStep(&ch, rampGetProfile(id), target, TICK_US, 0, &segDuty, &segMs);
+}
+
+/**
+ * Довести канал до цели программно, проверяя ограничения профиля.
+ * @return Тиков до выхода на цель
+ */
+static int runTo(RampProfileId id, uint8_t target, int maxTicks) {
+    const RampProfile& p = rampGetProfile(id);
+    float start = ch.pos;
+    float dir = target > start ? 1.0f : -1.0f;
+    float prevPos = ch.pos, prevVel = 0.0f;
+    for (int t = 1; t <= maxTicks; t++) {
+        TEST_ASSERT_EQUAL(RAMP_SOFTWARE, step(id, target));
+        float v = (ch.pos - prevPos) / DT;
+        // Монотонно, без перелёта
+        TEST_ASSERT_TRUE((ch.pos - prevPos) * dir >= 0.0f);
+        TEST_ASSERT_TRUE((target - ch.pos) * dir >= -1e-3f);
+        // Скорость — не выше rate профиля
+        float rate = dir > 0 ? p.rateUp : p.rateDown;
+        TEST_ASSERT_FLOAT_WITHIN(rate * 0.01f + 1e-3f, 0.0f, fmaxf(0.0f, fabsf(v) - rate));
+        // Рывок: скорость растёт не быстрее jerk·dt (кроме последнего шага — «прилипание» к цели)
+        if (p.jerk > 0.0f && ch.pos != target) {
+            TEST_ASSERT_TRUE(fabsf(v) - fabsf(prevVel) <= p.jerk * DT * 1.01f + 1e-3f);
+        }
+        if (ch.pos == target) return t;
+        prevPos = ch.pos;
+        prevVel = v;
+    }
+    TEST_FAIL_MESSAGE("цель не достигнута");
+    return -1;
+}
+
+// ------------------------------------------------------------
+
+void test_off_jumps_to_target() {
+    TEST_ASSERT_EQUAL(RAMP_SOFTWARE, step(RAMP_OFF, 200));
+    TEST_ASSERT_EQUAL_UINT8(200, rampDuty(&ch));
+    TEST_ASSERT_EQUAL(RAMP_SOFTWARE, step(RAMP_OFF, 0));
+    TEST_ASSERT_EQUAL_UINT8(0, rampDuty(&ch));
+}
+
+void test_sport_is_linear() {
+    // rateUp 2500 ед./с → 12.5 ед. за тик, 0→255 за ⌈255 / 12.5⌉ = 21 тик
+    int ticks = runTo(RAMP_SPORT, 255, 100);
+    TEST_ASSERT_EQUAL_INT(21, ticks);
+
+    rampReset(&ch, 0);
+    step(RAMP_SPORT, 255);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 12.5f, ch.pos);
+    step(RAMP_SPORT, 255);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 25.0f, ch.pos);
+}
+
+void test_soft_and_normal_are_s_curves() {
+    // S-кривая: первые шаги медленнее линейной рампы с тем же rate
+    step(RAMP_NORMAL, 255);
+    TEST_ASSERT_TRUE(ch.pos < rampGetProfile(RAMP_NORMAL).rateUp * DT);
+    TEST_ASSERT_TRUE(ch.pos > 0.0f);
+
+    rampReset(&ch, 0);
+    int normal = runTo(RAMP_NORMAL, 255, 400);
+    rampReset(&ch, 0);
+    int soft = runTo(RAMP_SOFT, 255, 400);
+    rampReset(&ch, 0);
+    int sport = runTo(RAMP_SPORT, 255, 400);
+
+    // Порядок профилей и документированные времена (ramp.cpp): ≈0.8 / 0.35 / 0.1 с
+    TEST_ASSERT_TRUE(sport < normal && normal < soft);
+    TEST_ASSERT_INT_WITHIN(12, 70, normal);    // 0.35 с ± 60 мс
+    TEST_ASSERT_INT_WITHIN(20, 165, soft);     // 0.8 с ± 100 мс
+}
+
+void test_rate_down_faster_than_up() {
+    int up = runTo(RAMP_NORMAL, 255, 400);
+    int down = runTo(RAMP_NORMAL, 0, 400);
+    TEST_ASSERT_TRUE(down < up);
+}
+
+void test_no_overshoot_on_small_step() {
+    runTo(RAMP_SOFT, 10, 400);
+    TEST_ASSERT_EQUAL_UINT8(10, rampDuty(&ch));
+    TEST_ASSERT_FLOAT_WITHIN(0.0f, 0.0f, ch.vel);
+}
+
+void test_linear_segment_goes_to_fade() {
+    const RampProfile& p = rampGetProfile(RAMP_SPORT);
+    RampAction a = rampStep(&ch, p, 255, TICK_US, 40000, &segDuty, &segMs);
+    TEST_ASSERT_EQUAL(RAMP_FADE_START, a);
+    TEST_ASSERT_EQUAL_UINT32(40, segMs);
+    // Конец участка — та же прямая: 12.5 + 2500 × 0.04 = 112.5
+    TEST_ASSERT_INT_WITHIN(1, 112, segDuty);
+
+    // Удержание: модель досчитывает прямую, выход не трогаем
+    for (int t = 0; t < 7; t++) {
+        TEST_ASSERT_EQUAL(RAMP_FADE_HOLD, rampStep(&ch, p, 255, TICK_US, 40000, &segDuty, &segMs));
+    }
+    TEST_ASSERT_FLOAT_WITHIN(0.1f, 12.5f + 2500.0f * 0.035f, ch.pos);
+    TEST_ASSERT_EQUAL(RAMP_FADE_HOLD, rampStep(&ch, p, 255, TICK_US, 40000, &segDuty, &segMs));
+    TEST_ASSERT_FLOAT_WITHIN(0.1f, 112.5f, ch.pos);
+    TEST_ASSERT_EQUAL_UINT32(0, ch.holdUs);
+}
+
+void test_fade_keeps_target_beyond_segment() {
+    const RampProfile& p = rampGetProfile(RAMP_SPORT);
+    rampStep(&ch, p, 255, TICK_US, 40000, &segDuty, &segMs);
+    // Новая цель дальше конца участка в ту же сторону — участок доигрывается
+    TEST_ASSERT_EQUAL(RAMP_FADE_HOLD, rampStep(&ch, p, 200, TICK_US, 40000, &segDuty, &segMs));
+}
+
+void test_stop_aborts_fade() {
+    const RampProfile& p = rampGetProfile(RAMP_SPORT);
+    rampStep(&ch, p, 255, TICK_US, 40000, &segDuty, &segMs);
+    rampStep(&ch, p, 255, TICK_US, 40000, &segDuty, &segMs);
+    float before = ch.pos;
+
+    // Стоп посреди участка: прерывание на этом же тике, выход уже вниз
+    TEST_ASSERT_EQUAL(RAMP_FADE_ABORT, rampStep(&ch, p, 0, TICK_US, 40000, &segDuty, &segMs));
+    TEST_ASSERT_EQUAL_UINT32(0, ch.holdUs);
+    TEST_ASSERT_TRUE(ch.pos < before);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, before - p.rateDown * DT, ch.pos);
+
+    // Дальше — обычная рампа вниз (в т.ч. на fade), до нуля за ⌈25 / 20⌉ тика
+    int t = 0;
+    while (ch.pos > 0.0f && t < 20) {
+        RampAction a = rampStep(&ch, p, 0, TICK_US, 40000, &segDuty, &segMs);
+        TEST_ASSERT_TRUE(a != RAMP_FADE_ABORT);
+        t++;
+    }
+    TEST_ASSERT_EQUAL_UINT8(0, rampDuty(&ch));
+    TEST_ASSERT_LESS_OR_EQUAL(2, t);
+}
+
+void test_lower_target_inside_segment_aborts_fade() {
+    const RampProfile& p = rampGetProfile(RAMP_SPORT);
+    rampStep(&ch, p, 255, TICK_US, 40000, &segDuty, &segMs);
+    // Цель между текущей точкой и концом участка — fade проскочил бы её
+    TEST_ASSERT_EQUAL(RAMP_FADE_ABORT, rampStep(&ch, p, 30, TICK_US, 40000, &segDuty, &segMs));
+    runTo(RAMP_SPORT, 30, 20);
+    TEST_ASSERT_EQUAL_UINT8(30, rampDuty(&ch));
+}
+
+void test_fade_down_continues_on_stop() {
+    const RampProfile& p = rampGetProfile(RAMP_SPORT);
+    rampReset(&ch, 255);
+    TEST_ASSERT_EQUAL(RAMP_FADE_START, rampStep(&ch, p, 0, TICK_US, 40000, &segDuty, &segMs));
+    // Уже едем вниз со скоростью rateDown — стоп не прерывает участок
+    TEST_ASSERT_EQUAL(RAMP_FADE_HOLD, rampStep(&ch, p, 0, TICK_US, 40000, &segDuty, &segMs));
+}
+
+void test_profile_by_name() {
+    RampProfileId id;
+    TEST_ASSERT_TRUE(rampProfileByName("soft", &id));
+    TEST_ASSERT_EQUAL(RAMP_SOFT, id);
+    TEST_ASSERT_FALSE(rampProfileByName("turbo", &id));
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_off_jumps_to_target);
+    RUN_TEST(test_sport_is_linear);
+    RUN_TEST(test_soft_and_normal_are_s_curves);
+    RUN_TEST(test_rate_down_faster_than_up);
+    RUN_TEST(test_no_overshoot_on_small_step);
+    RUN_TEST(test_linear_segment_goes_to_fade);
+    RUN_TEST(test_fade_keeps_target_beyond_segment);
+    RUN_TEST(test_stop_aborts_fade);
+    RUN_TEST(test_lower_target_inside_segment_aborts_fade);
+    RUN_TEST(test_fade_down_continues_on_stop);
+    RUN_TEST(test_profile_by_name);
+    return UNITY_END();
+}
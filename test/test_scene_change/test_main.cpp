@@ -0,0 +1,184 @@
+/**
+ * ============================================================
+ * 🧪 test_scene_change — Детектор смены сцены (scene_change.h), хост
+ * ============================================================
+ *
+ * Синтетические кадры RGB565 80×60 (VGA / 8, как у задачи Vision)
+ * с параметрами SCENE_* из config.h: «текущий» пол (полосы,
+ * сдвигающиеся каждый кадр) и вспышки экспозиции не срабатывают,
+ * объект, вошедший в нижнюю часть поля зрения, — срабатывает.
+ * Плюс сетка яркостей, фон и разрыв между кадрами.
+ *
+ *   pio test -e native -f test_scene_change
+ *
+ * ============================================================
+ */
+
+#include <unity.h>
+#include <string.h>
+#include "config.h"
+#include "scene_change.h"
+
+static const uint16_t W = 80, H = 60;
+static const uint32_t FRAME_US = 100000;         // 10 кадр/с
+static const SceneParams params = {
+    SCENE_BLOCK_DELTA,
+    SCENE_TRIGGER_PCT,
+    SCENE_SPIKE_RATIO_Q4,
+    (uint32_t)SCENE_MAX_GAP_MS * 1000
+};
+
+static uint8_t rgb[W * H * 2];
+static uint8_t grid[SCENE_GRID];
+static SceneDetector det;
+
+/** Серый пиксель RGB565 (старший байт первым) яркости ≈ l */
+static void put(uint16_t x, uint16_t y, uint8_t l) {
+    uint16_t v = ((l >> 3) << 11) | ((l >> 2) << 5) | (l >> 3);
+    rgb[(y * W + x) * 2] = v >> 8;
+    rgb[(y * W + x) * 2 + 1] = v & 0xFF;
+}
+
+/** Пол: горизонтальные полосы периода 8 строк, сдвиг phase строк */
+static void floorFrame(int phase, int exposure) {
+    for (uint16_t y = 0; y < H; y++) {
+        uint8_t base = ((y + phase) / 4) % 2 ? 110 : 70;
+        for (uint16_t x = 0; x < W; x++) put(x, y, base + exposure);
+    }
+}
+
+/** Тёмный объект в нижней части кадра */
+static void object(uint16_t x0, uint16_t y0, uint16_t w, uint16_t h) {
+    for (uint16_t y = y0; y < y0 + h && y < H; y++) {
+        for (uint16_t x = x0; x < x0 + w && x < W; x++) put(x, y, 10);
+    }
+}
+
+static bool feed(uint32_t nowUs) {
+    sceneGridRgb565(rgb, W, H, SCENE_ROI_PCT, grid);
+    return sceneUpdate(&det, params, grid, nowUs);
+}
+
+void setUp() {
+    sceneReset(&det);
+}
+
+void tearDown() {}
+
+// ------------------------------------------------------------
+
+void test_luma() {
+    uint8_t white[2] = {0xFF, 0xFF}, black[2] = {0, 0}, green[2] = {0x07, 0xE0};
+    TEST_ASSERT_EQUAL_UINT8(250, rgb565Luma(white));
+    TEST_ASSERT_EQUAL_UINT8(0, rgb565Luma(black));
+    TEST_ASSERT_EQUAL_UINT8(157, rgb565Luma(green));               // 5·252/8
+}
+
+void test_grid_covers_bottom_roi() {
+    // Верх кадра яркий, нижняя половина: левая часть тёмная, правая светлая
+    for (uint16_t y = 0; y < H; y++) {
+        for (uint16_t x = 0; x < W; x++) {
+            put(x, y, y < H / 2 ? 240 : (x < W / 2 ? 40 : 160));
+        }
+    }
+    sceneGridRgb565(rgb, W, H, 50, grid);
+    for (int gy = 0; gy < SCENE_GRID_H; gy++) {
+        for (int gx = 0; gx < SCENE_GRID_W; gx++) {
+            uint8_t v = grid[gy * SCENE_GRID_W + gx];
+            TEST_ASSERT_INT_WITHIN(4, gx < SCENE_GRID_W / 2 ? 40 : 160, v);
+        }
+    }
+}
+
+void test_first_frame_and_gap_only_store() {
+    floorFrame(0, 0);
+    TEST_ASSERT_FALSE(feed(0));
+    TEST_ASSERT_EQUAL_UINT32(0, det.frames);
+
+    // После долгого разрыва — сравнения нет, даже если сцена другая
+    object(0, 30, 80, 30);
+    TEST_ASSERT_FALSE(feed(params.maxGapUs + 1));
+    TEST_ASSERT_EQUAL_UINT32(0, det.frames);
+    TEST_ASSERT_EQUAL_UINT8(0, det.lastScore);
+}
+
+void test_flowing_floor_and_exposure_do_not_trigger() {
+    uint32_t t = 0;
+    for (int f = 0; f < 200; f++, t += FRAME_US) {
+        int exposure = (f % 10 == 5) ? 60 : 0;                      // Вспышка раз в секунду
+        floorFrame(f * 3, exposure);
+        TEST_ASSERT_FALSE(feed(t));
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, det.triggers);
+    TEST_ASSERT_EQUAL_UINT32(199, det.frames);
+}
+
+void test_object_entering_triggers() {
+    uint32_t t = 0;
+    for (int f = 0; f < 30; f++, t += FRAME_US) {
+        floorFrame(f * 3, 0);
+        feed(t);
+    }
+    // Объект входит снизу посередине — половина ширины, вся полоса ROI
+    floorFrame(30 * 3, 0);
+    object(20, 30, 40, 30);
+    TEST_ASSERT_TRUE(feed(t));
+    TEST_ASSERT_EQUAL_UINT32(1, det.triggers);
+    TEST_ASSERT_TRUE(det.lastScore >= SCENE_TRIGGER_PCT);
+}
+
+void test_object_above_roi_ignored() {
+    uint32_t t = 0;
+    for (int f = 0; f < 10; f++, t += FRAME_US) {
+        floorFrame(0, 0);
+        feed(t);
+    }
+    // Вдали (верх кадра) — не наша забота
+    floorFrame(0, 0);
+    object(0, 0, 80, 28);
+    TEST_ASSERT_FALSE(feed(t));
+    TEST_ASSERT_EQUAL_UINT8(0, det.lastScore);
+}
+
+/** Сетка: первые n блоков отклонены на ±d через один (общий сдвиг 0) */
+static void spreadGrid(uint8_t* g, int n, int d) {
+    for (int i = 0; i < SCENE_GRID; i++) g[i] = i < n ? (i % 2 ? 100 + d : 100 - d) : 100;
+}
+
+void test_busy_baseline_needs_bigger_spike() {
+    // Сетки напрямую: четверть блоков мигает каждый кадр — фон ≈ 25 %,
+    // последний кадр — спокойный
+    uint8_t g[SCENE_GRID];
+    uint32_t t = 0;
+    for (int f = 0; f < 60; f++, t += FRAME_US) {
+        spreadGrid(g, SCENE_GRID / 4, f % 2 ? 0 : 40);
+        sceneUpdate(&det, params, g, t);
+    }
+    TEST_ASSERT_INT_WITHIN(2 << 4, 25 << 4, det.baselineQ4);
+
+    // Половина блоков — выше порога 40 %, но не в 2.5 раза выше фона
+    spreadGrid(g, SCENE_GRID / 2, 50);
+    TEST_ASSERT_FALSE(sceneUpdate(&det, params, g, t));
+    TEST_ASSERT_EQUAL_UINT8(50, det.lastScore);
+    TEST_ASSERT_EQUAL_UINT32(0, det.triggers);
+
+    // Тот же скачок на спокойном фоне — срабатывание
+    sceneReset(&det);
+    spreadGrid(g, 0, 0);
+    sceneUpdate(&det, params, g, 0);
+    sceneUpdate(&det, params, g, FRAME_US);
+    spreadGrid(g, SCENE_GRID / 2, 50);
+    TEST_ASSERT_TRUE(sceneUpdate(&det, params, g, 2 * FRAME_US));
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_luma);
+    RUN_TEST(test_grid_covers_bottom_roi);
+    RUN_TEST(test_first_frame_and_gap_only_store);
+    RUN_TEST(test_flowing_floor_and_exposure_do_not_trigger);
+    RUN_TEST(test_object_entering_triggers);
+    RUN_TEST(test_object_above_roi_ignored);
+    RUN_TEST(test_busy_baseline_needs_bigger_spike);
+    return UNITY_END();
+}
@@ -0,0 +1,153 @@
+/**
+ * ============================================================
+ * 🧪 test_seqlock — Seqlock<T> (seqlock.h), хост
+ * ============================================================
+ *
+ * Писатели в отдельных потоках (на хосте сериализуются
+ * std::mutex), читатели крутят read() параллельно: ни одна
+ * копия не «порвана», номер публикации совпадает с содержимым
+ * и у каждого читателя не убывает. Два писателя со своими
+ * частями значения не затирают друг друга.
+ *
+ *   pio test -e native -f test_seqlock
+ *
+ * ============================================================
+ */
+
+#include <unity.h>
+#include <stdio.h>
+#include <atomic>
+#include <thread>
+#include "seqlock.h"
+
+static const int WORDS = 32;          // Копия заметно дольше одного слова
+static const int READERS = 3;
+static const uint32_t WRITES = 100000;
+
+struct Value {
+    uint32_t a[WORDS];                // Все слова = номер записи
+};
+
+struct Parts {
+    uint32_t left[WORDS / 2];         // Писатель L
+    uint32_t right[WORDS / 2];        // Писатель R
+};
+
+void setUp() {}
+
+void tearDown() {}
+
+// ------------------------------------------------------------
+
+void test_initial_value_and_version() {
+    Seqlock<Value> sl;
+    Value v;
+    TEST_ASSERT_EQUAL_UINT32(0, sl.read(&v));
+    TEST_ASSERT_EQUAL_UINT32(0, v.a[0]);
+    sl.write([](Value& x) { x.a[0] = 7; });
+    TEST_ASSERT_EQUAL_UINT32(1, sl.version());
+    TEST_ASSERT_EQUAL_UINT32(1, sl.read(&v));
+    TEST_ASSERT_EQUAL_UINT32(7, v.a[0]);
+}
+
+void test_readers_never_see_torn_value() {
+    static Seqlock<Value> sl;
+    std::atomic<bool> done(false);
+    std::atomic<uint32_t> torn(0), mismatched(0), backwards(0), reads(0), midway(0);
+    std::atomic<int> ready(0);
+
+    std::thread writer([&] {
+        while (ready.load() < READERS) {}                  // Все читатели уже крутятся
+        for (uint32_t k = 1; k <= WRITES; k++) {
+            sl.write([k](Value& x) {
+                for (int i = 0; i < WORDS; i++) x.a[i] = k;
+            });
+            if (k % 4096 == 0) std::this_thread::yield();   // Перемешать и на одном ядре
+        }
+        done.store(true);
+    });
+
+    std::thread readers[READERS];
+    for (int r = 0; r < READERS; r++) {
+        readers[r] = std::thread([&] {
+            uint32_t last = 0, n = 0, mid = 0;
+            Value v;
+            ready++;
+            while (!done.load()) {
+                uint32_t ver = sl.read(&v);
+                for (int i = 1; i < WORDS; i++) {
+                    if (v.a[i] != v.a[0]) { torn++; break; }
+                }
+                if (v.a[0] != ver) mismatched++;
+                if (ver < last) backwards++;
+                if (ver > 0 && ver < WRITES) mid++;
+                last = ver;
+                n++;
+            }
+            reads += n;
+            midway += mid;
+        });
+    }
+
+    writer.join();
+    for (int r = 0; r < READERS; r++) readers[r].join();
+
+    char msg[128];
+    snprintf(msg, sizeof(msg), "%lu записей, %lu чтений, из них %lu во время записи",
+             (unsigned long)WRITES, (unsigned long)reads.load(), (unsigned long)midway.load());
+    TEST_MESSAGE(msg);
+    TEST_ASSERT_TRUE(midway.load() > 0);                   // Читатели пересеклись с писателем
+    TEST_ASSERT_EQUAL_UINT32(0, torn.load());
+    TEST_ASSERT_EQUAL_UINT32(0, mismatched.load());
+    TEST_ASSERT_EQUAL_UINT32(0, backwards.load());
+    TEST_ASSERT_EQUAL_UINT32(WRITES, sl.version());
+}
+
+void test_two_writers_own_parts() {
+    static Seqlock<Parts> sl;
+    std::atomic<uint32_t> torn(0);
+    std::atomic<int> running(2);
+    std::atomic<bool> ready(false);
+
+    auto writer = [&](bool left) {
+        while (!ready.load()) {}
+        for (uint32_t k = 1; k <= WRITES / 2; k++) {
+            sl.write([k, left](Parts& p) {
+                uint32_t* part = left ? p.left : p.right;
+                for (int i = 0; i < WORDS / 2; i++) part[i] = k;
+            });
+            if (k % 4096 == 0) std::this_thread::yield();
+        }
+        running--;
+    };
+    std::thread l(writer, true), r(writer, false);
+
+    std::thread reader([&] {
+        Parts p;
+        ready.store(true);
+        while (running.load() > 0) {
+            sl.read(&p);
+            for (int i = 1; i < WORDS / 2; i++) {
+                if (p.left[i] != p.left[0] || p.right[i] != p.right[0]) { torn++; break; }
+            }
+        }
+    });
+
+    l.join();
+    r.join();
+    reader.join();
+
+    Parts p;
+    TEST_ASSERT_EQUAL_UINT32(WRITES, sl.read(&p));
+    TEST_ASSERT_EQUAL_UINT32(WRITES / 2, p.left[WORDS / 2 - 1]);
+    TEST_ASSERT_EQUAL_UINT32(WRITES / 2, p.right[WORDS / 2 - 1]);
+    TEST_ASSERT_EQUAL_UINT32(0, torn.load());
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_initial_value_and_version);
+    RUN_TEST(test_readers_never_see_torn_value);
+    RUN_TEST(test_two_writers_own_parts);
+    return UNITY_END();
+}
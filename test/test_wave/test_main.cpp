@@ -0,0 +1,131 @@
+/**
+ * ============================================================
+ * 🧪 test_wave — Проверка формы скважности (wave_format.h), хост
+ * ============================================================
+ *
+ * Формы собираются в тесте: заголовок + count × n байт. Верные
+ * (один канал, все каналы, частота = CONTROL_RATE_HZ и её
+ * делители, WAVE_MAX_SAMPLES) принимаются; на каждое правило —
+ * своя отклонённая форма с ожидаемым текстом ошибки: размер,
+ * заголовок, маска, частота, число отсчётов, размер не под count.
+ *
+ *   pio test -e native -f test_wave
+ *
+ * ============================================================
+ */
+
+#include <unity.h>
+#include <string.h>
+#include "config.h"
+#include "wave_format.h"
+
+static uint8_t buf[WAVE_FORMAT_MAX + 1];
+static const char* err;
+
+/** Заголовок формы; отсчёты — нули. @return Размер верной формы */
+static size_t build(uint8_t mask, uint16_t rate, uint16_t count) {
+    memset(buf, 0, sizeof(buf));
+    buf[0] = WAVE_MAGIC_0;
+    buf[1] = WAVE_MAGIC_1;
+    buf[2] = WAVE_VERSION;
+    buf[3] = mask;
+    buf[4] = rate & 0xFF;
+    buf[5] = rate >> 8;
+    buf[6] = count & 0xFF;
+    buf[7] = count >> 8;
+    return WAVE_HEADER_LEN + (size_t)count * waveChannelCount(mask);
+}
+
+static bool check(size_t len) {
+    err = "not set";
+    return waveValidate(buf, len, &err);
+}
+
+static void reject(size_t len, const char* msg) {
+    TEST_ASSERT_FALSE(check(len));
+    TEST_ASSERT_EQUAL_STRING(msg, err);
+}
+
+void setUp() {}
+
+void tearDown() {}
+
+// ------------------------------------------------------------
+
+void test_channel_count() {
+    TEST_ASSERT_EQUAL_UINT8(0, waveChannelCount(0));
+    TEST_ASSERT_EQUAL_UINT8(1, waveChannelCount(0x04));
+    TEST_ASSERT_EQUAL_UINT8(2, waveChannelCount(0x06));
+    TEST_ASSERT_EQUAL_UINT8(4, waveChannelCount(0x0F));
+    TEST_ASSERT_EQUAL_UINT8(4, waveChannelCount(0xFF));             // Лишние биты не считаются
+}
+
+void test_valid_waveforms() {
+    TEST_ASSERT_TRUE(check(build(0x01, CONTROL_RATE_HZ, 1)));
+    TEST_ASSERT_NULL(err);
+    TEST_ASSERT_TRUE(check(build(0x06, 100, 400)));
+    TEST_ASSERT_TRUE(check(build(0x0F, 1, 10)));
+    TEST_ASSERT_TRUE(check(build(0x0F, CONTROL_RATE_HZ, WAVE_MAX_SAMPLES)));
+    TEST_ASSERT_EQUAL(WAVE_FORMAT_MAX, build(0x0F, CONTROL_RATE_HZ, WAVE_MAX_SAMPLES));
+}
+
+void test_bad_size() {
+    reject(0, "Bad size");
+    reject(WAVE_HEADER_LEN - 1, "Bad size");
+    reject(WAVE_FORMAT_MAX + 1, "Bad size");
+}
+
+void test_bad_header() {
+    size_t len = build(0x01, CONTROL_RATE_HZ, 4);
+    buf[1] = 'M';                                                    // Миссия, не форма
+    reject(len, "Bad header");
+    len = build(0x01, CONTROL_RATE_HZ, 4);
+    buf[2] = WAVE_VERSION + 1;
+    reject(len, "Bad header");
+}
+
+void test_bad_mask() {
+    reject(build(0x00, CONTROL_RATE_HZ, 4), "Bad channel mask");
+    reject(build(1 << WAVE_CHANNELS, CONTROL_RATE_HZ, 4), "Bad channel mask");
+    reject(build(0x81, CONTROL_RATE_HZ, 4), "Bad channel mask");
+}
+
+void test_bad_rate() {
+    reject(build(0x01, 0, 4), "Rate must divide CONTROL_RATE_HZ");
+    reject(build(0x01, CONTROL_RATE_HZ + 1, 4), "Rate must divide CONTROL_RATE_HZ");
+    reject(build(0x01, CONTROL_RATE_HZ * 2, 4), "Rate must divide CONTROL_RATE_HZ");
+    reject(build(0x01, 3, 4), "Rate must divide CONTROL_RATE_HZ");   // 200 и 500 на 3 не делятся
+}
+
+void test_bad_count() {
+    reject(build(0x01, CONTROL_RATE_HZ, 0), "Bad sample count");
+    // Один канал: размер помещается в WAVE_FORMAT_MAX, count — нет
+    reject(build(0x01, CONTROL_RATE_HZ, WAVE_MAX_SAMPLES + 1), "Bad sample count");
+}
+
+void test_size_must_match_count() {
+    size_t len = build(0x06, 100, 50);                               // 2 канала × 50
+    reject(len - 1, "Size does not match count");
+    reject(len + 1, "Size does not match count");
+    reject(WAVE_HEADER_LEN + 50, "Size does not match count");      // Как для одного канала
+    TEST_ASSERT_TRUE(check(len));
+}
+
+void test_error_pointer_optional() {
+    build(0x00, CONTROL_RATE_HZ, 4);
+    TEST_ASSERT_FALSE(waveValidate(buf, WAVE_HEADER_LEN, NULL));
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_channel_count);
+    RUN_TEST(test_valid_waveforms);
+    RUN_TEST(test_bad_size);
+    RUN_TEST(test_bad_header);
+    RUN_TEST(test_bad_mask);
+    RUN_TEST(test_bad_rate);
+    RUN_TEST(test_bad_count);
+    RUN_TEST(test_size_must_match_count);
+    RUN_TEST(test_error_pointer_optional);
+    return UNITY_END();
+}
@@ -0,0 +1,250 @@
+/**
+ * ============================================================
+ * 🧪 test_wheel_pid — PID колеса на модели мотора, хост
+ * ============================================================
+ *
+ * Тот же контур, что driveTick() с источником «sim»: рампа
+ * ведёт уставку каждый тик, модель (SIM_MOTOR_*) шагает по
+ * выходу, раз в SPEEDCTL_DIVIDER тиков прирост импульсов →
+ * имп/с → wheelPidStep() (коэффициенты SPEEDCTL_* из config.h,
+ * обратно — поданная скважность) → мотор, мимо рампы выхода.
+ * Время установления считается как settle_ms в /api/drive: от
+ * смены уставки до последнего выхода измерения из полосы
+ * ±SPEEDCTL_SETTLE_PCT.
+ *
+ * Проверяем переходную характеристику 0 → 1000 имп/с, перерегу-
+ * лирование, восстановление после просадки нагрузки до 70 %,
+ * отсечку переда (scene guard) с удержанием и снятием, и что
+ * разомкнутый PWM на той же просадке остаётся медленнее.
+ *
+ * С рампой проскок не выходит за полосу установления: интеграл
+ * не копит ни ошибку слежения за рампой, ни время отсечки.
+ * Без рампы (скачок уставки) — до ≈17 %. Измерение квантовано
+ * по 50 имп/с (импульсы за шаг × 50 Гц); печатаются фактические.
+ *
+ *   pio test -e native -f test_wheel_pid -v
+ *
+ * ============================================================
+ */
+
+#include <unity.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "config.h"
+#include "ramp.h"
+#include "wheel_pid.h"
+
+static const uint32_t TICK_US = 1000000 / CONTROL_RATE_HZ;
+static const int32_t  RATE_HZ = CONTROL_RATE_HZ / SPEEDCTL_DIVIDER;
+static const uint8_t  TARGET = 128;                // Цель мотора 0-255
+static const int32_t  SETPOINT = TARGET * SPEEDCTL_MAX_CPS / 255;   // ≈1000 имп/с
+
+static const WheelPidGains gains = {
+    (int32_t)((255LL << 16) / SPEEDCTL_MAX_CPS),   // Как loopGains в drive.cpp
+    SPEEDCTL_KP_Q16,
+    SPEEDCTL_KI_Q16,
+    SPEEDCTL_KD_Q16,
+    SPEEDCTL_FILTER_SHIFT
+};
+
+// --- Контур: модель + рампа уставки + PID (разомкнутый — рампа выхода) ---
+struct Loop {
+    MotorModelParams params;
+    MotorModel  model;
+    WheelPid    pid;
+    RampChannel spRamp;        // Рампа уставки (единицы цели), как loopRamp
+    RampChannel ramp;          // Рампа выхода разомкнутого PWM
+    uint8_t     pidDuty;
+    uint8_t     cap;           // Срез, как driveSetForwardCap
+    uint8_t     output;
+    uint32_t    counts;
+    int         divider;       // Тики до следующего шага PID
+    int32_t     measCps;
+    uint32_t    sample;
+    uint32_t    stepSample;    // Сэмпл смены уставки
+    uint32_t    outSample;     // Последний сэмпл вне полосы
+    int32_t     peakCps;
+};
+
+static Loop loop;
+
+void setUp() {
+    loop = Loop();
+    loop.params = {SIM_MOTOR_GAIN_CPS, SIM_MOTOR_TAU_MS * 1000, SIM_MOTOR_DEADBAND, 100};
+    loop.cap = PWM_MAX_DUTY;
+    wheelPidReset(&loop.pid);
+    rampReset(&loop.spRamp, 0);
+    rampReset(&loop.ramp, 0);
+}
+
+void tearDown() {}
+
+/** Один тик управления (как speedLoopTick + driveTick без fade) */
+static void tick(uint8_t target, bool closed, RampProfileId profile) {
+    const RampProfile& p = rampGetProfile(profile);
+    int32_t setpoint = (int32_t)target * SPEEDCTL_MAX_CPS / 255;
+    uint8_t segDuty;
+    uint32_t segMs;
+
+    // Потолок — на цель; отсечка сбрасывает рампу уставки в ноль
+    if (target > loop.cap) target = loop.cap;
+    if (loop.cap == 0) rampReset(&loop.spRamp, 0);
+    rampStep(&loop.spRamp, p, target, TICK_US, 0, &segDuty, &segMs);
+
+    motorModelStep(&loop.model, loop.params, loop.output, TICK_US);
+
+    if (++loop.divider >= SPEEDCTL_DIVIDER) {
+        loop.divider = 0;
+        uint32_t counts = motorModelCounts(&loop.model);
+        int32_t cps = (int32_t)(counts - loop.counts) * RATE_HZ;
+        loop.counts = counts;
+        loop.sample++;
+
+        if (closed) {
+            int32_t ramped = (int32_t)rampDuty(&loop.spRamp) * SPEEDCTL_MAX_CPS / 255;
+            loop.pidDuty = wheelPidStep(&loop.pid, gains, ramped, cps, PWM_MAX_DUTY, loop.output);
+            loop.measCps = loop.pid.measCps;
+        } else {
+            loop.pidDuty = target;
+            loop.measCps = cps;
+        }
+        if (abs(setpoint - loop.measCps) > setpoint * SPEEDCTL_SETTLE_PCT / 100) {
+            loop.outSample = loop.sample;
+        }
+        if (loop.measCps > loop.peakCps) loop.peakCps = loop.measCps;
+    }
+
+    // PID — мимо рампы выхода, под потолком; разомкнутый — через рампу
+    uint8_t duty = loop.pidDuty < loop.cap ? loop.pidDuty : loop.cap;
+    if (closed) {
+        loop.output = duty;
+    } else {
+        rampStep(&loop.ramp, p, duty, TICK_US, 0, &segDuty, &segMs);
+        loop.output = rampDuty(&loop.ramp);
+    }
+}
+
+/** Прогнать контур ms миллисекунд; начало — новая уставка/возмущение */
+static void run(uint32_t ms, uint8_t target, bool closed, RampProfileId profile) {
+    loop.stepSample = loop.outSample = loop.sample;
+    loop.peakCps = 0;
+    for (uint32_t t = 0; t < ms * 1000 / TICK_US; t++) tick(target, closed, profile);
+}
+
+static uint32_t settleMs() {
+    return (loop.outSample - loop.stepSample) * 1000 / RATE_HZ;
+}
+
+static void report(const char* what) {
+    char msg[192];
+    snprintf(msg, sizeof(msg), "%s: settle %lu мс, пик %ld имп/с, итог %ld имп/с, скважность %u",
+             what, (unsigned long)settleMs(), (long)loop.peakCps, (long)loop.measCps, loop.pidDuty);
+    TEST_MESSAGE(msg);
+}
+
+// ------------------------------------------------------------
+
+void test_zero_setpoint_coasts() {
+    for (int i = 0; i < 10; i++) {
+        TEST_ASSERT_EQUAL_UINT8(0, wheelPidStep(&loop.pid, gains, 0, 500, PWM_MAX_DUTY, 0));
+    }
+    TEST_ASSERT_TRUE(loop.pid.integQ16 == 0);
+}
+
+void test_output_is_clamped() {
+    // Огромная ошибка: выход в потолке, интеграл не разгоняется
+    for (int i = 0; i < 200; i++) wheelPidStep(&loop.pid, gains, SPEEDCTL_MAX_CPS, 0, 180, 180);
+    TEST_ASSERT_EQUAL_UINT8(180, wheelPidStep(&loop.pid, gains, SPEEDCTL_MAX_CPS, 0, 180, 180));
+    TEST_ASSERT_TRUE(loop.pid.integQ16 <= (180LL << 16));
+}
+
+void test_held_output_freezes_integral() {
+    // Мотор получает 0 (отсечка, блокировка реверса), регулятор просит больше
+    for (int i = 0; i < 100; i++) wheelPidStep(&loop.pid, gains, SETPOINT, 0, PWM_MAX_DUTY, 0);
+    TEST_ASSERT_TRUE(loop.pid.integQ16 == 0);
+    // Выход дошёл до мотора — интеграл снова копит
+    uint8_t duty = 0;
+    for (int i = 0; i < 10; i++) duty = wheelPidStep(&loop.pid, gains, SETPOINT, SETPOINT - 50, PWM_MAX_DUTY, duty);
+    TEST_ASSERT_TRUE(loop.pid.integQ16 > 0);
+}
+
+void test_ramping_setpoint_freezes_integral() {
+    for (int32_t sp = 100; sp <= SETPOINT; sp += 100) {
+        uint8_t duty = wheelPidStep(&loop.pid, gains, sp, sp / 2, PWM_MAX_DUTY, loop.pid.lastDuty);
+        TEST_ASSERT_TRUE(duty > 0);
+    }
+    TEST_ASSERT_TRUE(loop.pid.integQ16 == 0);
+}
+
+void test_model_steady_state() {
+    // Без регулятора: установившаяся скорость = gain·(duty − deadband)/(255 − deadband)
+    for (int t = 0; t < 2000; t++) motorModelStep(&loop.model, loop.params, 140, TICK_US);
+    int32_t expected = SIM_MOTOR_GAIN_CPS * (140 - SIM_MOTOR_DEADBAND) / (255 - SIM_MOTOR_DEADBAND);
+    TEST_ASSERT_INT_WITHIN(2, expected, (int32_t)(loop.model.speedQ16 >> 16));
+    // Ниже мёртвой зоны — стоит
+    for (int t = 0; t < 2000; t++) motorModelStep(&loop.model, loop.params, SIM_MOTOR_DEADBAND, TICK_US);
+    TEST_ASSERT_INT_WITHIN(1, 0, (int32_t)(loop.model.speedQ16 >> 16));
+}
+
+void test_step_response_settles() {
+    run(3000, TARGET, true, RAMP_PROFILE_DEFAULT);
+    report("0 → 1000 имп/с");
+    TEST_ASSERT_INT_WITHIN(SETPOINT * SPEEDCTL_SETTLE_PCT / 100, SETPOINT, loop.measCps);
+    TEST_ASSERT_LESS_OR_EQUAL(400, settleMs());
+    TEST_ASSERT_LESS_OR_EQUAL(SETPOINT * (100 + SPEEDCTL_SETTLE_PCT) / 100, loop.peakCps);
+}
+
+void test_step_response_without_ramp() {
+    run(3000, TARGET, true, RAMP_OFF);
+    report("0 → 1000 имп/с, без рампы");
+    TEST_ASSERT_INT_WITHIN(SETPOINT * SPEEDCTL_SETTLE_PCT / 100, SETPOINT, loop.measCps);
+    TEST_ASSERT_LESS_OR_EQUAL(600, settleMs());
+    TEST_ASSERT_LESS_OR_EQUAL(SETPOINT * 120 / 100, loop.peakCps);
+}
+
+void test_recovers_from_load_drop() {
+    run(3000, TARGET, true, RAMP_PROFILE_DEFAULT);
+    loop.params.loadPct = 70;
+    run(3000, TARGET, true, RAMP_PROFILE_DEFAULT);
+    report("нагрузка 70 %");
+    TEST_ASSERT_INT_WITHIN(SETPOINT * SPEEDCTL_SETTLE_PCT / 100, SETPOINT, loop.measCps);
+    TEST_ASSERT_LESS_OR_EQUAL(600, settleMs());
+}
+
+void test_cap_release_does_not_overshoot() {
+    // Срез переда (scene guard) держит колесо в нуле всё SCENE_HOLD_MS;
+    // после снятия — без проскока за уставку (в пределах полосы)
+    run(3000, TARGET, true, RAMP_PROFILE_DEFAULT);
+    loop.cap = 0;
+    run(SCENE_HOLD_MS, TARGET, true, RAMP_PROFILE_DEFAULT);
+    TEST_ASSERT_EQUAL_UINT8(0, loop.output);
+    TEST_ASSERT_TRUE(loop.pid.integQ16 == 0);
+    loop.cap = PWM_MAX_DUTY;
+    run(3000, TARGET, true, RAMP_PROFILE_DEFAULT);
+    report("срез 0 → снят");
+    TEST_ASSERT_LESS_OR_EQUAL(SETPOINT * (100 + SPEEDCTL_SETTLE_PCT) / 100, loop.peakCps);
+    TEST_ASSERT_INT_WITHIN(SETPOINT * SPEEDCTL_SETTLE_PCT / 100, SETPOINT, loop.measCps);
+}
+
+void test_open_loop_stays_slow_on_load_drop() {
+    // Разомкнутый PWM с той же целью: при 70 % нагрузки — заметно ниже уставки
+    loop.params.loadPct = 70;
+    run(3000, TARGET, false, RAMP_PROFILE_DEFAULT);
+    report("разомкнутый, нагрузка 70 %");
+    TEST_ASSERT_LESS_THAN(SETPOINT * 80 / 100, loop.measCps);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_zero_setpoint_coasts);
+    RUN_TEST(test_output_is_clamped);
+    RUN_TEST(test_held_output_freezes_integral);
+    RUN_TEST(test_ramping_setpoint_freezes_integral);
+    RUN_TEST(test_model_steady_state);
+    RUN_TEST(test_step_response_settles);
+    RUN_TEST(test_step_response_without_ramp);
+    RUN_TEST(test_recovers_from_load_drop);
+    RUN_TEST(test_cap_release_does_not_overshoot);
+    RUN_TEST(test_open_loop_stays_slow_on_load_drop);
+    return UNITY_END();
+}
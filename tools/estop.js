@@ -0,0 +1,225 @@
+/**
+ * ============================================================
+ * 🛑 E-stop — аварийный стоп и замер его задержки под нагрузкой
+ * ============================================================
+ *
+ * Клиент UDP-канала аварийного стопа (src/estop.h, порт 4211).
+ *
+ * Запуск:
+ *   node tools/estop.js stop|clear|status <host>
+ *   node tools/estop.js bench <host> [--count 200] [--load 4] [--http]
+ *
+ *   stop   — STOP, при потере ответа — повтор (до 3 раз)
+ *   bench  — замер худшей задержки стопа, пока UI грузит статику:
+ *            --load N параллельных циклов скачивания ассетов
+ *            (index.html, script.js, style.css, ...) с порта 80,
+ *            затем count раз: CLEAR → STOP, RTT до ответа.
+ *            --http — то же для обычного пути POST /api/control
+ *            {"type":"stop"} (для сравнения, через httpd)
+ *
+ * Метки устройства (esp_timer, мкс): recv — пакет принят, stop —
+ * каналы LEDC погашены. Оценка стопа = RTT / 2 + (stop − recv);
+ * у HTTP устройство меток не даёт — для него приведён RTT.
+ *
+ * Моторы во время bench не крутятся: команды движения не шлются.
+ *
+ * ============================================================
+ */
+
+const dgram = require('dgram');
+const http = require('http');
+
+const PORT = 4211;                 // ESTOP_PORT
+const MAGIC = 0x53;                // 'S'
+const CMD = { stop: 1, clear: 2, status: 3 };
+const ASSETS = ['/', '/script.js', '/control.js', '/config.js', '/style.css',
+  '/compositor.js', '/cv-processor.js', '/mjpeg-reader.js', '/motion-detector.js', '/logo.svg'];
+
+const args = process.argv.slice(2);
+const argValue = (name, def) => {
+  const i = args.indexOf(name);
+  return i >= 0 ? args[i + 1] : def;
+};
+const nowUs = () => Number(process.hrtime.bigint() / 1000n);
+const sleep = (ms) => new Promise((r) => setTimeout(r, ms));
+
+// === UDP ===
+const sock = dgram.createSocket('udp4');
+const pending = new Map();   // nonce → { resolve, t0 }
+let nonceSeq = (Date.now() & 0xffff) << 16;
+
+sock.on('message', (msg) => {
+  if (msg.length !== 20 || msg[0] !== MAGIC || !(msg[1] & 0x80)) return;
+  const nonce = msg.readUInt32LE(4);
+  const p = pending.get(nonce);
+  if (!p) return;
+  pending.delete(nonce);
+  p.resolve({
+    rtt: nowUs() - p.t0,
+    latched: msg[2] === 1,
+    recv: msg.readUInt32LE(8),
+    stop: msg.readUInt32LE(12),
+    stops: msg.readUInt32LE(16),
+  });
+});
+
+/** Отправить команду и дождаться ответа (null — таймаут) */
+function send(host, cmd, timeoutMs = 1000) {
+  const nonce = (nonceSeq = (nonceSeq + 1) >>> 0);
+  const buf = Buffer.alloc(8);
+  buf[0] = MAGIC;
+  buf[1] = cmd;
+  buf.writeUInt32LE(nonce, 4);
+  return new Promise((resolve) => {
+    const timer = setTimeout(() => {
+      pending.delete(nonce);
+      resolve(null);
+    }, timeoutMs);
+    pending.set(nonce, { t0: nowUs(), resolve: (r) => { clearTimeout(timer); resolve(r); } });
+    sock.send(buf, PORT, host);
+  });
+}
+
+// === HTTP ===
+function httpRequest(host, path, body) {
+  return new Promise((resolve, reject) => {
+    const data = body ? Buffer.from(JSON.stringify(body)) : null;
+    const req = http.request({
+      host,
+      path,
+      method: data ? 'POST' : 'GET',
+      agent: false,   // Отдельное соединение — как у браузера под нагрузкой
+      headers: data ? { 'Content-Type': 'application/json', 'Content-Length': data.length } : {},
+    }, (res) => {
+      let size = 0;
+      res.on('data', (chunk) => { size += chunk.length; });
+      res.on('end', () => resolve({ status: res.statusCode, size }));
+    });
+    req.setTimeout(5000, () => req.destroy(new Error('timeout')));
+    req.on('error', reject);
+    if (data) req.write(data);
+    req.end();
+  });
+}
+
+/** Циклы скачивания ассетов, пока running() */
+function startLoad(host, workers, running) {
+  const stats = { files: 0, bytes: 0, errors: 0 };
+  for (let w = 0; w < workers; w++) {
+    (async () => {
+      for (let i = w; running(); i++) {
+        try {
+          const r = await httpRequest(host, ASSETS[i % ASSETS.length]);
+          stats.files++;
+          stats.bytes += r.size;
+        } catch (e) {
+          stats.errors++;
+          await sleep(50);
+        }
+      }
+    })();
+  }
+  return stats;
+}
+
+// === Отчёт ===
+function report(label, values) {
+  if (values.length === 0) {
+    console.log(`${label.padEnd(22)} нет данных`);
+    return;
+  }
+  const sorted = [...values].sort((a, b) => a - b);
+  const pct = (p) => sorted[Math.min(sorted.length - 1, Math.floor(sorted.length * p))];
+  const ms = (us) => (us / 1000).toFixed(2).padStart(8);
+  console.log(`${label.padEnd(22)} ${ms(pct(0.5))} ${ms(pct(0.9))} ${ms(pct(0.99))} ${ms(sorted[sorted.length - 1])}`);
+}
+
+async function bench(host) {
+  const count = parseInt(argValue('--count', 200));
+  const load = parseInt(argValue('--load', 4));
+  const viaHttp = args.includes('--http');
+
+  let running = true;
+  const loadStats = startLoad(host, load, () => running);
+  await sleep(500);   // Дать нагрузке разогнаться
+
+  const rtt = [];
+  const device = [];
+  const total = [];
+  let lost = 0;
+  const t0 = Date.now();
+
+  for (let i = 0; i < count; i++) {
+    await send(host, CMD.clear);
+    await sleep(20 + Math.random() * 30);   // Стоп в случайный момент нагрузки
+
+    if (viaHttp) {
+      const start = nowUs();
+      try {
+        await httpRequest(host, '/api/control', { type: 'stop' });
+        rtt.push(nowUs() - start);
+      } catch (e) {
+        lost++;
+      }
+      continue;
+    }
+
+    const r = await send(host, CMD.stop);
+    if (!r) {
+      lost++;
+      continue;
+    }
+    const stopUs = (r.stop - r.recv) >>> 0;
+    rtt.push(r.rtt);
+    device.push(stopUs);
+    total.push(Math.max(0, r.rtt / 2) + stopUs);
+  }
+
+  running = false;
+  await send(host, CMD.clear);
+  const secs = (Date.now() - t0) / 1000;
+
+  console.log(`\n${viaHttp ? 'HTTP POST /api/control' : `UDP :${PORT}`}: ${count} стопов, потеряно ${lost}`);
+  console.log(`Нагрузка: ${load} потоков, ${loadStats.files} файлов, ` +
+              `${(loadStats.bytes / 1024 / secs).toFixed(0)} КБ/с, ошибок ${loadStats.errors}\n`);
+  console.log('                          p50      p90      p99      max   (мс)');
+  report('RTT', rtt);
+  if (!viaHttp) {
+    report('recv → LEDC stop', device);
+    report('стоп (оценка)', total);
+  }
+  if (!viaHttp && device.length) {
+    console.log(`\nХудший стоп: ${(Math.max(...total) / 1000).toFixed(2)} мс (сеть + recv → LEDC)`);
+  }
+}
+
+async function main() {
+  const [cmd, host] = args;
+  if (!host || !['stop', 'clear', 'status', 'bench'].includes(cmd)) {
+    console.log('Использование: node tools/estop.js stop|clear|status|bench <host> [--count 200] [--load 4] [--http]');
+    process.exit(1);
+  }
+
+  if (cmd === 'bench') {
+    await bench(host);
+  } else {
+    let r = null;
+    const repeats = cmd === 'stop' ? 3 : 1;
+    for (let i = 0; i < repeats && !r; i++) {
+      r = await send(host, CMD[cmd], 300);
+      if (!r && i + 1 < repeats) await sleep(10);
+    }
+    if (!r) {
+      console.error('❌ Нет ответа');
+      process.exit(1);
+    }
+    const stopMs = r.stop ? ` — каналы погашены за ${(((r.stop - r.recv) >>> 0) / 1000).toFixed(3)} мс` : '';
+    console.log(`🛑 ${r.latched ? 'СТОП (защёлка)' : 'снят'}, всего стопов ${r.stops}, RTT ${(r.rtt / 1000).toFixed(2)} мс${stopMs}`);
+  }
+  sock.close();
+}
+
+main().catch((err) => {
+  console.error('❌', err.message);
+  process.exit(1);
+});
@@ -0,0 +1,189 @@
+/**
+ * ============================================================
+ * ⏱️ Latency Probe — задержка «команда → запись PWM»
+ * ============================================================
+ *
+ * Шлёт команды джойстика с флагом замера и разбирает метки
+ * устройства (esp_timer, мкс):
+ *
+ *   recv → post   разбор запроса и публикация в почтовый ящик
+ *   post → apply  ожидание тика задачи управления
+ *   apply → pwm   рампа и запись LEDC изменившегося канала
+ *   pwm → send    ожидание/сборка ответа
+ *
+ * Сеть в одну сторону оценивается как (RTT − (send − recv)) / 2,
+ * итог «стик → PWM» = сеть + (pwm − recv).
+ *
+ * Запуск:
+ *   node tools/latency-probe.js <host> [--http] [--rate 50] [--count 500]
+ *                               [--xy 0,80] [--step 20]
+ *
+ *   по умолчанию — UDP-канал (src/udp_control.h, флаг PROBE)
+ *   --http     — POST /api/control с "probe":true (по одному запросу)
+ *   --xy x,y   — команда; каждая вторая — с y + step, чтобы цели
+ *                моторов менялись на каждом пакете
+ *
+ * ⚠️ Ровер ПОЕДЕТ — поднимите колёса.
+ *
+ * ============================================================
+ */
+
+const dgram = require('dgram');
+const http = require('http');
+
+// === Аргументы ===
+const args = process.argv.slice(2);
+const argValue = (name, def) => {
+  const i = args.indexOf(name);
+  return i >= 0 ? args[i + 1] : def;
+};
+const HOST = args[0] && !args[0].startsWith('--') ? args[0] : null;
+const PORT = parseInt(argValue('--port', 4210));
+const RATE = parseInt(argValue('--rate', 50));
+const COUNT = parseInt(argValue('--count', 500));
+const [X, Y] = argValue('--xy', '0,80').split(',').map(Number);
+const STEP = parseInt(argValue('--step', 20));
+const HTTP = args.includes('--http');
+
+if (!HOST) {
+  console.log('Использование: node tools/latency-probe.js <host> [--http] [--rate 50] [--count 500] [--xy x,y] [--step 20]');
+  process.exit(1);
+}
+
+const nowUs = () => Number(process.hrtime.bigint() / 1000n);
+const sleep = (ms) => new Promise((r) => setTimeout(r, ms));
+const commandY = (i) => (i % 2 === 0 ? Y : Y + STEP);
+
+// === Сбор результатов ===
+const samples = [];
+let noPwm = 0;
+
+/** Учесть ответ: rtt клиента и метки устройства */
+function addSample(rttUs, d) {
+  const diff = (a, b) => (b - a) >>> 0;
+  if (d.pwm === 0) {
+    noPwm++;
+    return;
+  }
+  const server = diff(d.recv, d.send);
+  const net = Math.max(0, (rttUs - server) / 2);
+  samples.push({
+    rtt: rttUs,
+    parse: diff(d.recv, d.post),
+    queue: diff(d.post, d.apply),
+    pwm: diff(d.apply, d.pwm),
+    reply: diff(d.pwm, d.send),
+    net,
+    total: net + diff(d.recv, d.pwm),
+  });
+}
+
+function report(sent) {
+  console.log(`\nОтправлено ${sent}, замеров ${samples.length}, без изменения PWM ${noPwm}\n`);
+  if (samples.length === 0) return;
+  const rows = [
+    ['recv → post', 'parse'],
+    ['post → apply', 'queue'],
+    ['apply → pwm', 'pwm'],
+    ['pwm → send', 'reply'],
+    ['сеть (1 сторона)', 'net'],
+    ['RTT', 'rtt'],
+    ['стик → PWM', 'total'],
+  ];
+  const ms = (us) => (us / 1000).toFixed(2).padStart(8);
+  console.log('                       p50      p90      p99      max   (мс)');
+  for (const [label, key] of rows) {
+    const sorted = samples.map((s) => s[key]).sort((a, b) => a - b);
+    const pct = (p) => sorted[Math.min(sorted.length - 1, Math.floor(sorted.length * p))];
+    console.log(`${label.padEnd(18)} ${ms(pct(0.5))} ${ms(pct(0.9))} ${ms(pct(0.99))} ${ms(sorted[sorted.length - 1])}`);
+  }
+}
+
+// === UDP (src/udp_control.h) ===
+async function runUdp() {
+  const sock = dgram.createSocket('udp4');
+  const sentAt = new Map();
+
+  sock.on('message', (msg) => {
+    if (msg.length !== 36 || msg.readUInt8(2) !== 0x82) return;
+    const seq = msg.readUInt32LE(4);
+    const t0 = sentAt.get(seq);
+    if (t0 === undefined) return;
+    sentAt.delete(seq);
+    addSample(nowUs() - t0, {
+      recv: msg.readUInt32LE(16),
+      post: msg.readUInt32LE(20),
+      apply: msg.readUInt32LE(24),
+      pwm: msg.readUInt32LE(28),
+      send: msg.readUInt32LE(32),
+    });
+  });
+
+  for (let i = 0; i < COUNT; i++) {
+    const buf = Buffer.alloc(16);
+    const seq = i + 1;
+    buf.writeUInt8(0x52, 0);
+    buf.writeUInt8(1, 1);
+    buf.writeUInt8(1, 2);           // XY
+    buf.writeUInt8(0x01 | 0x02, 3); // ACK | PROBE
+    buf.writeUInt32LE(seq, 4);
+    buf.writeUInt32LE(nowUs() >>> 0, 8);
+    buf.writeInt16LE(X, 12);
+    buf.writeInt16LE(commandY(i), 14);
+    sentAt.set(seq, nowUs());
+    sock.send(buf, PORT, HOST);
+    await sleep(1000 / RATE);
+  }
+
+  // Остановка и ожидание хвоста ответов
+  const stop = Buffer.alloc(16);
+  stop.writeUInt8(0x52, 0);
+  stop.writeUInt8(1, 1);
+  stop.writeUInt8(2, 2);
+  stop.writeUInt32LE(COUNT + 1, 4);
+  sock.send(stop, PORT, HOST);
+  await sleep(500);
+  sock.close();
+}
+
+// === HTTP (POST /api/control, "probe":true) ===
+function post(agent, body) {
+  return new Promise((resolve, reject) => {
+    const data = JSON.stringify(body);
+    const req = http.request({
+      host: HOST,
+      path: '/api/control',
+      method: 'POST',
+      agent,
+      headers: { 'Content-Type': 'application/json', 'Content-Length': Buffer.byteLength(data) },
+    }, (res) => {
+      let text = '';
+      res.on('data', (chunk) => { text += chunk; });
+      res.on('end', () => resolve(JSON.parse(text)));
+    });
+    req.on('error', reject);
+    req.write(data);
+    req.end();
+  });
+}
+
+async function runHttp() {
+  const agent = new http.Agent({ keepAlive: true, maxSockets: 1 });
+  for (let i = 0; i < COUNT; i++) {
+    const t0 = nowUs();
+    const res = await post(agent, { type: 'xy', x: X, y: commandY(i), probe: true, t: t0 >>> 0 });
+    if (res.probe) addSample(nowUs() - t0, res.probe);
+    const waitMs = 1000 / RATE - (nowUs() - t0) / 1000;
+    if (waitMs > 0) await sleep(waitMs);
+  }
+  await post(agent, { type: 'stop' });
+  agent.destroy();
+}
+
+console.log(`⏱️ ${HTTP ? 'HTTP' : 'UDP'} → ${HOST}: ${COUNT} команд, ${RATE} Гц, xy ${X},${Y}/${Y + STEP}`);
+(HTTP ? runHttp() : runUdp())
+  .then(() => report(COUNT))
+  .catch((err) => {
+    console.error('❌', err.message);
+    process.exit(1);
+  });
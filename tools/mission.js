@@ -0,0 +1,279 @@
+/**
+ * ============================================================
+ * 📜 Mission — компилятор и загрузчик сценариев движения
+ * ============================================================
+ *
+ * Собирает текстовый сценарий в байткод ВМ прошивки (формат —
+ * src/mission_code.h), загружает его в /api/mission и запускает.
+ * Тайминг шагов держит прошивка — сеть нужна только для
+ * загрузки и keepalive сторожа.
+ *
+ * Запуск:
+ *   node tools/mission.js compile <file.mis> [-o file.bin]
+ *   node tools/mission.js disasm <file.mis|file.bin>
+ *   node tools/mission.js run <host> <file.mis|file.bin>
+ *   node tools/mission.js start <host> [demo|user]
+ *   node tools/mission.js stop|status <host>
+ *
+ *   run — загрузить, запустить и держать keepalive (для
+ *         watchdog), пока программа не закончится; Ctrl+C — стоп
+ *
+ * Язык сценария (строка — инструкция, # — комментарий):
+ *
+ *   watchdog 1000          стоп, если keepalive не было 1000 мс
+ *   loop 3                 цикл на 3 прохода (loop / loop 0 — бесконечно)
+ *     mark 1               метка шага (видна в /api/mission)
+ *     set fl=200 fr=200    цели моторов, неуказанные — 0 (all=N — все)
+ *     wait 2s              пауза: 1500, 1500ms, 2s, 0.5s
+ *     ramp 1s fl=0 fr=0    линейно к целям за время
+ *   next                   конец цикла
+ *   stop                   все моторы 0
+ *   end                    конец (добавляется сам)
+ *
+ * ⚠️ Ровер ПОЕДЕТ — поднимите колёса.
+ *
+ * ============================================================
+ */
+
+const fs = require('fs');
+const http = require('http');
+
+// === Формат (см. src/mission_code.h) ===
+const HEADER = [0x52, 0x4d, 1, 0];   // "RM", версия 1
+const OP = { end: 0x00, set: 0x01, ramp: 0x02, wait: 0x03, loop: 0x04, next: 0x05, watchdog: 0x06, stop: 0x07, mark: 0x08 };
+const OP_SIZE = [1, 5, 7, 3, 2, 1, 3, 1, 2];
+const OP_NAMES = Object.fromEntries(Object.entries(OP).map(([k, v]) => [v, k]));
+const MOTORS = ['rl', 'fr', 'fl', 'rr'];  // Порядок enum Motor
+const PROGRAM_MAX = 1024;                  // MISSION_PROGRAM_MAX
+const LOOP_DEPTH = 4;                      // MISSION_LOOP_DEPTH
+const U16_MAX = 0xffff;
+
+// === Компилятор ===
+
+/** Длительность: 1500 | 1500ms | 2s | 0.5s → мс */
+function parseDuration(text, line) {
+  const m = /^(\d+(?:\.\d+)?)(ms|s)?$/.exec(text || '');
+  if (!m) throw new Error(`строка ${line}: не длительность «${text}»`);
+  return Math.round(parseFloat(m[1]) * (m[2] === 's' ? 1000 : 1));
+}
+
+/** Цели моторов: fl=200 fr=200 | all=150 → [rl, fr, fl, rr] */
+function parseSpeeds(args, line) {
+  const speeds = [0, 0, 0, 0];
+  for (const arg of args) {
+    const m = /^(fl|fr|rl|rr|all)=(\d+)$/.exec(arg);
+    if (!m || Number(m[2]) > 255) throw new Error(`строка ${line}: ожидалось мотор=0..255, получено «${arg}»`);
+    if (m[1] === 'all') speeds.fill(Number(m[2]));
+    else speeds[MOTORS.indexOf(m[1])] = Number(m[2]);
+  }
+  return speeds;
+}
+
+function u16(v) {
+  return [v & 0xff, v >> 8];
+}
+
+function compile(source) {
+  const code = [...HEADER];
+  const loops = [];   // { line, forever, waits }
+  let ended = false;
+
+  source.split('\n').forEach((raw, i) => {
+    const line = i + 1;
+    const [cmd, ...args] = raw.replace(/#.*/, '').trim().toLowerCase().split(/\s+/);
+    if (!cmd) return;
+    if (ended) throw new Error(`строка ${line}: код после end`);
+    const markWaits = () => loops.forEach((l) => { l.waits = true; });
+
+    switch (cmd) {
+      case 'set':
+        code.push(OP.set, ...parseSpeeds(args, line));
+        break;
+      case 'ramp': {
+        const ms = parseDuration(args[0], line);
+        if (ms > U16_MAX) throw new Error(`строка ${line}: ramp длиннее ${U16_MAX} мс`);
+        code.push(OP.ramp, ...u16(ms), ...parseSpeeds(args.slice(1), line));
+        markWaits();
+        break;
+      }
+      case 'wait': {
+        // Длинные паузы — несколькими WAIT
+        let ms = parseDuration(args[0], line);
+        do {
+          const chunk = Math.min(ms, U16_MAX);
+          code.push(OP.wait, ...u16(chunk));
+          ms -= chunk;
+        } while (ms > 0);
+        markWaits();
+        break;
+      }
+      case 'loop': {
+        const n = args[0] === undefined || args[0] === 'forever' ? 0 : Number(args[0]);
+        if (!Number.isInteger(n) || n < 0 || n > 255) throw new Error(`строка ${line}: loop 0..255`);
+        if (loops.length >= LOOP_DEPTH) throw new Error(`строка ${line}: вложенность циклов больше ${LOOP_DEPTH}`);
+        loops.push({ line, forever: n === 0, waits: false });
+        code.push(OP.loop, n);
+        break;
+      }
+      case 'next': {
+        const l = loops.pop();
+        if (!l) throw new Error(`строка ${line}: next без loop`);
+        if (l.forever && !l.waits) throw new Error(`строка ${l.line}: бесконечный цикл без wait/ramp`);
+        code.push(OP.next);
+        break;
+      }
+      case 'watchdog': {
+        const ms = args[0] === 'off' ? 0 : parseDuration(args[0], line);
+        if (ms > U16_MAX) throw new Error(`строка ${line}: watchdog до ${U16_MAX} мс`);
+        code.push(OP.watchdog, ...u16(ms));
+        break;
+      }
+      case 'mark': {
+        const n = Number(args[0]);
+        if (!Number.isInteger(n) || n < 0 || n > 255) throw new Error(`строка ${line}: mark 0..255`);
+        code.push(OP.mark, n);
+        break;
+      }
+      case 'stop':
+        code.push(OP.stop);
+        break;
+      case 'end':
+        code.push(OP.end);
+        ended = true;
+        break;
+      default:
+        throw new Error(`строка ${line}: неизвестная инструкция «${cmd}»`);
+    }
+  });
+
+  if (loops.length) throw new Error(`строка ${loops[loops.length - 1].line}: loop без next`);
+  if (!ended) code.push(OP.end);
+  if (code.length > PROGRAM_MAX) throw new Error(`программа ${code.length} байт, максимум ${PROGRAM_MAX}`);
+  return Buffer.from(code);
+}
+
+function disasm(buf) {
+  let depth = 0;
+  for (let pc = HEADER.length; pc < buf.length;) {
+    const op = buf[pc];
+    const name = OP_NAMES[op];
+    if (!name) throw new Error(`неизвестный опкод 0x${op.toString(16)} @${pc}`);
+    const speeds = (o) => MOTORS.map((m, i) => `${m}=${buf[o + i]}`).join(' ');
+    let text = name;
+    if (op === OP.set) text += ' ' + speeds(pc + 1);
+    if (op === OP.ramp) text += ` ${buf.readUInt16LE(pc + 1)}ms ` + speeds(pc + 3);
+    if (op === OP.wait || op === OP.watchdog) text += ` ${buf.readUInt16LE(pc + 1)}ms`;
+    if (op === OP.loop || op === OP.mark) text += ` ${buf[pc + 1]}`;
+    if (op === OP.next) depth--;
+    console.log(`${String(pc - HEADER.length).padStart(5)}  ${'  '.repeat(Math.max(depth, 0))}${text}`);
+    if (op === OP.loop) depth++;
+    pc += OP_SIZE[op];
+  }
+}
+
+/** Байткод из .bin (с заголовком) или компиляция .mis */
+function load(file) {
+  const buf = fs.readFileSync(file);
+  if (buf.length >= 4 && buf[0] === HEADER[0] && buf[1] === HEADER[1]) return buf;
+  return compile(buf.toString('utf8'));
+}
+
+// === HTTP ===
+function request(host, urlPath, body) {
+  return new Promise((resolve, reject) => {
+    const data = body === undefined ? null : Buffer.isBuffer(body) ? body : Buffer.from(JSON.stringify(body));
+    const req = http.request({
+      host,
+      path: urlPath,
+      method: data ? 'POST' : 'GET',
+      headers: data ? {
+        'Content-Type': Buffer.isBuffer(body) ? 'application/octet-stream' : 'application/json',
+        'Content-Length': data.length,
+      } : {},
+    }, (res) => {
+      let text = '';
+      res.on('data', (chunk) => { text += chunk; });
+      res.on('end', () => {
+        if (res.statusCode !== 200) return reject(new Error(`${urlPath}: HTTP ${res.statusCode} ${text}`));
+        resolve(JSON.parse(text));
+      });
+    });
+    req.on('error', reject);
+    if (data) req.write(data);
+    req.end();
+  });
+}
+
+const api = (host, body) => request(host, '/api/mission', body);
+const sleep = (ms) => new Promise((r) => setTimeout(r, ms));
+
+function printStatus(st) {
+  const abort = st.state === 'aborted' ? ` (${st.abort})` : '';
+  console.log(`📜 ${st.program}: ${st.state}${abort}, mark ${st.mark}, pc ${st.pc}, ${st.elapsed_ms} мс`);
+}
+
+async function run(host, code) {
+  await request(host, '/api/mission?upload=1', code);
+  console.log(`⬆️ Загружено ${code.length} байт`);
+  let st = await api(host, { action: 'start', program: 'user' });
+
+  let stopping = false;
+  process.on('SIGINT', () => {
+    stopping = true;
+    api(host, { action: 'stop' }).then(printStatus).finally(() => process.exit(130));
+  });
+
+  // keepalive сторожу и состояние раз в 250 мс
+  let lastMark = -1;
+  while (!stopping) {
+    await sleep(250);
+    st = await api(host, { action: 'keepalive' });
+    if (st.mark !== lastMark || st.state !== 'running') printStatus(st);
+    lastMark = st.mark;
+    if (st.state !== 'running') return st.state === 'done';
+  }
+  return false;
+}
+
+// === Точка входа ===
+async function main() {
+  const [cmd, a, b] = process.argv.slice(2);
+  const args = process.argv.slice(2);
+  const argValue = (name, def) => {
+    const i = args.indexOf(name);
+    return i >= 0 ? args[i + 1] : def;
+  };
+
+  switch (cmd) {
+    case 'compile': {
+      const code = compile(fs.readFileSync(a, 'utf8'));
+      const out = argValue('-o', a.replace(/\.[^.]+$/, '') + '.bin');
+      fs.writeFileSync(out, code);
+      console.log(`💾 ${out}: ${code.length} байт`);
+      break;
+    }
+    case 'disasm':
+      disasm(load(a));
+      break;
+    case 'run':
+      process.exit(await run(a, load(b)) ? 0 : 1);
+      break;
+    case 'start':
+      printStatus(await api(a, { action: 'start', program: b || 'demo' }));
+      break;
+    case 'stop':
+      printStatus(await api(a, { action: 'stop' }));
+      break;
+    case 'status':
+      printStatus(await api(a));
+      break;
+    default:
+      console.log('Использование: node tools/mission.js compile|disasm|run|start|stop|status … (см. заголовок файла)');
+      process.exit(1);
+  }
+}
+
+main().catch((err) => {
+  console.error('❌', err.message);
+  process.exit(1);
+});
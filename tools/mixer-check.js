@@ -0,0 +1,119 @@
+/**
+ * ============================================================
+ * 🎚️ Mixer Check — сверка таблиц прошивки с JS-формулами
+ * ============================================================
+ *
+ * Для набора настроек осей (expo, min, max) задаёт их через
+ * POST /api/mixer, читает таблицы GET /api/mixer?table=1 и
+ * сравнивает каждое значение |v| = 0..255 с эталоном —
+ * ControlService._applyExpo() + _remapOutput() из data/control.js.
+ * В конце возвращает исходные настройки.
+ *
+ * Запуск:
+ *   node tools/mixer-check.js <host>
+ *
+ * Код выхода 0 — все таблицы совпали.
+ *
+ * ============================================================
+ */
+
+const fs = require('fs');
+const http = require('http');
+const path = require('path');
+const vm = require('vm');
+
+const HOST = process.argv[2];
+if (!HOST) {
+  console.log('Использование: node tools/mixer-check.js <host>');
+  process.exit(1);
+}
+
+// === Эталон: ControlService из веб-интерфейса ===
+const sandbox = { window: {}, console };
+vm.runInNewContext(
+  fs.readFileSync(path.join(__dirname, '..', 'data', 'control.js'), 'utf8'),
+  sandbox
+);
+const reference = new sandbox.window.ControlService('/api/control');
+
+function referenceTable(expo, min, max) {
+  const table = [];
+  for (let v = 0; v < 256; v++) {
+    const e = reference._applyExpo(v, expo / 100);
+    table.push(reference._remapOutput(e, min, max));
+  }
+  return table;
+}
+
+// === HTTP ===
+function request(method, urlPath, body) {
+  return new Promise((resolve, reject) => {
+    const data = body ? JSON.stringify(body) : null;
+    const req = http.request({
+      host: HOST,
+      path: urlPath,
+      method,
+      headers: data ? { 'Content-Type': 'application/json', 'Content-Length': Buffer.byteLength(data) } : {},
+    }, (res) => {
+      let text = '';
+      res.on('data', (chunk) => { text += chunk; });
+      res.on('end', () => {
+        if (res.statusCode !== 200) return reject(new Error(`${method} ${urlPath}: HTTP ${res.statusCode} ${text}`));
+        resolve(JSON.parse(text));
+      });
+    });
+    req.on('error', reject);
+    if (data) req.write(data);
+    req.end();
+  });
+}
+
+// === Набор проверок ===
+const CASES = [
+  { expo: 0, min: 0, max: 255 },
+  { expo: 30, min: 0, max: 255 },
+  { expo: 100, min: 0, max: 255 },
+  { expo: -50, min: 0, max: 255 },
+  { expo: -100, min: 0, max: 255 },
+  { expo: 0, min: 60, max: 255 },
+  { expo: 45, min: 80, max: 200 },
+  { expo: -25, min: 40, max: 180 },
+];
+
+async function main() {
+  const original = await request('GET', '/api/mixer');
+  let failed = 0;
+
+  for (const c of CASES) {
+    for (const axis of ['x', 'y']) {
+      await request('POST', '/api/mixer', { axis, ...c });
+      const device = (await request('GET', '/api/mixer?table=1'))[axis].table;
+      const expected = referenceTable(c.expo, c.min, c.max);
+
+      const diffs = [];
+      for (let v = 0; v < 256; v++) {
+        if (device[v] !== expected[v]) diffs.push(`${v}: ${device[v]} ≠ ${expected[v]}`);
+      }
+      const label = `${axis} expo=${c.expo} ${c.min}..${c.max}`;
+      if (diffs.length === 0) {
+        console.log(`✅ ${label}`);
+      } else {
+        failed++;
+        console.log(`❌ ${label}: ${diffs.length} расхождений (${diffs.slice(0, 5).join(', ')})`);
+      }
+    }
+  }
+
+  // Вернуть исходные настройки
+  for (const axis of ['x', 'y']) {
+    await request('POST', '/api/mixer', { axis, ...original[axis] });
+  }
+
+  console.log(failed === 0 ? '\nВсе таблицы совпали с data/control.js' : `\nНе совпало таблиц: ${failed}`);
+  process.exit(failed === 0 ? 0 : 1);
+}
+
+main().catch((err) => {
+  console.error('❌', err.message);
+  process.exit(1);
+});
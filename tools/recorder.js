@@ -0,0 +1,241 @@
+/**
+ * ============================================================
+ * 🎞️ Recorder — журнал команд управления ровера
+ * ============================================================
+ *
+ * Разбирает файлы журнала (GET /api/recorder?download=1, формат —
+ * src/recorder.h), сравнивает прогоны и воспроизводит журнал.
+ *
+ * Запуск:
+ *   node tools/recorder.js info <host|file.rec>
+ *   node tools/recorder.js save <host> <file.rec>
+ *   node tools/recorder.js compare <a> <b>        (host или файл)
+ *   node tools/recorder.js replay <host> <file.rec> [--port 4210]
+ *   node tools/recorder.js bench <host> [--save base.rec] [--lease N]
+ *
+ *   replay — воспроизведение с хоста в исходном темпе: XY/STOP —
+ *            UDP-пакетами (src/udp_control.h), направления — POST
+ *            /api/control; прямые скорости (/api/drive) пропускаются
+ *   bench  — скачать журнал, воспроизвести его на устройстве с
+ *            записью (record=true), скачать прогон и сравнить
+ *            цели моторов out[] и тайминг с исходным; при
+ *            занятой аренде нужен её токен (--lease, иначе 409)
+ *
+ * Код выхода compare/bench: 0 — цели моторов совпали.
+ *
+ * ============================================================
+ */
+
+const dgram = require('dgram');
+const fs = require('fs');
+const http = require('http');
+
+// === Формат (см. src/recorder.h) ===
+const MAGIC = 'RREC';
+const HEADER_LEN = 16;
+const ENTRY_LEN = 20;
+const SOURCES = ['http', 'udp', 'replay'];
+const KINDS = ['stop', 'movement', 'xy', 'drive'];
+const DIRECTIONS = ['stop', 'forward', 'backward', 'left', 'right', 'rotate_left', 'rotate_right'];
+const MOTORS = ['rl', 'fr', 'fl', 'rr'];  // Порядок enum Motor
+
+function parse(buf) {
+  if (buf.length < HEADER_LEN || buf.toString('ascii', 0, 4) !== MAGIC) {
+    throw new Error('не файл журнала (нет сигнатуры RREC)');
+  }
+  const entrySize = buf.readUInt8(5);
+  if (entrySize !== ENTRY_LEN) throw new Error(`размер записи ${entrySize}, ожидался ${ENTRY_LEN}`);
+  const count = buf.readUInt32LE(8);
+  const rec = {
+    version: buf.readUInt8(4),
+    rateHz: buf.readUInt16LE(6),
+    lost: buf.readUInt32LE(12),
+    entries: [],
+  };
+  for (let i = 0; i < count; i++) {
+    const o = HEADER_LEN + i * ENTRY_LEN;
+    if (o + ENTRY_LEN > buf.length) throw new Error(`файл обрезан: ${i}/${count} записей`);
+    rec.entries.push({
+      stampUs: buf.readUInt32LE(o),
+      source: buf.readUInt8(o + 4),
+      kind: buf.readUInt8(o + 5),
+      direction: buf.readUInt8(o + 6),
+      speed: buf.readUInt8(o + 7),
+      x: buf.readInt16LE(o + 8),
+      y: buf.readInt16LE(o + 10),
+      drive: [...buf.subarray(o + 12, o + 16)],
+      out: [...buf.subarray(o + 16, o + 20)],
+    });
+  }
+  return rec;
+}
+
+// === HTTP ===
+function request(host, method, urlPath, body) {
+  return new Promise((resolve, reject) => {
+    const data = body ? JSON.stringify(body) : null;
+    const req = http.request({
+      host,
+      path: urlPath,
+      method,
+      headers: data ? { 'Content-Type': 'application/json', 'Content-Length': Buffer.byteLength(data) } : {},
+    }, (res) => {
+      const chunks = [];
+      res.on('data', (chunk) => chunks.push(chunk));
+      res.on('end', () => {
+        const buf = Buffer.concat(chunks);
+        if (res.statusCode !== 200) return reject(new Error(`${method} ${urlPath}: HTTP ${res.statusCode} ${buf}`));
+        resolve(buf);
+      });
+    });
+    req.on('error', reject);
+    if (data) req.write(data);
+    req.end();
+  });
+}
+
+const api = async (host, body) => JSON.parse(await request(host, body ? 'POST' : 'GET', '/api/recorder', body));
+const download = (host) => request(host, 'GET', '/api/recorder?download=1');
+
+/** Журнал из файла или с устройства */
+async function load(src) {
+  if (fs.existsSync(src)) return parse(fs.readFileSync(src));
+  return parse(await download(src));
+}
+
+// === Команды ===
+function info(rec) {
+  const n = rec.entries.length;
+  const span = n > 1 ? (rec.entries[n - 1].stampUs - rec.entries[0].stampUs) >>> 0 : 0;
+  const bySource = {};
+  const byKind = {};
+  for (const e of rec.entries) {
+    const s = SOURCES[e.source] || e.source;
+    const k = KINDS[e.kind] || e.kind;
+    bySource[s] = (bySource[s] || 0) + 1;
+    byKind[k] = (byKind[k] || 0) + 1;
+  }
+  console.log(`Записей: ${n} (затёрто до начала: ${rec.lost}), ${(span / 1e6).toFixed(1)} с, тик ${rec.rateHz} Гц`);
+  console.log('Источники:', bySource);
+  console.log('Команды:  ', byKind);
+}
+
+/** Относительное время записи i (мкс от первой) */
+const rel = (rec, i) => (rec.entries[i].stampUs - rec.entries[0].stampUs) >>> 0;
+
+function compare(a, b) {
+  const n = Math.min(a.entries.length, b.entries.length);
+  const diffs = [];
+  const timing = [];
+  for (let i = 0; i < n; i++) {
+    const ea = a.entries[i];
+    const eb = b.entries[i];
+    if (ea.kind !== eb.kind || ea.out.join() !== eb.out.join()) {
+      diffs.push(`#${i} ${KINDS[ea.kind]}: [${ea.out}] ≠ ${KINDS[eb.kind]}: [${eb.out}]`);
+    }
+    timing.push(Math.abs(rel(a, i) - rel(b, i)));
+  }
+
+  console.log(`Сравнено записей: ${n} (${a.entries.length} / ${b.entries.length})`);
+  if (timing.length > 0) {
+    const sorted = timing.sort((x, y) => x - y);
+    const pct = (p) => (sorted[Math.min(sorted.length - 1, Math.floor(sorted.length * p))] / 1000).toFixed(2);
+    console.log(`Расхождение времени: p50 ${pct(0.5)} мс, p99 ${pct(0.99)} мс, max ${pct(1)} мс`);
+  }
+  if (diffs.length === 0 && a.entries.length === b.entries.length) {
+    console.log(`✅ Цели моторов (${MOTORS.join('/')}) совпали`);
+    return true;
+  }
+  console.log(`❌ Расхождений целей: ${diffs.length}`);
+  diffs.slice(0, 10).forEach((d) => console.log('   ' + d));
+  return false;
+}
+
+async function replay(host, rec, port) {
+  const sock = dgram.createSocket('udp4');
+  const sleep = (ms) => new Promise((r) => setTimeout(r, ms));
+  const startMs = Date.now();
+  let seq = 1;
+  let skipped = 0;
+
+  for (let i = 0; i < rec.entries.length; i++) {
+    const e = rec.entries[i];
+    const waitMs = startMs + rel(rec, i) / 1000 - Date.now();
+    if (waitMs > 0) await sleep(waitMs);
+
+    if (e.kind === 0 || e.kind === 2) {
+      // STOP / XY — пакет UDP-канала без ACK
+      const buf = Buffer.alloc(16);
+      buf.writeUInt8(0x52, 0);
+      buf.writeUInt8(1, 1);
+      buf.writeUInt8(e.kind === 2 ? 1 : 2, 2);
+      buf.writeUInt32LE(seq++, 4);
+      buf.writeInt16LE(e.x, 12);
+      buf.writeInt16LE(e.y, 14);
+      sock.send(buf, port, host);
+    } else if (e.kind === 1) {
+      request(host, 'POST', '/api/control',
+        { type: 'direction', direction: DIRECTIONS[e.direction], speed: e.speed }).catch(() => {});
+    } else {
+      skipped++;
+    }
+  }
+  sock.close();
+  console.log(`Воспроизведено: ${rec.entries.length - skipped}, пропущено прямых скоростей: ${skipped}`);
+}
+
+async function bench(host, savePath, lease) {
+  const baseBuf = await download(host);
+  const base = parse(baseBuf);
+  if (savePath) fs.writeFileSync(savePath, baseBuf);
+  if (base.entries.length === 0) throw new Error('журнал пуст');
+  console.log(`Исходный журнал: ${base.entries.length} записей`);
+
+  await api(host, { action: 'replay', record: true, lease });
+  let st;
+  do {
+    await new Promise((r) => setTimeout(r, 500));
+    st = await api(host);
+    process.stdout.write(`\r▶️ ${st.replayed}/${st.replay_total}`);
+  } while (st.replaying);
+  console.log();
+
+  return compare(base, parse(await download(host)));
+}
+
+// === Точка входа ===
+async function main() {
+  const [cmd, a, b] = process.argv.slice(2);
+  const args = process.argv.slice(2);
+  const argValue = (name, def) => {
+    const i = args.indexOf(name);
+    return i >= 0 ? args[i + 1] : def;
+  };
+
+  switch (cmd) {
+    case 'info':
+      info(await load(a));
+      break;
+    case 'save':
+      fs.writeFileSync(b, await download(a));
+      console.log(`💾 ${b}`);
+      break;
+    case 'compare':
+      process.exit(compare(await load(a), await load(b)) ? 0 : 1);
+      break;
+    case 'replay':
+      await replay(a, parse(fs.readFileSync(b)), parseInt(argValue('--port', 4210)));
+      break;
+    case 'bench':
+      process.exit(await bench(a, argValue('--save', null), parseInt(argValue('--lease', 0))) ? 0 : 1);
+      break;
+    default:
+      console.log('Использование: node tools/recorder.js info|save|compare|replay|bench … (см. заголовок файла)');
+      process.exit(1);
+  }
+}
+
+main().catch((err) => {
+  console.error('❌', err.message);
+  process.exit(1);
+});
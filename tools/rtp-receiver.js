@@ -0,0 +1,262 @@
+/**
+ * ============================================================
+ * 📡 RTP Receiver — приёмник RTP/JPEG стрима ровера (RFC 2435)
+ * ============================================================
+ *
+ * Принимает RTP-пакеты и раз в секунду печатает статистику:
+ *   - потери (по разрывам sequence number)
+ *   - jitter (RFC 3550, A.8) в миллисекундах
+ *   - FPS целых/битых кадров и битрейт
+ *
+ * Запуск:
+ *   node tools/rtp-receiver.js [port] [--multicast 239.255.0.81] [--save frame.jpg]
+ *
+ * Стрим включается на ровере:
+ *   curl -X POST http://<rover>/api/rtp -d '{"action":"start"}'                 # unicast на этот хост
+ *   curl -X POST http://<rover>/api/rtp -d '{"action":"start","multicast":true}'
+ *
+ * --save пишет последний целый кадр как JPEG (заголовки
+ * восстанавливаются по RFC 2435, Appendix A).
+ *
+ * ============================================================
+ */
+
+const dgram = require('dgram');
+const fs = require('fs');
+
+// === Аргументы ===
+const args = process.argv.slice(2);
+const argValue = (name) => {
+  const i = args.indexOf(name);
+  return i >= 0 ? args[i + 1] : null;
+};
+const PORT = parseInt(args.find(a => /^\d+$/.test(a))) || 5004;
+const MULTICAST = argValue('--multicast');
+const SAVE_PATH = argValue('--save');
+
+const RTP_CLOCK_HZ = 90000;
+
+// === Статистика (за интервал и всего) ===
+const stats = {
+  packets: 0, bytes: 0, lost: 0, framesOk: 0, framesBad: 0,
+  totalPackets: 0, totalLost: 0,
+};
+let lastSeq = null;
+let jitter = 0;           // В единицах RTP timestamp
+let lastTransit = null;
+
+// Сборка текущего кадра
+let frame = null;         // { ts, parts: Map(offset → Buffer), end, type, width, height, qtables }
+
+// ============================================================
+// RFC 2435 Appendix A — восстановление JFIF-заголовков
+// ============================================================
+
+const LUM_DC_CODELENS = [0, 1, 5, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0];
+const LUM_DC_SYMBOLS = [0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11];
+const LUM_AC_CODELENS = [0, 2, 1, 3, 3, 2, 4, 3, 5, 5, 4, 4, 0, 0, 1, 0x7d];
+const LUM_AC_SYMBOLS = [
+  0x01, 0x02, 0x03, 0x00, 0x04, 0x11, 0x05, 0x12, 0x21, 0x31, 0x41, 0x06, 0x13, 0x51, 0x61, 0x07,
+  0x22, 0x71, 0x14, 0x32, 0x81, 0x91, 0xa1, 0x08, 0x23, 0x42, 0xb1, 0xc1, 0x15, 0x52, 0xd1, 0xf0,
+  0x24, 0x33, 0x62, 0x72, 0x82, 0x09, 0x0a, 0x16, 0x17, 0x18, 0x19, 0x1a, 0x25, 0x26, 0x27, 0x28,
+  0x29, 0x2a, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49,
+  0x4a, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5a, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69,
+  0x6a, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7a, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89,
+  0x8a, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9a, 0xa2, 0xa3, 0xa4, 0xa5, 0xa6, 0xa7,
+  0xa8, 0xa9, 0xaa, 0xb2, 0xb3, 0xb4, 0xb5, 0xb6, 0xb7, 0xb8, 0xb9, 0xba, 0xc2, 0xc3, 0xc4, 0xc5,
+  0xc6, 0xc7, 0xc8, 0xc9, 0xca, 0xd2, 0xd3, 0xd4, 0xd5, 0xd6, 0xd7, 0xd8, 0xd9, 0xda, 0xe1, 0xe2,
+  0xe3, 0xe4, 0xe5, 0xe6, 0xe7, 0xe8, 0xe9, 0xea, 0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8,
+  0xf9, 0xfa,
+];
+const CHM_DC_CODELENS = [0, 3, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0];
+const CHM_DC_SYMBOLS = [0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11];
+const CHM_AC_CODELENS = [0, 2, 1, 2, 4, 4, 3, 4, 7, 5, 4, 4, 0, 1, 2, 0x77];
+const CHM_AC_SYMBOLS = [
+  0x00, 0x01, 0x02, 0x03, 0x11, 0x04, 0x05, 0x21, 0x31, 0x06, 0x12, 0x41, 0x51, 0x07, 0x61, 0x71,
+  0x13, 0x22, 0x32, 0x81, 0x08, 0x14, 0x42, 0x91, 0xa1, 0xb1, 0xc1, 0x09, 0x23, 0x33, 0x52, 0xf0,
+  0x15, 0x62, 0x72, 0xd1, 0x0a, 0x16, 0x24, 0x34, 0xe1, 0x25, 0xf1, 0x17, 0x18, 0x19, 0x1a, 0x26,
+  0x27, 0x28, 0x29, 0x2a, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48,
+  0x49, 0x4a, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5a, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68,
+  0x69, 0x6a, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7a, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87,
+  0x88, 0x89, 0x8a, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9a, 0xa2, 0xa3, 0xa4, 0xa5,
+  0xa6, 0xa7, 0xa8, 0xa9, 0xaa, 0xb2, 0xb3, 0xb4, 0xb5, 0xb6, 0xb7, 0xb8, 0xb9, 0xba, 0xc2, 0xc3,
+  0xc4, 0xc5, 0xc6, 0xc7, 0xc8, 0xc9, 0xca, 0xd2, 0xd3, 0xd4, 0xd5, 0xd6, 0xd7, 0xd8, 0xd9, 0xda,
+  0xe2, 0xe3, 0xe4, 0xe5, 0xe6, 0xe7, 0xe8, 0xe9, 0xea, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8,
+  0xf9, 0xfa,
+];
+
+function huffmanSegment(codelens, symbols, tableNo, tableClass) {
+  const len = 2 + 1 + 16 + symbols.length;
+  return Buffer.from([
+    0xff, 0xc4, len >> 8, len & 0xff, (tableClass << 4) | tableNo,
+    ...codelens, ...symbols,
+  ]);
+}
+
+/**
+ * Собрать JFIF-заголовок по RFC 2435 (SOI … SOS)
+ */
+function makeHeaders(type, width, height, qtables) {
+  const parts = [Buffer.from([0xff, 0xd8])];
+
+  qtables.forEach((table, i) => {
+    parts.push(Buffer.from([0xff, 0xdb, 0x00, 67, i]), table);
+  });
+
+  const chromaQ = qtables.length > 1 ? 1 : 0;
+  parts.push(Buffer.from([
+    0xff, 0xc0, 0x00, 17, 8,
+    height >> 8, height & 0xff, width >> 8, width & 0xff, 3,
+    1, type === 0 ? 0x21 : 0x22, 0,
+    2, 0x11, chromaQ,
+    3, 0x11, chromaQ,
+  ]));
+
+  parts.push(huffmanSegment(LUM_DC_CODELENS, LUM_DC_SYMBOLS, 0, 0));
+  parts.push(huffmanSegment(LUM_AC_CODELENS, LUM_AC_SYMBOLS, 0, 1));
+  parts.push(huffmanSegment(CHM_DC_CODELENS, CHM_DC_SYMBOLS, 1, 0));
+  parts.push(huffmanSegment(CHM_AC_CODELENS, CHM_AC_SYMBOLS, 1, 1));
+
+  parts.push(Buffer.from([
+    0xff, 0xda, 0x00, 12, 3,
+    1, 0x00, 2, 0x11, 3, 0x11,
+    0, 63, 0,
+  ]));
+
+  return Buffer.concat(parts);
+}
+
+// ============================================================
+// Приём пакетов
+// ============================================================
+
+function finishFrame() {
+  if (!frame) return;
+
+  // Кадр целый, если фрагменты идут без дыр от 0 до маркера
+  let expected = 0;
+  const offsets = [...frame.parts.keys()].sort((a, b) => a - b);
+  for (const off of offsets) {
+    if (off !== expected) break;
+    expected += frame.parts.get(off).length;
+  }
+  const complete = frame.end !== null && expected === frame.end && frame.qtables;
+
+  if (complete) {
+    stats.framesOk++;
+    if (SAVE_PATH) {
+      const scan = Buffer.concat(offsets.map(o => frame.parts.get(o)));
+      const jpeg = Buffer.concat([
+        makeHeaders(frame.type, frame.width, frame.height, frame.qtables),
+        scan,
+        Buffer.from([0xff, 0xd9]),
+      ]);
+      fs.writeFileSync(SAVE_PATH, jpeg);
+    }
+  } else {
+    stats.framesBad++;
+  }
+  frame = null;
+}
+
+function onPacket(msg) {
+  const arrival = Number(process.hrtime.bigint() / 1000n);  // мкс
+  if (msg.length < 20 || (msg[0] >> 6) !== 2) return;
+
+  const marker = (msg[1] & 0x80) !== 0;
+  const seq = msg.readUInt16BE(2);
+  const ts = msg.readUInt32BE(4);
+
+  stats.packets++;
+  stats.totalPackets++;
+  stats.bytes += msg.length;
+
+  // --- Потери по sequence number ---
+  if (lastSeq !== null) {
+    const gap = (seq - lastSeq - 1 + 0x10000) & 0xffff;
+    if (gap > 0 && gap < 0x8000) {
+      stats.lost += gap;
+      stats.totalLost += gap;
+    }
+  }
+  lastSeq = seq;
+
+  // --- Jitter (RFC 3550, A.8) ---
+  const transit = (arrival * RTP_CLOCK_HZ) / 1e6 - ts;
+  if (lastTransit !== null) {
+    const d = Math.abs(transit - lastTransit);
+    jitter += (d - jitter) / 16;
+  }
+  lastTransit = transit;
+
+  // --- RFC 2435 JPEG header ---
+  let p = 12;
+  const offset = msg.readUIntBE(p + 1, 3);
+  const type = msg[p + 4];
+  const q = msg[p + 5];
+  const width = msg[p + 6] * 8;
+  const height = msg[p + 7] * 8;
+  p += 8;
+
+  if (!frame || frame.ts !== ts) {
+    finishFrame();
+    frame = { ts, parts: new Map(), end: null, type, width, height, qtables: null };
+  }
+
+  if (offset === 0 && q >= 128) {
+    const qLen = msg.readUInt16BE(p + 2);
+    p += 4;
+    const tables = [];
+    for (let i = 0; i + 64 <= qLen; i += 64) {
+      tables.push(msg.subarray(p + i, p + i + 64));
+    }
+    frame.qtables = tables;
+    p += qLen;
+  }
+
+  const data = msg.subarray(p);
+  frame.parts.set(offset, Buffer.from(data));
+  if (marker) {
+    frame.end = offset + data.length;
+    finishFrame();
+  }
+}
+
+// ============================================================
+// Запуск
+// ============================================================
+
+const socket = dgram.createSocket({ type: 'udp4', reuseAddr: true });
+
+socket.on('message', onPacket);
+socket.on('error', (err) => {
+  console.error('❌ Socket error:', err.message);
+  process.exit(1);
+});
+
+socket.bind(PORT, () => {
+  if (MULTICAST) socket.addMembership(MULTICAST);
+  console.log(`📡 RTP receiver: порт ${PORT}${MULTICAST ? `, группа ${MULTICAST}` : ''}`);
+  if (SAVE_PATH) console.log(`💾 Последний кадр → ${SAVE_PATH}`);
+});
+
+setInterval(() => {
+  const expected = stats.packets + stats.lost;
+  const lossPct = expected > 0 ? (stats.lost / expected) * 100 : 0;
+  const totalExpected = stats.totalPackets + stats.totalLost;
+  const totalLossPct = totalExpected > 0 ? (stats.totalLost / totalExpected) * 100 : 0;
+  const jitterMs = (jitter / RTP_CLOCK_HZ) * 1000;
+
+  console.log(
+    `🎞️ ${stats.framesOk} fps (битых ${stats.framesBad}) | ` +
+    `${(stats.bytes * 8 / 1000).toFixed(0)} kbit/s | ` +
+    `потери ${stats.lost} пак. (${lossPct.toFixed(1)}%, всего ${totalLossPct.toFixed(2)}%) | ` +
+    `jitter ${jitterMs.toFixed(1)} мс`
+  );
+
+  stats.packets = 0;
+  stats.bytes = 0;
+  stats.lost = 0;
+  stats.framesOk = 0;
+  stats.framesBad = 0;
+}, 1000);
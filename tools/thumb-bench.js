@@ -0,0 +1,120 @@
+/**
+ * ============================================================
+ * 🖼️ Thumb Bench — пропускная способность воркера миниатюр
+ * ============================================================
+ *
+ * Для каждого масштаба (2, 4, 8) делает --count запросов
+ * GET /photo?scale=N по одному и до и после серии снимает
+ * GET /api/thumbnail. Итог по масштабу:
+ *
+ *   кадр/с     — с клиента (включая захват, Wi-Fi и ответ)
+ *   p50/p99    — время запроса клиента (мс)
+ *   decode/enc — среднее время этапов воркера за серию (мкс, EMA
+ *                устройства) — потолок пропускной способности
+ *                перекодирования без сети
+ *   размер     — средний размер миниатюры (байт)
+ *
+ * Затем (--stream S) держит /stream?scale=4 S секунд и печатает
+ * fps воркера из /api/thumbnail — асинхронный режим стрима.
+ *
+ * Запуск:
+ *   node tools/thumb-bench.js <host> [--count 30] [--stream 10]
+ *
+ * ============================================================
+ */
+
+const http = require('http');
+
+// === Аргументы ===
+const args = process.argv.slice(2);
+const argValue = (name, def) => {
+  const i = args.indexOf(name);
+  return i >= 0 ? args[i + 1] : def;
+};
+const HOST = args[0] && !args[0].startsWith('--') ? args[0] : null;
+const COUNT = parseInt(argValue('--count', 30));
+const STREAM_S = parseInt(argValue('--stream', 10));
+const STREAM_PORT = 81;
+
+if (!HOST) {
+  console.log('Использование: node tools/thumb-bench.js <host> [--count 30] [--stream 10]');
+  process.exit(1);
+}
+
+const nowUs = () => Number(process.hrtime.bigint() / 1000n);
+const sleep = (ms) => new Promise((r) => setTimeout(r, ms));
+const agent = new http.Agent({ keepAlive: true, maxSockets: 1 });
+
+/** GET → Buffer (ошибка на статусе ≠ 200) */
+function get(path) {
+  return new Promise((resolve, reject) => {
+    http.get({ host: HOST, path, agent }, (res) => {
+      const chunks = [];
+      res.on('data', (chunk) => chunks.push(chunk));
+      res.on('end', () => {
+        if (res.statusCode !== 200) reject(new Error(`${path}: HTTP ${res.statusCode}`));
+        else resolve(Buffer.concat(chunks));
+      });
+    }).on('error', reject);
+  });
+}
+
+const stats = async () => JSON.parse((await get('/api/thumbnail')).toString());
+
+async function benchScale(scale) {
+  const before = await stats();
+  const times = [];
+  let bytes = 0;
+  const t0 = nowUs();
+  for (let i = 0; i < COUNT; i++) {
+    const t = nowUs();
+    const jpg = await get(`/photo?scale=${scale}`);
+    times.push(nowUs() - t);
+    bytes += jpg.length;
+  }
+  const elapsed = nowUs() - t0;
+  const after = await stats();
+
+  times.sort((a, b) => a - b);
+  const pct = (p) => times[Math.min(times.length - 1, Math.floor(times.length * p))];
+  const ms = (us) => (us / 1000).toFixed(1).padStart(7);
+  console.log(
+    `1/${scale}  ${(COUNT * 1e6 / elapsed).toFixed(1).padStart(6)} ` +
+    `${ms(pct(0.5))} ${ms(pct(0.99))} ` +
+    `${String(after.decode_us.avg).padStart(8)} ${String(after.encode_us.avg).padStart(8)} ` +
+    `${String(Math.round(bytes / COUNT)).padStart(8)}` +
+    `${after.failed > before.failed ? `   ошибок: ${after.failed - before.failed}` : ''}`
+  );
+}
+
+/** /stream?scale=4 — fps воркера в асинхронном режиме */
+async function benchStream() {
+  const req = http.get({ host: HOST, port: STREAM_PORT, path: '/stream?scale=4' }, (res) => res.resume());
+  req.on('error', () => {});
+  await sleep(2000);                          // Прогрев: камера, первый кадр
+  const before = await stats();
+  const fps = [];
+  for (let s = 0; s < STREAM_S; s++) {
+    await sleep(1000);
+    fps.push((await stats()).fps);
+  }
+  const after = await stats();
+  req.destroy();
+  const avg = fps.reduce((a, b) => a + b, 0) / fps.length;
+  console.log(`\n/stream?scale=4 ${STREAM_S} с: воркер ${avg.toFixed(1)} кадр/с ` +
+              `(мин ${Math.min(...fps)}, макс ${Math.max(...fps)}), ` +
+              `вытеснено ${after.dropped - before.dropped}`);
+}
+
+async function main() {
+  console.log(`🖼️ ${HOST}: ${COUNT} снимков на масштаб\n`);
+  console.log('       кадр/с     p50     p99   decode   encode   размер');
+  for (const scale of [2, 4, 8]) await benchScale(scale);
+  if (STREAM_S > 0) await benchStream();
+  agent.destroy();
+}
+
+main().catch((err) => {
+  console.error('❌', err.message);
+  process.exit(1);
+});
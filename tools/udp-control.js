@@ -0,0 +1,181 @@
+/**
+ * ============================================================
+ * 🛰️ UDP Control — клиент бинарного канала управления ровера
+ * ============================================================
+ *
+ * Шлёт 16-байтные пакеты управления (src/udp_control.h) с флагом ACK
+ * и меряет RTT по эхо clientTimeUs. Односторонняя латентность
+ * команды ≈ RTT / 2.
+ *
+ * Запуск:
+ *   node tools/udp-control.js <host> [--port 4210] [--rate 50] [--count 500]
+ *                              [--xy 0,120] [--stale] [--http]
+ *
+ *   по умолчанию — PING (ровер не двигается, только ACK)
+ *   --xy x,y  — слать команду джойстика (ровер ПОЕДЕТ!)
+ *   --stale   — STOP-пакеты, каждый 10-й повторяется со старым seq:
+ *               проверка, что устройство отбрасывает устаревшие
+ *   --http    — для сравнения тот же замер через POST /api/control
+ *
+ * ============================================================
+ */
+
+const dgram = require('dgram');
+const http = require('http');
+
+// === Аргументы ===
+const args = process.argv.slice(2);
+const argValue = (name, def) => {
+  const i = args.indexOf(name);
+  return i >= 0 ? args[i + 1] : def;
+};
+const HOST = args[0] && !args[0].startsWith('--') ? args[0] : null;
+const PORT = parseInt(argValue('--port', 4210));
+const RATE = parseInt(argValue('--rate', 50));
+const COUNT = parseInt(argValue('--count', 500));
+const XY = argValue('--xy', null);
+const STALE = args.includes('--stale');
+const HTTP = args.includes('--http');
+
+if (!HOST) {
+  console.log('Использование: node tools/udp-control.js <host> [--port 4210] [--rate 50] [--count 500] [--xy x,y] [--stale] [--http]');
+  process.exit(1);
+}
+
+// === Протокол (см. src/udp_control.h) ===
+const MAGIC = 0x52;
+const VERSION = 1;
+const TYPE_XY = 1;
+const TYPE_STOP = 2;
+const TYPE_PING = 3;
+const TYPE_ACK = 0x81;
+const FLAG_ACK = 0x01;
+
+const nowUs = () => Number(process.hrtime.bigint() / 1000n);
+
+function encode(type, seq, x = 0, y = 0) {
+  const buf = Buffer.alloc(16);
+  buf.writeUInt8(MAGIC, 0);
+  buf.writeUInt8(VERSION, 1);
+  buf.writeUInt8(type, 2);
+  buf.writeUInt8(FLAG_ACK, 3);
+  buf.writeUInt32LE(seq >>> 0, 4);
+  buf.writeUInt32LE(nowUs() >>> 0, 8);
+  buf.writeInt16LE(x, 12);
+  buf.writeInt16LE(y, 14);
+  return buf;
+}
+
+// === Статистика ===
+function summary(label, rtts, sent) {
+  if (rtts.length === 0) {
+    console.log(`${label}: ответов нет (отправлено ${sent})`);
+    return;
+  }
+  const sorted = [...rtts].sort((a, b) => a - b);
+  const pct = (p) => sorted[Math.min(sorted.length - 1, Math.floor(sorted.length * p))];
+  const avg = sorted.reduce((s, v) => s + v, 0) / sorted.length;
+  const ms = (us) => (us / 1000).toFixed(2);
+  console.log(
+    `${label}: ${sorted.length}/${sent} ответов, потери ${((1 - sorted.length / sent) * 100).toFixed(1)}%\n` +
+    `  RTT мс: min ${ms(sorted[0])}  avg ${ms(avg)}  p50 ${ms(pct(0.5))}  ` +
+    `p95 ${ms(pct(0.95))}  p99 ${ms(pct(0.99))}  max ${ms(sorted[sorted.length - 1])}\n` +
+    `  ≈ односторонняя латентность p50: ${ms(pct(0.5) / 2)} мс`
+  );
+}
+
+// ============================================================
+// UDP замер
+// ============================================================
+
+function runUdp() {
+  return new Promise((resolve) => {
+    const sock = dgram.createSocket('udp4');
+    const rtts = [];
+    let sent = 0;
+    let staleSent = 0;
+    let rejected = 0;
+    let seq = 1;
+
+    let type = TYPE_PING;
+    let x = 0;
+    let y = 0;
+    if (XY) {
+      [x, y] = XY.split(',').map(v => parseInt(v));
+      type = TYPE_XY;
+    }
+    if (STALE) type = TYPE_STOP;
+
+    sock.on('message', (msg) => {
+      if (msg.length !== 16 || msg[0] !== MAGIC || msg[2] !== TYPE_ACK) return;
+      const rtt = ((nowUs() >>> 0) - msg.readUInt32LE(8)) >>> 0;
+      rtts.push(rtt);
+      if (!(msg[3] & 0x01) && type !== TYPE_PING) rejected++;
+    });
+
+    const timer = setInterval(() => {
+      if (sent >= COUNT) {
+        clearInterval(timer);
+        // Стоп после XY, затем ждём последние ACK
+        if (type === TYPE_XY) sock.send(encode(TYPE_STOP, seq++), PORT, HOST);
+        setTimeout(() => {
+          sock.close();
+          summary(`🛰️ UDP ${HOST}:${PORT}`, rtts, sent + staleSent);
+          if (STALE) {
+            console.log(`  устаревших отправлено ${staleSent}, отклонено устройством: ${rejected} (ожидается ${staleSent})`);
+          }
+          resolve();
+        }, 500);
+        return;
+      }
+
+      sock.send(encode(type, seq, x, y), PORT, HOST);
+      sent++;
+
+      // Повтор пакета со старым seq
+      if (STALE && sent % 10 === 0) {
+        sock.send(encode(TYPE_STOP, seq - 5), PORT, HOST);
+        staleSent++;
+      }
+      seq++;
+    }, 1000 / RATE);
+  });
+}
+
+// ============================================================
+// HTTP замер (для сравнения)
+// ============================================================
+
+function postStop() {
+  return new Promise((resolve) => {
+    const body = JSON.stringify({ type: 'stop' });
+    const t0 = nowUs();
+    const req = http.request({
+      host: HOST, port: 80, path: '/api/control', method: 'POST',
+      headers: { 'Content-Type': 'application/json', 'Content-Length': body.length },
+    }, (res) => {
+      res.resume();
+      res.on('end', () => resolve(nowUs() - t0));
+    });
+    req.on('error', () => resolve(null));
+    req.setTimeout(2000, () => { req.destroy(); });
+    req.end(body);
+  });
+}
+
+async function runHttp() {
+  const rtts = [];
+  const n = Math.min(COUNT, 200);
+  for (let i = 0; i < n; i++) {
+    const rtt = await postStop();
+    if (rtt !== null) rtts.push(rtt);
+    await new Promise(r => setTimeout(r, 1000 / RATE));
+  }
+  summary(`🌐 HTTP POST http://${HOST}/api/control`, rtts, n);
+}
+
+(async () => {
+  console.log(`🛰️ ${COUNT} пакетов, ${RATE} Гц → ${HOST}:${PORT}`);
+  await runUdp();
+  if (HTTP) await runHttp();
+})();
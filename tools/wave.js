@@ -0,0 +1,309 @@
+/**
+ * ============================================================
+ * 〰️ Wave — формы скважности для характеризации моторов
+ * ============================================================
+ *
+ * Собирает форму (ступенька, чирп, ПСП) в формат проигрывателя
+ * прошивки (src/wave_format.h), загружает в /api/wave, запускает и
+ * скачивает журнал прогона: на каждый отсчёт — время тика, время
+ * записи в бэкенд и фактический выход всех каналов. Тайминг
+ * отсчётов держит задача управления — сеть в прогоне не участвует.
+ *
+ * Запуск:
+ *   node tools/wave.js gen <step|chirp|prbs> [опции] -o file.rw
+ *   node tools/wave.js run <host> <file.rw|step|chirp|prbs> [опции] [--csv out.csv]
+ *   node tools/wave.js log <host|file.wlg> [--csv out.csv] [--save file.wlg]
+ *   node tools/wave.js stop|status <host>
+ *
+ * Опции формы:
+ *   --ch fl,fr         каналы (fl fr rl rr), одна форма на все
+ *   --rate 200         частота отсчётов, Гц (делитель CONTROL_RATE_HZ)
+ *   --len 5s           длительность: 1500ms, 5s
+ *   --low 0 --high 200 уровни скважности
+ *   step:  --at 1s     момент ступеньки low → high
+ *   chirp: --f0 0.2 --f1 10   линейный чирп, Гц (вокруг (low+high)/2)
+ *   prbs:  --bit 50ms  длительность бита ПСП-7 (x^7 + x^6 + 1)
+ *
+ * CSV журнала: sample,t_us,done_us,dev_us,written,rl,fr,fl,rr
+ *   t_us — от тика первого отсчёта, dev_us — от идеальной сетки
+ *
+ * ⚠️ Ровер ПОЕДЕТ — поднимите колёса.
+ *
+ * ============================================================
+ */
+
+const fs = require('fs');
+const http = require('http');
+
+// === Формат (см. src/wave_format.h, журнал — src/wave.h) ===
+const MAGIC = [0x52, 0x57];          // "RW"
+const VERSION = 1;
+const HEADER_LEN = 8;
+const LOG_MAGIC = 'RWLG';
+const LOG_HEADER_LEN = 16;
+const LOG_ENTRY_LEN = 16;
+const MOTORS = ['rl', 'fr', 'fl', 'rr'];  // Порядок enum Motor
+const MAX_SAMPLES = 12000;                 // WAVE_MAX_SAMPLES
+
+// === Генератор ===
+
+/** Длительность: 1500 | 1500ms | 2s | 0.5s → мс */
+function parseDuration(text) {
+  const m = /^(\d+(?:\.\d+)?)(ms|s)?$/.exec(text || '');
+  if (!m) throw new Error(`не длительность «${text}»`);
+  return parseFloat(m[1]) * (m[2] === 's' ? 1000 : 1);
+}
+
+function parseMask(text) {
+  let mask = 0;
+  for (const name of text.split(',')) {
+    const i = MOTORS.indexOf(name.trim());
+    if (i < 0) throw new Error(`неизвестный канал «${name}» (fl fr rl rr)`);
+    mask |= 1 << i;
+  }
+  return mask;
+}
+
+/** Отсчёты формы 0-255 по типу и опциям */
+function generate(kind, opt) {
+  const rate = Number(opt.rate);
+  const count = Math.round(parseDuration(opt.len) * rate / 1000);
+  const low = Number(opt.low);
+  const high = Number(opt.high);
+  if (!(count > 0 && count <= MAX_SAMPLES)) throw new Error(`${count} отсчётов, допустимо 1..${MAX_SAMPLES}`);
+  if (!(low >= 0 && high <= 255 && low <= high)) throw new Error('уровни: 0 ≤ low ≤ high ≤ 255');
+
+  const samples = new Uint8Array(count);
+  switch (kind) {
+    case 'step': {
+      const at = Math.round(parseDuration(opt.at) * rate / 1000);
+      for (let i = 0; i < count; i++) samples[i] = i < at ? low : high;
+      break;
+    }
+    case 'chirp': {
+      const f0 = Number(opt.f0);
+      const f1 = Number(opt.f1);
+      const T = count / rate;
+      const mid = (low + high) / 2;
+      const amp = (high - low) / 2;
+      for (let i = 0; i < count; i++) {
+        const t = i / rate;
+        const phase = 2 * Math.PI * (f0 * t + (f1 - f0) * t * t / (2 * T));
+        samples[i] = Math.round(mid + amp * Math.sin(phase));
+      }
+      break;
+    }
+    case 'prbs': {
+      const perBit = Math.max(1, Math.round(parseDuration(opt.bit) * rate / 1000));
+      let lfsr = 0x7f;
+      let bit = 0;
+      for (let i = 0; i < count; i++) {
+        if (i % perBit === 0) {
+          bit = lfsr & 1;
+          const fb = ((lfsr >> 6) ^ (lfsr >> 5)) & 1;
+          lfsr = ((lfsr << 1) | fb) & 0x7f;
+        }
+        samples[i] = bit ? high : low;
+      }
+      break;
+    }
+    default:
+      throw new Error(`неизвестная форма «${kind}» (step chirp prbs)`);
+  }
+  return samples;
+}
+
+/** Собрать файл формы: заголовок + отсчёты, продублированные по каналам маски */
+function build(mask, rate, samples) {
+  const n = MOTORS.filter((_, i) => mask & (1 << i)).length;
+  const buf = Buffer.alloc(HEADER_LEN + samples.length * n);
+  buf[0] = MAGIC[0];
+  buf[1] = MAGIC[1];
+  buf[2] = VERSION;
+  buf[3] = mask;
+  buf.writeUInt16LE(rate, 4);
+  buf.writeUInt16LE(samples.length, 6);
+  for (let i = 0; i < samples.length; i++) buf.fill(samples[i], HEADER_LEN + i * n, HEADER_LEN + (i + 1) * n);
+  return buf;
+}
+
+/** Форма из файла .rw или генератора */
+function loadWave(src, opt) {
+  if (fs.existsSync(src)) {
+    const buf = fs.readFileSync(src);
+    if (buf.length < HEADER_LEN || buf[0] !== MAGIC[0] || buf[1] !== MAGIC[1]) throw new Error(`${src}: не файл формы`);
+    return buf;
+  }
+  const rate = Number(opt.rate);
+  return build(parseMask(opt.ch), rate, generate(src, opt));
+}
+
+// === Журнал прогона ===
+
+function parseLog(buf) {
+  if (buf.length < LOG_HEADER_LEN || buf.toString('ascii', 0, 4) !== LOG_MAGIC) {
+    throw new Error('не журнал формы (нет сигнатуры RWLG)');
+  }
+  const entrySize = buf.readUInt8(5);
+  if (entrySize !== LOG_ENTRY_LEN) throw new Error(`размер записи ${entrySize}, ожидался ${LOG_ENTRY_LEN}`);
+  const log = {
+    mask: buf.readUInt8(6),
+    rateHz: buf.readUInt16LE(8),
+    controlHz: buf.readUInt16LE(10),
+    entries: [],
+  };
+  const count = buf.readUInt32LE(12);
+  for (let i = 0; i < count; i++) {
+    const o = LOG_HEADER_LEN + i * LOG_ENTRY_LEN;
+    if (o + LOG_ENTRY_LEN > buf.length) throw new Error(`файл обрезан: ${i}/${count} записей`);
+    log.entries.push({
+      tickUs: buf.readUInt32LE(o),
+      doneUs: buf.readUInt32LE(o + 4),
+      sample: buf.readUInt16LE(o + 8),
+      written: buf.readUInt8(o + 10),
+      out: [...buf.subarray(o + 11, o + 15)],
+    });
+  }
+  return log;
+}
+
+/** Строки CSV и сводка тайминга */
+function analyze(log) {
+  const periodUs = 1e6 / log.rateHz;
+  const t0 = log.entries.length ? log.entries[0].tickUs : 0;
+  const rows = ['sample,t_us,done_us,dev_us,written,' + MOTORS.join(',')];
+  let devMax = 0;
+  let writeMax = 0;
+  let gaps = 0;
+  log.entries.forEach((e, i) => {
+    const t = (e.tickUs - t0) >>> 0;
+    const dev = t - e.sample * periodUs;
+    devMax = Math.max(devMax, Math.abs(dev));
+    writeMax = Math.max(writeMax, (e.doneUs - e.tickUs) >>> 0);
+    if (i > 0 && e.sample !== log.entries[i - 1].sample + 1) gaps++;
+    rows.push([e.sample, t, (e.doneUs - t0) >>> 0, Math.round(dev), e.written, ...e.out].join(','));
+  });
+  return { rows, devMax, writeMax, gaps };
+}
+
+function printLog(log, csvPath) {
+  const a = analyze(log);
+  const channels = MOTORS.filter((_, i) => log.mask & (1 << i)).join(',');
+  console.log(`〰️ ${log.entries.length} отсчётов, каналы ${channels}, ${log.rateHz} Гц (тик ${log.controlHz} Гц)`);
+  console.log(`   отклонение от сетки ≤ ${Math.round(a.devMax)} мкс, тик → запись ≤ ${a.writeMax} мкс, пропусков индекса ${a.gaps}`);
+  if (csvPath) {
+    fs.writeFileSync(csvPath, a.rows.join('\n') + '\n');
+    console.log(`💾 ${csvPath}`);
+  }
+}
+
+// === HTTP ===
+function request(host, urlPath, body, raw) {
+  return new Promise((resolve, reject) => {
+    const data = body === undefined ? null : Buffer.isBuffer(body) ? body : Buffer.from(JSON.stringify(body));
+    const req = http.request({
+      host,
+      path: urlPath,
+      method: data ? 'POST' : 'GET',
+      headers: data ? {
+        'Content-Type': Buffer.isBuffer(body) ? 'application/octet-stream' : 'application/json',
+        'Content-Length': data.length,
+      } : {},
+    }, (res) => {
+      const chunks = [];
+      res.on('data', (chunk) => chunks.push(chunk));
+      res.on('end', () => {
+        const buf = Buffer.concat(chunks);
+        if (res.statusCode !== 200) return reject(new Error(`${urlPath}: HTTP ${res.statusCode} ${buf}`));
+        resolve(raw ? buf : JSON.parse(buf.toString()));
+      });
+    });
+    req.on('error', reject);
+    if (data) req.write(data);
+    req.end();
+  });
+}
+
+const api = (host, body) => request(host, '/api/wave', body);
+const sleep = (ms) => new Promise((r) => setTimeout(r, ms));
+
+function printStatus(st) {
+  const abort = st.state === 'aborted' ? ` (${st.abort})` : '';
+  console.log(`〰️ ${st.state}${abort}: ${st.played}/${st.count} отсчётов, отклонение ≤ ${st.dev_max_us} мкс`);
+}
+
+async function run(host, wave, csvPath) {
+  await request(host, '/api/wave?upload=1', wave);
+  console.log(`⬆️ Загружено ${wave.length} байт`);
+  // Запуск — с ближайшего тика: ждём, пока счётчик прогонов сдвинется
+  const runs = (await api(host, { action: 'start' })).runs;
+
+  process.on('SIGINT', () => {
+    api(host, { action: 'stop' }).then(printStatus).finally(() => process.exit(130));
+  });
+
+  let st;
+  do {
+    await sleep(250);
+    st = await api(host);
+  } while (st.runs === runs || st.state === 'running');
+  printStatus(st);
+
+  printLog(parseLog(await request(host, '/api/wave?download=1', undefined, true)), csvPath);
+  return st.state === 'done';
+}
+
+// === Точка входа ===
+async function main() {
+  const args = process.argv.slice(2);
+  const [cmd, a, b] = args;
+  const argValue = (name, def) => {
+    const i = args.indexOf(name);
+    return i >= 0 ? args[i + 1] : def;
+  };
+  const opt = {
+    ch: argValue('--ch', 'fl'),
+    rate: argValue('--rate', '200'),
+    len: argValue('--len', '5s'),
+    low: argValue('--low', '0'),
+    high: argValue('--high', '200'),
+    at: argValue('--at', '1s'),
+    f0: argValue('--f0', '0.2'),
+    f1: argValue('--f1', '10'),
+    bit: argValue('--bit', '50ms'),
+  };
+
+  switch (cmd) {
+    case 'gen': {
+      const wave = loadWave(a, opt);
+      const out = argValue('-o', `${a}.rw`);
+      fs.writeFileSync(out, wave);
+      console.log(`💾 ${out}: ${wave.length} байт`);
+      break;
+    }
+    case 'run':
+      process.exit(await run(a, loadWave(b, opt), argValue('--csv')) ? 0 : 1);
+      break;
+    case 'log': {
+      const buf = fs.existsSync(a) ? fs.readFileSync(a) : await request(a, '/api/wave?download=1', undefined, true);
+      const save = argValue('--save');
+      if (save) fs.writeFileSync(save, buf);
+      printLog(parseLog(buf), argValue('--csv'));
+      break;
+    }
+    case 'stop':
+      printStatus(await api(a, { action: 'stop' }));
+      break;
+    case 'status':
+      printStatus(await api(a));
+      break;
+    default:
+      console.log('Использование: node tools/wave.js gen|run|log|stop|status … (см. заголовок файла)');
+      process.exit(1);
+  }
+}
+
+main().catch((err) => {
+  console.error('❌', err.message);
+  process.exit(1);
+});